@@ -3,9 +3,12 @@ import inspect
 import math
 import os
 import random
+import resource
+import sys
+import threading
 import time
 from pathlib import Path
-from typing import Any, Dict, Iterator, List, Tuple, Union
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple, Union
 
 import numpy as np
 import py_progress_tracker as progress
@@ -248,6 +251,62 @@ BENCHMARK_CONFIGURATION = fhe.Configuration(
 )
 
 
+def timed(func: Callable, *args) -> Tuple[Any, float]:
+    """Run a function and return its output along with its execution time, in seconds."""
+    t_start = time.perf_counter()
+    output = func(*args)
+    return output, time.perf_counter() - t_start
+
+
+def get_current_rss() -> int:
+    """Get the resident set size (RSS) of the current process, in bytes.
+
+    On systems without '/proc', the peak RSS since the process started is returned instead.
+    """
+    try:
+        with open("/proc/self/statm", encoding="utf-8") as file:
+            return int(file.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except OSError:
+        max_rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+
+        # The peak RSS is given in bytes on macOS and in kilobytes on Linux
+        return max_rss if sys.platform == "darwin" else max_rss * 1024
+
+
+class PeakRSSMonitor:
+    """Track the peak resident set size (RSS) of the current process while a block runs.
+
+    The process' RSS is sampled from a background thread, which gives the peak reached by each
+    benchmarked configuration instead of the process' overall peak.
+
+    Args:
+        interval (float): The time between two samples, in seconds. Default to 0.01.
+    """
+
+    def __init__(self, interval: float = 0.01):
+        self.interval = interval
+        self.peak_rss = 0
+        self._stop_event = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    def _sample(self):
+        while not self._stop_event.wait(self.interval):
+            self.peak_rss = max(self.peak_rss, get_current_rss())
+
+    def __enter__(self) -> "PeakRSSMonitor":
+        self.peak_rss = get_current_rss()
+        self._stop_event.clear()
+        self._thread = threading.Thread(target=self._sample, daemon=True)
+        self._thread.start()
+        return self
+
+    def __exit__(self, *exc_info):
+        self._stop_event.set()
+        assert self._thread is not None
+        self._thread.join()
+        self.peak_rss = max(self.peak_rss, get_current_rss())
+
+
 def run_and_report_metric(y_gt, y_pred, metric, metric_id, metric_label):
     """Run a single metric and report results to progress tracker"""
     value = metric(y_gt, y_pred) if y_gt.size > 0 else 0
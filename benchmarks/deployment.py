@@ -0,0 +1,360 @@
+import argparse
+import json
+import random
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Any, Dict, Iterator, List, Tuple
+
+import numpy as np
+import py_progress_tracker as progress
+from common import (
+    BENCHMARK_CONFIGURATION,
+    BENCHMARK_PARAMS,
+    CLASSIFIERS,
+    MODELS_STRING_TO_CLASS,
+    REGRESSORS,
+    benchmark_name_generator,
+    seed_everything,
+    timed,
+)
+from sklearn.datasets import make_classification, make_regression
+from sklearn.model_selection import train_test_split
+from sklearn.preprocessing import StandardScaler
+
+from concrete import fhe
+from concrete.ml.deployment import FHEModelClient, FHEModelDev, FHEModelServer
+
+# Models benchmarked by default, chosen for their short FHE execution times
+DEFAULT_DEPLOYMENT_MODELS = [
+    "LogisticRegression",
+    "LinearRegression",
+    "DecisionTreeClassifier",
+    "DecisionTreeRegressor",
+    "XGBClassifier",
+]
+
+DEPLOYMENT_DATASETS = {
+    "classification": "synthetic-classification",
+    "regression": "synthetic-regression",
+}
+
+# Stages of a round trip between the client and the server, in chronological order
+DEPLOYMENT_STAGES = [
+    ("quantize", "Quantization"),
+    ("encrypt", "Encryption"),
+    ("serialize", "Serialization"),
+    ("server-run", "Server Run"),
+    ("deserialize", "Deserialization"),
+    ("decrypt", "Decryption"),
+    ("dequantize", "De-quantization"),
+]
+
+LATENCY_PERCENTILES = [50, 95, 99]
+
+
+def argument_manager():
+    # Manage arguments
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--verbose", action="store_true", help="show more information on stdio")
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=random.randint(0, 2**32 - 1),
+        help="set the seed for reproducibility",
+    )
+    parser.add_argument(
+        "--models",
+        choices=[model.__name__ for model in CLASSIFIERS + REGRESSORS],
+        nargs="+",
+        default=None,
+        help="model(s) to use",
+    )
+    parser.add_argument(
+        "--configs",
+        nargs="+",
+        type=json.loads,
+        default=None,
+        help="config(s) to use",
+    )
+    parser.add_argument(
+        "--model_samples",
+        type=int,
+        default=1,
+        help="number of model samples (i.e., overwrite PROGRESS_SAMPLES)",
+    )
+    parser.add_argument(
+        "--fhe_samples",
+        type=int,
+        default=10,
+        help="number of round trips used for measuring latencies",
+    )
+    parser.add_argument(
+        "--n_features", type=int, default=10, help="number of features of the synthetic data-sets"
+    )
+    parser.add_argument(
+        "--concurrency",
+        type=int,
+        default=4,
+        help="number of concurrent server runs used for measuring the throughput",
+    )
+    parser.add_argument(
+        "--long_list",
+        action="store_true",
+        help="just list the different tasks and stop",
+    )
+    parser.add_argument(
+        "--short_list",
+        action="store_true",
+        help="just list the different tasks (one per model type) and stop",
+    )
+
+    args = parser.parse_args()
+
+    if args.models is None:  # Default to the fast models
+        args.models = [name for name in DEFAULT_DEPLOYMENT_MODELS if name in MODELS_STRING_TO_CLASS]
+
+    # Cast from string to class
+    args.models = [MODELS_STRING_TO_CLASS[name] for name in args.models]
+
+    return args
+
+
+def deployment_benchmark_generator(args) -> Iterator[Tuple[str, type, Dict[str, Any]]]:
+    """Generates all elements to test."""
+    for model_class in args.models:
+        task = "classification" if model_class in CLASSIFIERS else "regression"
+        dataset = DEPLOYMENT_DATASETS[task]
+
+        # By default, only benchmark the first (smallest) configuration of each model
+        configs = args.configs
+        if configs is None:
+            configs = BENCHMARK_PARAMS[model_class.__name__][:1]
+
+        for config in configs:
+            yield (dataset, model_class, config)
+
+
+def get_dataset(dataset: str, n_features: int) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Generate a synthetic data-set, returning the train inputs, train targets and test inputs."""
+    if dataset == DEPLOYMENT_DATASETS["classification"]:
+        x_all, y_all = make_classification(
+            n_samples=1000, n_features=n_features, n_informative=n_features // 2, random_state=42
+        )
+    else:
+        x_all, y_all = make_regression(n_samples=1000, n_features=n_features, random_state=42)
+
+    x_all = x_all.astype(np.float32)
+
+    x_train, x_test, y_train, _ = train_test_split(x_all, y_all, test_size=0.15, random_state=42)
+
+    normalizer = StandardScaler()
+    x_train = normalizer.fit_transform(x_train)
+    x_test = normalizer.transform(x_test)
+
+    return x_train, y_train, x_test
+
+
+def measure_round_trip(
+    client: FHEModelClient,
+    server: FHEModelServer,
+    serialized_evaluation_keys: bytes,
+    x_sample: np.ndarray,
+) -> Tuple[Dict[str, float], int, int]:
+    """Run a single client/server round trip, timing each stage separately.
+
+    Returns the duration of each stage (in seconds) as well as the sizes of the serialized input
+    and output ciphertexts (in bytes).
+    """
+    durations = {}
+
+    # Client side
+    q_x, durations["quantize"] = timed(client.model.quantize_input, x_sample)
+    q_x_encrypted, durations["encrypt"] = timed(client.client.encrypt, q_x)
+    q_x_serialized, durations["serialize"] = timed(q_x_encrypted.serialize)
+
+    # Server side, including the deserialization of inputs, evaluation keys and outputs
+    q_y_serialized, durations["server-run"] = timed(
+        server.run, q_x_serialized, serialized_evaluation_keys
+    )
+
+    # Client side
+    q_y_encrypted, durations["deserialize"] = timed(fhe.Value.deserialize, q_y_serialized)
+    q_y, durations["decrypt"] = timed(client.client.decrypt, q_y_encrypted)
+    _, durations["dequantize"] = timed(
+        lambda q_y: client.model.post_processing(client.model.dequantize_output(q_y)), q_y
+    )
+
+    return durations, len(q_x_serialized), len(q_y_serialized)
+
+
+def measure_throughput(
+    server: FHEModelServer,
+    serialized_evaluation_keys: bytes,
+    q_x_serialized: List[bytes],
+    concurrency: int,
+) -> float:
+    """Measure the number of server runs per second when running them concurrently."""
+    t_start = time.perf_counter()
+
+    with ThreadPoolExecutor(max_workers=concurrency) as pool:
+        list(pool.map(lambda q_x: server.run(q_x, serialized_evaluation_keys), q_x_serialized))
+
+    duration = time.perf_counter() - t_start
+
+    return len(q_x_serialized) / duration if duration > 0 else 0
+
+
+# pylint: disable-next=too-many-locals
+def benchmark_deployment(model_class: type, dataset: str, config: Dict[str, Any], args):
+    """Benchmark the deployment API on a single model.
+
+    The model is trained, compiled and saved using the development API. Then, several round trips
+    between a client and a server are run in order to measure the latency of each stage. Finally,
+    the server's throughput is measured by running several encrypted inputs concurrently.
+    """
+    if args.verbose:
+        print("Fit and compile")
+
+    x_train, y_train, x_test = get_dataset(dataset, args.n_features)
+
+    model = model_class(**config)
+    model.fit(x_train, y_train)
+    model.compile(x_train, configuration=BENCHMARK_CONFIGURATION)
+
+    x_test = x_test[: args.fhe_samples]
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        dev_dir, key_dir = Path(temp_dir) / "dev", Path(temp_dir) / "keys"
+
+        if args.verbose:
+            print("Save and load")
+
+        _, duration = timed(FHEModelDev(path_dir=str(dev_dir), model=model).save)
+        progress.measure(id="deployment-save-time", label="Deployment Save Time", value=duration)
+
+        client = FHEModelClient(path_dir=str(dev_dir), key_dir=str(key_dir))
+        server = FHEModelServer(path_dir=str(dev_dir))
+
+        if args.verbose:
+            print("Key generation")
+
+        serialized_evaluation_keys, duration = timed(client.get_serialized_evaluation_keys)
+        progress.measure(
+            id="deployment-keygen-time", label="Deployment Keygen Time", value=duration
+        )
+        progress.measure(
+            id="evaluation-keys-size",
+            label="Evaluation Keys Size (bytes)",
+            value=len(serialized_evaluation_keys),
+        )
+
+        if args.verbose:
+            print(f"Round trips ({x_test.shape[0]} samples)")
+
+        stage_durations: Dict[str, List[float]] = {stage: [] for stage, _ in DEPLOYMENT_STAGES}
+        latencies = []
+        input_sizes, output_sizes = [], []
+
+        for i in range(x_test.shape[0]):
+            durations, input_size, output_size = measure_round_trip(
+                client, server, serialized_evaluation_keys, x_test[i : i + 1]
+            )
+
+            for stage, duration in durations.items():
+                stage_durations[stage].append(duration)
+
+            latencies.append(sum(durations.values()))
+            input_sizes.append(input_size)
+            output_sizes.append(output_size)
+
+        for stage, stage_label in DEPLOYMENT_STAGES:
+            progress.measure(
+                id=f"deployment-{stage}-time",
+                label=f"Deployment {stage_label} Time per sample",
+                value=float(np.mean(stage_durations[stage])),
+            )
+
+        for percentile in LATENCY_PERCENTILES:
+            progress.measure(
+                id=f"deployment-latency-p{percentile}",
+                label=f"Deployment Latency P{percentile}",
+                value=float(np.percentile(latencies, percentile)),
+            )
+
+        progress.measure(
+            id="input-ciphertext-size",
+            label="Input Ciphertext Size (bytes)",
+            value=float(np.mean(input_sizes)),
+        )
+        progress.measure(
+            id="output-ciphertext-size",
+            label="Output Ciphertext Size (bytes)",
+            value=float(np.mean(output_sizes)),
+        )
+
+        if args.verbose:
+            print(f"Throughput ({args.concurrency} concurrent runs)")
+
+        q_x_serialized = [
+            client.quantize_encrypt_serialize(x_test[i : i + 1]) for i in range(x_test.shape[0])
+        ]
+        progress.measure(
+            id="deployment-throughput",
+            label=f"Deployment Throughput (samples/s, {args.concurrency} concurrent runs)",
+            value=measure_throughput(
+                server, serialized_evaluation_keys, q_x_serialized, args.concurrency
+            ),
+        )
+
+
+def main():
+
+    # Parameters by the user
+    args = argument_manager()
+
+    # Seed everything we can
+    seed_everything(args.seed)
+    print(f"Using --seed {args.seed}")
+
+    all_tasks = list(deployment_benchmark_generator(args))
+
+    # Listing
+    if args.long_list or args.short_list:
+        already_done_models = {}
+        for _, model_class_i, config_i in all_tasks:
+            config_n = json.dumps(config_i).replace("'", '"')
+            model_name_i = model_class_i.__name__
+
+            if not args.short_list or model_name_i not in already_done_models:
+                print(
+                    f"--models {model_name_i} --configs '{config_n}' "
+                    f"--fhe_samples {args.fhe_samples}"
+                )
+                already_done_models[model_name_i] = 1
+        return
+
+    print(f"Will perform benchmarks on {len(all_tasks)} test cases")
+
+    @progress.track(
+        [
+            {
+                "id": benchmark_name_generator(dataset, model, config, "_"),
+                "name": benchmark_name_generator(dataset, model, config, " on "),
+                "parameters": {"model": model, "dataset": dataset, "config": config},
+                "samples": args.model_samples,
+            }
+            for (dataset, model, config) in all_tasks
+        ]
+    )
+    def perform_deployment_benchmark(model, dataset, config):
+        """
+        This is the test function called by the py-progress module. It just calls the
+        benchmark function with the right parameter combination
+        """
+        benchmark_deployment(model, dataset, config, args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,380 @@
+import argparse
+import itertools
+import random
+import tempfile
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional, Tuple
+
+import py_progress_tracker as progress
+import torch
+from common import BENCHMARK_CONFIGURATION, PeakRSSMonitor, seed_everything, timed
+from transformers import AutoModelForCausalLM, GPT2Config, GPT2LMHeadModel, PreTrainedModel
+
+from concrete.ml.common.batch_executor import BatchExecutor
+from concrete.ml.common.instrumentation import RecordingHook, register_hook, unregister_hook
+from concrete.ml.common.utils import HybridFHEMode
+from concrete.ml.quantization import QuantizedModule
+from concrete.ml.torch.hybrid_model import HybridFHEModel
+
+# Modes in which the hybrid model can be benchmarked. The 'remote' mode needs a running server,
+# for example the one from use_case_examples/hybrid_model/serve_model.py
+HYBRID_FHE_MODES = [
+    HybridFHEMode.SIMULATE.value,
+    HybridFHEMode.EXECUTE.value,
+    HybridFHEMode.REMOTE.value,
+]
+
+# The projections computed in FHE by default, matching the hybrid model use case
+DEFAULT_MODULE_NAMES = ["transformer.h.0.attn.c_attn"]
+
+# Architecture of the small GPT-2 model benchmarked by default, randomly initialized so that no
+# weights need to be downloaded
+TINY_GPT2_CONFIG = {
+    "vocab_size": 64,
+    "n_positions": 64,
+    "n_embd": 16,
+    "n_layer": 1,
+    "n_head": 2,
+    "bos_token_id": 0,
+    "eos_token_id": 0,
+}
+
+
+def argument_manager():
+    # Manage arguments
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--verbose", action="store_true", help="show more information on stdio")
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=random.randint(0, 2**32 - 1),
+        help="set the seed for reproducibility",
+    )
+    parser.add_argument(
+        "--fhe_mode",
+        choices=HYBRID_FHE_MODES,
+        default=HybridFHEMode.EXECUTE.value,
+        help="how the private modules are run",
+    )
+    parser.add_argument(
+        "--model_name",
+        type=str,
+        default=None,
+        help="Hugging Face model to use, a small randomly initialized GPT-2 model if not set",
+    )
+    parser.add_argument(
+        "--module_names",
+        type=str,
+        nargs="+",
+        default=DEFAULT_MODULE_NAMES,
+        help="module(s) to run in FHE",
+    )
+    parser.add_argument(
+        "--server_address",
+        type=str,
+        default="http://0.0.0.0:8000",
+        help="address of the FHE server, only used in 'remote' mode",
+    )
+    parser.add_argument(
+        "--n_bits",
+        type=int,
+        default=4,
+        help="number of bits used for quantizing the private modules",
+    )
+    parser.add_argument(
+        "--prompt_lengths",
+        type=int,
+        nargs="+",
+        default=[4],
+        help="number(s) of tokens of the prompts",
+    )
+    parser.add_argument(
+        "--n_sequences",
+        type=int,
+        nargs="+",
+        default=[1, 2],
+        help="number(s) of sequences generated at the same time",
+    )
+    parser.add_argument(
+        "--n_jobs",
+        type=int,
+        nargs="+",
+        default=[1, 4],
+        help=(
+            "number(s) of workers running the FHE computations, or of requests in flight in "
+            "'remote' mode"
+        ),
+    )
+    parser.add_argument(
+        "--batch_sizes",
+        type=int,
+        nargs="+",
+        default=[1],
+        help=(
+            "number(s) of rows processed at the same time by the workers, or sent in a single "
+            "request in 'remote' mode"
+        ),
+    )
+    parser.add_argument(
+        "--max_new_tokens",
+        type=int,
+        default=4,
+        help="number of tokens generated for each sequence",
+    )
+    parser.add_argument(
+        "--model_samples",
+        type=int,
+        default=1,
+        help="number of samples per configuration (i.e., overwrite PROGRESS_SAMPLES)",
+    )
+    parser.add_argument(
+        "--long_list",
+        action="store_true",
+        help="just list the different tasks and stop",
+    )
+    parser.add_argument(
+        "--short_list",
+        action="store_true",
+        help="just list the different tasks (one per prompt length) and stop",
+    )
+
+    args = parser.parse_args()
+
+    if args.fhe_mode == HybridFHEMode.REMOTE.value and args.model_name is None:
+        parser.error("--model_name is needed in 'remote' mode, as served by the FHE server")
+
+    return args
+
+
+def hybrid_benchmark_generator(args) -> Iterator[Tuple[int, int, int, int]]:
+    """Generates all elements to test."""
+    yield from itertools.product(
+        args.prompt_lengths, args.n_sequences, args.n_jobs, args.batch_sizes
+    )
+
+
+def hybrid_benchmark_name(
+    fhe_mode: str,
+    prompt_length: int,
+    n_sequences: int,
+    n_jobs: int,
+    batch_size: int,
+    joiner: str = "_",
+) -> str:
+    """Turns a combination of generation + execution parameters and returns a string"""
+    return joiner.join(
+        [
+            "hybrid-llm",
+            fhe_mode,
+            f"{prompt_length}-prompt-tokens",
+            f"{n_sequences}-sequences",
+            f"{n_jobs}-jobs",
+            f"{batch_size}-batch",
+        ]
+    )
+
+
+def get_model(model_name: Optional[str]) -> PreTrainedModel:
+    """Load the model to benchmark, a small randomly initialized GPT-2 model if no name is given."""
+    if model_name is None:
+        return GPT2LMHeadModel(GPT2Config(**TINY_GPT2_CONFIG)).eval()
+
+    return AutoModelForCausalLM.from_pretrained(model_name, trust_remote_code=True).eval()
+
+
+def get_compiled_modules(hybrid_model: HybridFHEModel) -> List[QuantizedModule]:
+    """List the quantized modules compiled for all private modules and their input shapes."""
+    compiled_modules = list(hybrid_model.private_q_modules.values())
+
+    for bucket_q_modules in hybrid_model.bucket_q_modules.values():
+        compiled_modules += [
+            q_module for q_module in bucket_q_modules.values() if q_module not in compiled_modules
+        ]
+
+    return compiled_modules
+
+
+def generate(model: PreTrainedModel, input_ids: torch.Tensor, max_new_tokens: int) -> torch.Tensor:
+    """Generate exactly 'max_new_tokens' tokens for each sequence, reusing the attention cache."""
+    with torch.no_grad():
+        return model.generate(
+            input_ids,
+            attention_mask=torch.ones_like(input_ids),
+            max_new_tokens=max_new_tokens,
+            min_new_tokens=max_new_tokens,
+            do_sample=False,
+            use_cache=True,
+            pad_token_id=model.config.eos_token_id,
+        )
+
+
+# pylint: disable-next=too-many-arguments, too-many-locals
+def benchmark_hybrid_llm(
+    prompt_length: int, n_sequences: int, n_jobs: int, batch_size: int, args, temp_dir: Path
+):
+    """Benchmark the end-to-end token generation of a hybrid model.
+
+    In local modes, the private modules are compiled for the prompts and for the single tokens
+    that follow them, their samples being spread across 'n_jobs' workers. In 'remote' mode, the
+    private modules run on the FHE server, with 'n_jobs' requests in flight and 'batch_size' rows
+    per request. The number of bytes exchanged with the server is then also measured.
+    """
+    model = get_model(args.model_name)
+    input_ids = torch.randint(0, model.config.vocab_size, (n_sequences, prompt_length))
+
+    is_remote = args.fhe_mode == HybridFHEMode.REMOTE.value
+
+    hybrid_model = HybridFHEModel(
+        model,
+        args.module_names,
+        server_remote_address=args.server_address if is_remote else None,
+        model_name=(args.model_name or "tiny-gpt2").replace("/", "_"),
+        remote_batch_size=batch_size,
+        max_in_flight_requests=n_jobs,
+    )
+
+    with PeakRSSMonitor() as rss_monitor:
+        if is_remote:
+            if args.verbose:
+                print("Initialize clients")
+
+            _, duration = timed(
+                lambda: hybrid_model.init_client(
+                    path_to_clients=temp_dir / "clients", path_to_keys=temp_dir / "keys"
+                )
+            )
+            progress.measure(id="hybrid-init-time", label="Hybrid Client Init Time", value=duration)
+
+            hybrid_model.set_fhe_mode(HybridFHEMode.REMOTE)
+
+        else:
+            if args.verbose:
+                print("Compile")
+
+            # After the prompt, each forward only runs on the last token thanks to the cache
+            _, duration = timed(
+                lambda: hybrid_model.compile_model(
+                    [input_ids, input_ids[:, :1]],
+                    n_bits=args.n_bits,
+                    configuration=BENCHMARK_CONFIGURATION,
+                    n_shape_buckets=2,
+                )
+            )
+            progress.measure(
+                id="hybrid-compile-time", label="Hybrid Compile Time", value=duration
+            )
+
+            compiled_modules = get_compiled_modules(hybrid_model)
+            for q_module in compiled_modules:
+                q_module.fhe_executor = BatchExecutor(n_jobs=n_jobs, batch_size=batch_size)
+
+            if args.fhe_mode == HybridFHEMode.EXECUTE.value:
+                if args.verbose:
+                    print("Key generation")
+
+                _, duration = timed(
+                    lambda: [q_module.fhe_circuit.keygen() for q_module in compiled_modules]
+                )
+                progress.measure(
+                    id="hybrid-keygen-time", label="Hybrid Keygen Time", value=duration
+                )
+
+            hybrid_model.set_fhe_mode(args.fhe_mode)
+
+        if args.verbose:
+            print(f"Generate {args.max_new_tokens} tokens for {n_sequences} sequence(s)")
+
+        recording_hook = register_hook(RecordingHook())
+        try:
+            _, duration = timed(generate, model, input_ids, args.max_new_tokens)
+        finally:
+            unregister_hook(recording_hook)
+
+    n_tokens = n_sequences * args.max_new_tokens
+    progress.measure(id="hybrid-generate-time", label="Hybrid Generate Wall Time", value=duration)
+    progress.measure(
+        id="hybrid-token-throughput",
+        label="Hybrid Token Throughput (tokens/s)",
+        value=n_tokens / duration if duration > 0 else 0,
+    )
+    progress.measure(
+        id="hybrid-time-per-token",
+        label="Hybrid Time per generated token",
+        value=duration / n_tokens,
+    )
+    progress.measure(
+        id="hybrid-peak-rss", label="Hybrid Peak RSS (bytes)", value=rss_monitor.peak_rss
+    )
+
+    if is_remote:
+        metrics: Dict[str, Dict[str, float]] = recording_hook.metrics
+
+        for name, label in [("inputs", "Sent"), ("outputs", "Received")]:
+            progress.measure(
+                id=f"hybrid-bytes-{name}",
+                label=f"Hybrid Bytes {label}",
+                value=metrics.get(f"hybrid.remote_{name}.bytes", {}).get("total", 0),
+            )
+
+        progress.measure(
+            id="hybrid-remote-call-time",
+            label="Hybrid Remote Call Time",
+            value=metrics.get("hybrid.remote_call.duration", {}).get("total", 0),
+        )
+
+
+def main():
+
+    # Parameters by the user
+    args = argument_manager()
+
+    # Seed everything we can
+    seed_everything(args.seed)
+    print(f"Using --seed {args.seed}")
+
+    all_tasks = list(hybrid_benchmark_generator(args))
+
+    # Listing
+    if args.long_list or args.short_list:
+        already_done_lengths = {}
+        for prompt_length, n_sequences, n_jobs, batch_size in all_tasks:
+            if not args.short_list or prompt_length not in already_done_lengths:
+                print(
+                    f"--fhe_mode {args.fhe_mode} --prompt_lengths {prompt_length} "
+                    f"--n_sequences {n_sequences} --n_jobs {n_jobs} --batch_sizes {batch_size}"
+                )
+                already_done_lengths[prompt_length] = 1
+        return
+
+    print(f"Will perform benchmarks on {len(all_tasks)} test cases")
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+
+        @progress.track(
+            [
+                {
+                    "id": hybrid_benchmark_name(args.fhe_mode, *task, joiner="_"),
+                    "name": hybrid_benchmark_name(args.fhe_mode, *task, joiner=" "),
+                    "parameters": {
+                        "prompt_length": task[0],
+                        "n_sequences": task[1],
+                        "n_jobs": task[2],
+                        "batch_size": task[3],
+                    },
+                    "samples": args.model_samples,
+                }
+                for task in all_tasks
+            ]
+        )
+        def perform_hybrid_benchmark(prompt_length, n_sequences, n_jobs, batch_size):
+            """
+            This is the test function called by the py-progress module. It just calls the
+            benchmark function with the right parameter combination
+            """
+            benchmark_hybrid_llm(
+                prompt_length, n_sequences, n_jobs, batch_size, args, Path(temp_dir)
+            )
+
+
+if __name__ == "__main__":
+    main()
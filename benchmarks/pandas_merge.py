@@ -0,0 +1,265 @@
+import argparse
+import itertools
+import random
+import tempfile
+from pathlib import Path
+from typing import Dict, Iterator, Tuple
+
+import numpy as np
+import pandas
+import py_progress_tracker as progress
+from common import PeakRSSMonitor, seed_everything, timed
+
+from concrete.ml.pandas import ClientEngine, EncryptedDataFrame, load_encrypted_dataframe
+from concrete.ml.pandas._development import get_min_max_allowed
+
+# Name of the column on which data-frames are merged
+MERGE_KEY = "index"
+
+# Stages of an encrypted merge, in chronological order
+MERGE_STAGES = [
+    ("encrypt", "Encryption"),
+    ("serialize", "Serialization"),
+    ("deserialize", "Deserialization"),
+    ("merge", "Merge"),
+    ("decrypt", "Decryption"),
+]
+
+
+def argument_manager():
+    # Manage arguments
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--verbose", action="store_true", help="show more information on stdio")
+    parser.add_argument(
+        "--seed",
+        type=int,
+        default=random.randint(0, 2**32 - 1),
+        help="set the seed for reproducibility",
+    )
+    parser.add_argument(
+        "--n_rows",
+        type=int,
+        nargs="+",
+        default=[4, 8],
+        help="number(s) of rows of both data-frames, at most the largest value allowed in them",
+    )
+    parser.add_argument(
+        "--n_columns",
+        type=int,
+        nargs="+",
+        default=[1, 2],
+        help="number(s) of columns of both data-frames, not counting the merge key",
+    )
+    parser.add_argument(
+        "--n_jobs",
+        type=int,
+        nargs="+",
+        default=[1, 4],
+        help="number(s) of workers used for encrypting, merging and decrypting",
+    )
+    parser.add_argument(
+        "--model_samples",
+        type=int,
+        default=1,
+        help="number of samples per configuration (i.e., overwrite PROGRESS_SAMPLES)",
+    )
+    parser.add_argument(
+        "--long_list",
+        action="store_true",
+        help="just list the different tasks and stop",
+    )
+    parser.add_argument(
+        "--short_list",
+        action="store_true",
+        help="just list the different tasks (one per data-frame size) and stop",
+    )
+
+    args = parser.parse_args()
+
+    _, max_value = get_min_max_allowed()
+    for n_rows in args.n_rows:
+        if not 1 <= n_rows <= max_value:
+            parser.error(f"--n_rows must be between 1 and {max_value}. Got {n_rows}")
+
+    return args
+
+
+def merge_benchmark_generator(args) -> Iterator[Tuple[int, int, int]]:
+    """Generates all elements to test."""
+    yield from itertools.product(args.n_rows, args.n_columns, args.n_jobs)
+
+
+def merge_benchmark_name(n_rows: int, n_columns: int, n_jobs: int, joiner: str = "_") -> str:
+    """Turns a combination of data-frame size + number of workers and returns a string"""
+    return joiner.join(
+        ["pandas-merge", f"{n_rows}-rows", f"{n_columns}-columns", f"{n_jobs}-jobs"]
+    )
+
+
+def get_dataframes(n_rows: int, n_columns: int) -> Tuple[pandas.DataFrame, pandas.DataFrame]:
+    """Generate the left and right data-frames, sharing some of their merge keys."""
+    min_value, max_value = get_min_max_allowed()
+
+    def get_dataframe(prefix: str) -> pandas.DataFrame:
+        """Generate a data-frame with unique merge keys and random integer values."""
+        data = {
+            MERGE_KEY: np.random.choice(
+                np.arange(min_value, max_value + 1), size=n_rows, replace=False
+            )
+        }
+        for i in range(n_columns):
+            data[f"{prefix}_{i}"] = np.random.randint(min_value, max_value + 1, size=n_rows)
+
+        return pandas.DataFrame(data)
+
+    return get_dataframe("left"), get_dataframe("right")
+
+
+def save_and_load(
+    encrypted_dataframe: EncryptedDataFrame, path: Path
+) -> Tuple[EncryptedDataFrame, Dict[str, float], int]:
+    """Save an encrypted data-frame and load it back, as done when sending it to another party.
+
+    Returns the loaded data-frame, the duration of each stage (in seconds) and the size of the
+    saved data-frame (in bytes).
+    """
+    durations = {}
+
+    _, durations["serialize"] = timed(encrypted_dataframe.save, path)
+    loaded_dataframe, durations["deserialize"] = timed(load_encrypted_dataframe, path)
+
+    return loaded_dataframe, durations, path.stat().st_size
+
+
+# pylint: disable-next=too-many-locals
+def benchmark_merge(client: ClientEngine, n_rows: int, n_columns: int, n_jobs: int, args):
+    """Benchmark an encrypted left join between two data-frames.
+
+    Both data-frames are encrypted, sent to the server and merged there. The result is then sent
+    back and decrypted. Every transfer is simulated by saving the data-frame on disk and loading
+    it back, the size of the saved files giving the number of bytes transferred.
+    """
+    df_left, df_right = get_dataframes(n_rows, n_columns)
+
+    durations: Dict[str, float] = {stage: 0.0 for stage, _ in MERGE_STAGES}
+    n_bytes_sent, n_bytes_received = 0, 0
+
+    with tempfile.TemporaryDirectory() as temp_dir, PeakRSSMonitor() as rss_monitor:
+        if args.verbose:
+            print("Encrypt")
+
+        (df_left_enc, df_right_enc), durations["encrypt"] = timed(
+            lambda: (
+                client.encrypt_from_pandas(df_left, n_jobs=n_jobs),
+                client.encrypt_from_pandas(df_right, n_jobs=n_jobs),
+            )
+        )
+
+        # Client side, sending both data-frames to the server
+        server_inputs = []
+        for name, df_enc in [("left", df_left_enc), ("right", df_right_enc)]:
+            df_loaded, stage_durations, n_bytes = save_and_load(
+                df_enc, Path(temp_dir) / f"{name}.zip"
+            )
+            server_inputs.append(df_loaded)
+            n_bytes_sent += n_bytes
+
+            for stage, duration in stage_durations.items():
+                durations[stage] += duration
+
+        if args.verbose:
+            print(f"Merge ({n_jobs} jobs)")
+
+        # Server side
+        df_left_loaded, df_right_loaded = server_inputs
+        df_joined_enc, durations["merge"] = timed(
+            lambda: df_left_loaded.merge(df_right_loaded, how="left", on=MERGE_KEY, n_jobs=n_jobs)
+        )
+
+        # Sending the result back to the client
+        df_joined_enc, stage_durations, n_bytes_received = save_and_load(
+            df_joined_enc, Path(temp_dir) / "joined.zip"
+        )
+        for stage, duration in stage_durations.items():
+            durations[stage] += duration
+
+        if args.verbose:
+            print("Decrypt")
+
+        # Client side
+        _, durations["decrypt"] = timed(
+            lambda: client.decrypt_to_pandas(df_joined_enc, n_jobs=n_jobs)
+        )
+
+    for stage, stage_label in MERGE_STAGES:
+        progress.measure(
+            id=f"merge-{stage}-time",
+            label=f"Merge {stage_label} Time",
+            value=durations[stage],
+        )
+
+    progress.measure(
+        id="merge-wall-time", label="Merge Wall Time", value=sum(durations.values())
+    )
+    progress.measure(
+        id="merge-time-per-row",
+        label="Merge Time per left row",
+        value=durations["merge"] / n_rows,
+    )
+    progress.measure(
+        id="merge-peak-rss", label="Merge Peak RSS (bytes)", value=rss_monitor.peak_rss
+    )
+    progress.measure(id="merge-bytes-sent", label="Merge Bytes Sent", value=n_bytes_sent)
+    progress.measure(
+        id="merge-bytes-received", label="Merge Bytes Received", value=n_bytes_received
+    )
+
+
+def main():
+
+    # Parameters by the user
+    args = argument_manager()
+
+    # Seed everything we can
+    seed_everything(args.seed)
+    print(f"Using --seed {args.seed}")
+
+    all_tasks = list(merge_benchmark_generator(args))
+
+    # Listing
+    if args.long_list or args.short_list:
+        already_done_sizes = {}
+        for n_rows, n_columns, n_jobs in all_tasks:
+            if not args.short_list or (n_rows, n_columns) not in already_done_sizes:
+                print(f"--n_rows {n_rows} --n_columns {n_columns} --n_jobs {n_jobs}")
+                already_done_sizes[(n_rows, n_columns)] = 1
+        return
+
+    print(f"Will perform benchmarks on {len(all_tasks)} test cases")
+
+    # Keys are generated once and shared by all configurations
+    with tempfile.TemporaryDirectory() as keys_dir:
+        client, duration = timed(ClientEngine, True, Path(keys_dir) / "keys")
+        print(f"Key generation done in {duration:.2f} seconds")
+
+        @progress.track(
+            [
+                {
+                    "id": merge_benchmark_name(n_rows, n_columns, n_jobs, "_"),
+                    "name": merge_benchmark_name(n_rows, n_columns, n_jobs, " "),
+                    "parameters": {"n_rows": n_rows, "n_columns": n_columns, "n_jobs": n_jobs},
+                    "samples": args.model_samples,
+                }
+                for (n_rows, n_columns, n_jobs) in all_tasks
+            ]
+        )
+        def perform_merge_benchmark(n_rows, n_columns, n_jobs):
+            """
+            This is the test function called by the py-progress module. It just calls the
+            benchmark function with the right parameter combination
+            """
+            benchmark_merge(client, n_rows, n_columns, n_jobs, args)
+
+
+if __name__ == "__main__":
+    main()
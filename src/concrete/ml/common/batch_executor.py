@@ -0,0 +1,584 @@
+"""Batched execution of compiled FHE circuits on several workers."""
+
+import os
+import threading
+import time
+from collections import deque
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Any, Callable, Deque, Dict, Generator, Iterable, List, Optional, Tuple, Union
+
+import numpy
+from concrete.fhe.compilation.circuit import Circuit
+
+from .debugging import assert_true
+from .instrumentation import measure_stage
+from .simulation import BatchedGraphSimulator
+from .utils import USE_OLD_VL, FheMode, check_device_is_valid, get_visible_gpu_count, to_tuple
+
+# A method executing a single sample, or such a method for each device
+PredictMethods = Union[Callable, Dict[str, Callable]]
+
+# Default number of CPU workers of a DeviceBatchExecutor. Concrete's CPU runtime already executes
+# each sample on several threads, so a few concurrent samples are enough to keep all cores busy
+DEFAULT_N_CPU_JOBS = 2
+
+
+def get_fhe_predict_method(fhe_circuit: Circuit, fhe: Union[FheMode, str]) -> Callable:
+    """Retrieve the circuit's method to use for executing a single sample.
+
+    Resolving this method once per batch avoids re-evaluating the simulation dispatch for every
+    sample. When the circuit's graph is simulated instead of using the official simulation, the
+    returned method is a BatchedGraphSimulator, which also executes whole batches in a single call.
+
+    Args:
+        fhe_circuit (Circuit): The compiled circuit to execute.
+        fhe (Union[FheMode, str]): The mode to use, either FheMode.SIMULATE or FheMode.EXECUTE.
+            Can also be the string representation of any of these values.
+
+    Returns:
+        Callable: The circuit's method executing a single sample in FHE or with simulation.
+    """
+    assert_true(
+        fhe in ["simulate", "execute"],
+        "Only 'simulate' (resp. FheMode.SIMULATE) or 'execute' (resp. FheMode.EXECUTE) modes "
+        f"can be executed on a compiled circuit. Got {fhe}",
+        ValueError,
+    )
+
+    # If the inference should be executed using simulation
+    if fhe == "simulate":
+        is_crt_encoding = fhe_circuit.statistics["packing_key_switch_count"] != 0
+
+        # If the virtual library method should be used
+        # For now, use the virtual library when simulating
+        # circuits that use CRT  encoding because the official simulation is too slow
+        # The graph is simulated on the whole batch at once instead of sample by sample
+        # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4391
+        if USE_OLD_VL or is_crt_encoding:
+            return BatchedGraphSimulator(  # pragma: no cover
+                fhe_circuit.graph, p_error=fhe_circuit.p_error
+            )
+
+        # Else, use the official simulation method
+        return fhe_circuit.simulate
+
+    # Else, use the FHE execution method
+    return fhe_circuit.encrypt_run_decrypt
+
+
+def get_fhe_execution_device(is_compiled_for_cuda: bool, fhe: Union[FheMode, str]) -> str:
+    """Get the device on which a circuit's samples are executed.
+
+    Args:
+        is_compiled_for_cuda (bool): Whether the circuit is compiled for CUDA.
+        fhe (Union[FheMode, str]): The mode to use, either FheMode.SIMULATE or FheMode.EXECUTE.
+
+    Returns:
+        str: 'cuda' if the samples are executed in FHE by a circuit compiled for CUDA, else 'cpu',
+            as simulation always runs on CPU.
+    """
+    return "cuda" if is_compiled_for_cuda and fhe == "execute" else "cpu"
+
+
+def _get_single_predict_method(predict_method: PredictMethods, device: Optional[str]) -> Callable:
+    """Get the method to use on executors that do not spread calls across devices.
+
+    Args:
+        predict_method (PredictMethods): The method to call, or a method for each device.
+        device (Optional[str]): The device the method executes on.
+
+    Returns:
+        Callable: The method for the given device, or the only method given.
+    """
+    if not isinstance(predict_method, dict):
+        return predict_method
+
+    if device is not None and device in predict_method:
+        return predict_method[device]
+
+    assert_true(
+        len(predict_method) == 1,
+        "A single method or a device must be given to executors that do not spread calls across "
+        f"devices. Got methods for devices {list(predict_method)}",
+        ValueError,
+    )
+    return next(iter(predict_method.values()))
+
+
+class BatchExecutor:
+    """Execute a circuit's predict method over a batch of samples.
+
+    Samples are executed one at a time, as expected by Concrete circuits, but are spread across a
+    pool of worker threads. Results are always returned in the same order as the inputs. The same
+    circuit instance is shared by all workers, which means no additional keys or compilation are
+    needed.
+
+    Only threads are supported, as compiled Concrete circuits cannot be pickled and sent to other
+    processes.
+
+    Args:
+        n_jobs (Optional[int]): The number of workers to use. If None or 1, samples are executed
+            sequentially in the calling thread. If -1, all available CPU cores are used. Default
+            to None.
+        batch_size (Optional[int]): The maximum number of samples being processed at the same time.
+            This bounds the memory used by inputs and outputs in flight. If None, it is set to
+            twice the number of workers. Default to None.
+    """
+
+    def __init__(self, n_jobs: Optional[int] = None, batch_size: Optional[int] = None):
+        assert_true(
+            n_jobs is None or n_jobs == -1 or n_jobs >= 1,
+            f"Parameter 'n_jobs' must be None, -1 or a strictly positive integer. Got {n_jobs}",
+            ValueError,
+        )
+        assert_true(
+            batch_size is None or batch_size >= 1,
+            f"Parameter 'batch_size' must be None or a strictly positive integer. Got {batch_size}",
+            ValueError,
+        )
+
+        self.n_jobs = n_jobs
+        self.batch_size = batch_size
+
+    @property
+    def n_workers(self) -> int:
+        """Get the effective number of workers.
+
+        Returns:
+            int: The number of workers used for executing the samples.
+        """
+        if self.n_jobs is None:
+            return 1
+
+        if self.n_jobs == -1:
+            return os.cpu_count() or 1
+
+        return self.n_jobs
+
+    @property
+    def max_in_flight(self) -> int:
+        """Get the maximum number of samples processed at the same time.
+
+        Returns:
+            int: The maximum number of samples in flight.
+        """
+        if self.batch_size is None:
+            return 2 * self.n_workers
+
+        return max(self.batch_size, self.n_workers)
+
+    def imap_calls(
+        self,
+        predict_method: PredictMethods,
+        calls: Iterable[Tuple[Any, ...]],
+        device: Optional[str] = None,
+    ) -> Generator[Any, None, None]:
+        """Call the predict method on each set of arguments and yield the results in order.
+
+        Args:
+            predict_method (PredictMethods): The method to call. Executors spreading calls across
+                devices also accept a method for each device.
+            calls (Iterable[Tuple[Any, ...]]): The positional arguments of each call.
+            device (Optional[str]): The device the method executes on, only used by executors
+                spreading calls across devices. Default to None.
+
+        Yields:
+            Any: The results of each call, in the same order as the calls.
+        """
+        predict_method = _get_single_predict_method(predict_method, device)
+
+        if self.n_workers == 1:
+            for args in calls:
+                yield predict_method(*args)
+            return
+
+        # Submit a bounded window of calls and yield results as soon as the oldest one is ready
+        with ThreadPoolExecutor(max_workers=self.n_workers) as pool:
+            in_flight: Deque[Future] = deque()
+            for args in calls:
+                in_flight.append(pool.submit(predict_method, *args))
+
+                if len(in_flight) >= self.max_in_flight:
+                    yield in_flight.popleft().result()
+
+            while in_flight:
+                yield in_flight.popleft().result()
+
+    def imap(
+        self, predict_method: PredictMethods, *q_x: numpy.ndarray, device: Optional[str] = None
+    ) -> Generator[Tuple[numpy.ndarray, ...], None, None]:
+        """Execute the predict method on each sample and yield the results in order.
+
+        Args:
+            predict_method (PredictMethods): The method executing a single sample, with inputs of
+                shape (1, ...). Executors spreading samples across devices also accept a method for
+                each device.
+            *q_x (numpy.ndarray): The batched inputs, all sharing the same first dimension.
+            device (Optional[str]): The device the method executes on, only used by executors
+                spreading samples across devices. Default to None.
+
+        Yields:
+            Tuple[numpy.ndarray, ...]: The outputs of each sample, in the same order as the inputs.
+        """
+        n_samples = q_x[0].shape[0]
+
+        assert_true(
+            all(q_x_i.shape[0] == n_samples for q_x_i in q_x),
+            "All inputs must have the same number of samples.",
+            ValueError,
+        )
+
+        # Extract example i from every element in the tuple q_x
+        samples = (tuple(q_x_i[[i]] for q_x_i in q_x) for i in range(n_samples))
+
+        for q_result in self.imap_calls(predict_method, samples, device=device):
+            yield to_tuple(q_result)
+
+    def run(
+        self, predict_method: PredictMethods, *q_x: numpy.ndarray, device: Optional[str] = None
+    ) -> Tuple[numpy.ndarray, ...]:
+        """Execute the predict method on each sample and concatenate the results.
+
+        Args:
+            predict_method (PredictMethods): The method executing a single sample, with inputs of
+                shape (1, ...). Executors spreading samples across devices also accept a method for
+                each device.
+            *q_x (numpy.ndarray): The batched inputs, all sharing the same first dimension.
+            device (Optional[str]): The device the method executes on, only used by executors
+                spreading samples across devices. Default to None.
+
+        Returns:
+            Tuple[numpy.ndarray, ...]: The concatenated outputs, one array per circuit output.
+        """
+        # Methods supporting batches, such as the batched graph simulation, run in a single call
+        if getattr(predict_method, "supports_batches", False):
+            assert_true(q_x[0].shape[0] > 0, "Cannot execute an empty batch.", ValueError)
+            return to_tuple(predict_method(*q_x))  # type: ignore[operator]
+
+        q_result_by_output: Optional[List[List[numpy.ndarray]]] = None
+
+        for q_result in self.imap(predict_method, *q_x, device=device):
+            if q_result_by_output is None:
+                q_result_by_output = [[] for _ in q_result]
+
+            assert len(q_result) == len(q_result_by_output), (
+                "Number of outputs does not match between samples.\n"
+                f"{len(q_result)=}!={len(q_result_by_output)=}"
+            )
+            for elt_index, elt in enumerate(q_result):
+                q_result_by_output[elt_index].append(elt)
+
+        assert_true(q_result_by_output is not None, "Cannot execute an empty batch.", ValueError)
+        assert q_result_by_output is not None  # For mypy
+
+        return tuple(numpy.concatenate(elt, axis=0) for elt in q_result_by_output)
+
+
+def get_default_n_jobs_per_device() -> Dict[str, int]:
+    """Get the default number of workers of each device.
+
+    Returns:
+        Dict[str, int]: One 'cuda' worker per visible GPU, if any, and DEFAULT_N_CPU_JOBS 'cpu'
+            workers, as Concrete's CPU runtime is multi-threaded.
+    """
+    n_jobs_per_device = {}
+
+    n_gpus = get_visible_gpu_count()
+    if n_gpus > 0:
+        n_jobs_per_device["cuda"] = n_gpus  # pragma: no cover
+
+    n_jobs_per_device["cpu"] = min(DEFAULT_N_CPU_JOBS, os.cpu_count() or 1)
+
+    return n_jobs_per_device
+
+
+# pylint: disable-next=too-many-instance-attributes
+class DeviceBatchExecutor(BatchExecutor):
+    """Execute a circuit's predict method over a batch of samples, on the workers of each device.
+
+    Each device has its own pool of worker threads, for example one worker per visible GPU and a
+    few CPU workers. GPU workers are preferred: CPU workers only take a sample when all GPU
+    workers are busy, which makes them process the overflow of samples during large batches.
+
+    A predict method can be given for each device. Circuits compiled for CUDA only run on GPUs, so
+    the CPU overflow needs a circuit compiled for CPU with the same cryptographic parameters, as
+    done by `FHEModelServer.run_batch` with an `overflow_server`. When a single method is given
+    along with its device, only the workers of that device are used.
+
+    The time each device spends executing samples is recorded for reporting its utilization.
+
+    Args:
+        n_jobs_per_device (Optional[Dict[str, int]]): The number of workers of each device, either
+            'cpu' or 'cuda'. If None, one 'cuda' worker per visible GPU and DEFAULT_N_CPU_JOBS 'cpu'
+            workers are used, as each CPU sample already runs on several threads. Default to None.
+        batch_size (Optional[int]): The maximum number of samples being processed at the same time.
+            If None, it is set to twice the number of workers. Default to None.
+    """
+
+    def __init__(
+        self,
+        n_jobs_per_device: Optional[Dict[str, int]] = None,
+        batch_size: Optional[int] = None,
+    ):
+        if n_jobs_per_device is None:
+            n_jobs_per_device = get_default_n_jobs_per_device()
+
+        assert_true(
+            len(n_jobs_per_device) > 0
+            and all(n_jobs >= 1 for n_jobs in n_jobs_per_device.values()),
+            "Parameter 'n_jobs_per_device' must map at least one device to a strictly positive "
+            f"number of workers. Got {n_jobs_per_device}",
+            ValueError,
+        )
+
+        for device in n_jobs_per_device:
+            check_device_is_valid(device)
+
+        # GPU devices come first, as they are preferred over CPU workers
+        self.n_jobs_per_device = dict(
+            sorted(n_jobs_per_device.items(), key=lambda device_n_jobs: device_n_jobs[0] == "cpu")
+        )
+
+        super().__init__(n_jobs=sum(self.n_jobs_per_device.values()), batch_size=batch_size)
+
+        self._utilization_lock = threading.Lock()
+        self.reset_utilization()
+
+    def __getstate__(self) -> Dict[str, Any]:
+        """Get the executor's state for pickling and deep copies, without its lock.
+
+        Locks cannot be pickled or copied, which would otherwise prevent copying the models
+        holding the executor.
+
+        Returns:
+            Dict[str, Any]: The executor's attributes, except its utilization lock.
+        """
+        with self._utilization_lock:
+            state = self.__dict__.copy()
+            state["_busy_time"] = dict(self._busy_time)
+            state["_n_samples"] = dict(self._n_samples)
+
+        del state["_utilization_lock"]
+        return state
+
+    def __setstate__(self, state: Dict[str, Any]):
+        """Restore the executor's state, with a new lock.
+
+        Args:
+            state (Dict[str, Any]): The executor's attributes, as given by `__getstate__`.
+        """
+        self.__dict__.update(state)
+        self._utilization_lock = threading.Lock()
+
+    @property
+    def primary_device(self) -> str:
+        """Get the device whose workers are preferred.
+
+        Returns:
+            str: The first GPU device, or 'cpu' if there are only CPU workers.
+        """
+        return next(iter(self.n_jobs_per_device))
+
+    def reset_utilization(self):
+        """Reset the utilization measurements."""
+        with self._utilization_lock:
+            self._utilization_start = time.monotonic()
+            self._busy_time = {device: 0.0 for device in self.n_jobs_per_device}
+            self._n_samples = {device: 0 for device in self.n_jobs_per_device}
+
+    def get_utilization(self) -> Dict[str, Dict[str, Any]]:
+        """Report the utilization of each device since the executor's creation or the last reset.
+
+        All GPUs share the 'cuda' device: their utilization is reported as a whole, since the GPU
+        on which Concrete executes each sample is not known.
+
+        Returns:
+            Dict[str, Dict[str, Any]]: For each device, its number of workers, the number of
+                samples it executed, the total time its workers spent executing them, in seconds,
+                and its utilization, i.e., the fraction of its workers' time spent executing
+                samples.
+        """
+        with self._utilization_lock:
+            elapsed = max(time.monotonic() - self._utilization_start, 1e-9)
+
+            return {
+                device: {
+                    "n_workers": n_jobs,
+                    "n_samples": self._n_samples[device],
+                    "busy_time": self._busy_time[device],
+                    "utilization": min(self._busy_time[device] / (n_jobs * elapsed), 1.0),
+                }
+                for device, n_jobs in self.n_jobs_per_device.items()
+            }
+
+    def _get_predict_methods(
+        self, predict_method: PredictMethods, device: Optional[str]
+    ) -> Dict[str, Callable]:
+        """Get the method to use on each device.
+
+        Args:
+            predict_method (PredictMethods): The method to call, or a method for each device.
+            device (Optional[str]): The device the method executes on, if a single method is given.
+                If None, the workers of all devices use this method.
+
+        Returns:
+            Dict[str, Callable]: The method of each device whose workers are used.
+
+        Raises:
+            ValueError: If none of the given devices has workers.
+        """
+        if isinstance(predict_method, dict):
+            predict_methods = predict_method
+        elif device is not None:
+            predict_methods = {device: predict_method}
+        else:
+            predict_methods = {device: predict_method for device in self.n_jobs_per_device}
+
+        available_predict_methods = {
+            device: predict_methods[device]
+            for device in self.n_jobs_per_device
+            if device in predict_methods
+        }
+
+        if not available_predict_methods:
+            raise ValueError(
+                f"None of the devices {list(predict_methods)} has workers. Available devices are "
+                f"{list(self.n_jobs_per_device)}"
+            )
+
+        return available_predict_methods
+
+    def imap_calls(
+        self,
+        predict_method: PredictMethods,
+        calls: Iterable[Tuple[Any, ...]],
+        device: Optional[str] = None,
+    ) -> Generator[Any, None, None]:
+        """Call the predict method on each set of arguments and yield the results in order.
+
+        Args:
+            predict_method (PredictMethods): The method to call, or a method for each device.
+            calls (Iterable[Tuple[Any, ...]]): The positional arguments of each call.
+            device (Optional[str]): The device the method executes on, if a single method is given.
+                If None, the workers of all devices use this method. Default to None.
+
+        Yields:
+            Any: The results of each call, in the same order as the calls.
+        """
+        predict_methods = self._get_predict_methods(predict_method, device)
+
+        # Only the workers of the first device are preferred, the other ones take the overflow
+        preferred_device = next(iter(predict_methods))
+
+        calls_iterator = iter(calls)
+        condition = threading.Condition()
+        state: Dict[str, Any] = {
+            "n_submitted": 0,
+            "n_yielded": 0,
+            "is_exhausted": False,
+            "is_stopped": False,
+            "n_idle_preferred": self.n_jobs_per_device[preferred_device],
+        }
+        results: Dict[int, Tuple[bool, Any]] = {}
+
+        def can_take_call(is_preferred: bool) -> bool:
+            """Check if a worker can take the next call, while holding the lock.
+
+            Args:
+                is_preferred (bool): Whether the worker belongs to the preferred device.
+
+            Returns:
+                bool: Whether the worker can take the next call.
+            """
+            is_in_window = state["n_submitted"] < state["n_yielded"] + self.max_in_flight
+            return is_in_window and (is_preferred or state["n_idle_preferred"] == 0)
+
+        def work(worker_device: str):
+            """Execute calls on a device until there are none left.
+
+            Args:
+                worker_device (str): The worker's device.
+            """
+            is_preferred = worker_device == preferred_device
+
+            while True:
+                with condition:
+                    while not (
+                        state["is_exhausted"] or state["is_stopped"] or can_take_call(is_preferred)
+                    ):
+                        condition.wait()
+
+                    if state["is_exhausted"] or state["is_stopped"]:
+                        return
+
+                    try:
+                        args = next(calls_iterator)
+                    except StopIteration:
+                        state["is_exhausted"] = True
+                        condition.notify_all()
+                        return
+                    except Exception as error:  # pylint: disable=broad-exception-caught
+                        # Errors raised while generating the calls are raised in their place
+                        results[state["n_submitted"]] = (False, error)
+                        state["n_submitted"] += 1
+                        state["is_exhausted"] = True
+                        condition.notify_all()
+                        return
+
+                    index = state["n_submitted"]
+                    state["n_submitted"] += 1
+                    if is_preferred:
+                        state["n_idle_preferred"] -= 1
+
+                start = time.monotonic()
+                try:
+                    with measure_stage("executor.run_sample", device=worker_device):
+                        result = (True, predict_methods[worker_device](*args))
+                except Exception as error:  # pylint: disable=broad-exception-caught
+                    result = (False, error)
+                duration = time.monotonic() - start
+
+                with self._utilization_lock:
+                    self._busy_time[worker_device] += duration
+                    self._n_samples[worker_device] += 1
+
+                with condition:
+                    results[index] = result
+                    if is_preferred:
+                        state["n_idle_preferred"] += 1
+                    condition.notify_all()
+
+        workers = [
+            threading.Thread(target=work, args=(worker_device,), daemon=True)
+            for worker_device in predict_methods
+            for _ in range(self.n_jobs_per_device[worker_device])
+        ]
+        for worker in workers:
+            worker.start()
+
+        try:
+            while True:
+                with condition:
+                    while state["n_yielded"] not in results and not (
+                        state["is_exhausted"] and state["n_yielded"] == state["n_submitted"]
+                    ):
+                        condition.wait()
+
+                    if state["n_yielded"] not in results:
+                        return
+
+                    is_success, result = results.pop(state["n_yielded"])
+                    state["n_yielded"] += 1
+                    condition.notify_all()
+
+                if not is_success:
+                    raise result
+
+                yield result
+        finally:
+            with condition:
+                state["is_stopped"] = True
+                condition.notify_all()
+
+            for worker in workers:
+                worker.join()
@@ -0,0 +1,181 @@
+"""Compiled circuits restored from their client and server artifacts."""
+
+import zipfile
+from pathlib import Path
+from typing import Any, Iterable, Optional, Tuple, Union
+
+from concrete import fhe
+from concrete.fhe.compilation.configuration import Configuration
+from concrete.fhe.representation import Graph
+
+
+class CachedCircuit:
+    """A compiled circuit restored from its saved client and server artifacts.
+
+    Concrete can not rebuild an `fhe.Circuit` without compiling it again. This class loads the
+    already compiled `server.zip` and `client.zip` files instead and exposes the parts of the
+    circuit's interface used by Concrete ML: its graph, configuration, keys, FHE execution and
+    simulation. Other properties, such as the circuit's statistics, complexity or sizes, are read
+    from the server, as done by `fhe.Circuit`.
+
+    A loaded server can not be saved through MLIR again, `save_server` copies the compiled
+    `server.zip` file instead. Simulation evaluates the traced graph rather than a circuit compiled
+    in simulation mode, see `simulate`.
+
+    Args:
+        server_path (Union[str, Path]): The path to the compiled server's `server.zip` file.
+        client_path (Union[str, Path]): The path to the client's `client.zip` file.
+        graph (Graph): The circuit's computation graph, as traced from the compilation
+            input-set.
+        configuration (Configuration): The configuration the circuit was compiled with, including
+            the compilation options.
+    """
+
+    def __init__(
+        self,
+        server_path: Union[str, Path],
+        client_path: Union[str, Path],
+        graph: Graph,
+        configuration: Configuration,
+    ):
+        self.graph = graph
+        self.configuration = configuration
+
+        # Keys are cached the same way they are for compiled circuits
+        keyset_cache_directory = None
+        if configuration.use_insecure_key_cache:
+            keyset_cache_directory = configuration.insecure_key_cache_location
+
+        self.server_path = Path(server_path)
+        self.server = fhe.Server.load(self.server_path)
+        self.client = fhe.Client.load(Path(client_path), keyset_cache_directory)
+
+    def __getattr__(self, name: str) -> Any:
+        """Read the circuit's other properties from its server.
+
+        Args:
+            name (str): The property's name.
+
+        Returns:
+            Any: The server's property.
+
+        Raises:
+            AttributeError: If the server is not loaded yet or has no such property.
+        """
+        # Avoid infinite recursions when the server is not set, for example while copying
+        if name == "server":
+            raise AttributeError(name)
+
+        return getattr(self.server, name)
+
+    def save_server(self, path: Union[str, Path], excluded_file_names: Iterable[str] = ()):
+        """Save the circuit's compiled server artifacts.
+
+        The loaded `server.zip` file is copied, as the server can not be compiled again.
+
+        Args:
+            path (Union[str, Path]): The path of the saved `server.zip` file.
+            excluded_file_names (Iterable[str]): The names of the files not to copy from the
+                loaded `server.zip` file, for example the ones added to it by the deployment API.
+                Default to no files.
+        """
+        excluded_file_names = set(excluded_file_names)
+
+        with zipfile.ZipFile(self.server_path, "r") as source_file, zipfile.ZipFile(
+            path, "w", compression=zipfile.ZIP_DEFLATED
+        ) as target_file:
+            for item in source_file.infolist():
+                if item.filename not in excluded_file_names:
+                    target_file.writestr(item, source_file.read(item))
+
+    @property
+    def keys(self) -> fhe.Keys:
+        """Get the circuit's keys.
+
+        Returns:
+            fhe.Keys: The client's keys.
+        """
+        return self.client.keys
+
+    def keygen(
+        self,
+        force: bool = False,
+        seed: Optional[int] = None,
+        encryption_seed: Optional[int] = None,
+    ):
+        """Generate the circuit's keys.
+
+        Args:
+            force (bool): Whether to generate new keys even if keys are already generated.
+                Default to False.
+            seed (Optional[int]): The seed for private keys randomness. Default to None.
+            encryption_seed (Optional[int]): The seed for encryption randomness. Default to None.
+        """
+        self.client.keygen(force, seed, encryption_seed)
+
+    def encrypt(self, *args: Any) -> Any:
+        """Encrypt the circuit's inputs.
+
+        Args:
+            *args (Any): The clear inputs.
+
+        Returns:
+            Any: The encrypted inputs, as a single value or a tuple of values.
+        """
+        return self.client.encrypt(*args)
+
+    def run(self, *args: Any) -> Any:
+        """Run the circuit on encrypted inputs.
+
+        Args:
+            *args (Any): The encrypted inputs, possibly given as a single tuple.
+
+        Returns:
+            Any: The encrypted outputs, as a single value or a tuple of values.
+        """
+        if len(args) == 1 and isinstance(args[0], tuple):
+            args = args[0]
+
+        return self.server.run(*args, evaluation_keys=self.client.evaluation_keys)
+
+    def decrypt(self, *results: Any) -> Any:
+        """Decrypt the circuit's outputs.
+
+        Args:
+            *results (Any): The encrypted outputs, possibly given as a single tuple.
+
+        Returns:
+            Any: The clear outputs, as a single value or a tuple of values.
+        """
+        if len(results) == 1 and isinstance(results[0], tuple):
+            results = results[0]
+
+        return self.client.decrypt(*results)
+
+    def encrypt_run_decrypt(self, *args: Any) -> Any:
+        """Encrypt the inputs, run the circuit and decrypt the outputs.
+
+        Args:
+            *args (Any): The clear inputs.
+
+        Returns:
+            Any: The clear outputs, as a single value or a tuple of values.
+        """
+        return self.decrypt(self.run(self.encrypt(*args)))
+
+    def simulate(self, *args: Any) -> Union[Any, Tuple[Any, ...]]:
+        """Simulate the circuit on clear inputs, using its graph.
+
+        Unlike `fhe.Circuit.simulate`, which runs the circuit compiled in simulation mode, the
+        traced graph is evaluated directly, with the circuit's `p_error` as the probability of
+        error of each table lookup. Errors thus happen as often as in FHE but are not drawn from
+        the compiled circuit's exact noise model. Simulated results are identical when `p_error`
+        is 0, and may differ otherwise even with the same seed.
+
+        Args:
+            *args (Any): The clear inputs.
+
+        Returns:
+            Union[Any, Tuple[Any, ...]]: The simulated outputs.
+        """
+        return self.graph(*args, p_error=self.server.p_error)
@@ -0,0 +1,294 @@
+"""Instrumentation hooks for measuring the time and data sizes of inference stages.
+
+Stages are timed using `measure_stage` and data sizes are reported using `record_bytes`. Both
+are forwarded to all registered hooks, for example an in-memory `RecordingHook` or one of the
+Prometheus and OpenTelemetry adapters. When no hooks are registered, which is the default,
+measuring a stage only costs a single list check.
+
+Stage names are dot-separated, starting with the component that emits them, for example
+'server.run' or 'client.encrypt'.
+"""
+
+import threading
+import time
+from collections import defaultdict
+from contextlib import nullcontext
+from typing import Any, ContextManager, Dict, List, Optional
+
+# The hooks currently registered. This list is replaced instead of being modified in place so that
+# it can be read without any locks
+_HOOKS: List["InstrumentationHook"] = []
+_HOOKS_LOCK = threading.Lock()
+
+# Context manager returned when instrumentation is disabled
+_NULL_CONTEXT = nullcontext()
+
+
+class InstrumentationHook:
+    """Base class for hooks receiving the instrumentation measurements.
+
+    Hooks can be called from several threads at the same time and should therefore be
+    thread-safe.
+    """
+
+    def on_stage(self, stage: str, duration: float, attributes: Dict[str, Any]):
+        """Handle the duration of a stage.
+
+        Args:
+            stage (str): The stage's name.
+            duration (float): The stage's duration, in seconds.
+            attributes (Dict[str, Any]): Additional attributes describing the stage.
+        """
+
+    def on_bytes(self, name: str, n_bytes: int, attributes: Dict[str, Any]):
+        """Handle a number of bytes.
+
+        Args:
+            name (str): The name of the measured data.
+            n_bytes (int): The number of bytes.
+            attributes (Dict[str, Any]): Additional attributes describing the data.
+        """
+
+
+def register_hook(hook: InstrumentationHook) -> InstrumentationHook:
+    """Register a hook that receives all instrumentation measurements.
+
+    Args:
+        hook (InstrumentationHook): The hook to register.
+
+    Returns:
+        InstrumentationHook: The registered hook.
+    """
+    global _HOOKS  # pylint: disable=global-statement
+    with _HOOKS_LOCK:
+        if hook not in _HOOKS:
+            _HOOKS = _HOOKS + [hook]
+
+    return hook
+
+
+def unregister_hook(hook: InstrumentationHook):
+    """Unregister a hook.
+
+    Args:
+        hook (InstrumentationHook): The hook to unregister.
+    """
+    global _HOOKS  # pylint: disable=global-statement
+    with _HOOKS_LOCK:
+        _HOOKS = [registered_hook for registered_hook in _HOOKS if registered_hook is not hook]
+
+
+def is_enabled() -> bool:
+    """Indicate if at least one hook is registered.
+
+    Returns:
+        bool: Whether instrumentation is enabled.
+    """
+    return bool(_HOOKS)
+
+
+class _StageTimer:
+    """Context manager timing a stage and forwarding its duration to the hooks."""
+
+    __slots__ = ("stage", "attributes", "hooks", "start")
+
+    def __init__(self, stage: str, attributes: Dict[str, Any], hooks: List[InstrumentationHook]):
+        self.stage = stage
+        self.attributes = attributes
+        self.hooks = hooks
+        self.start = 0.0
+
+    def __enter__(self) -> "_StageTimer":
+        self.start = time.perf_counter()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        duration = time.perf_counter() - self.start
+
+        # Failed stages are still reported, in order to be able to monitor them
+        if exc_type is not None:
+            self.attributes["error"] = exc_type.__name__
+
+        for hook in self.hooks:
+            hook.on_stage(self.stage, duration, self.attributes)
+
+
+def measure_stage(stage: str, **attributes: Any) -> ContextManager:
+    """Measure the duration of a stage.
+
+    Example:
+        with measure_stage("server.run", model="my_model"):
+            ...
+
+    Args:
+        stage (str): The stage's name.
+        **attributes (Any): Additional attributes describing the stage.
+
+    Returns:
+        ContextManager: The context manager timing the stage.
+    """
+    hooks = _HOOKS
+
+    if not hooks:
+        return _NULL_CONTEXT
+
+    return _StageTimer(stage, attributes, hooks)
+
+
+def record_bytes(name: str, n_bytes: int, **attributes: Any):
+    """Report a number of bytes, for example the size of serialized ciphertexts.
+
+    Args:
+        name (str): The name of the measured data.
+        n_bytes (int): The number of bytes.
+        **attributes (Any): Additional attributes describing the data.
+    """
+    hooks = _HOOKS
+
+    for hook in hooks:
+        hook.on_bytes(name, n_bytes, attributes)
+
+
+class RecordingHook(InstrumentationHook):
+    """Hook aggregating all measurements in memory.
+
+    This is mostly useful for debugging or for reporting metrics through a custom exporter.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._durations: Dict[str, List[float]] = defaultdict(list)
+        self._bytes: Dict[str, List[int]] = defaultdict(list)
+
+    def on_stage(self, stage: str, duration: float, attributes: Dict[str, Any]):
+        with self._lock:
+            self._durations[stage].append(duration)
+
+    def on_bytes(self, name: str, n_bytes: int, attributes: Dict[str, Any]):
+        with self._lock:
+            self._bytes[name].append(n_bytes)
+
+    def clear(self):
+        """Remove all recorded measurements."""
+        with self._lock:
+            self._durations.clear()
+            self._bytes.clear()
+
+    @property
+    def durations(self) -> Dict[str, List[float]]:
+        """Get all the recorded durations.
+
+        Returns:
+            Dict[str, List[float]]: The durations, in seconds, for each stage.
+        """
+        with self._lock:
+            return {stage: list(durations) for stage, durations in self._durations.items()}
+
+    @property
+    def metrics(self) -> Dict[str, Dict[str, float]]:
+        """Get a summary of the recorded measurements.
+
+        Returns:
+            Dict[str, Dict[str, float]]: The count, total and mean of each stage's duration (in
+                seconds) and of each data's number of bytes.
+        """
+        with self._lock:
+            values_by_name: Dict[str, List[float]] = {
+                **{f"{stage}.duration": list(values) for stage, values in self._durations.items()},
+                **{f"{name}.bytes": list(values) for name, values in self._bytes.items()},
+            }
+
+        return {
+            name: {"count": len(values), "total": sum(values), "mean": sum(values) / len(values)}
+            for name, values in values_by_name.items()
+        }
+
+
+class PrometheusHook(InstrumentationHook):  # pragma: no cover
+    """Hook exporting measurements as Prometheus metrics.
+
+    Stage durations are exported in a histogram and byte counts in a counter, both labeled by the
+    stage or data name. Additional attributes are not exported, as Prometheus labels need to be
+    known in advance.
+
+    Args:
+        registry (Optional[Any]): The Prometheus registry to use. If None, the default registry
+            is used. Default to None.
+        namespace (str): The namespace of the metrics. Default to "concrete_ml".
+    """
+
+    def __init__(self, registry: Optional[Any] = None, namespace: str = "concrete_ml"):
+        # pylint: disable-next=import-outside-toplevel
+        from prometheus_client import REGISTRY, Counter, Histogram
+
+        registry = REGISTRY if registry is None else registry
+
+        self._durations = Histogram(
+            "stage_duration_seconds",
+            "Duration of Concrete ML stages",
+            ["stage"],
+            namespace=namespace,
+            registry=registry,
+        )
+        self._bytes = Counter(
+            "bytes",
+            "Number of bytes handled by Concrete ML stages",
+            ["name"],
+            namespace=namespace,
+            registry=registry,
+        )
+
+    def on_stage(self, stage: str, duration: float, attributes: Dict[str, Any]):
+        self._durations.labels(stage=stage).observe(duration)
+
+    def on_bytes(self, name: str, n_bytes: int, attributes: Dict[str, Any]):
+        self._bytes.labels(name=name).inc(n_bytes)
+
+
+class OpenTelemetryHook(InstrumentationHook):  # pragma: no cover
+    """Hook exporting measurements as OpenTelemetry metrics.
+
+    Stage durations are exported in a histogram and byte counts in a counter. The stage or data
+    name as well as all additional attributes are exported as metric attributes.
+
+    Args:
+        meter (Optional[Any]): The OpenTelemetry meter to use. If None, a meter named
+            "concrete.ml" is retrieved from the global meter provider. Default to None.
+    """
+
+    def __init__(self, meter: Optional[Any] = None):
+        if meter is None:
+            # pylint: disable-next=import-outside-toplevel
+            from opentelemetry import metrics
+
+            meter = metrics.get_meter("concrete.ml")
+
+        self._durations = meter.create_histogram(
+            "concrete_ml.stage.duration", unit="s", description="Duration of Concrete ML stages"
+        )
+        self._bytes = meter.create_counter(
+            "concrete_ml.bytes",
+            unit="By",
+            description="Number of bytes handled by Concrete ML stages",
+        )
+
+    @staticmethod
+    def _to_otel_attributes(attributes: Dict[str, Any]) -> Dict[str, Any]:
+        """Convert attributes to types supported by OpenTelemetry.
+
+        Args:
+            attributes (Dict[str, Any]): The attributes to convert.
+
+        Returns:
+            Dict[str, Any]: The attributes, with unsupported values converted to strings.
+        """
+        return {
+            key: value if isinstance(value, (str, bool, int, float)) else str(value)
+            for key, value in attributes.items()
+        }
+
+    def on_stage(self, stage: str, duration: float, attributes: Dict[str, Any]):
+        self._durations.record(duration, {"stage": stage, **self._to_otel_attributes(attributes)})
+
+    def on_bytes(self, name: str, n_bytes: int, attributes: Dict[str, Any]):
+        self._bytes.add(n_bytes, {"name": name, **self._to_otel_attributes(attributes)})
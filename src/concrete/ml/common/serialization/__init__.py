@@ -7,6 +7,13 @@ from torch.nn.modules import activation
 # If the use of Skops needs to be disabled.
 USE_SKOPS = bool(os.environ.get("USE_SKOPS", 1))
 
+# Magic bytes starting all files dumped using the binary serialization format
+BINARY_FORMAT_MAGIC = b"CMLBIN01"
+
+# Alignment (in bytes) of the raw array blobs stored in the binary serialization format, which
+# makes them directly usable as numpy arrays once the file is memory-mapped
+BINARY_FORMAT_ALIGNMENT = 64
+
 # Define all currently supported Torch activation functions
 SUPPORTED_TORCH_ACTIVATIONS = [
     activation.CELU,
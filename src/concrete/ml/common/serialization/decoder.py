@@ -2,7 +2,8 @@
 
 import inspect
 import json
-from typing import Any, Dict, Type
+from functools import partial
+from typing import Any, Dict, List, Optional, Type, Union
 
 import numpy
 import onnx
@@ -12,6 +13,7 @@ from skorch.dataset import ValidSplit
 
 from ...common.utils import Exactness
 from ...quantization.base_quantized_op import ALL_QUANTIZED_OPS
+from ...quantization.pipeline import QuantizedPipeline
 from ...quantization.quantized_module import QuantizedModule
 from ...quantization.quantizers import (
     MinMaxQuantizationStats,
@@ -58,7 +60,7 @@ _TRUSTED_CONCRETE_MODELS = [
 TRUSTED_SKOPS = (
     _TRUSTED_TORCH_ACTIVATIONS
     + _TRUSTED_CONCRETE_MODELS
-    + [_get_fully_qualified_name(QuantizedModule)]
+    + [_get_fully_qualified_name(QuantizedModule), _get_fully_qualified_name(QuantizedPipeline)]
     + [
         "numpy.int64",
         "numpy.float64",
@@ -101,8 +103,23 @@ TRUSTED_SKOPS = (
 SERIALIZABLE_CLASSES: Dict[str, Type] = {}
 
 
+def _load_bytes(serialized_value: Union[str, bytes]) -> bytes:
+    """Load a binary payload dumped either as a hexadecimal string or as a raw blob.
+
+    Args:
+        serialized_value (Union[str, bytes]): The hexadecimal string or the loaded blob.
+
+    Returns:
+        bytes: The binary payload.
+    """
+    if isinstance(serialized_value, str):
+        return bytes.fromhex(serialized_value)
+
+    return serialized_value
+
+
 # pylint: disable-next=too-many-return-statements, too-many-branches
-def object_hook(d: Any) -> Any:
+def object_hook(d: Any, blobs: Optional[List[numpy.ndarray]] = None) -> Any:
     """Define a custom object hook that enables loading any supported serialized values.
 
     If the input's type is non-native, then we expect it to have the following format.More
@@ -110,6 +127,8 @@ def object_hook(d: Any) -> Any:
 
     Args:
         d (Any): The serialized value to load.
+        blobs (Optional[List[numpy.ndarray]]): The raw uint8 blobs referenced by the serialized
+            values, if they were dumped using the binary format. Default to None.
 
     Returns:
         Any: The loaded value.
@@ -125,6 +144,17 @@ def object_hook(d: Any) -> Any:
 
         type_name, serialized_value = d["type_name"], d["serialized_value"]
 
+        # Blobs are views on the loaded buffer, they are therefore not copied
+        if type_name == "blob":
+            assert blobs is not None, "Loading a dumped blob requires the binary format's blobs"
+
+            blob = blobs[serialized_value]
+
+            if d["dtype"] == "bytes":
+                return blob.tobytes()
+
+            return blob.view(d["dtype"]).reshape(d["shape"])
+
         if type_name == "RandomState":
             random_state = RandomState()
             random_state.set_state(serialized_value)
@@ -140,10 +170,10 @@ def object_hook(d: Any) -> Any:
             if USE_SKOPS:
                 loads_sklearn_kwargs["trusted"] = TRUSTED_SKOPS
 
-            return pickle_or_skops_loads(bytes.fromhex(serialized_value), **loads_sklearn_kwargs)
+            return pickle_or_skops_loads(_load_bytes(serialized_value), **loads_sklearn_kwargs)
 
         if type_name == "onnx_model":
-            return onnx.load_model_from_string(bytes.fromhex(serialized_value))
+            return onnx.load_model_from_string(_load_bytes(serialized_value))
 
         if type_name == "set":
             return set(serialized_value)
@@ -227,7 +257,11 @@ def object_hook(d: Any) -> Any:
 
 
 class ConcreteDecoder(json.JSONDecoder):
-    """Custom json decoder to handle non-native types found in serialized Concrete ML objects."""
+    """Custom json decoder to handle non-native types found in serialized Concrete ML objects.
+
+    If a list of blobs is given, the blobs referenced in the JSON content (see the
+    ConcreteEncoder class) are loaded from it.
+    """
 
-    def __init__(self, *args, **kwargs):
-        super().__init__(object_hook=object_hook, *args, **kwargs)
+    def __init__(self, *args, blobs: Optional[List[numpy.ndarray]] = None, **kwargs):
+        super().__init__(object_hook=partial(object_hook, blobs=blobs), *args, **kwargs)
@@ -1,8 +1,13 @@
 """Dump functions for serialization."""
 
+import io
 import json
-from typing import Any, TextIO
+import struct
+from typing import Any, BinaryIO, List, TextIO
 
+import numpy
+
+from . import BINARY_FORMAT_ALIGNMENT, BINARY_FORMAT_MAGIC
 from .encoder import ConcreteEncoder
 
 
@@ -27,3 +32,70 @@ def dump(obj: Any, file: TextIO):
         file (TextIO): The file to dump the serialized object into.
     """
     file.write(dumps(obj))
+
+
+def _get_padding(size: int) -> bytes:
+    """Get the padding needed to align the given size with the binary format's alignment.
+
+    Arguments:
+        size (int): The size to align.
+
+    Returns:
+        bytes: The padding's null bytes.
+    """
+    return b"\0" * (-size % BINARY_FORMAT_ALIGNMENT)
+
+
+def dump_binary(obj: Any, file: BinaryIO):
+    """Dump any Concrete ML object in a file using the binary format.
+
+    The binary format is made of the format's magic bytes, the size of a JSON header (as an unsigned
+    64 bits little-endian integer), the JSON header, the JSON content and the raw bytes of all
+    numeric numpy arrays and binary payloads, each aligned on 64 bytes. The JSON header provides
+    the size of the JSON content as well as the offset and number of bytes of each blob, while the
+    JSON content is the ConcreteEncoder's string representation of the object in which blobs are
+    only referenced. Arrays are therefore neither converted to lists nor written in hexadecimal,
+    and they can be loaded without any copy.
+
+    Arguments:
+        obj (Any): The object to dump.
+        file (BinaryIO): The binary file to dump the serialized object into.
+    """
+    array_blobs: List[numpy.ndarray] = []
+    content = json.dumps(obj, cls=ConcreteEncoder, array_blobs=array_blobs).encode("utf-8")
+
+    # Only keep contiguous uint8 views of the arrays, which are then written without any copy
+    blobs = [numpy.ascontiguousarray(array).reshape(-1).view(numpy.uint8) for array in array_blobs]
+
+    # The blobs' offsets are relative to the start of the first blob
+    blobs_table = []
+    offset = 0
+    for blob in blobs:
+        blobs_table.append([offset, blob.nbytes])
+        offset += blob.nbytes + len(_get_padding(blob.nbytes))
+
+    header = json.dumps({"content_size": len(content), "blobs": blobs_table}).encode("utf-8")
+
+    file.write(BINARY_FORMAT_MAGIC)
+    file.write(struct.pack("<Q", len(header)))
+    file.write(header)
+    file.write(content)
+    file.write(_get_padding(len(BINARY_FORMAT_MAGIC) + 8 + len(header) + len(content)))
+
+    for blob in blobs:
+        file.write(blob.data)
+        file.write(_get_padding(blob.nbytes))
+
+
+def dumps_binary(obj: Any) -> bytes:
+    """Dump any object as bytes using the binary format.
+
+    Arguments:
+        obj (Any): Object to dump.
+
+    Returns:
+        bytes: A binary representation of the object.
+    """
+    with io.BytesIO() as buffer:
+        dump_binary(obj, buffer)
+        return buffer.getvalue()
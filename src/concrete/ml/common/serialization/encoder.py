@@ -6,7 +6,7 @@ from json.encoder import _make_iterencode  # type: ignore[attr-defined]
 from json.encoder import encode_basestring  # type: ignore[attr-defined]
 from json.encoder import encode_basestring_ascii  # type: ignore[attr-defined]
 from json.encoder import INFINITY, JSONEncoder
-from typing import Any, Callable, Dict, Generator, Type
+from typing import Any, Callable, Dict, Generator, List, Optional, Type
 
 import numpy
 import onnx
@@ -72,8 +72,46 @@ class ConcreteEncoder(JSONEncoder):
     supports the necessary types. For example, torch.Tensor objects are not serializable using this
     encoder as built-in models only use numpy arrays. However, the list of supported types might
     expand in future releases if new models are added and need new types.
+
+    If a list of blobs is given, numeric numpy arrays and binary payloads (ONNX and scikit-learn
+    models) are not encoded in the JSON string. Instead, they are appended to this list and only
+    referenced by their index, along with their dtype and shape. This is used by the binary
+    serialization format, which stores these blobs as raw bytes next to the JSON content.
     """
 
+    def __init__(self, *args, array_blobs: Optional[List[numpy.ndarray]] = None, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.array_blobs = array_blobs
+
+    def _dump_blob(self, array: numpy.ndarray, **kwargs) -> Dict:
+        """Store the array in the list of blobs and return its reference.
+
+        Args:
+            array (numpy.ndarray): The array to store as a raw blob.
+            **kwargs (dict): Additional arguments to dump along the reference.
+
+        Returns:
+            Dict: The reference to the blob in the custom dict format.
+        """
+        assert self.array_blobs is not None
+
+        self.array_blobs.append(array)
+        return dump_name_and_value("blob", len(self.array_blobs) - 1, **kwargs)
+
+    def _dump_bytes(self, value: bytes) -> Any:
+        """Dump a binary payload, either as a hexadecimal string or as a raw blob.
+
+        Args:
+            value (bytes): The binary payload to dump.
+
+        Returns:
+            Any: The hexadecimal string or, if blobs are stored separately, the blob's reference.
+        """
+        if self.array_blobs is None:
+            return value.hex()
+
+        return self._dump_blob(numpy.frombuffer(value, dtype=numpy.uint8), dtype="bytes")
+
     @staticmethod
     def isinstance(o: Any, cls: Type) -> bool:
         """Define a custom isinstance method.
@@ -202,10 +240,11 @@ class ConcreteEncoder(JSONEncoder):
         # Concrete ML models, which currently inherit from scikit-learn models, have their own
         # serialization methods. We therefore make sure that they do not get serialized here
         if isinstance(o, sklearn.base.BaseEstimator) and not hasattr(o, "_is_a_public_cml_model"):
-            return dump_name_and_value("sklearn_model", pickle_or_skops_dumps(o).hex())
+            serialized_model = self._dump_bytes(pickle_or_skops_dumps(o))
+            return dump_name_and_value("sklearn_model", serialized_model)
 
         if isinstance(o, onnx.ModelProto):
-            return dump_name_and_value("onnx_model", o.SerializeToString().hex())
+            return dump_name_and_value("onnx_model", self._dump_bytes(o.SerializeToString()))
 
         # The list is sorted before being serialized in order to be able to properly compare two
         # JSON strings, as sets do not have any order notion but lists do.
@@ -231,6 +270,12 @@ class ConcreteEncoder(JSONEncoder):
         # Dump the numpy array along its dtype
         if isinstance(o, numpy.ndarray):
             kwargs = {"dtype": str(o.dtype)}
+
+            # Numeric arrays are stored as raw blobs if possible, which avoids both the conversion
+            # to Python lists and the parsing of these lists when loading
+            if self.array_blobs is not None and o.dtype.kind in "biufc":
+                return self._dump_blob(o, shape=list(o.shape), **kwargs)
+
             return dump_name_and_value("numpy_array", o.tolist(), **kwargs)
 
         # This specific type is widely used in QuantizedModule instances and therefore is treated
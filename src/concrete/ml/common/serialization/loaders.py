@@ -1,8 +1,14 @@
 """Load functions for serialization."""
 
+import io
 import json
+import mmap
+import struct
 from typing import IO, Any, Union
 
+import numpy
+
+from . import BINARY_FORMAT_ALIGNMENT, BINARY_FORMAT_MAGIC
 from .decoder import ConcreteDecoder
 
 
@@ -29,3 +35,65 @@ def load(file: Union[IO[str], IO[bytes]]):
     """
     content = file.read()
     return loads(content)
+
+
+def loads_binary(content: Union[bytes, bytearray, memoryview, mmap.mmap]) -> Any:
+    """Load any Concrete ML object dumped using the binary format.
+
+    Numpy arrays are loaded as views on the given buffer and are therefore not copied. Since loaded
+    objects might modify their arrays in place, read-only buffers (such as bytes) are first copied
+    once into a writable buffer.
+
+    Arguments:
+        content (Union[bytes, bytearray, memoryview, mmap.mmap]): An object serialized using the
+            binary format.
+
+    Returns:
+        Any: The object itself.
+
+    Raises:
+        ValueError: If the content was not dumped using the binary format.
+    """
+    if bytes(content[: len(BINARY_FORMAT_MAGIC)]) != BINARY_FORMAT_MAGIC:
+        raise ValueError(
+            "The given content was not dumped using Concrete ML's binary serialization format."
+        )
+
+    buffer = numpy.frombuffer(content, dtype=numpy.uint8)
+    if not buffer.flags.writeable:
+        buffer = numpy.frombuffer(bytearray(content), dtype=numpy.uint8)
+
+    header_start = len(BINARY_FORMAT_MAGIC) + 8
+    (header_size,) = struct.unpack_from("<Q", content, len(BINARY_FORMAT_MAGIC))
+    header = json.loads(buffer[header_start : header_start + header_size].tobytes())
+
+    content_start = header_start + header_size
+    content_end = content_start + header["content_size"]
+    blobs_start = content_end + (-content_end % BINARY_FORMAT_ALIGNMENT)
+
+    blobs = [
+        buffer[blobs_start + offset : blobs_start + offset + n_bytes]
+        for offset, n_bytes in header["blobs"]
+    ]
+
+    return json.loads(buffer[content_start:content_end].tobytes(), cls=ConcreteDecoder, blobs=blobs)
+
+
+def load_binary(file: IO[bytes]) -> Any:
+    """Load any Concrete ML object from a file dumped using the binary format.
+
+    If the file is backed by a file descriptor, the whole file is memory-mapped (copy-on-write) so
+    that numpy arrays are read lazily from the disk without any copy. Else, the file is read.
+
+    Arguments:
+        file (IO[bytes]): The binary file containing the serialized object.
+
+    Returns:
+        Any: The object itself.
+    """
+    try:
+        fileno = file.fileno()
+    except (AttributeError, io.UnsupportedOperation):
+        return loads_binary(file.read())
+
+    return loads_binary(mmap.mmap(fileno, 0, access=mmap.ACCESS_COPY))
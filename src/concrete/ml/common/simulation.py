@@ -0,0 +1,344 @@
+"""Whole-batch simulation of compiled FHE circuits."""
+
+from typing import Any, Dict, List, Optional, Tuple, Union
+
+import networkx
+import numpy
+from concrete.fhe.dtypes import Integer
+from concrete.fhe.representation import Graph, Node
+from concrete.fhe.representation.operation import Operation
+from scipy.special import erfinv
+
+from .debugging import assert_true
+
+# Element-wise operations, sample-wise broadcasting is kept by aligning the batched operands on
+# the output's number of dimensions
+ELEMENTWISE_OPERATIONS = {"add", "subtract", "multiply", "negative", "maximum", "minimum"}
+
+# Operations broadcasting over their leading "stack" dimensions, as long as all operands have at
+# least 2 dimensions
+STACKED_OPERATIONS = {"matmul"}
+
+# Maximal number of entries in the table built for evaluating a lookup table on the whole batch
+MAX_TABLE_SIZE = 2**24
+
+
+def get_pbs_error_standard_deviation(p_error: float) -> float:
+    """Get the standard deviation of the noise modeling a PBS's error probability.
+
+    The rounded noise is non-zero with probability p_error, i.e., the lookup table's input is
+    shifted to one of its neighbors as often as a PBS is expected to fail.
+
+    Args:
+        p_error (float): The error probability of a single PBS.
+
+    Returns:
+        float: The standard deviation of the Gaussian noise added to the lookup tables' inputs.
+    """
+    return 0.5 / (numpy.sqrt(2) * erfinv(1 - p_error))
+
+
+class BatchedGraphSimulator:
+    """Simulate a compiled circuit's graph on a whole batch of samples at once.
+
+    The circuit's graph describes the computation of a single sample. Instead of evaluating it
+    sample by sample, as done by `fhe_circuit.graph`, each node is evaluated once on the full batch:
+
+    - element-wise and matrix multiplication nodes are applied on the batched values directly
+    - univariate lookup tables are evaluated once on every possible input value and then indexed
+    - any other node, or any node whose batched evaluation fails, is evaluated sample by sample,
+      as done by Concrete
+
+    As for Concrete's graph evaluation, the PBS error is simulated by adding a rounded Gaussian
+    noise to the encrypted inputs of each lookup table, using a vectorized sampling over the whole
+    batch. Inputs read directly from the circuit's inputs are freshly encrypted and are thus left
+    unchanged. Results are therefore the same as the per-sample evaluation when p_error is None or
+    0, and follow the same error distribution otherwise.
+
+    Args:
+        graph (Graph): The compiled circuit's graph.
+        p_error (Optional[float]): The error probability of a single PBS. If None or 0, no error
+            is simulated. Default to None.
+    """
+
+    # Tells the batch executor that the whole batch can be given in a single call
+    supports_batches = True
+
+    def __init__(self, graph: Graph, p_error: Optional[float] = None):
+        self.graph = graph
+        self.p_error = p_error
+        self.ordered_nodes: List[Node] = list(networkx.topological_sort(graph.graph))
+
+    def __call__(self, *q_x: numpy.ndarray) -> Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]:
+        """Simulate the circuit on the whole batch.
+
+        Args:
+            *q_x (numpy.ndarray): The batched integer inputs, each sample having the shape of the
+                circuit's input (usually (1, ...)) and samples being concatenated along the first
+                axis.
+
+        Returns:
+            Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]: The concatenated outputs, as if each
+                sample was simulated on its own and the results concatenated along the first axis.
+        """
+        input_nodes = self.graph.ordered_inputs()
+
+        assert_true(
+            len(q_x) == len(input_nodes),
+            f"Expected {len(input_nodes)} inputs, got {len(q_x)}.",
+            ValueError,
+        )
+
+        values: Dict[Node, Tuple[Any, bool]] = {}
+        n_samples = None
+
+        # Split each input's first axis into the batch and the circuit's input shape
+        for input_node, q_x_i in zip(input_nodes, q_x):
+            q_x_i = numpy.asarray(q_x_i)
+            input_shape = input_node.output.shape
+
+            assert_true(
+                q_x_i.ndim == len(input_shape)
+                and q_x_i.shape[1:] == input_shape[1:]
+                and q_x_i.shape[0] % input_shape[0] == 0,
+                f"Input of shape {q_x_i.shape} cannot be split in samples of shape {input_shape}.",
+                ValueError,
+            )
+
+            q_x_i = q_x_i.reshape((-1,) + input_shape)
+            n_samples = q_x_i.shape[0] if n_samples is None else n_samples
+
+            assert_true(
+                q_x_i.shape[0] == n_samples,
+                "All inputs must have the same number of samples.",
+                ValueError,
+            )
+            values[input_node] = (q_x_i, True)
+
+        assert n_samples is not None  # For mypy
+
+        for node in self.ordered_nodes:
+            if node.operation == Operation.Input:
+                continue
+
+            if node.operation == Operation.Constant:
+                values[node] = (node(), False)
+                continue
+
+            preds = self.graph.ordered_preds_of(node)
+            args = [values[pred] for pred in preds]
+
+            # Nodes only depending on constants are the same for all samples
+            if not any(is_batched for _, is_batched in args):
+                values[node] = (node(*(arg for arg, _ in args)), False)
+                continue
+
+            if self.p_error and node.converted_to_table_lookup:
+                args = self._add_pbs_error(node, preds, args)
+
+            values[node] = (self._evaluate(node, args, n_samples), True)
+
+        # Merge the batch axis back into the first axis, as done when concatenating the samples
+        q_results = tuple(
+            self._unbatch(output_node, values[output_node], n_samples)
+            for output_node in self.graph.ordered_outputs()
+        )
+
+        if len(q_results) == 1:
+            return q_results[0]
+        return q_results
+
+    @staticmethod
+    def _unbatch(node: Node, value: Tuple[Any, bool], n_samples: int) -> numpy.ndarray:
+        """Merge the batch axis of an output value into its first axis.
+
+        Args:
+            node (Node): The output node.
+            value (Tuple[Any, bool]): The output value and whether it is batched.
+            n_samples (int): The number of samples in the batch.
+
+        Returns:
+            numpy.ndarray: The batch's output.
+        """
+        output, is_batched = value
+        output_shape = node.output.shape
+
+        if not is_batched:
+            output = numpy.broadcast_to(output, (n_samples,) + output_shape)
+
+        if len(output_shape) == 0:
+            return numpy.asarray(output)
+
+        return numpy.asarray(output).reshape((-1,) + output_shape[1:])
+
+    def _add_pbs_error(
+        self, node: Node, preds: List[Node], args: List[Tuple[Any, bool]]
+    ) -> List[Tuple[Any, bool]]:
+        """Add the PBS error noise to the encrypted inputs of a lookup table.
+
+        The noisy inputs wrap around their bit-width, as they would in FHE. Values coming directly
+        from the circuit's inputs are not changed.
+
+        Args:
+            node (Node): The lookup table node.
+            preds (List[Node]): The nodes computing the lookup table's inputs, in order.
+            args (List[Tuple[Any, bool]]): The node's input values and whether they are batched.
+
+        Returns:
+            List[Tuple[Any, bool]]: The node's noisy input values.
+        """
+        assert self.p_error is not None  # For mypy
+
+        standard_deviation = get_pbs_error_standard_deviation(self.p_error)
+
+        noisy_args = []
+        for (arg, is_batched), input_value, pred in zip(args, node.inputs, preds):
+            dtype = input_value.dtype
+
+            if (
+                is_batched
+                and pred.operation != Operation.Input
+                and input_value.is_encrypted
+                and isinstance(dtype, Integer)
+            ):
+                error = numpy.rint(
+                    numpy.random.normal(0, standard_deviation, size=arg.shape)
+                ).astype(numpy.int64)
+
+                n_values = dtype.max() - dtype.min() + 1
+                arg = (arg + error - dtype.min()) % n_values + dtype.min()
+
+            noisy_args.append((arg, is_batched))
+
+        return noisy_args
+
+    def _evaluate(self, node: Node, args: List[Tuple[Any, bool]], n_samples: int) -> Any:
+        """Evaluate a node on the whole batch.
+
+        Nodes whose batched evaluation is not supported, or fails on the given shapes, are
+        evaluated sample by sample instead.
+
+        Args:
+            node (Node): The node to evaluate.
+            args (List[Tuple[Any, bool]]): The node's input values and whether they are batched.
+            n_samples (int): The number of samples in the batch.
+
+        Returns:
+            Any: The node's batched output value.
+        """
+        expected_shape = (n_samples,) + node.output.shape
+        name = node.properties.get("name")
+
+        result = None
+        try:
+            if name == "reshape":
+                result = args[0][0].reshape(expected_shape)
+
+            elif name in ELEMENTWISE_OPERATIONS or (
+                name in STACKED_OPERATIONS
+                and all(len(input_value.shape) >= 2 for input_value in node.inputs)
+            ):
+                result = node.evaluator(*self._align(node, args))
+
+            elif node.converted_to_table_lookup:
+                result = self._evaluate_table_lookup(node, args, n_samples)
+
+        # Operands that numpy can't broadcast or reshape as expected, as well as evaluators that
+        # don't support batched values, are evaluated sample by sample
+        except (ValueError, TypeError, IndexError):
+            result = None
+
+        if result is not None and numpy.shape(result) == expected_shape:
+            return result
+
+        # Fall back to the per-sample evaluation
+        return numpy.stack(
+            [
+                node(*(arg[i] if is_batched else arg for arg, is_batched in args))
+                for i in range(n_samples)
+            ]
+        )
+
+    @staticmethod
+    def _align(node: Node, args: List[Tuple[Any, bool]]) -> List[Any]:
+        """Align batched values on the node's output number of dimensions.
+
+        Inserting the missing dimensions after the batch axis makes numpy broadcast the batched
+        values with the constant ones exactly as it would for a single sample.
+
+        Args:
+            node (Node): The node to evaluate.
+            args (List[Tuple[Any, bool]]): The node's input values and whether they are batched.
+
+        Returns:
+            List[Any]: The node's aligned input values.
+        """
+        n_dims = len(node.output.shape)
+
+        aligned_args = []
+        for arg, is_batched in args:
+            if is_batched:
+                missing_dims = (1,) * (n_dims - (arg.ndim - 1))
+                arg = arg.reshape(arg.shape[:1] + missing_dims + arg.shape[1:])
+            aligned_args.append(arg)
+
+        return aligned_args
+
+    @staticmethod
+    def _evaluate_table_lookup(
+        node: Node, args: List[Tuple[Any, bool]], n_samples: int
+    ) -> Optional[numpy.ndarray]:
+        """Evaluate a univariate lookup table on the whole batch by indexing its table.
+
+        The table is built by evaluating the node once for every possible input value. This is
+        only done if the batch has at least as many samples as there are input values, else the
+        per-sample evaluation is cheaper.
+
+        Args:
+            node (Node): The lookup table node.
+            args (List[Tuple[Any, bool]]): The node's input values and whether they are batched.
+            n_samples (int): The number of samples in the batch.
+
+        Returns:
+            Optional[numpy.ndarray]: The node's batched output value, or None if the node cannot be
+                evaluated this way.
+        """
+        batched_indices = [i for i, (_, is_batched) in enumerate(args) if is_batched]
+
+        if len(batched_indices) != 1:
+            return None
+
+        index = batched_indices[0]
+        input_value = node.inputs[index]
+        dtype = input_value.dtype
+
+        if not isinstance(dtype, Integer) or input_value.shape != node.output.shape:
+            return None
+
+        n_values = dtype.max() - dtype.min() + 1
+        n_positions = int(numpy.prod(input_value.shape))
+
+        if n_values > n_samples or n_values * n_positions > MAX_TABLE_SIZE:
+            return None
+
+        # Values out of the input's bit-width are not in the table
+        table_indices = args[index][0].reshape(n_samples, n_positions) - dtype.min()
+        if table_indices.min() < 0 or table_indices.max() >= n_values:
+            return None
+
+        # The table holds one entry per input value and per position, as lookup tables can be
+        # applied differently on each position of the input
+        table = numpy.stack(
+            [
+                node(
+                    *(
+                        (numpy.full(input_value.shape, value) if i == index else arg)
+                        for i, (arg, _) in enumerate(args)
+                    )
+                )
+                for value in range(dtype.min(), dtype.max() + 1)
+            ]
+        ).reshape(n_values, n_positions)
+
+        result = table[table_indices, numpy.arange(n_positions)]
+        return result.reshape((n_samples,) + node.output.shape)
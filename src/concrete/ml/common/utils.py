@@ -555,6 +555,47 @@ def to_tuple(x: Any) -> tuple:
     return x
 
 
+def reduce_block_outputs(
+    block_outputs: List[tuple], merge: Optional[Callable], merge_final: Callable
+) -> Any:
+    """Merge the outputs of several blocks two by two, following a balanced binary tree.
+
+    Each merge is given the unpacked outputs of two blocks (or of two previous merges) and returns
+    a tuple of the same format. The last merge is done using `merge_final` instead, whose output
+    is returned as is.
+
+    Args:
+        block_outputs (List[tuple]): The outputs of each block, in order. At least two blocks are
+            expected.
+        merge (Optional[Callable]): The function merging two outputs into a new one. Can be None
+            if there are only two blocks.
+        merge_final (Callable): The function merging the last two outputs.
+
+    Returns:
+        Any: The output of `merge_final`.
+    """
+    assert_true(
+        len(block_outputs) >= 2,
+        f"At least two block outputs are expected. Got {len(block_outputs)}.",
+    )
+
+    outputs = [to_tuple(output) for output in block_outputs]
+
+    while len(outputs) > 2:
+        assert merge is not None, "A merge function is needed for more than two blocks."
+        merged_outputs = [
+            to_tuple(merge(*outputs[i], *outputs[i + 1])) for i in range(0, len(outputs) - 1, 2)
+        ]
+
+        # With an odd number of outputs, the last one is merged at the next level
+        if len(outputs) % 2 == 1:
+            merged_outputs.append(outputs[-1])
+
+        outputs = merged_outputs
+
+    return merge_final(*outputs[0], *outputs[1])
+
+
 def all_values_are_integers(*values: Any) -> bool:
     """Indicate if all unpacked values are of a supported integer dtype.
 
@@ -722,6 +763,21 @@ def check_device_is_valid(device: str) -> str:
     return device
 
 
+def get_visible_gpu_count() -> int:
+    """Get the number of GPUs on which circuits compiled for CUDA can be executed.
+
+    Returns:
+        int: The number of visible CUDA devices, which honors `CUDA_VISIBLE_DEVICES`, or 0 if the
+            Concrete runtime cannot execute circuits on GPUs.
+    """
+    if not check_gpu_available():
+        return 0
+
+    # The Concrete runtime can use the GPUs even if the installed Torch package does not support
+    # CUDA, in which case at least one GPU is visible
+    return max(torch.cuda.device_count(), 1)  # pragma: no cover
+
+
 def check_compilation_device_is_valid_and_is_cuda(device: str) -> bool:
     """Check whether the device string for compilation or FHE execution is CUDA or CPU.
 
@@ -1,3 +1,6 @@
 """Module for deployment of the FHE model."""
 
+from .compilation_cache import CompilationCache
 from .fhe_client_server import FHEModelClient, FHEModelDev, FHEModelServer
+from .model_registry import ModelRegistry
+from .scheduler import DeadlineExceededError, RequestScheduler, SchedulerOverloadedError
@@ -0,0 +1,212 @@
+"""Thread-safe in-memory caches used when serving FHE models."""
+
+import threading
+from collections import OrderedDict
+from concurrent.futures import Future
+from typing import Any, Callable, Dict, Hashable, Optional, Tuple
+
+from ..common.debugging.custom_assert import assert_true
+
+
+class LRUCache:
+    """Least-recently-used cache with an optional memory budget.
+
+    Each entry is stored along with an estimation of its size in bytes. When adding an entry makes
+    the cache exceed its budget, least recently used entries are evicted until it fits again.
+    Entries that are larger than the whole budget are never cached. The cache can be shared between
+    threads.
+
+    Args:
+        max_size (Optional[int]): The maximum total size of the cached entries, in bytes. If None,
+            the size is not bounded. Default to None.
+        max_entries (Optional[int]): The maximum number of cached entries. If None, the number of
+            entries is not bounded. Default to None.
+    """
+
+    def __init__(self, max_size: Optional[int] = None, max_entries: Optional[int] = None):
+        assert_true(
+            max_size is None or max_size >= 0,
+            f"Parameter 'max_size' must be None or a positive integer. Got {max_size}",
+            ValueError,
+        )
+        assert_true(
+            max_entries is None or max_entries >= 0,
+            f"Parameter 'max_entries' must be None or a positive integer. Got {max_entries}",
+            ValueError,
+        )
+
+        self.max_size = max_size
+        self.max_entries = max_entries
+
+        self._entries: "OrderedDict[Hashable, Tuple[Any, int]]" = OrderedDict()
+        self._current_size = 0
+        self._lock = threading.RLock()
+
+        # The entries being loaded by `get_or_load`, so that other threads wait for them
+        self._loading: Dict[Hashable, Future] = {}
+
+        self._hits = 0
+        self._misses = 0
+        self._evictions = 0
+
+    def __len__(self) -> int:
+        with self._lock:
+            return len(self._entries)
+
+    def __contains__(self, key: Hashable) -> bool:
+        with self._lock:
+            return key in self._entries
+
+    @property
+    def current_size(self) -> int:
+        """Get the total size of the cached entries.
+
+        Returns:
+            int: The total size of the cached entries, in bytes.
+        """
+        with self._lock:
+            return self._current_size
+
+    @property
+    def metrics(self) -> Dict[str, int]:
+        """Get the cache's metrics.
+
+        Returns:
+            Dict[str, int]: The number of hits, misses and evictions, as well as the current number
+                of entries and their total size in bytes.
+        """
+        with self._lock:
+            return {
+                "hits": self._hits,
+                "misses": self._misses,
+                "evictions": self._evictions,
+                "n_entries": len(self._entries),
+                "size": self._current_size,
+            }
+
+    def _fits(self, size: int) -> bool:
+        """Indicate if an entry of the given size can be cached at all.
+
+        Args:
+            size (int): The entry's size, in bytes.
+
+        Returns:
+            bool: Whether the entry can be cached.
+        """
+        if self.max_entries == 0:
+            return False
+
+        return self.max_size is None or size <= self.max_size
+
+    def _evict(self):
+        """Evict least recently used entries until the cache is within its budget."""
+        while self._entries and (
+            (self.max_size is not None and self._current_size > self.max_size)
+            or (self.max_entries is not None and len(self._entries) > self.max_entries)
+        ):
+            _, (_, size) = self._entries.popitem(last=False)
+            self._current_size -= size
+            self._evictions += 1
+
+    def get(self, key: Hashable) -> Optional[Any]:
+        """Get an entry from the cache and mark it as the most recently used one.
+
+        Args:
+            key (Hashable): The entry's key.
+
+        Returns:
+            Optional[Any]: The cached value, or None if the key is not in the cache.
+        """
+        with self._lock:
+            if key not in self._entries:
+                self._misses += 1
+                return None
+
+            self._hits += 1
+            self._entries.move_to_end(key)
+            return self._entries[key][0]
+
+    def put(self, key: Hashable, value: Any, size: int = 0):
+        """Add an entry to the cache, evicting least recently used entries if needed.
+
+        Args:
+            key (Hashable): The entry's key.
+            value (Any): The value to cache.
+            size (int): The estimated size of the value, in bytes. Default to 0.
+        """
+        with self._lock:
+            self.pop(key)
+
+            if not self._fits(size):
+                return
+
+            self._entries[key] = (value, size)
+            self._current_size += size
+            self._evict()
+
+    def get_or_load(self, key: Hashable, loader: Callable[[], Tuple[Any, int]]) -> Any:
+        """Get an entry from the cache, loading and caching it if it is missing.
+
+        The loader is called outside of the cache's lock so that slow loads do not block other
+        threads. Each entry is only loaded once: threads asking for an entry that is being loaded
+        wait for it and get the same value, or the same error if the loader fails.
+
+        Args:
+            key (Hashable): The entry's key.
+            loader (Callable[[], Tuple[Any, int]]): The function loading the value, returning it
+                along with its estimated size in bytes.
+
+        Returns:
+            Any: The cached or loaded value.
+        """
+        with self._lock:
+            value = self.get(key)
+            if value is not None:
+                return value
+
+            loading_future = self._loading.get(key)
+            is_loading_thread = loading_future is None
+            if loading_future is None:
+                loading_future = self._loading[key] = Future()
+
+        # Another thread is already loading the entry
+        if not is_loading_thread:
+            return loading_future.result()
+
+        try:
+            value, size = loader()
+        except BaseException as error:
+            with self._lock:
+                self._loading.pop(key)
+            loading_future.set_exception(error)
+            raise
+
+        with self._lock:
+            self.put(key, value, size)
+            self._loading.pop(key)
+
+        loading_future.set_result(value)
+        return value
+
+    def pop(self, key: Hashable) -> Optional[Any]:
+        """Remove an entry from the cache.
+
+        Args:
+            key (Hashable): The entry's key.
+
+        Returns:
+            Optional[Any]: The removed value, or None if the key was not in the cache.
+        """
+        with self._lock:
+            if key not in self._entries:
+                return None
+
+            value, size = self._entries.pop(key)
+            self._current_size -= size
+            return value
+
+    def clear(self):
+        """Remove all entries from the cache."""
+        with self._lock:
+            self._entries.clear()
+            self._current_size = 0
@@ -0,0 +1,341 @@
+"""On-disk cache of the client and server artifacts of compiled models."""
+
+import hashlib
+import json
+import os
+import platform
+import shutil
+import sys
+import tempfile
+import threading
+from enum import Enum
+from importlib.metadata import version
+from pathlib import Path
+from typing import Any, Callable, Dict, Optional, Union
+
+import numpy
+from concrete.fhe.compilation.configuration import Configuration
+from concrete.fhe.representation import Graph
+
+from ..common.cached_circuit import CachedCircuit
+from ..common.check_inputs import check_array_and_assert
+from ..common.instrumentation import measure_stage
+from ..common.serialization.dumpers import dumps
+from ..common.utils import to_tuple
+from ..quantization import QuantizedModule
+from ..version import __version__ as CML_VERSION
+from .fhe_client_server import FHEModelDev
+
+# Files stored for each cache entry, as expected by `FHEModelClient` and `FHEModelServer`
+CACHED_FILE_NAMES = ("client.zip", "server.zip")
+
+# Compilation parameters that do not impact the compiled circuit
+IGNORED_COMPILE_PARAMETERS = {"artifacts", "show_mlir", "verbose", "fhe_executor"}
+
+# Environment variables read at compilation time that impact the compiled circuit
+COMPILATION_ENVIRONMENT_VARIABLES = ("USE_INPUT_COMPRESSION", "USE_KEY_COMPRESSION")
+
+
+def _normalize_parameter(value: Any) -> Any:
+    """Convert a compilation parameter to a value that can be hashed across processes.
+
+    Args:
+        value (Any): The parameter's value.
+
+    Returns:
+        Any: A JSON serializable representation of the value.
+    """
+    if value is None or isinstance(value, (bool, int, float, str)):
+        return value
+
+    if isinstance(value, Enum):
+        return str(value)
+
+    if isinstance(value, (list, tuple)):
+        return [_normalize_parameter(item) for item in value]
+
+    if isinstance(value, dict):
+        return {str(key): _normalize_parameter(item) for key, item in sorted(value.items())}
+
+    # Configuration objects are described by their attributes
+    if hasattr(value, "__dict__"):
+        return {
+            "type": type(value).__name__,
+            "attributes": {
+                key: _normalize_parameter(item)
+                for key, item in sorted(vars(value).items())
+                if not key.startswith("_")
+            },
+        }
+
+    # Fall back to the representation if it does not depend on the object's address
+    representation = repr(value)
+    return type(value).__name__ if " at 0x" in representation else representation
+
+
+class CompilationCache:
+    """Cache of the client and server artifacts of compiled models, stored on disk.
+
+    Entries are keyed on a hash of everything that determines the compiled circuit: the model's
+    quantized graph and quantizers, the quantized input-set (which sets the circuit's bit-widths),
+    the compilation parameters (configuration, p_error, global_p_error, device, ...) and the
+    Concrete, Concrete ML and Python versions. Server artifacts are stored already compiled, so
+    that loading them from an `FHEModelServer` does not trigger any compilation either.
+
+    Models compiled with a `compilation_cache` argument load their circuit from these artifacts
+    on a cache hit, as a `CachedCircuit`, and can then be executed in FHE without being compiled.
+    The `compile_and_save` method instead provides the `client.zip` and `server.zip` files used
+    by the deployment API. The cache can be shared between processes and threads.
+
+    Args:
+        cache_dir (Union[str, Path]): The directory where the entries are stored.
+    """
+
+    def __init__(self, cache_dir: Union[str, Path]):
+        self.cache_dir = Path(cache_dir)
+        self.cache_dir.mkdir(parents=True, exist_ok=True)
+
+        self._lock = threading.Lock()
+        self._hits = 0
+        self._misses = 0
+
+    @property
+    def metrics(self) -> Dict[str, int]:
+        """Get the cache's metrics.
+
+        Returns:
+            Dict[str, int]: The number of hits and misses of this instance.
+        """
+        with self._lock:
+            return {"hits": self._hits, "misses": self._misses}
+
+    @staticmethod
+    def get_key(model: Any, X: Any, **compile_kwargs) -> str:
+        """Compute the key identifying the compilation of a model.
+
+        Args:
+            model (Any): The built-in model or QuantizedModule to compile.
+            X (Any): The input-set used for compilation.
+            **compile_kwargs: The parameters given to the model's `compile` method.
+
+        Returns:
+            str: The key, as an hexadecimal hash.
+        """
+        hasher = hashlib.sha256()
+
+        # The model's quantized graph and quantizers, without its compilation status
+        model_state = model.dump_dict()
+        model_state.pop("_is_compiled", None)
+        hasher.update(type(model).__name__.encode("utf-8"))
+        hasher.update(dumps(model_state).encode("utf-8"))
+
+        # The quantized input-set, which determines the bounds and bit-widths of the circuit
+        if isinstance(model, QuantizedModule):
+            inputs = model.pre_processing(*to_tuple(X))
+            q_inputs = to_tuple(model.quantize_input(*inputs))
+        else:
+            q_inputs = to_tuple(model.quantize_input(check_array_and_assert(X)))
+
+        for q_input in q_inputs:
+            q_input = numpy.ascontiguousarray(q_input)
+            hasher.update(str((q_input.shape, q_input.dtype.str)).encode("utf-8"))
+            hasher.update(q_input.tobytes())
+
+        # The compilation parameters and environment. Parameters left to their default value are
+        # ignored, so that the key does not depend on whether they are explicitly given or not
+        parameters = {
+            key: _normalize_parameter(value)
+            for key, value in compile_kwargs.items()
+            if key not in IGNORED_COMPILE_PARAMETERS
+            and value is not None
+            and not (key == "device" and value == "cpu")
+        }
+        environment = {
+            "environment_variables": {
+                name: os.environ.get(name) for name in COMPILATION_ENVIRONMENT_VARIABLES
+            },
+            "concrete-python": version("concrete-python"),
+            "concrete-ml": CML_VERSION,
+            "python": f"{sys.version_info.major}.{sys.version_info.minor}",
+            "platform": f"{platform.system()}-{platform.machine()}",
+        }
+        hasher.update(dumps({"parameters": parameters, "environment": environment}).encode("utf-8"))
+
+        return hasher.hexdigest()
+
+    def _lookup(self, key: str) -> Optional[Path]:
+        """Get the directory of a cache entry, counting the lookup as a hit or a miss.
+
+        Args:
+            key (str): The entry's key.
+
+        Returns:
+            Optional[Path]: The entry's directory, or None if the key is not in the cache.
+        """
+        entry_dir = self.get(key)
+
+        is_hit = entry_dir is not None
+
+        with self._lock:
+            self._hits += is_hit
+            self._misses += not is_hit
+
+        return entry_dir
+
+    def get(self, key: str) -> Optional[Path]:
+        """Get the directory of a cache entry.
+
+        Args:
+            key (str): The entry's key.
+
+        Returns:
+            Optional[Path]: The directory containing the entry's `client.zip` and `server.zip`
+                files, or None if the key is not in the cache.
+        """
+        entry_dir = self.cache_dir / key
+
+        if all((entry_dir / file_name).is_file() for file_name in CACHED_FILE_NAMES):
+            return entry_dir
+
+        return None
+
+    def put(self, key: str, model: Any) -> Path:
+        """Store the artifacts of a compiled model.
+
+        Artifacts are first saved in a temporary directory that is then moved to its final
+        location, so that concurrent processes never see partially written entries.
+
+        Args:
+            key (str): The entry's key.
+            model (Any): The compiled built-in model or QuantizedModule.
+
+        Returns:
+            Path: The entry's directory.
+        """
+        entry_dir = self.cache_dir / key
+
+        temp_dir = Path(tempfile.mkdtemp(prefix=f".{key}-", dir=self.cache_dir))
+        try:
+            # Server artifacts are saved compiled so that they can be loaded without compiling
+            # the MLIR again
+            FHEModelDev(path_dir=str(temp_dir), model=model).save(via_mlir=False)
+
+            try:
+                temp_dir.rename(entry_dir)
+
+            # Another process may have stored the same entry in the meantime
+            except OSError:
+                if self.get(key) is None:
+                    raise
+        finally:
+            shutil.rmtree(temp_dir, ignore_errors=True)
+
+        return entry_dir
+
+    def compile_and_save(self, model: Any, X: Any, path_dir: str, **compile_kwargs) -> bool:
+        """Save a model's deployment artifacts, compiling it only if they are not cached.
+
+        This is the cached equivalent of compiling the model and then saving it with
+        `FHEModelDev`. The model is left unchanged if the artifacts are found in the cache, and
+        is compiled otherwise.
+
+        Args:
+            model (Any): The fitted built-in model or QuantizedModule.
+            X (Any): The input-set to use for compilation.
+            path_dir (str): The directory where `client.zip` and `server.zip` are saved. If it
+                exists, it must be empty.
+            **compile_kwargs: The parameters to give to the model's `compile` method.
+
+        Returns:
+            bool: Whether the artifacts were found in the cache.
+
+        Raises:
+            Exception: If `path_dir` is not empty.
+        """
+        path = Path(path_dir)
+        if path.exists() and any(path.iterdir()):
+            raise Exception(
+                f"path_dir: {path_dir} is not empty. Please delete it before saving a new model."
+            )
+
+        key = self.get_key(model, X, **compile_kwargs)
+        entry_dir = self._lookup(key)
+
+        is_hit = entry_dir is not None
+
+        if entry_dir is None:
+            with measure_stage("compilation_cache.compile", model=type(model).__name__):
+                model.compile(X, **compile_kwargs)
+
+            entry_dir = self.put(key, model)
+
+        path.mkdir(parents=True, exist_ok=True)
+        for file_name in CACHED_FILE_NAMES:
+            shutil.copyfile(entry_dir / file_name, path / file_name)
+
+        return is_hit
+
+    def load_circuit(
+        self, key: str, trace: Callable[[], Graph], configuration: Configuration
+    ) -> Optional[CachedCircuit]:
+        """Load the compiled circuit of a cache entry, without compiling it.
+
+        Args:
+            key (str): The entry's key, as computed by `get_key`.
+            trace (Callable[[], Graph]): A function tracing the circuit's computation graph. It is
+                only called on a cache hit.
+            configuration (Configuration): The configuration the circuit is compiled with,
+                including the compilation options.
+
+        Returns:
+            Optional[CachedCircuit]: The loaded circuit, or None if the key is not in the cache.
+        """
+        entry_dir = self._lookup(key)
+
+        if entry_dir is None:
+            return None
+
+        with measure_stage("compilation_cache.load"):
+            return CachedCircuit(
+                entry_dir / "server.zip", entry_dir / "client.zip", trace(), configuration
+            )
+
+    def get_statistics(self, key: str) -> Optional[Dict[str, Any]]:
+        """Get the statistics stored for a compilation, for example its estimated cost.
+
+        Args:
+            key (str): The compilation's key.
+
+        Returns:
+            Optional[Dict[str, Any]]: The stored statistics, or None if there are none.
+        """
+        statistics_path = self.cache_dir / "statistics" / f"{key}.json"
+
+        if not statistics_path.is_file():
+            return None
+
+        with open(statistics_path, "r", encoding="utf-8") as file:
+            return json.load(file)
+
+    def put_statistics(self, key: str, statistics: Dict[str, Any]):
+        """Store statistics about a compilation, so that they can be retrieved without compiling.
+
+        Args:
+            key (str): The compilation's key.
+            statistics (Dict[str, Any]): The JSON serializable statistics.
+        """
+        statistics_dir = self.cache_dir / "statistics"
+        statistics_dir.mkdir(exist_ok=True)
+
+        # Write to a temporary file first so that concurrent readers never see partial files
+        file_descriptor, temp_path = tempfile.mkstemp(prefix=f".{key}-", dir=statistics_dir)
+        with os.fdopen(file_descriptor, "w", encoding="utf-8") as file:
+            json.dump(statistics, file)
+
+        os.replace(temp_path, statistics_dir / f"{key}.json")
+
+    def clear(self):
+        """Remove all entries from the cache."""
+        for entry in self.cache_dir.iterdir():
+            if entry.is_dir():
+                shutil.rmtree(entry, ignore_errors=True)
@@ -2,19 +2,26 @@
 
 import json
 import sys
+import threading
+import uuid
 import zipfile
+from collections import deque
+from concurrent.futures import Future, ThreadPoolExecutor
 from enum import Enum
 from pathlib import Path
-from typing import Any, Optional, Tuple, Union
+from typing import Any, Callable, Deque, Dict, Generator, Iterable, Optional, Tuple, Union
 
 import numpy
 
 from concrete import fhe
 
+from ..common.batch_executor import BatchExecutor, DeviceBatchExecutor
+from ..common.cached_circuit import CachedCircuit
 from ..common.debugging.custom_assert import assert_true
-from ..common.serialization.dumpers import dump
-from ..common.serialization.loaders import load
-from ..common.utils import to_tuple
+from ..common.instrumentation import measure_stage, record_bytes
+from ..common.serialization.dumpers import dump, dump_binary
+from ..common.serialization.loaders import load, load_binary
+from ..common.utils import reduce_block_outputs, to_tuple
 from ..quantization import QuantizedModule
 from ..version import __version__ as CML_VERSION
 from ._utils import deserialize_encrypted_values, serialize_encrypted_values
@@ -104,8 +111,95 @@ def check_concrete_versions(zip_path: Path):
             )
 
 
+def get_wire_format(
+    fhe_circuit: Union[fhe.Circuit, Any], functions: Optional[Dict[str, Any]] = None
+) -> Dict[str, Dict[str, Any]]:
+    """Get the wire format of the data exchanged by a circuit's client and server.
+
+    Input ciphertexts can be compressed (seeded) and evaluation keys can be compressed when the
+    circuit is compiled. Compressed values are much smaller to send and are decompressed by the
+    server on arrival. Expected sizes are the ones Concrete computes from the values' shapes and
+    cryptographic parameters, which do not account for compression.
+
+    Models compiled by blocks (such as KNN with a `block_size`) are compiled as a module. The
+    names of its functions are then stored in the wire format, telling the client which function
+    to encrypt the inputs for and the server how to chain them.
+
+    Args:
+        fhe_circuit (Union[fhe.Circuit, Any]): The compiled circuit, or the compiled module.
+        functions (Optional[Dict[str, Any]]): If a module is given, the names of the query
+            function ("query"), of the blocks' functions ("blocks"), of the merge function
+            ("merge", possibly None) and of the last merge function ("merge_final"). Default to
+            None.
+
+    Returns:
+        Dict[str, Dict[str, Any]]: For the inputs, outputs and evaluation keys, whether they are
+            compressed and their expected uncompressed size in bytes. For modules, also the names
+            of their functions.
+    """
+    configuration = fhe_circuit.configuration
+
+    if functions is None:
+        size_of_inputs = fhe_circuit.size_of_inputs
+        size_of_outputs = fhe_circuit.size_of_outputs
+    else:
+        # The client encrypts the inputs once for all blocks and only receives the last merge's
+        # outputs
+        size_of_inputs = getattr(fhe_circuit, functions["blocks"][0]).size_of_inputs
+        size_of_outputs = getattr(fhe_circuit, functions["merge_final"]).size_of_outputs
+
+    wire_format: Dict[str, Dict[str, Any]] = {
+        "inputs": {
+            "compressed": bool(configuration.compress_input_ciphertexts),
+            "expected_size": int(size_of_inputs),
+        },
+        "outputs": {
+            "compressed": False,
+            "expected_size": int(size_of_outputs),
+        },
+        "evaluation_keys": {
+            "compressed": bool(configuration.compress_evaluation_keys),
+            "expected_size": int(
+                fhe_circuit.size_of_bootstrap_keys + fhe_circuit.size_of_keyswitch_keys
+            ),
+        },
+    }
+
+    if functions is not None:
+        wire_format["functions"] = functions
+
+    return wire_format
+
+
+def load_wire_format(zip_path: Path) -> Optional[Dict[str, Dict[str, Any]]]:
+    """Load the wire format found in a client.zip or server.zip file.
+
+    Args:
+        zip_path (Path): The path to the client or server zip file.
+
+    Returns:
+        Optional[Dict[str, Dict[str, Any]]]: The wire format, as given by `get_wire_format`, or
+            None if the file was saved by a Concrete ML version that did not provide it.
+    """
+    with zipfile.ZipFile(zip_path) as zip_file:
+        if "wire_format.json" not in zip_file.namelist():
+            return None
+
+        with zip_file.open("wire_format.json", mode="r") as file:
+            return json.load(file)
+
+
+# Types of the encrypted and quantized values handled by the server
+EncryptedValues = Union[bytes, fhe.Value, Tuple[bytes, ...], Tuple[fhe.Value, ...]]
+
+
 class FHEModelServer:
-    """Server API to load and run the FHE circuit."""
+    """Server API to load and run the FHE circuit.
+
+    Evaluation keys can either be given to each `run` call or registered once using
+    `register_evaluation_keys`. Registered keys are deserialized only once and pinned in memory
+    until they are unregistered. The returned handle can then be given to `run` or `run_batch`.
+    """
 
     server: fhe.Server
 
@@ -118,6 +212,10 @@ class FHEModelServer:
 
         self.path_dir = path_dir
 
+        # Evaluation keys registered by clients, identified by their handle
+        self._registered_evaluation_keys: Dict[str, fhe.EvaluationKeys] = {}
+        self._registered_evaluation_keys_lock = threading.Lock()
+
         # Load the FHE circuit
         self.load()
 
@@ -127,39 +225,111 @@ class FHEModelServer:
 
         check_concrete_versions(server_zip_path)
 
+        # Formats in which the server receives the inputs and evaluation keys
+        self.wire_format = load_wire_format(server_zip_path)
+
+        # Functions of the module to chain, for models compiled by blocks
+        self.functions = self.wire_format.get("functions") if self.wire_format else None
+
         self.server = fhe.Server.load(Path(self.path_dir).joinpath("server.zip"))
 
-    # We should make 'serialized_encrypted_quantized_data' handle unpacked inputs, as Concrete does,
-    # instead of tuples
-    # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4477
-    # We should also rename the input arguments to remove the `serialized` part, as we now accept
-    # both serialized and deserialized input values
-    # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4476
-    def run(
+    def register_evaluation_keys(
+        self, serialized_evaluation_keys: Union[bytes, fhe.EvaluationKeys]
+    ) -> str:
+        """Register evaluation keys to use in later calls.
+
+        The keys are deserialized once and kept in memory until they are unregistered.
+
+        Args:
+            serialized_evaluation_keys (Union[bytes, fhe.EvaluationKeys]): The evaluation keys. If
+                they are serialized (in bytes), they are first deserialized.
+
+        Returns:
+            str: The handle identifying the registered keys.
+        """
+        evaluation_keys = serialized_evaluation_keys
+        if isinstance(evaluation_keys, bytes):
+            record_bytes("server.evaluation_keys", len(evaluation_keys))
+            with measure_stage("server.deserialize_evaluation_keys"):
+                evaluation_keys = fhe.EvaluationKeys.deserialize(evaluation_keys)
+
+        handle = str(uuid.uuid4())
+        with self._registered_evaluation_keys_lock:
+            self._registered_evaluation_keys[handle] = evaluation_keys
+
+        return handle
+
+    def unregister_evaluation_keys(self, handle: str):
+        """Remove registered evaluation keys from memory.
+
+        Args:
+            handle (str): The handle identifying the registered keys.
+
+        Raises:
+            KeyError: If no evaluation keys are registered with this handle.
+        """
+        with self._registered_evaluation_keys_lock:
+            if handle not in self._registered_evaluation_keys:
+                raise KeyError(f"No evaluation keys are registered with handle '{handle}'.")
+
+            del self._registered_evaluation_keys[handle]
+
+    def _get_evaluation_keys(
         self,
-        serialized_encrypted_quantized_data: Union[
-            bytes, fhe.Value, Tuple[bytes, ...], Tuple[fhe.Value, ...]
-        ],
-        serialized_evaluation_keys: bytes,
-    ) -> Union[bytes, fhe.Value, Tuple[bytes, ...], Tuple[fhe.Value, ...]]:
-        """Run the model on the server over encrypted data.
+        serialized_evaluation_keys: Optional[Union[bytes, fhe.EvaluationKeys]],
+        evaluation_keys_handle: Optional[str],
+    ) -> fhe.EvaluationKeys:
+        """Retrieve the evaluation keys to use, either given directly or through a handle.
 
         Args:
-            serialized_encrypted_quantized_data (Union[bytes, fhe.Value, Tuple[bytes, ...], \
-                Tuple[fhe.Value, ...]]): The encrypted and quantized values to consider. If these
-                values are serialized (in bytes), they are first deserialized.
-            serialized_evaluation_keys (bytes): The evaluation keys. If they are serialized (in
-                bytes), they are first deserialized.
+            serialized_evaluation_keys (Optional[Union[bytes, fhe.EvaluationKeys]]): The
+                evaluation keys. If they are serialized (in bytes), they are first deserialized.
+            evaluation_keys_handle (Optional[str]): The handle of registered evaluation keys.
 
         Returns:
-            Union[bytes, fhe.Value, Tuple[bytes, ...], Tuple[fhe.Value, ...]]: The model's encrypted
-                and quantized results. If the inputs were initially serialized, the outputs are also
-                serialized.
+            fhe.EvaluationKeys: The deserialized evaluation keys.
+
+        Raises:
+            ValueError: If both or none of the evaluation keys and handle are given.
+            KeyError: If no evaluation keys are registered with the given handle.
         """
+        if (serialized_evaluation_keys is None) == (evaluation_keys_handle is None):
+            raise ValueError(
+                "Exactly one of 'serialized_evaluation_keys' or 'evaluation_keys_handle' must be "
+                "given."
+            )
 
-        # TODO: make desr / ser optional
-        assert_true(self.server is not None, "Model has not been loaded.")
+        if evaluation_keys_handle is not None:
+            with self._registered_evaluation_keys_lock:
+                if evaluation_keys_handle not in self._registered_evaluation_keys:
+                    raise KeyError(
+                        f"No evaluation keys are registered with handle '{evaluation_keys_handle}'."
+                    )
+                return self._registered_evaluation_keys[evaluation_keys_handle]
 
+        # Deserialize the evaluation keys if they are serialized
+        evaluation_keys = serialized_evaluation_keys
+        if isinstance(evaluation_keys, bytes):
+            record_bytes("server.evaluation_keys", len(evaluation_keys))
+            with measure_stage("server.deserialize_evaluation_keys"):
+                evaluation_keys = fhe.EvaluationKeys.deserialize(evaluation_keys)
+
+        return evaluation_keys
+
+    @staticmethod
+    def _prepare_inputs(
+        serialized_encrypted_quantized_data: EncryptedValues,
+    ) -> Tuple[Tuple[fhe.Value, ...], bool]:
+        """Check the input values and deserialize them if needed.
+
+        Args:
+            serialized_encrypted_quantized_data (EncryptedValues): The encrypted and quantized
+                values to consider.
+
+        Returns:
+            Tuple[Tuple[fhe.Value, ...], bool]: The deserialized values and whether they were
+                initially serialized.
+        """
         input_quant_encrypted = to_tuple(serialized_encrypted_quantized_data)
 
         # Make sure no inputs are None, to avoid any crash in Concrete
@@ -175,25 +345,327 @@ class FHEModelServer:
 
         # Deserialize the values if they are all serialized
         if inputs_are_serialized:
-            input_quant_encrypted = to_tuple(deserialize_encrypted_values(*input_quant_encrypted))
+            record_bytes("server.inputs", sum(len(x) for x in input_quant_encrypted))
+            with measure_stage("server.deserialize_inputs"):
+                input_quant_encrypted = to_tuple(
+                    deserialize_encrypted_values(*input_quant_encrypted)
+                )
 
-        # Deserialize the evaluation keys if they are serialized
-        evaluation_keys = serialized_evaluation_keys
-        if isinstance(evaluation_keys, bytes):
-            evaluation_keys = fhe.EvaluationKeys.deserialize(evaluation_keys)
+        return input_quant_encrypted, inputs_are_serialized
 
-        result_quant_encrypted = self.server.run(
-            *input_quant_encrypted, evaluation_keys=evaluation_keys
-        )
+    def _run_prepared(
+        self,
+        input_quant_encrypted: Tuple[fhe.Value, ...],
+        inputs_are_serialized: bool,
+        evaluation_keys: fhe.EvaluationKeys,
+    ) -> EncryptedValues:
+        """Run the circuit on deserialized inputs.
+
+        Args:
+            input_quant_encrypted (Tuple[fhe.Value, ...]): The deserialized encrypted values.
+            inputs_are_serialized (bool): Whether the values were initially serialized, in which
+                case the outputs are serialized as well.
+            evaluation_keys (fhe.EvaluationKeys): The deserialized evaluation keys.
+
+        Returns:
+            EncryptedValues: The model's encrypted and quantized results.
+        """
+        with measure_stage("server.run"):
+            if self.functions is None:
+                result_quant_encrypted = self.server.run(
+                    *input_quant_encrypted, evaluation_keys=evaluation_keys
+                )
+            else:
+                result_quant_encrypted = self._run_functions(input_quant_encrypted, evaluation_keys)
 
         # If inputs were serialized, return serialized values as well
         if inputs_are_serialized:
-            result_quant_encrypted = serialize_encrypted_values(*to_tuple(result_quant_encrypted))
+            with measure_stage("server.serialize_outputs"):
+                result_quant_encrypted = serialize_encrypted_values(
+                    *to_tuple(result_quant_encrypted)
+                )
+            record_bytes("server.outputs", sum(len(x) for x in to_tuple(result_quant_encrypted)))
 
         # Mypy complains because the outputs of `serialize_encrypted_values` can be None, but here
         # we already made sure this is not the case
         return result_quant_encrypted  # type: ignore[return-value]
 
+    def _run_functions(
+        self, input_quant_encrypted: Tuple[fhe.Value, ...], evaluation_keys: fhe.EvaluationKeys
+    ) -> Union[fhe.Value, Tuple[fhe.Value, ...]]:
+        """Run the blocks' functions of a module and chain their outputs through the merges.
+
+        The encrypted outputs are directly given to the next functions, without being sent back
+        to the client.
+
+        Args:
+            input_quant_encrypted (Tuple[fhe.Value, ...]): The deserialized encrypted values,
+                given to all blocks.
+            evaluation_keys (fhe.EvaluationKeys): The deserialized evaluation keys.
+
+        Returns:
+            Union[fhe.Value, Tuple[fhe.Value, ...]]: The last merge's encrypted results.
+        """
+        assert self.functions is not None
+
+        assert_true(
+            len(input_quant_encrypted) == 1,
+            "Expected a single encrypted input, given to all the "
+            f"{len(self.functions['blocks'])} blocks. Got {len(input_quant_encrypted)}.",
+            ValueError,
+        )
+
+        def get_run_method(function_name: str) -> Callable:
+            """Get the method running one of the module's functions.
+
+            Args:
+                function_name (str): The name of the function.
+
+            Returns:
+                Callable: The method.
+            """
+
+            def run_method(*args: fhe.Value) -> Union[fhe.Value, Tuple[fhe.Value, ...]]:
+                """Run the function on encrypted values.
+
+                Args:
+                    *args (fhe.Value): The encrypted values.
+
+                Returns:
+                    Union[fhe.Value, Tuple[fhe.Value, ...]]: The encrypted results.
+                """
+                return self.server.run(
+                    *args, evaluation_keys=evaluation_keys, function_name=function_name
+                )
+
+            return run_method
+
+        # All blocks share the same input encryption parameters and are given the same query
+        block_outputs = [
+            get_run_method(function_name)(*input_quant_encrypted)
+            for function_name in self.functions["blocks"]
+        ]
+
+        merge_name = self.functions["merge"]
+        return reduce_block_outputs(
+            block_outputs,
+            get_run_method(merge_name) if merge_name is not None else None,
+            get_run_method(self.functions["merge_final"]),
+        )
+
+    # We should make 'serialized_encrypted_quantized_data' handle unpacked inputs, as Concrete does,
+    # instead of tuples
+    # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4477
+    # We should also rename the input arguments to remove the `serialized` part, as we now accept
+    # both serialized and deserialized input values
+    # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4476
+    def run(
+        self,
+        serialized_encrypted_quantized_data: EncryptedValues,
+        serialized_evaluation_keys: Optional[Union[bytes, fhe.EvaluationKeys]] = None,
+        evaluation_keys_handle: Optional[str] = None,
+    ) -> EncryptedValues:
+        """Run the model on the server over encrypted data.
+
+        Args:
+            serialized_encrypted_quantized_data (Union[bytes, fhe.Value, Tuple[bytes, ...], \
+                Tuple[fhe.Value, ...]]): The encrypted and quantized values to consider. If these
+                values are serialized (in bytes), they are first deserialized.
+            serialized_evaluation_keys (Optional[Union[bytes, fhe.EvaluationKeys]]): The evaluation
+                keys. If they are serialized (in bytes), they are first deserialized. Cannot be
+                given along `evaluation_keys_handle`. Default to None.
+            evaluation_keys_handle (Optional[str]): The handle of evaluation keys registered with
+                `register_evaluation_keys`, which avoids deserializing them again. Cannot be given
+                along `serialized_evaluation_keys`. Default to None.
+
+        Returns:
+            Union[bytes, fhe.Value, Tuple[bytes, ...], Tuple[fhe.Value, ...]]: The model's encrypted
+                and quantized results. If the inputs were initially serialized, the outputs are also
+                serialized.
+        """
+
+        assert_true(self.server is not None, "Model has not been loaded.")
+
+        evaluation_keys = self._get_evaluation_keys(
+            serialized_evaluation_keys, evaluation_keys_handle
+        )
+
+        input_quant_encrypted, inputs_are_serialized = self._prepare_inputs(
+            serialized_encrypted_quantized_data
+        )
+
+        return self._run_prepared(input_quant_encrypted, inputs_are_serialized, evaluation_keys)
+
+    def run_batch(
+        self,
+        serialized_encrypted_quantized_data_batch: Iterable[EncryptedValues],
+        serialized_evaluation_keys: Optional[Union[bytes, fhe.EvaluationKeys]] = None,
+        evaluation_keys_handle: Optional[str] = None,
+        n_workers: int = 2,
+        fhe_executor: Optional[BatchExecutor] = None,
+        overflow_server: Optional["FHEModelServer"] = None,
+    ) -> Generator[EncryptedValues, None, None]:
+        """Run the model on several encrypted inputs, streaming the results.
+
+        Inputs are deserialized on a pool of workers while the circuit is running on previous
+        inputs. The evaluation keys are only deserialized once for the whole batch.
+
+        If an executor is given, the inputs are instead deserialized and run by its workers, for
+        example on all visible GPUs with a `DeviceBatchExecutor`. This server then executes the
+        inputs of the executor's preferred device, and the overflow server, if any, the inputs
+        taken by its CPU workers.
+
+        Args:
+            serialized_encrypted_quantized_data_batch (Iterable[EncryptedValues]): The encrypted
+                and quantized values to consider, one element per circuit call. Elements follow the
+                same format as the first argument of `run`.
+            serialized_evaluation_keys (Optional[Union[bytes, fhe.EvaluationKeys]]): The evaluation
+                keys. If they are serialized (in bytes), they are first deserialized. Cannot be
+                given along `evaluation_keys_handle`. Default to None.
+            evaluation_keys_handle (Optional[str]): The handle of evaluation keys registered with
+                `register_evaluation_keys`. Cannot be given along `serialized_evaluation_keys`.
+                Default to None.
+            n_workers (int): The number of workers used for deserializing the inputs. This is also
+                the number of inputs deserialized ahead of the circuit's execution. Only used if
+                no executor is given. Default to 2.
+            fhe_executor (Optional[BatchExecutor]): The executor spreading the inputs across
+                workers. Default to None.
+            overflow_server (Optional[FHEModelServer]): A server loading the same model compiled
+                for CPU, with the same cryptographic parameters, which executes the inputs taken by
+                the executor's CPU workers while its GPU workers are busy. Default to None.
+
+        Yields:
+            EncryptedValues: The model's encrypted and quantized results, in the same order as the
+                inputs.
+
+        Raises:
+            ValueError: If an overflow server is given without an executor having both GPU and CPU
+                workers, or if it does not load a model with the same client specs.
+        """
+        assert_true(self.server is not None, "Model has not been loaded.")
+        assert_true(
+            n_workers >= 1,
+            f"Parameter 'n_workers' must be a strictly positive integer. Got {n_workers}",
+            ValueError,
+        )
+
+        evaluation_keys = self._get_evaluation_keys(
+            serialized_evaluation_keys, evaluation_keys_handle
+        )
+
+        if fhe_executor is not None:
+            yield from self._run_batch_on_executor(
+                serialized_encrypted_quantized_data_batch,
+                evaluation_keys,
+                fhe_executor,
+                overflow_server,
+            )
+            return
+
+        if overflow_server is not None:
+            raise ValueError(
+                "An overflow server needs a DeviceBatchExecutor with both GPU and CPU workers."
+            )
+
+        with ThreadPoolExecutor(max_workers=n_workers) as pool:
+            pending: Deque[Future] = deque()
+            for encrypted_quantized_data in serialized_encrypted_quantized_data_batch:
+                pending.append(pool.submit(self._prepare_inputs, encrypted_quantized_data))
+
+                # Run the oldest input while the next ones are being deserialized
+                if len(pending) > n_workers:
+                    yield self._run_prepared(*pending.popleft().result(), evaluation_keys)
+
+            while pending:
+                yield self._run_prepared(*pending.popleft().result(), evaluation_keys)
+
+    def _run_batch_on_executor(
+        self,
+        batch: Iterable[EncryptedValues],
+        evaluation_keys: fhe.EvaluationKeys,
+        fhe_executor: BatchExecutor,
+        overflow_server: Optional["FHEModelServer"],
+    ) -> Generator[EncryptedValues, None, None]:
+        """Run the model on several encrypted inputs using the workers of an executor.
+
+        Args:
+            batch (Iterable[EncryptedValues]): The encrypted and quantized values to consider, one
+                element per circuit call.
+            evaluation_keys (fhe.EvaluationKeys): The deserialized evaluation keys.
+            fhe_executor (BatchExecutor): The executor spreading the inputs across workers.
+            overflow_server (Optional[FHEModelServer]): The server executing the inputs taken by
+                the executor's CPU workers.
+
+        Yields:
+            EncryptedValues: The model's encrypted and quantized results, in the same order as the
+                inputs.
+
+        Raises:
+            ValueError: If an overflow server is given without an executor having both GPU and CPU
+                workers, or if it does not load a model with the same client specs.
+        """
+
+        def get_run_method(server: "FHEModelServer") -> Callable:
+            """Get the method deserializing and running a single input on a server.
+
+            Args:
+                server (FHEModelServer): The server running the input.
+
+            Returns:
+                Callable: The method.
+            """
+
+            def run_method(encrypted_quantized_data: EncryptedValues) -> EncryptedValues:
+                """Deserialize and run a single input.
+
+                Args:
+                    encrypted_quantized_data (EncryptedValues): The encrypted and quantized values.
+
+                Returns:
+                    EncryptedValues: The model's encrypted and quantized results.
+                """
+                # pylint: disable-next=protected-access
+                input_quant_encrypted, inputs_are_serialized = server._prepare_inputs(
+                    encrypted_quantized_data
+                )
+
+                # pylint: disable-next=protected-access
+                return server._run_prepared(
+                    input_quant_encrypted, inputs_are_serialized, evaluation_keys
+                )
+
+            return run_method
+
+        primary_device = getattr(fhe_executor, "primary_device", "cpu")
+        run_methods = {primary_device: get_run_method(self)}
+
+        if overflow_server is not None:
+            if not isinstance(fhe_executor, DeviceBatchExecutor) or primary_device == "cpu" or (
+                "cpu" not in fhe_executor.n_jobs_per_device
+            ):
+                raise ValueError(
+                    "An overflow server needs a DeviceBatchExecutor with both GPU and CPU workers."
+                )
+
+            # Both servers execute the same ciphertexts with the same evaluation keys, which is
+            # only possible if their circuits share the same client specs
+            if (
+                overflow_server.server.client_specs.serialize()
+                != self.server.client_specs.serialize()
+            ):
+                raise ValueError(
+                    "The overflow server must load the same model as this server, compiled with "
+                    "the same cryptographic parameters, but their client specs differ."
+                )
+
+            run_methods["cpu"] = get_run_method(overflow_server)
+
+        yield from fhe_executor.imap_calls(
+            run_methods,
+            ((encrypted_quantized_data,) for encrypted_quantized_data in batch),
+            device=primary_device,
+        )
+
 
 class FHEModelDev:
     """Dev API to save the model and then load and run the FHE circuit."""
@@ -213,14 +685,16 @@ class FHEModelDev:
 
         Path(self.path_dir).mkdir(parents=True, exist_ok=True)
 
-    def _export_model_to_json(self, is_training: bool = False) -> Path:
+    def _export_model_to_json(self, is_training: bool = False, binary: bool = False) -> Path:
         """Export the quantizers to a json file.
 
         Args:
             is_training (bool): If True, we export the training circuit.
+            binary (bool): If True, the quantizers are exported using the binary serialization
+                format instead of JSON.
 
         Returns:
-            Path: the path to the json file
+            Path: the path to the json file (or binary file if `binary` is True)
         """
         module_to_export = self.model.training_quantized_module if is_training else self.model
         serialized_processing = {
@@ -235,6 +709,14 @@ class FHEModelDev:
         if hasattr(self.model, "is_fitted"):
             serialized_processing["is_fitted"] = self.model.is_fitted
 
+        # Dump the binary file, in which arrays are stored as raw bytes
+        if binary:
+            binary_path = Path(self.path_dir).joinpath("serialized_processing.bin")
+            with open(binary_path, "wb") as binary_file:
+                dump_binary(serialized_processing, binary_file)
+
+            return binary_path
+
         # Dump json
         json_path = Path(self.path_dir).joinpath("serialized_processing.json")
         with open(json_path, "w", encoding="utf-8") as file:
@@ -242,13 +724,22 @@ class FHEModelDev:
 
         return json_path
 
-    def save(self, mode: DeploymentMode = DeploymentMode.INFERENCE, via_mlir: bool = True):
+    def save(
+        self,
+        mode: DeploymentMode = DeploymentMode.INFERENCE,
+        via_mlir: bool = True,
+        binary_serialization: bool = False,
+    ):
         """Export all needed artifacts for the client and server.
 
         Arguments:
             mode (DeploymentMode): the mode to save the FHE circuit,
                 either "inference" or "training".
-            via_mlir (bool): serialize with `via_mlir` option from Concrete-Python.
+            via_mlir (bool): serialize with `via_mlir` option from Concrete-Python. Ignored for
+                circuits loaded from a compilation cache, which are saved already compiled.
+            binary_serialization (bool): serialize the quantizers using the binary format instead
+                of JSON, which makes them faster to save and load. Clients from older Concrete ML
+                versions cannot load such artifacts. Default to False.
 
         Raises:
             Exception: path_dir is not empty or training module does not exist
@@ -262,6 +753,7 @@ class FHEModelDev:
             mode = DeploymentMode(mode_lower)
 
         # Get fhe_circuit based on the mode
+        functions = None
         if mode == DeploymentMode.TRAINING:
 
             # Check that training FHE circuit exists
@@ -274,7 +766,13 @@ class FHEModelDev:
             fhe_circuit = self.model.training_quantized_module.fhe_circuit
         else:
             self.model.check_model_is_compiled()
-            fhe_circuit = self.model.fhe_circuit
+
+            # Models compiled by blocks (such as KNN with a `block_size`) are compiled as a module
+            if getattr(self.model, "fhe_module_", None) is not None:
+                fhe_circuit = self.model.fhe_module_
+                functions = self.model.fhe_module_functions_
+            else:
+                fhe_circuit = self.model.fhe_circuit
 
         # Check if the path_dir is empty with pathlib
         listdir = list(Path(self.path_dir).glob("**/*"))
@@ -285,18 +783,27 @@ class FHEModelDev:
             )
 
         # Export the quantizers
-        json_path = self._export_model_to_json(is_training=(mode == DeploymentMode.TRAINING))
+        json_path = self._export_model_to_json(
+            is_training=(mode == DeploymentMode.TRAINING), binary=binary_serialization
+        )
 
         # Save the circuit for the server
         path_circuit_server = Path(self.path_dir).joinpath("server.zip")
-        fhe_circuit.server.save(path_circuit_server, via_mlir=via_mlir)
+        # Circuits loaded from a compilation cache have no MLIR to compile again, their compiled
+        # server artifacts are copied without the files added below
+        if isinstance(fhe_circuit, CachedCircuit):
+            fhe_circuit.save_server(
+                path_circuit_server, excluded_file_names=("versions.json", "wire_format.json")
+            )
+        else:
+            fhe_circuit.server.save(path_circuit_server, via_mlir=via_mlir)
 
         # Save the circuit for the client
         path_circuit_client = Path(self.path_dir).joinpath("client.zip")
         fhe_circuit.client.save(path_circuit_client)
 
         with zipfile.ZipFile(path_circuit_client, "a") as zip_file:
-            zip_file.write(filename=json_path, arcname="serialized_processing.json")
+            zip_file.write(filename=json_path, arcname=json_path.name)
 
         # Add versions
         versions_path = Path(self.path_dir).joinpath("versions.json")
@@ -308,13 +815,19 @@ class FHEModelDev:
         with open(versions_path, "w", encoding="utf-8") as file:
             json.dump(fp=file, obj=versions)
 
-        with zipfile.ZipFile(path_circuit_server, "a") as zip_file:
-            zip_file.write(filename=versions_path, arcname="versions.json")
+        # Add the wire format, which tells the client and server whether input ciphertexts and
+        # evaluation keys are sent compressed
+        wire_format_path = Path(self.path_dir).joinpath("wire_format.json")
+        with open(wire_format_path, "w", encoding="utf-8") as file:
+            json.dump(fp=file, obj=get_wire_format(fhe_circuit, functions))
 
-        with zipfile.ZipFile(path_circuit_client, "a") as zip_file:
-            zip_file.write(filename=versions_path, arcname="versions.json")
+        for path_circuit in [path_circuit_server, path_circuit_client]:
+            with zipfile.ZipFile(path_circuit, "a") as zip_file:
+                zip_file.write(filename=versions_path, arcname="versions.json")
+                zip_file.write(filename=wire_format_path, arcname="wire_format.json")
 
         versions_path.unlink()
+        wire_format_path.unlink()
         json_path.unlink()
 
 
@@ -333,6 +846,9 @@ class FHEModelClient:
         self.path_dir = path_dir
         self.key_dir = key_dir
 
+        # Sizes of the last serialized inputs and evaluation keys, in bytes
+        self._sent_sizes: Dict[str, int] = {}
+
         # If path_dir does not exist raise
         assert_true(
             Path(path_dir).exists(), f"{path_dir} does not exist. Please specify a valid path."
@@ -348,13 +864,25 @@ class FHEModelClient:
         self.client = fhe.Client.load(client_zip_path, self.key_dir)
 
         # Load the quantizers
+        # Models saved using the binary serialization format provide a binary file instead of
+        # the json one. Zip members cannot be memory-mapped, the binary file is thus read
         with zipfile.ZipFile(client_zip_path) as client_zip:
-            with client_zip.open("serialized_processing.json", mode="r") as file:
-                serialized_processing = load(file)
+            if "serialized_processing.bin" in client_zip.namelist():
+                with client_zip.open("serialized_processing.bin", mode="r") as binary_file:
+                    serialized_processing = load_binary(binary_file)
+            else:
+                with client_zip.open("serialized_processing.json", mode="r") as file:
+                    serialized_processing = load(file)
 
         # Load and check versions
         check_concrete_versions(client_zip_path)
 
+        # Formats in which the inputs and evaluation keys are sent to the server
+        self.wire_format = load_wire_format(client_zip_path)
+
+        # Functions of the module to encrypt the inputs for, for models compiled by blocks
+        self.functions = self.wire_format.get("functions") if self.wire_format else None
+
         # Initialize the model
         self.model = serialized_processing["model_type"]()
 
@@ -392,7 +920,16 @@ class FHEModelClient:
         # Generate private and evaluation keys if not already generated
         self.generate_private_and_evaluation_keys(force=False)
 
-        return self.client.evaluation_keys.serialize()
+        serialized_evaluation_keys = self.client.evaluation_keys.serialize()
+
+        self._sent_sizes["evaluation_keys"] = len(serialized_evaluation_keys)
+        record_bytes(
+            "client.evaluation_keys",
+            len(serialized_evaluation_keys),
+            compressed=self._is_compressed("evaluation_keys"),
+        )
+
+        return serialized_evaluation_keys
 
     def quantize_encrypt_serialize(
         self, *x: Optional[numpy.ndarray]
@@ -407,16 +944,85 @@ class FHEModelClient:
         """
 
         # Quantize the values
-        x_quant = to_tuple(self.model.quantize_input(*x))
-
-        # Encrypt the values
-        x_quant_encrypted = to_tuple(self.client.encrypt(*x_quant))
+        with measure_stage("client.quantize"):
+            x_quant = to_tuple(self.model.quantize_input(*x))
+
+        # Encrypt the values. Models compiled by blocks encrypt them once for all blocks, as they
+        # share the same input encryption parameters
+        with measure_stage("client.encrypt"):
+            if self.functions is None:
+                x_quant_encrypted = to_tuple(self.client.encrypt(*x_quant))
+            else:
+                x_quant_encrypted = to_tuple(
+                    self.client.encrypt(*x_quant, function_name=self.functions["blocks"][0])
+                )
 
         # Serialize the encrypted values to be sent to the server
-        x_quant_encrypted_serialized = serialize_encrypted_values(*x_quant_encrypted)
+        with measure_stage("client.serialize"):
+            x_quant_encrypted_serialized = serialize_encrypted_values(*x_quant_encrypted)
+
+        n_bytes = sum(len(x) for x in to_tuple(x_quant_encrypted_serialized) if x is not None)
+
+        self._sent_sizes["inputs"] = n_bytes
+        record_bytes("client.inputs", n_bytes, compressed=self._is_compressed("inputs"))
 
         return x_quant_encrypted_serialized
 
+    def _is_compressed(self, name: str) -> Optional[bool]:
+        """Indicate if the given data is sent compressed to the server.
+
+        Args:
+            name (str): The data's name in the wire format, either "inputs" or "evaluation_keys".
+
+        Returns:
+            Optional[bool]: Whether the data is compressed, or None if the model's artifacts do not
+                provide their wire format.
+        """
+        if self.wire_format is None:
+            return None
+
+        return self.wire_format[name]["compressed"]
+
+    def get_compression_report(self) -> Dict[str, Dict[str, Any]]:
+        """Report how the data sent to the server is compressed and the corresponding sizes.
+
+        For the inputs and the evaluation keys, the report indicates:
+
+        - "compressed": whether they are compressed
+        - "uncompressed_size": their size in bytes without compression, as computed by Concrete
+          from their shapes and cryptographic parameters when compiling the model
+        - "sent_size": the size in bytes of the last serialized ones, or None if none were
+          serialized yet
+        - "compression_ratio": the uncompressed size divided by the sent size, or None if none
+          were serialized yet
+
+        Returns:
+            Dict[str, Dict[str, Any]]: The report, for the inputs and the evaluation keys.
+
+        Raises:
+            ValueError: If the model's artifacts were saved by a Concrete ML version that did not
+                provide their wire format.
+        """
+        if self.wire_format is None:
+            raise ValueError(
+                "The model's artifacts do not provide their wire format. Please save the model "
+                "again using the current Concrete ML version."
+            )
+
+        report = {}
+        for name in ["inputs", "evaluation_keys"]:
+            uncompressed_size = self.wire_format[name]["expected_size"]
+            sent_size = self._sent_sizes.get(name)
+
+            report[name] = {
+                "compressed": self.wire_format[name]["compressed"],
+                "uncompressed_size": uncompressed_size,
+                "sent_size": sent_size,
+                "compression_ratio": uncompressed_size / sent_size if sent_size else None,
+            }
+
+        return report
+
     # We should find a better name for `serialized_encrypted_quantized_result`
     # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4476
     def deserialize_decrypt(
@@ -431,13 +1037,25 @@ class FHEModelClient:
         Returns:
             Union[Any, Tuple[Any, ...]]: The decrypted and deserialized values.
         """
-        # Deserialize the encrypted values
-        result_quant_encrypted = to_tuple(
-            deserialize_encrypted_values(*serialized_encrypted_quantized_result)
+        record_bytes(
+            "client.outputs",
+            sum(len(x) for x in serialized_encrypted_quantized_result if x is not None),
         )
 
+        # Deserialize the encrypted values
+        with measure_stage("client.deserialize"):
+            result_quant_encrypted = to_tuple(
+                deserialize_encrypted_values(*serialized_encrypted_quantized_result)
+            )
+
         # Decrypt the values
-        result_quant = self.client.decrypt(*result_quant_encrypted)
+        with measure_stage("client.decrypt"):
+            if self.functions is None:
+                result_quant = self.client.decrypt(*result_quant_encrypted)
+            else:
+                result_quant = self.client.decrypt(
+                    *result_quant_encrypted, function_name=self.functions["merge_final"]
+                )
 
         return result_quant
 
@@ -459,7 +1077,8 @@ class FHEModelClient:
         result_quant = to_tuple(self.deserialize_decrypt(*serialized_encrypted_quantized_result))
 
         # De-quantize the values
-        result = to_tuple(self.model.dequantize_output(*result_quant))
+        with measure_stage("client.dequantize"):
+            result = to_tuple(self.model.dequantize_output(*result_quant))
 
         # Apply post-processing to the de-quantized values
         # Side note: `post_processing` method from built-in models (not Quantized Modules) only
@@ -0,0 +1,295 @@
+"""Registry of loaded FHE model servers, shared across requests and threads."""
+
+import os
+import threading
+from concurrent.futures import Future, ThreadPoolExecutor
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Tuple, Union
+
+from ..common.debugging import assert_true
+from ..common.instrumentation import measure_stage
+from .fhe_client_server import FHEModelServer
+
+
+def _get_fingerprint(path_dir: Path) -> Tuple[int, int]:
+    """Get a fingerprint of a model's server artifacts, changing whenever they are re-written.
+
+    Args:
+        path_dir (Path): The directory where the model's server.zip file is saved.
+
+    Returns:
+        Tuple[int, int]: The server.zip file's modification time, in nanoseconds, and size.
+    """
+    stat = (path_dir / "server.zip").stat()
+    return stat.st_mtime_ns, stat.st_size
+
+
+@dataclass
+class _RegistryEntry:
+    """A registered model, with its currently loaded server if any."""
+
+    path_dir: Path
+    server: Optional[FHEModelServer] = None
+    fingerprint: Optional[Tuple[int, int]] = None
+    loading: Optional[Future] = None
+
+
+class ModelRegistry:
+    """Load and share the FHE model servers of several models.
+
+    Each registered model is loaded at most once and the same FHEModelServer instance is then
+    shared by all requests and threads. Loading a model checks its versions and loads (and JIT
+    compiles, if needed) its circuit, which can take a significant amount of time. Models can be
+    preloaded in parallel when the server starts using `preload`, else they are loaded on their
+    first request.
+
+    When a model's artifacts change on disk, the model is reloaded in the background while the
+    previously loaded server keeps handling the requests, and is then replaced. Changes are
+    detected when calling `refresh`, or periodically if `reload_interval` is set. Evaluation keys
+    registered on a replaced server are not kept, as they might not match the new circuit.
+
+    Args:
+        n_workers (Optional[int]): The number of threads loading the models in parallel. If None,
+            one thread per available CPU core is used. Default to None.
+        reload_interval (Optional[float]): The delay, in seconds, between two checks for changed
+            artifacts. If None, artifacts are only checked when calling `refresh`. Default to None.
+    """
+
+    def __init__(self, n_workers: Optional[int] = None, reload_interval: Optional[float] = None):
+        assert_true(
+            n_workers is None or n_workers >= 1,
+            f"Parameter 'n_workers' must be None or a strictly positive integer. Got {n_workers}",
+            ValueError,
+        )
+        assert_true(
+            reload_interval is None or reload_interval > 0,
+            "Parameter 'reload_interval' must be None or a strictly positive number. Got "
+            f"{reload_interval}",
+            ValueError,
+        )
+
+        self._entries: Dict[str, _RegistryEntry] = {}
+        self._lock = threading.Lock()
+        self._pool = ThreadPoolExecutor(
+            max_workers=n_workers or os.cpu_count() or 1, thread_name_prefix="fhe-model-registry"
+        )
+
+        self._stop_event = threading.Event()
+        self._reload_thread: Optional[threading.Thread] = None
+        if reload_interval is not None:
+            self._reload_thread = threading.Thread(
+                target=self._watch, args=(reload_interval,), daemon=True
+            )
+            self._reload_thread.start()
+
+    @property
+    def names(self) -> List[str]:
+        """Get the names of the registered models.
+
+        Returns:
+            List[str]: The registered models' names.
+        """
+        with self._lock:
+            return list(self._entries)
+
+    def register(self, name: str, path_dir: Union[str, Path]):
+        """Register a model without loading it.
+
+        Args:
+            name (str): The name identifying the model.
+            path_dir (Union[str, Path]): The directory where the model's server.zip file is saved.
+
+        Raises:
+            ValueError: If another directory is already registered under the same name.
+        """
+        path_dir = Path(path_dir).resolve()
+
+        with self._lock:
+            entry = self._entries.setdefault(name, _RegistryEntry(path_dir))
+
+        if entry.path_dir != path_dir:
+            raise ValueError(
+                f"A model named '{name}' is already registered with directory {entry.path_dir}."
+            )
+
+    def register_directory(self, model_dir: Union[str, Path]) -> List[str]:
+        """Register all models found in a directory, without loading them.
+
+        Each sub-directory holding a server.zip file is registered, using its path relative to the
+        given directory as the model's name.
+
+        Args:
+            model_dir (Union[str, Path]): The directory to search for models.
+
+        Returns:
+            List[str]: The names of the registered models.
+        """
+        model_dir = Path(model_dir)
+
+        names = []
+        for server_zip_path in sorted(model_dir.rglob("server.zip")):
+            name = server_zip_path.parent.relative_to(model_dir).as_posix()
+            self.register(name, server_zip_path.parent)
+            names.append(name)
+
+        return names
+
+    def preload(self, names: Optional[Sequence[str]] = None) -> Dict[str, FHEModelServer]:
+        """Load several models in parallel and wait for them to be ready.
+
+        Args:
+            names (Optional[Sequence[str]]): The names of the models to load. If None, all
+                registered models are loaded. Default to None.
+
+        Returns:
+            Dict[str, FHEModelServer]: The loaded servers, by model name.
+        """
+        names = self.names if names is None else names
+
+        futures = {name: self._load_async(name) for name in names}
+        return {name: future.result() for name, future in futures.items()}
+
+    def get(self, name: str) -> FHEModelServer:
+        """Get a model's server, loading it if needed.
+
+        Args:
+            name (str): The model's name.
+
+        Returns:
+            FHEModelServer: The model's server.
+        """
+        with self._lock:
+            server = self._get_entry(name).server
+
+        if server is not None:
+            return server
+
+        return self._load_async(name).result()
+
+    def refresh(self) -> Dict[str, Future]:
+        """Reload in the background the loaded models whose artifacts changed.
+
+        Returns:
+            Dict[str, Future]: The futures of the reloaded servers, by model name.
+        """
+        with self._lock:
+            loaded_entries = [
+                (name, entry) for name, entry in self._entries.items() if entry.server is not None
+            ]
+
+        futures = {}
+        for name, entry in loaded_entries:
+            try:
+                has_changed = _get_fingerprint(entry.path_dir) != entry.fingerprint
+
+            # Artifacts being re-written might be missing for a short time
+            except FileNotFoundError:  # pragma: no cover
+                continue
+
+            if has_changed:
+                futures[name] = self._load_async(name)
+
+        return futures
+
+    def _get_entry(self, name: str) -> _RegistryEntry:
+        """Get a registered model's entry. This method must be called while holding the lock.
+
+        Args:
+            name (str): The model's name.
+
+        Returns:
+            _RegistryEntry: The model's entry.
+
+        Raises:
+            KeyError: If no model is registered under this name.
+        """
+        if name not in self._entries:
+            raise KeyError(f"No model named '{name}' is registered.")
+
+        return self._entries[name]
+
+    def _load_async(self, name: str) -> Future:
+        """Load a model in the background, unless it is already loaded and up to date.
+
+        Args:
+            name (str): The model's name.
+
+        Returns:
+            Future: The future holding the model's server.
+        """
+        with self._lock:
+            entry = self._get_entry(name)
+
+            # Concurrent loads of the same model share the same future
+            if entry.loading is not None:
+                return entry.loading
+
+            if entry.server is not None and entry.fingerprint == _get_fingerprint(entry.path_dir):
+                future: Future = Future()
+                future.set_result(entry.server)
+                return future
+
+            # The lock is held until the future is stored, before the load can finish
+            entry.loading = self._pool.submit(self._load, name, entry)
+            return entry.loading
+
+    def _load(self, name: str, entry: _RegistryEntry) -> FHEModelServer:
+        """Load a model and make it available to the following requests.
+
+        Args:
+            name (str): The model's name.
+            entry (_RegistryEntry): The model's entry.
+
+        Returns:
+            FHEModelServer: The loaded server.
+        """
+        try:
+            fingerprint = _get_fingerprint(entry.path_dir)
+
+            with measure_stage("model_registry.load", model=name):
+                server = FHEModelServer(str(entry.path_dir))
+
+            with self._lock:
+                entry.server = server
+                entry.fingerprint = fingerprint
+
+            return server
+
+        finally:
+            with self._lock:
+                entry.loading = None
+
+    def _watch(self, reload_interval: float):
+        """Periodically reload the models whose artifacts changed, until the registry is closed.
+
+        Args:
+            reload_interval (float): The delay, in seconds, between two checks.
+        """
+        while not self._stop_event.wait(reload_interval):
+            self.refresh()
+
+    def close(self):
+        """Stop checking for changed artifacts and wait for the ongoing loads to finish."""
+        self._stop_event.set()
+
+        if self._reload_thread is not None:
+            self._reload_thread.join()
+
+        self._pool.shutdown(wait=True)
+
+    def __enter__(self) -> "ModelRegistry":
+        """Enter the registry's context.
+
+        Returns:
+            ModelRegistry: The registry.
+        """
+        return self
+
+    def __exit__(self, *exc_info):
+        """Close the registry when leaving its context.
+
+        Args:
+            *exc_info: The exception information, if any.
+        """
+        self.close()
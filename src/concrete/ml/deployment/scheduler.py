@@ -0,0 +1,382 @@
+"""Scheduling of FHE requests from many clients on bounded pools of workers."""
+
+import bisect
+import itertools
+import math
+import os
+import threading
+import time
+from collections import defaultdict
+from concurrent.futures import Future
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional, Tuple, Union
+
+from concrete import fhe
+
+from ..common.debugging import assert_true
+from ..common.instrumentation import measure_stage
+from .fhe_client_server import EncryptedValues, FHEModelServer
+
+
+class SchedulerOverloadedError(RuntimeError):
+    """Raised when a request is rejected because the scheduler's queue is full."""
+
+
+class DeadlineExceededError(TimeoutError):
+    """Raised when a request's deadline passed before it could be started."""
+
+
+@dataclass(order=True)
+class _ScheduledRequest:
+    """A request waiting in the scheduler's queue, ordered by deadline then submission order."""
+
+    priority: Tuple[float, int]
+    model_name: str = field(compare=False)
+    device: str = field(compare=False)
+    function: Callable[[], Any] = field(compare=False)
+    future: Future = field(compare=False)
+    deadline: Optional[float] = field(compare=False)
+
+
+class RequestScheduler:
+    """Schedule the FHE requests of several models on bounded pools of workers.
+
+    Requests are stored in a bounded queue and executed by pools of worker threads, one pool for
+    each device (for example 'cpu' or 'cuda'). Workers always start the request with the earliest
+    deadline first, requests without deadline being started after them in submission order.
+
+    A model never runs more requests at the same time than its concurrency limit. Its other
+    requests then wait in the queue while requests of other models are started. Requests whose
+    deadline passed before they could be started fail with a DeadlineExceededError without being
+    executed. When the queue is full, new requests are rejected right away with a
+    SchedulerOverloadedError, which servers can forward to their clients as a backpressure
+    response (for example, an HTTP 503 status).
+
+    Args:
+        n_workers (Optional[Dict[str, int]]): The number of workers of each device's pool. If
+            None, a single 'cpu' pool with one worker per available CPU core is used. Default to
+            None.
+        max_queue_size (int): The maximum number of requests waiting to be started. Default to
+            128.
+        max_concurrency_per_model (Optional[int]): The default maximum number of requests of a
+            single model running at the same time. If None, models are only bounded by the
+            number of workers. Default to None.
+    """
+
+    def __init__(
+        self,
+        n_workers: Optional[Dict[str, int]] = None,
+        max_queue_size: int = 128,
+        max_concurrency_per_model: Optional[int] = None,
+    ):
+        if n_workers is None:
+            n_workers = {"cpu": os.cpu_count() or 1}
+
+        assert_true(
+            len(n_workers) > 0 and all(n_workers_i >= 1 for n_workers_i in n_workers.values()),
+            "Parameter 'n_workers' must map at least one device to a strictly positive number of "
+            f"workers. Got {n_workers}",
+            ValueError,
+        )
+        assert_true(
+            max_queue_size >= 1,
+            f"Parameter 'max_queue_size' must be a strictly positive integer. Got {max_queue_size}",
+            ValueError,
+        )
+        assert_true(
+            max_concurrency_per_model is None or max_concurrency_per_model >= 1,
+            "Parameter 'max_concurrency_per_model' must be None or a strictly positive integer. "
+            f"Got {max_concurrency_per_model}",
+            ValueError,
+        )
+
+        self.n_workers = dict(n_workers)
+        self.max_queue_size = max_queue_size
+        self.max_concurrency_per_model = max_concurrency_per_model
+
+        self._queue: List[_ScheduledRequest] = []
+        self._n_running: Dict[str, int] = defaultdict(int)
+        self._model_concurrency: Dict[str, Optional[int]] = {}
+        self._condition = threading.Condition()
+        self._sequence = itertools.count()
+        self._is_shutdown = False
+
+        self._workers = [
+            threading.Thread(
+                target=self._work, args=(device,), name=f"fhe-scheduler-{device}-{i}", daemon=True
+            )
+            for device, n_workers_i in self.n_workers.items()
+            for i in range(n_workers_i)
+        ]
+        for worker in self._workers:
+            worker.start()
+
+    @property
+    def n_pending(self) -> int:
+        """Get the number of requests waiting to be started.
+
+        Returns:
+            int: The number of queued requests.
+        """
+        with self._condition:
+            return len(self._queue)
+
+    def set_model_concurrency(self, model_name: str, max_concurrency: Optional[int]):
+        """Set the maximum number of requests of a model running at the same time.
+
+        Args:
+            model_name (str): The model's name, as given when submitting its requests.
+            max_concurrency (Optional[int]): The model's concurrency limit. If None, the model is
+                only bounded by the number of workers.
+        """
+        assert_true(
+            max_concurrency is None or max_concurrency >= 1,
+            "Parameter 'max_concurrency' must be None or a strictly positive integer. Got "
+            f"{max_concurrency}",
+            ValueError,
+        )
+
+        with self._condition:
+            self._model_concurrency[model_name] = max_concurrency
+            self._condition.notify_all()
+
+    def submit(
+        self,
+        model_name: str,
+        function: Callable,
+        *args,
+        deadline: Optional[float] = None,
+        device: str = "cpu",
+        **kwargs,
+    ) -> Future:
+        """Queue a request calling the given function.
+
+        Args:
+            model_name (str): The name of the model the request belongs to, used for its
+                concurrency limit.
+            function (Callable): The function to call.
+            *args: The function's positional arguments.
+            deadline (Optional[float]): The delay, in seconds from now, after which the request
+                fails if it has not been started yet. Requests with the earliest deadlines are
+                started first. If None, the request never expires. Default to None.
+            device (str): The device whose pool of workers executes the request. Default to 'cpu'.
+            **kwargs: The function's keyword arguments.
+
+        Returns:
+            Future: The future holding the function's result.
+
+        Raises:
+            SchedulerOverloadedError: If the queue is full.
+            RuntimeError: If the scheduler has been shut down.
+        """
+        assert_true(
+            device in self.n_workers,
+            f"Device '{device}' has no pool of workers. Available devices are "
+            f"{list(self.n_workers)}",
+            ValueError,
+        )
+
+        future: Future = Future()
+        absolute_deadline = None if deadline is None else time.monotonic() + deadline
+
+        def call() -> Any:
+            """Call the function with its arguments.
+
+            Returns:
+                Any: The function's result.
+            """
+            return function(*args, **kwargs)
+
+        with self._condition:
+            if self._is_shutdown:
+                raise RuntimeError("Cannot submit requests to a scheduler that has been shut down.")
+
+            if len(self._queue) >= self.max_queue_size:
+                raise SchedulerOverloadedError(
+                    f"The scheduler's queue is full ({self.max_queue_size} pending requests). "
+                    "Please retry later."
+                )
+
+            request = _ScheduledRequest(
+                priority=(
+                    math.inf if absolute_deadline is None else absolute_deadline,
+                    next(self._sequence),
+                ),
+                model_name=model_name,
+                device=device,
+                function=call,
+                future=future,
+                deadline=absolute_deadline,
+            )
+            bisect.insort(self._queue, request)
+            self._condition.notify_all()
+
+        return future
+
+    def submit_run(
+        self,
+        model_name: str,
+        fhe_model_server: FHEModelServer,
+        serialized_encrypted_quantized_data: EncryptedValues,
+        serialized_evaluation_keys: Optional[Union[bytes, fhe.EvaluationKeys]] = None,
+        evaluation_keys_handle: Optional[str] = None,
+        deadline: Optional[float] = None,
+        device: str = "cpu",
+    ) -> Future:
+        """Queue a request running a model server on encrypted data.
+
+        This is the scheduled equivalent of `FHEModelServer.run`.
+
+        Args:
+            model_name (str): The name of the model, used for its concurrency limit.
+            fhe_model_server (FHEModelServer): The server executing the request.
+            serialized_encrypted_quantized_data (EncryptedValues): The encrypted and quantized
+                values to consider, as given to `FHEModelServer.run`.
+            serialized_evaluation_keys (Optional[Union[bytes, fhe.EvaluationKeys]]): The evaluation
+                keys, as given to `FHEModelServer.run`. Default to None.
+            evaluation_keys_handle (Optional[str]): The handle of registered evaluation keys, as
+                given to `FHEModelServer.run`. Default to None.
+            deadline (Optional[float]): The delay, in seconds from now, after which the request
+                fails if it has not been started yet. If None, the request never expires. Default
+                to None.
+            device (str): The device whose pool of workers executes the request. Default to 'cpu'.
+
+        Returns:
+            Future: The future holding the model's encrypted results.
+        """
+        return self.submit(
+            model_name,
+            fhe_model_server.run,
+            serialized_encrypted_quantized_data,
+            serialized_evaluation_keys=serialized_evaluation_keys,
+            evaluation_keys_handle=evaluation_keys_handle,
+            deadline=deadline,
+            device=device,
+        )
+
+    def _pop_next_request(self, device: str) -> Optional[_ScheduledRequest]:
+        """Remove the next request to start on the given device from the queue.
+
+        Expired requests met along the way are removed and failed. This method must be called
+        while holding the scheduler's lock.
+
+        Args:
+            device (str): The device of the worker looking for a request.
+
+        Returns:
+            Optional[_ScheduledRequest]: The request with the earliest deadline whose model is
+                below its concurrency limit, or None if there is none.
+        """
+        now = time.monotonic()
+
+        next_request = None
+        remaining_requests = []
+        for request in self._queue:
+            if request.deadline is not None and request.deadline <= now:
+                if request.future.set_running_or_notify_cancel():
+                    request.future.set_exception(
+                        DeadlineExceededError(
+                            f"The request for model '{request.model_name}' could not be started "
+                            "before its deadline."
+                        )
+                    )
+                continue
+
+            max_concurrency = self._model_concurrency.get(
+                request.model_name, self.max_concurrency_per_model
+            )
+            is_available = (
+                max_concurrency is None or self._n_running[request.model_name] < max_concurrency
+            )
+
+            if next_request is None and request.device == device and is_available:
+                next_request = request
+            else:
+                remaining_requests.append(request)
+
+        self._queue = remaining_requests
+        return next_request
+
+    def _get_wait_timeout(self) -> Optional[float]:
+        """Get how long a worker can wait before the earliest queued deadline passes.
+
+        Workers waiting for a request wake up at this deadline, so that the expired request fails
+        even if no other event wakes them up before. This method must be called while holding the
+        scheduler's lock.
+
+        Returns:
+            Optional[float]: The delay in seconds until the earliest queued deadline, or None if
+                no queued request has a deadline.
+        """
+        # The queue is sorted by deadline, requests without deadline being last
+        if not self._queue or self._queue[0].deadline is None:
+            return None
+
+        return max(self._queue[0].deadline - time.monotonic(), 0.0)
+
+    def _work(self, device: str):
+        """Execute the queued requests of a device until the scheduler is shut down.
+
+        Args:
+            device (str): The worker's device.
+        """
+        while True:
+            with self._condition:
+                request = self._pop_next_request(device)
+                while request is None:
+                    if self._is_shutdown:
+                        return
+                    self._condition.wait(timeout=self._get_wait_timeout())
+                    request = self._pop_next_request(device)
+
+                self._n_running[request.model_name] += 1
+
+            try:
+                if request.future.set_running_or_notify_cancel():
+                    try:
+                        with measure_stage(
+                            "scheduler.run", model=request.model_name, device=device
+                        ):
+                            result = request.function()
+                    except Exception as error:  # pylint: disable=broad-exception-caught
+                        request.future.set_exception(error)
+                    else:
+                        request.future.set_result(result)
+            finally:
+                with self._condition:
+                    self._n_running[request.model_name] -= 1
+                    self._condition.notify_all()
+
+    def shutdown(self, wait: bool = True):
+        """Stop the workers and cancel the requests that have not been started.
+
+        Args:
+            wait (bool): Whether to wait for the running requests to finish. Default to True.
+        """
+        with self._condition:
+            self._is_shutdown = True
+            pending_requests, self._queue = self._queue, []
+            self._condition.notify_all()
+
+        for request in pending_requests:
+            request.future.cancel()
+
+        if wait:
+            for worker in self._workers:
+                worker.join()
+
+    def __enter__(self) -> "RequestScheduler":
+        """Enter the scheduler's context.
+
+        Returns:
+            RequestScheduler: The scheduler.
+        """
+        return self
+
+    def __exit__(self, *exc_info):
+        """Shut the scheduler down when leaving its context.
+
+        Args:
+            *exc_info: The exception information, if any.
+        """
+        self.shutdown()
@@ -22,6 +22,7 @@ from .onnx_utils import (
     execute_onnx_with_numpy_trees,
     get_op_type,
 )
+from .tree_traversal import TreeTraversalExecutor
 
 NumpyForwardCallable: TypeAlias = Callable[..., Tuple[numpy.ndarray, ...]]
 ONNXAndNumpyForwards: TypeAlias = Tuple[
@@ -325,9 +326,23 @@ def get_equivalent_numpy_forward_from_onnx_tree(
 
     _, equivalent_onnx_model = preprocess_onnx_model(onnx_model, check_model)
 
-    # Return lambda of numpy equivalent of onnx execution
-    return (
-        lambda *args: execute_onnx_with_numpy_trees(
+    # Clear inputs are evaluated by traversing the trees, which gives the same results as the
+    # graph's execution, while Concrete tracers still go through the graph to build the circuit
+    tree_traversal = TreeTraversalExecutor.from_graph(
+        equivalent_onnx_model.graph, lsbs_to_remove_for_trees
+    )
+
+    def tree_forward(*args):
+        if (
+            tree_traversal is not None
+            and len(args) == 1
+            and isinstance(args[0], numpy.ndarray)
+            and args[0].ndim == 2
+        ):
+            return tree_traversal(*args)
+
+        return execute_onnx_with_numpy_trees(
             equivalent_onnx_model.graph, lsbs_to_remove_for_trees, *args
         )
-    ), equivalent_onnx_model
+
+    return tree_forward, equivalent_onnx_model
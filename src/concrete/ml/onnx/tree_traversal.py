@@ -0,0 +1,462 @@
+"""Clear evaluation of tree-based models' ONNX graphs by traversing the trees."""
+
+from typing import Any, Callable, Dict, List, Optional, Set, Tuple
+
+import numpy
+import onnx
+from onnx import numpy_helper
+
+from .onnx_utils import (
+    ONNX_COMPARISON_OPS_TO_ROUNDED_TREES_NUMPY_IMPL_BOOL,
+    ONNX_OPS_TO_NUMPY_IMPL_BOOL,
+    get_attribute,
+)
+
+# Comparisons found in the trees' decision nodes, with their clear equivalent
+# The quantized thresholds are integers, so truncating the LSBs of `x - threshold`, as done by the
+# FHE circuit and by the rounded ONNX operators, does not change the sign of the difference. These
+# comparisons are therefore bit-exact whatever the number of LSBs removed in the first stage
+TREE_DECISION_OPS: Dict[str, Callable[[numpy.ndarray, numpy.ndarray], numpy.ndarray]] = {
+    "Less": numpy.less,
+    "LessOrEqual": numpy.less_equal,
+}
+
+
+class TreeTraversalExecutor:
+    """Evaluate the ONNX graph of a tree-based model by traversing its trees.
+
+    Hummingbird's GEMM representation of a tree ensemble, used to build the FHE circuit, evaluates
+    all the decision nodes of all trees and then matches all the leaves against them. This executor
+    instead recovers the trees from the graph's quantized initializers and stores them as flat
+    struct-of-arrays tables (feature, threshold, children), laid out breadth-first across all trees.
+    Each sample is then moved from the roots to the leaves with one vectorized gather per level.
+
+    The selected leaves are given to the graph's remaining nodes (leaf values, reshapes, ...), so
+    that the outputs are bit-exact with the ones of `execute_onnx_with_numpy_trees`.
+
+    Instances should be built with `from_graph`, which returns None for graphs that cannot be
+    traversed exactly.
+
+    Args:
+        graph (onnx.GraphProto): The tree-based model's quantized ONNX graph.
+        decision_op_type (str): The decision nodes' comparison, either "Less" or "LessOrEqual".
+        feature (numpy.ndarray): The feature compared by each node of the flat table.
+        threshold (numpy.ndarray): The quantized threshold of each node of the flat table.
+        child_true (numpy.ndarray): The node reached when the comparison is true. Leaves point to
+            themselves.
+        child_false (numpy.ndarray): The node reached when the comparison is false. Leaves point to
+            themselves.
+        leaf_index (numpy.ndarray): The index of each leaf in the graph's flattened leaves, -1 for
+            decision nodes.
+        n_roots (int): The number of roots, stored at the start of the table.
+        depth (int): The number of levels to traverse to reach the deepest leaf.
+        padding_leaves (numpy.ndarray): The graph's leaves that match all samples.
+        selection_node (onnx.NodeProto): The graph node matching the leaves.
+        selection_shape (Tuple[int, ...]): The shape of the leaves' selection, without the samples'
+            axis.
+        tail_nodes (List[onnx.NodeProto]): The graph nodes evaluated after the leaves' selection.
+        lsbs_to_remove_for_trees (Optional[Tuple[int, int]]): The LSBs to remove in the graph's
+            comparisons.
+    """
+
+    # pylint: disable-next=too-many-arguments
+    def __init__(
+        self,
+        graph: onnx.GraphProto,
+        decision_op_type: str,
+        feature: numpy.ndarray,
+        threshold: numpy.ndarray,
+        child_true: numpy.ndarray,
+        child_false: numpy.ndarray,
+        leaf_index: numpy.ndarray,
+        n_roots: int,
+        depth: int,
+        padding_leaves: numpy.ndarray,
+        selection_node: onnx.NodeProto,
+        selection_shape: Tuple[int, ...],
+        tail_nodes: List[onnx.NodeProto],
+        lsbs_to_remove_for_trees: Optional[Tuple[int, int]],
+    ):
+        self.graph = graph
+        self.decision = TREE_DECISION_OPS[decision_op_type]
+        self.feature = feature
+        self.threshold = threshold
+        self.child_true = child_true
+        self.child_false = child_false
+        self.leaf_index = leaf_index
+        self.n_roots = n_roots
+        self.depth = depth
+        self.padding_leaves = padding_leaves
+        self.selection_node = selection_node
+        self.selection_shape = selection_shape
+        self.tail_nodes = tail_nodes
+        self.lsbs_to_remove_for_trees = lsbs_to_remove_for_trees
+
+        self.initializers = {
+            initializer.name: numpy_helper.to_array(initializer)
+            for initializer in graph.initializer
+        }
+
+    # pylint: disable-next=too-many-return-statements,too-many-locals,too-many-branches
+    @classmethod
+    def from_graph(
+        cls,
+        graph: onnx.GraphProto,
+        lsbs_to_remove_for_trees: Optional[Tuple[int, int]] = None,
+    ) -> Optional["TreeTraversalExecutor"]:
+        """Build the executor of a tree-based model's quantized ONNX graph.
+
+        Args:
+            graph (onnx.GraphProto): The graph, as generated by Hummingbird's GEMM implementation
+                and quantized by `tree_to_numpy` or `onnx_fp32_model_to_quantized_model`.
+            lsbs_to_remove_for_trees (Optional[Tuple[int, int]]): The LSBs to remove in the
+                graph's comparisons, as given to `execute_onnx_with_numpy_trees`.
+
+        Returns:
+            Optional[TreeTraversalExecutor]: The executor, or None if the graph does not have the
+                expected structure or if its traversal would not be bit-exact.
+        """
+
+        # Rounding the leaves' matching changes the "Equal" operator into a "LessOrEqual" one,
+        # which can select several leaves per tree and thus cannot be reproduced by a traversal
+        if lsbs_to_remove_for_trees is not None and lsbs_to_remove_for_trees[1] > 0:
+            return None
+
+        initializers = {
+            initializer.name: numpy_helper.to_array(initializer)
+            for initializer in graph.initializer
+        }
+        producers = {output: node for node in graph.node for output in node.output}
+        input_names = {graph_input.name for graph_input in graph.input}
+
+        decision_nodes = [node for node in graph.node if node.op_type in TREE_DECISION_OPS]
+        selection_nodes = [node for node in graph.node if node.op_type == "Equal"]
+
+        if len(decision_nodes) != 1 or len(selection_nodes) != 1:
+            return None
+
+        decision_node, selection_node = decision_nodes[0], selection_nodes[0]
+
+        # The decision nodes compare `weight_1 @ x.T` with the thresholds `bias_1` while the leaves
+        # are matched by comparing `weight_2 @ decisions` with `bias_2`
+        decision_matmul = cls._get_matmul(decision_node.input[0], producers)
+        selection_matmul = cls._get_matmul(selection_node.input[0], producers)
+
+        if decision_matmul is None or selection_matmul is None:
+            return None
+
+        weight_1 = initializers.get(decision_matmul.input[0])
+        bias_1 = initializers.get(decision_node.input[1])
+        weight_2 = initializers.get(selection_matmul.input[0])
+        bias_2 = initializers.get(selection_node.input[1])
+
+        # The decisions must be made on the graph's (transposed) inputs
+        features_name = decision_matmul.input[1]
+        features_node = producers.get(features_name)
+        if features_node is not None and features_node.op_type == "Transpose":
+            features_name = features_node.input[0]
+
+        if features_name not in input_names:
+            return None
+
+        if weight_1 is None or bias_1 is None or weight_2 is None or bias_2 is None:
+            return None
+
+        # Single trees may not have the trees' axis
+        if weight_2.ndim == 2:
+            weight_2 = weight_2[None, ...]
+
+        n_trees, n_leaves, n_nodes = weight_2.shape
+
+        if (
+            weight_1.ndim != 2
+            or weight_1.shape[0] != n_trees * n_nodes
+            or bias_1.size != n_trees * n_nodes
+            or bias_2.size != n_trees * n_leaves
+            or bias_2.shape[-1] != 1
+        ):
+            return None
+
+        # Each decision node selects a single feature, and each leaf is matched if all decisions on
+        # its path take the expected value, i.e., if `weight_2 @ decisions` reaches the number of
+        # decisions expected to be true
+        if (
+            not numpy.isin(weight_1, (0, 1)).all()
+            or (weight_1.sum(axis=1) > 1).any()
+            or not numpy.isin(weight_2, (-1, 0, 1)).all()
+            or not numpy.array_equal(
+                bias_2.reshape(n_trees, n_leaves), (weight_2 > 0).sum(axis=2)
+            )
+        ):
+            return None
+
+        tables = cls._build_tables(weight_1, bias_1.reshape(-1), weight_2)
+        if tables is None:
+            return None
+
+        # Find the nodes to evaluate once the leaves are selected
+        tail_nodes = cls._get_tail_nodes(graph, selection_node, initializers, input_names)
+        if tail_nodes is None or decision_node in tail_nodes:
+            return None
+
+        return cls(
+            graph,
+            decision_node.op_type,
+            *tables,
+            selection_node=selection_node,
+            selection_shape=tuple(bias_2.shape[:-1]),
+            tail_nodes=tail_nodes,
+            lsbs_to_remove_for_trees=lsbs_to_remove_for_trees,
+        )
+
+    @staticmethod
+    def _get_matmul(name: str, producers: Dict[str, onnx.NodeProto]) -> Optional[onnx.NodeProto]:
+        """Get the MatMul node producing a tensor, possibly through reshapes.
+
+        Args:
+            name (str): The tensor's name.
+            producers (Dict[str, onnx.NodeProto]): The node producing each tensor of the graph.
+
+        Returns:
+            Optional[onnx.NodeProto]: The MatMul node, or None if the tensor is not produced by one.
+        """
+        node = producers.get(name)
+
+        while node is not None and node.op_type in ("Reshape", "Squeeze", "Unsqueeze"):
+            node = producers.get(node.input[0])
+
+        if node is None or node.op_type != "MatMul":
+            return None
+
+        return node
+
+    # pylint: disable-next=too-many-locals
+    @staticmethod
+    def _build_tables(
+        weight_1: numpy.ndarray, bias_1: numpy.ndarray, weight_2: numpy.ndarray
+    ) -> Optional[Tuple[Any, ...]]:
+        """Recover the trees from the GEMM matrices and store them in breadth-first tables.
+
+        Args:
+            weight_1 (numpy.ndarray): The features selected by the decision nodes, of shape
+                (n_trees * n_nodes, n_features).
+            bias_1 (numpy.ndarray): The decision nodes' thresholds, of shape (n_trees * n_nodes,).
+            weight_2 (numpy.ndarray): The decisions expected by each leaf, of shape
+                (n_trees, n_leaves, n_nodes).
+
+        Returns:
+            Optional[Tuple[Any, ...]]: The feature, threshold, child_true, child_false, leaf_index
+                tables, the number of roots, the depth and the padding leaves, or None if the
+                matrices do not describe binary trees.
+        """
+        n_trees, n_leaves, n_nodes = weight_2.shape
+
+        # Each level of the breadth-first layout, as (tree, node or None, leaf or None) entries
+        levels: List[List[Tuple[int, Optional[int], Optional[int]]]] = [[]]
+        children: Dict[Tuple[int, int], Tuple[Any, Any]] = {}
+
+        # Leaves that are not on any path (padding leaves, or trees reduced to a single leaf)
+        # are matched by all samples
+        padding_leaves = []
+
+        for tree in range(n_trees):
+            paths = weight_2[tree]
+            is_on_path = paths.any(axis=1)
+            leaves = numpy.flatnonzero(is_on_path)
+            padding_leaves += [
+                tree * n_leaves + int(leaf) for leaf in numpy.flatnonzero(~is_on_path)
+            ]
+
+            if leaves.size == 0:
+                continue
+
+            # The sub-tree of a node is described by the set of leaves whose path contain it
+            subtrees: Dict[frozenset, int] = {}
+            for node in numpy.flatnonzero(paths.any(axis=0)):
+                if not weight_1[tree * n_nodes + node].any():
+                    return None
+                subtrees[frozenset(numpy.flatnonzero(paths[:, node]))] = node
+
+            root = TreeTraversalExecutor._get_child(subtrees, leaves, tree * n_leaves)
+            if root is None:
+                return None
+
+            levels[0].append((tree, *root))
+
+            for node in subtrees.values():
+                child_true = TreeTraversalExecutor._get_child(
+                    subtrees, numpy.flatnonzero(paths[:, node] > 0), tree * n_leaves
+                )
+                child_false = TreeTraversalExecutor._get_child(
+                    subtrees, numpy.flatnonzero(paths[:, node] < 0), tree * n_leaves
+                )
+                if child_true is None or child_false is None:
+                    return None
+                children[(tree, node)] = (child_true, child_false)
+
+        # Lay out the trees level by level, so that each traversal step reads contiguous entries
+        position: Dict[Tuple[int, Optional[int], Optional[int]], int] = {}
+        while levels[-1]:
+            next_level = []
+            for entry in levels[-1]:
+                position[entry] = len(position)
+                tree, node, _ = entry
+                if node is not None:
+                    next_level += [(tree, *child) for child in children[(tree, node)]]
+            levels.append(next_level)
+
+        n_entries = len(position)
+        feature = numpy.zeros(n_entries, dtype=numpy.int64)
+        threshold = numpy.zeros(n_entries, dtype=numpy.int64)
+        child_true = numpy.zeros(n_entries, dtype=numpy.int64)
+        child_false = numpy.zeros(n_entries, dtype=numpy.int64)
+        leaf_index = numpy.full(n_entries, -1, dtype=numpy.int64)
+
+        for (tree, node, leaf), index in position.items():
+            # Leaves point to themselves, so that all samples can be moved at each level
+            if node is None:
+                child_true[index] = child_false[index] = index
+                leaf_index[index] = leaf
+                continue
+
+            feature[index] = numpy.argmax(weight_1[tree * n_nodes + node])
+            threshold[index] = bias_1[tree * n_nodes + node]
+            true_entry, false_entry = children[(tree, node)]
+            child_true[index] = position[(tree, *true_entry)]
+            child_false[index] = position[(tree, *false_entry)]
+
+        return (
+            feature,
+            threshold,
+            child_true,
+            child_false,
+            leaf_index,
+            len(levels[0]),
+            len(levels) - 2,
+            numpy.array(padding_leaves, dtype=numpy.int64),
+        )
+
+    @staticmethod
+    def _get_child(
+        subtrees: Dict[frozenset, int], leaves: numpy.ndarray, leaf_offset: int
+    ) -> Optional[Tuple[Optional[int], Optional[int]]]:
+        """Get the node or leaf whose sub-tree is made of the given leaves.
+
+        Args:
+            subtrees (Dict[frozenset, int]): The node of a tree for each set of leaves below it.
+            leaves (numpy.ndarray): The leaves' indexes in the tree.
+            leaf_offset (int): The index of the tree's first leaf in the graph's flattened leaves.
+
+        Returns:
+            Optional[Tuple[Optional[int], Optional[int]]]: The (node, None) or (None, leaf) pair,
+                or None if no node has these leaves.
+        """
+        leaves_set = frozenset(leaves)
+
+        if leaves_set in subtrees:
+            return (subtrees[leaves_set], None)
+
+        if len(leaves_set) == 1:
+            return (None, leaf_offset + int(leaves[0]))
+
+        return None
+
+    @staticmethod
+    def _get_tail_nodes(
+        graph: onnx.GraphProto,
+        selection_node: onnx.NodeProto,
+        initializers: Dict[str, numpy.ndarray],
+        input_names: Set[str],
+    ) -> Optional[List[onnx.NodeProto]]:
+        """Get the nodes computing the graph's outputs from the leaves' selection.
+
+        Args:
+            graph (onnx.GraphProto): The graph.
+            selection_node (onnx.NodeProto): The node matching the leaves.
+            initializers (Dict[str, numpy.ndarray]): The graph's initializers.
+            input_names (Set[str]): The graph's input names.
+
+        Returns:
+            Optional[List[onnx.NodeProto]]: The nodes, in execution order, or None if the outputs
+                do not depend on the leaves' selection.
+        """
+        available = set(initializers) | input_names | set(selection_node.output)
+        required = {output.name for output in graph.output} - available
+
+        tail_nodes = []
+        for node in reversed(graph.node):
+            if node != selection_node and required.intersection(node.output):
+                tail_nodes.append(node)
+                required.difference_update(node.output)
+                required.update(name for name in node.input if name and name not in available)
+
+        if required or not tail_nodes:
+            return None
+
+        return tail_nodes[::-1]
+
+    def select_leaves(self, q_x: numpy.ndarray) -> numpy.ndarray:
+        """Traverse the trees and select the leaves reached by each sample.
+
+        Args:
+            q_x (numpy.ndarray): The quantized inputs, of shape (n_samples, n_features).
+
+        Returns:
+            numpy.ndarray: The boolean selection of the flattened leaves, of shape
+                (n_samples, n_trees * n_leaves).
+        """
+        n_samples = q_x.shape[0]
+        samples = numpy.arange(n_samples)[:, None]
+
+        # Start from the roots, stored at the beginning of the table
+        current = numpy.broadcast_to(numpy.arange(self.n_roots), (n_samples, self.n_roots))
+
+        for _ in range(self.depth):
+            is_true = self.decision(q_x[samples, self.feature[current]], self.threshold[current])
+            current = numpy.where(is_true, self.child_true[current], self.child_false[current])
+
+        selection = numpy.zeros((n_samples, int(numpy.prod(self.selection_shape))), dtype=bool)
+        selection[:, self.padding_leaves] = True
+        selection[samples, self.leaf_index[current]] = True
+
+        return selection
+
+    def __call__(self, *inputs: numpy.ndarray) -> Tuple[numpy.ndarray, ...]:
+        """Execute the graph on the given inputs.
+
+        Args:
+            *inputs (numpy.ndarray): The graph's quantized inputs.
+
+        Returns:
+            Tuple[numpy.ndarray, ...]: The graph's outputs.
+        """
+        q_x = inputs[0]
+        selection = self.select_leaves(q_x)
+
+        # Give the selection the layout of the graph's "Equal" node output, with the samples last
+        selection = selection.T.reshape(self.selection_shape + (q_x.shape[0],))
+
+        node_results: Dict[str, numpy.ndarray] = dict(
+            {graph_input.name: value for graph_input, value in zip(self.graph.input, inputs)},
+            **self.initializers,
+        )
+        node_results[self.selection_node.output[0]] = selection
+
+        for node in self.tail_nodes:
+            curr_inputs = (node_results[input_name] for input_name in node.input)
+            attributes = {attribute.name: get_attribute(attribute) for attribute in node.attribute}
+
+            if (
+                self.lsbs_to_remove_for_trees is not None
+                and node.op_type in ONNX_COMPARISON_OPS_TO_ROUNDED_TREES_NUMPY_IMPL_BOOL
+            ):  # pragma: no cover
+                stage = 0 if node.op_type != "Equal" else 1
+                attributes["lsbs_to_remove_for_trees"] = self.lsbs_to_remove_for_trees[stage]
+                op_type = ONNX_COMPARISON_OPS_TO_ROUNDED_TREES_NUMPY_IMPL_BOOL[node.op_type]
+            else:
+                op_type = ONNX_OPS_TO_NUMPY_IMPL_BOOL[node.op_type]
+
+            outputs = op_type(*curr_inputs, **attributes)
+            node_results.update(zip(node.output, outputs))
+
+        return tuple(node_results[output.name] for output in self.graph.output)
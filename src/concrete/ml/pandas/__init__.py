@@ -8,17 +8,25 @@ from .client_engine import ClientEngine
 from .dataframe import EncryptedDataFrame
 
 
-def load_encrypted_dataframe(path: Union[Path, str]) -> EncryptedDataFrame:
+def load_encrypted_dataframe(
+    path: Union[Path, str],
+    columns: Optional[Sequence[str]] = None,
+    rows: Optional[slice] = None,
+) -> EncryptedDataFrame:
     """Load a serialized encrypted data-frame.
 
     Args:
         path (Union[Path, str]): The path to consider for loading the serialized encrypted
             data-frame.
+        columns (Optional[Sequence[str]]): The names of the columns to load. If None, all columns
+            are loaded. Default to None.
+        rows (Optional[slice]): The contiguous range of rows to load. If None, all rows are loaded.
+            Default to None.
 
     Returns:
         EncryptedDataFrame: The loaded encrypted data-frame.
     """
-    return EncryptedDataFrame.load(path)
+    return EncryptedDataFrame.load(path, columns=columns, rows=rows)
 
 
 # pylint: disable-next=too-many-arguments, invalid-name
@@ -36,6 +44,7 @@ def merge(
     copy: Optional[bool] = None,
     indicator: Union[bool, str] = False,
     validate: Optional[str] = None,
+    n_jobs: Optional[int] = -1,
 ) -> EncryptedDataFrame:
     """Merge two encrypted data-frames in FHE using Pandas parameters.
 
@@ -76,6 +85,9 @@ def merge(
             Default to False.
         validate (Optional[str]): Currently not supported, please keep the default value.
             Default to None.
+        n_jobs (Optional[int]): The number of workers to use for running the FHE computations.
+            If None or 1, computations are run sequentially. If -1, all available CPU cores are
+            used. Default to -1.
 
     Returns:
         EncryptedDataFrame: The joined encrypted data-frame.
@@ -93,4 +105,5 @@ def merge(
         copy=copy,
         indicator=indicator,
         validate=validate,
+        n_jobs=n_jobs,
     )
@@ -1,13 +1,16 @@
 """Implement Pandas operators in FHE using encrypted data-frames."""
 
 from collections.abc import Hashable
+from concurrent.futures import ThreadPoolExecutor
 from typing import Any, Dict, List, Optional, Sequence, Tuple, Union
 
 import numpy
 import pandas
-from concrete.fhe import Server
+from concrete.fhe import EvaluationKeys, Server, Value
 from pandas.core.reshape.merge import _MergeOperation
 
+from concrete.ml.pandas._utils import get_n_workers
+
 # List of Pandas parameters per operator that are not currently supported
 UNSUPPORTED_PANDAS_PARAMETERS = {
     "merge": {
@@ -95,13 +98,63 @@ def check_dtype_of_selected_column_for_merge(left_encrypted, right_encrypted, se
         )
 
 
-# pylint: disable-next=invalid-name
+# pylint: disable-next=too-many-arguments
+def encrypted_select_right_value(
+    server: Server,
+    evaluation_keys: EvaluationKeys,
+    encrypted_nan: Value,
+    left_key: Value,
+    right_keys: numpy.ndarray,
+    right_values: numpy.ndarray,
+) -> Value:
+    """Select the value from a right column whose key matches the given left key, in FHE.
+
+    Args:
+        server (Server): The Concrete server to use for running the computations in FHE.
+        evaluation_keys (EvaluationKeys): The evaluation keys to use.
+        encrypted_nan (Value): The encrypted value representing NaN, used as the initial value.
+        left_key (Value): The left data-frame's encrypted key to consider.
+        right_keys (numpy.ndarray): The right data-frame's encrypted keys, one per row.
+        right_values (numpy.ndarray): The right column's encrypted values, one per row.
+
+    Returns:
+        Value: The selected encrypted value, or NaN if no right key matches the left key.
+    """
+    # Default value is NaN
+    right_value_to_join = encrypted_nan
+
+    # Loop over the right data-frame's number of rows in order to check if one row's key matches
+    # the left key
+    for right_key, value_to_put_right in zip(right_keys, right_values):
+
+        # Run the FHE execution:
+        # - on the first iteration, this is applied on a 0 (representing a NaN) and the right
+        #   data-frame's value
+        # - on the following iterations, this is applied between the previous accumulated value
+        # and the right data-frame's value.
+        # Basically, if both keys match, the function adds the accumulated value with the right
+        # data-frame's value. If they don't, it just adds 0 to the accumulated value. In practice,
+        # keys only match once throughout this very loop as keys are assumed to be unique on both
+        # data-frames.
+        right_value_to_join = server.run(
+            right_value_to_join,
+            value_to_put_right,
+            left_key,
+            right_key,
+            evaluation_keys=evaluation_keys,
+        )
+
+    return right_value_to_join
+
+
+# pylint: disable-next=invalid-name,too-many-locals
 def encrypted_left_right_join(
     left_encrypted,
     right_encrypted,
     server: Server,
     how: str,
     on: Optional[str],  # pylint: disable=invalid-name
+    n_jobs: Optional[int] = -1,
 ) -> numpy.ndarray:
     """Compute a left/right join in FHE between two encrypted data-frames using Pandas parameters.
 
@@ -119,6 +172,10 @@ def encrypted_left_right_join(
     to know the number of columns and rows at compilation time. More details can be found in the
     '_development.py' file.
 
+    Each (left row, right column) cell of the joined data-frame is computed independently from the
+    others, which means these cells are spread across a pool of workers. Only the loop over the
+    right rows needs to be sequential.
+
     Args:
         left_encrypted (EncryptedDataFrame): The left encrypted data-frame.
         right_encrypted (EncryptedDataFrame): The right encrypted data-frame.
@@ -130,6 +187,9 @@ def encrypted_left_right_join(
             preserve key order.
         on (Optional[str]): Column name to join on. These must be found in both DataFrames. If it is
             None then this defaults to the intersection of the columns in both DataFrames.
+        n_jobs (Optional[int]): The number of workers to use for running the FHE computations. If
+            None or 1, cells are computed sequentially. If -1, all available CPU cores are used.
+            Default to -1.
 
     Returns:
         numpy.ndarray: The values representing the joined encrypted data-frame.
@@ -137,106 +197,86 @@ def encrypted_left_right_join(
     allowed_how = ["left", "right"]
     assert how in allowed_how, f"Parameter 'how' must be in {allowed_how}. Got {how}."
 
+    n_workers = get_n_workers(n_jobs)
+
     # In case of a right merge, swap the input data-frames
     if how == "right":
         left_encrypted, right_encrypted = right_encrypted, left_encrypted
 
-    joined_rows = []
-
     # Retrieve the left and right column's position on which keys to merge
     left_key_column_position = left_encrypted.column_names_to_position[on]
     right_key_column_position = right_encrypted.column_names_to_position[on]
 
-    # Retrieve the number of useful rows and columns
-    n_rows_left = left_encrypted.encrypted_values.shape[0]
-    n_columns_right = right_encrypted.encrypted_values.shape[1]
-    n_rows_right = right_encrypted.encrypted_values.shape[0]
-
-    # Loop over the left data frame's number of rows (which will become the joined data frame's
-    # number of rows)
-    for i_left in range(n_rows_left):
-
-        # For left merge, all left values are exactly equal to the left data-frame
-        array_joined_i_left = left_encrypted.encrypted_values[i_left, :]
-
-        # In case of a right merge, remove the column containing the keys on which to merge. This
-        # avoid unnecessary FHE computations as the output keys will exactly match the one contained
-        # in the (initial) left data-frame. The reason why this is needed only for the right merge
-        # is because, in Pandas, this selected column is always kept on the output data-frame's
-        # left side. The column is manually inserted back at the end of this function
-        if how == "right":
-            array_joined_i_left = numpy.delete(
-                array_joined_i_left, left_key_column_position, axis=0
-            )
-
-        left_row_to_join = array_joined_i_left.tolist()
-
-        # Retrieve the left data frame's key to merge on
-        left_key = left_encrypted.encrypted_values[i_left, left_key_column_position]
-
-        right_row_to_join = []
-
-        # Loop over the right data-frame's number of columns
-        for j_right in range(n_columns_right):
-
-            # Skip the right's index column
-            if j_right == right_key_column_position:
-                continue
-
-            # Default value is NaN
-            right_value_to_join = right_encrypted.encrypted_nan
-
-            # Loop over the right data-frame's number of rows in order to check if one row's key
-            # matches the on-going left key
-            for i_right in range(n_rows_right):
-
-                # Retrieve the right data-frame's value to sum if both keys match
-                value_to_put_right = right_encrypted.encrypted_values[i_right, j_right]
-
-                # Retrieve the right data frame's key to merge on
-                right_key = right_encrypted.encrypted_values[i_right, right_key_column_position]
-
-                merge_inputs = (right_value_to_join, value_to_put_right, left_key, right_key)
-
-                # Run the FHE execution:
-                # - on the first iteration, this is applied on a 0 (representing a NaN) and the
-                #   right data-frame's value
-                # - on the following iterations, this is applied between the previous accumulated
-                # value and the right data-frame's value.
-                # Basically, if both keys match, the function adds the accumulated value with the
-                # right data-frame's value. If they don't, it just adds 0 to the accumulated value.
-                # In practice, keys only match once throughout this very loop as keys are assumed to
-                # be unique on both data-frames.
-                right_value_to_join = server.run(
-                    *merge_inputs, evaluation_keys=left_encrypted.evaluation_keys
-                )
-
-            right_row_to_join.append(right_value_to_join)
-
-        # In case of a right merge, since data-frames wee initially swapped, swap back the values
-        # when re-building the joined data-frame
-        if how == "right":
-            joined_row = right_row_to_join + left_row_to_join
-        else:
-            joined_row = left_row_to_join + right_row_to_join
+    left_values = left_encrypted.encrypted_values
+    right_values = right_encrypted.encrypted_values
+
+    # Retrieve the keys to merge on, for both data-frames
+    left_keys = left_values[:, left_key_column_position]
+    right_keys = right_values[:, right_key_column_position]
+
+    # Retrieve the right data-frame's columns to join, skipping the right's index column
+    right_columns_to_join = [
+        j_right for j_right in range(right_values.shape[1]) if j_right != right_key_column_position
+    ]
+
+    # List all the cells to compute, ordered by left rows first and then right columns
+    cells = [
+        (left_key, right_values[:, j_right])
+        for left_key in left_keys
+        for j_right in right_columns_to_join
+    ]
+
+    def _select_cell(cell: Tuple[Value, numpy.ndarray]) -> Value:
+        left_key, right_column = cell
+        return encrypted_select_right_value(
+            server,
+            left_encrypted.evaluation_keys,
+            right_encrypted.encrypted_nan,
+            left_key,
+            right_keys,
+            right_column,
+        )
 
-        joined_rows.append(joined_row)
+    if n_workers == 1:
+        selected_values = [_select_cell(cell) for cell in cells]
+    else:
+        with ThreadPoolExecutor(max_workers=n_workers) as pool:
+            selected_values = list(pool.map(_select_cell, cells))
+
+    # Build the right part of the joined data-frame
+    n_rows_left = left_values.shape[0]
+    array_right_to_join = numpy.empty((n_rows_left, len(right_columns_to_join)), dtype=object)
+    for cell_index, selected_value in enumerate(selected_values):
+        array_right_to_join.flat[cell_index] = selected_value
+
+    # For left merge, all left values are exactly equal to the left data-frame
+    array_left_to_join = left_values
+
+    # In case of a right merge, remove the column containing the keys on which to merge. This
+    # avoid unnecessary FHE computations as the output keys will exactly match the one contained
+    # in the (initial) left data-frame. The reason why this is needed only for the right merge
+    # is because, in Pandas, this selected column is always kept on the output data-frame's
+    # left side. The column is manually inserted back at the end of this function
+    if how == "right":
+        array_left_to_join = numpy.delete(left_values, left_key_column_position, axis=1)
 
-    array_joined = numpy.array(joined_rows)
+        # Since data-frames were initially swapped, swap back the values when re-building the
+        # joined data-frame
+        array_joined = numpy.hstack((array_right_to_join, array_left_to_join))
 
-    # In case of a right merge, as mentioned above, the column containing the right keys needs to be
-    # manually re-inserted. This avoids unnecessary FHE computations
-    if how == "right":
+        # As mentioned above, the column containing the right keys needs to be manually
+        # re-inserted. This avoids unnecessary FHE computations
         array_joined = numpy.hstack(
             (
                 array_joined[:, :right_key_column_position],
-                left_encrypted.encrypted_values[
-                    :, left_key_column_position : left_key_column_position + 1
-                ],
+                left_values[:, left_key_column_position : left_key_column_position + 1],
                 array_joined[:, right_key_column_position:],
             ),
         )
 
+    else:
+        array_joined = numpy.hstack((array_left_to_join, array_right_to_join))
+
     return array_joined
 
 
@@ -256,6 +296,7 @@ def encrypted_merge(
     copy: Optional[bool] = None,
     indicator: Union[bool, str] = False,
     validate: Optional[str] = None,
+    n_jobs: Optional[int] = -1,
 ) -> Tuple[numpy.ndarray, List[str], Dict]:
     """Merge two encrypted data-frames in FHE using Pandas parameters.
 
@@ -296,6 +337,9 @@ def encrypted_merge(
             Default to False.
         validate (Optional[str]): Currently not supported, please keep the default value. Default
             to None.
+        n_jobs (Optional[int]): The number of workers to use for running the FHE computations. If
+            None or 1, computations are run sequentially. If -1, all available CPU cores are used.
+            Default to -1.
 
     Raises:
         ValueError: If the merge is expected to be done on multiple columns.
@@ -370,7 +414,7 @@ def encrypted_merge(
     # Add a way to ensure that 'selected_column' only contains unique values in both data-frames
     # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4342
     joined_array = encrypted_left_right_join(
-        left_encrypted, right_encrypted, server, how, selected_column
+        left_encrypted, right_encrypted, server, how, selected_column, n_jobs=n_jobs
     )
 
     return joined_array, joined_column_names, joined_dtype_mappings
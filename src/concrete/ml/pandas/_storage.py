@@ -0,0 +1,460 @@
+"""Define the chunked and columnar on-disk format used for storing encrypted data-frames.
+
+Encrypted data-frames are stored in a ZIP64 archive made of the following files:
+    * 'metadata.json': the column names, dtype mappings, API version, number of rows and chunk
+        size, as well as the format's version
+    * 'evaluation_keys': the serialized evaluation keys, stored only once
+    * 'encrypted_nan': the serialized encrypted value representing NaN
+    * 'columns/<column_position>/<chunk_index>': the serialized encrypted values of a column for
+        a range of 'chunk_size' consecutive rows, made of length-prefixed ciphertexts
+
+Each chunk is a separate archive file, which means a single column or a range of rows can be
+loaded without reading the rest of the data-frame. Files that are not compressed are read through
+a memory map. Chunks can optionally be compressed, in which case they are read using the archive's
+decompression instead.
+"""
+
+import json
+import mmap
+import struct
+from pathlib import Path
+from typing import Dict, Generator, List, Optional, Sequence, Tuple, Union
+from zipfile import ZIP_DEFLATED, ZIP_STORED, ZipFile
+
+import numpy
+
+# Version of the chunked and columnar format
+STORAGE_FORMAT_VERSION = 2
+
+METADATA_FILE_NAME = "metadata.json"
+EVALUATION_KEYS_FILE_NAME = "evaluation_keys"
+ENCRYPTED_NAN_FILE_NAME = "encrypted_nan"
+
+# File name used by the initial format, which stored all values in a single JSON file
+LEGACY_FILE_NAME = "encrypted_dataframe.json"
+
+# Default number of rows stored in a single chunk
+DEFAULT_CHUNK_SIZE = 1024
+
+# Each ciphertext is prefixed with its length, stored as an unsigned 8-byte big-endian integer
+_LENGTH_PREFIX = struct.Struct(">Q")
+
+# Layout of a ZIP local file header, which precedes a file's data
+_ZIP_LOCAL_HEADER = struct.Struct("<4s5H3L2H")
+_ZIP_LOCAL_HEADER_SIGNATURE = b"PK\x03\x04"
+
+
+def get_chunk_file_name(column_position: int, chunk_index: int) -> str:
+    """Get the archive file name of a column's chunk.
+
+    Args:
+        column_position (int): The column's position in the data-frame.
+        chunk_index (int): The chunk's index.
+
+    Returns:
+        str: The chunk's file name.
+    """
+    return f"columns/{column_position}/{chunk_index}"
+
+
+def pack_values(serialized_values: Sequence[bytes]) -> bytes:
+    """Pack serialized values into a single buffer, each value being prefixed with its length.
+
+    Args:
+        serialized_values (Sequence[bytes]): The serialized values to pack.
+
+    Returns:
+        bytes: The packed values.
+    """
+    return b"".join(
+        _LENGTH_PREFIX.pack(len(serialized_value)) + serialized_value
+        for serialized_value in serialized_values
+    )
+
+
+def unpack_values(buffer: bytes) -> List[bytes]:
+    """Unpack a buffer made with 'pack_values'.
+
+    Args:
+        buffer (bytes): The packed values.
+
+    Returns:
+        List[bytes]: The serialized values.
+
+    Raises:
+        ValueError: If the buffer is truncated.
+    """
+    serialized_values = []
+    offset = 0
+
+    while offset < len(buffer):
+        if offset + _LENGTH_PREFIX.size > len(buffer):
+            raise ValueError(
+                f"Truncated chunk: expected a length prefix at offset {offset} but only "
+                f"{len(buffer) - offset} bytes remain."
+            )
+
+        (length,) = _LENGTH_PREFIX.unpack_from(buffer, offset)
+        offset += _LENGTH_PREFIX.size
+
+        if offset + length > len(buffer):
+            raise ValueError(
+                f"Truncated chunk: expected {length} bytes at offset {offset} but only "
+                f"{len(buffer) - offset} bytes remain."
+            )
+
+        serialized_values.append(bytes(buffer[offset : offset + length]))
+        offset += length
+
+    return serialized_values
+
+
+class EncryptedDataFrameWriter:
+    """Write serialized encrypted values on disk, chunk by chunk.
+
+    Rows are buffered until a full chunk is available, which is then written column by column.
+    This makes it possible to write data-frames that do not fit in memory.
+
+    Args:
+        path (Union[Path, str]): The path of the archive to write.
+        serialized_evaluation_keys (bytes): The serialized evaluation keys.
+        serialized_encrypted_nan (bytes): The serialized encrypted value representing NaN.
+        column_names (Sequence[str]): The data-frame's column names.
+        dtype_mappings (Dict): The mappings needed for recovering the columns' initial values.
+        api_version (int): The encrypted data-frame's API version.
+        chunk_size (int): The number of rows stored in a single chunk. Default to
+            DEFAULT_CHUNK_SIZE.
+        compress (bool): Whether the chunks should be compressed. Compressed chunks cannot be read
+            through a memory map. Default to False.
+    """
+
+    # pylint: disable-next=too-many-arguments
+    def __init__(
+        self,
+        path: Union[Path, str],
+        serialized_evaluation_keys: bytes,
+        serialized_encrypted_nan: bytes,
+        column_names: Sequence[str],
+        dtype_mappings: Dict,
+        api_version: int,
+        chunk_size: int = DEFAULT_CHUNK_SIZE,
+        compress: bool = False,
+    ):
+        if chunk_size < 1:
+            raise ValueError(
+                f"Parameter 'chunk_size' must be a strictly positive integer. Got {chunk_size}."
+            )
+
+        self.column_names = list(column_names)
+        self.dtype_mappings = dtype_mappings
+        self.api_version = api_version
+        self.chunk_size = chunk_size
+        self.compress = compress
+
+        self.n_rows = 0
+        self.n_chunks = 0
+        self._pending_rows: List[List[bytes]] = []
+
+        self._zip_file: Optional[ZipFile] = ZipFile(
+            path, "w", compression=ZIP_STORED, allowZip64=True
+        )
+
+        # Keys and NaN values are never compressed as they are read only once
+        self._zip_file.writestr(EVALUATION_KEYS_FILE_NAME, serialized_evaluation_keys)
+        self._zip_file.writestr(ENCRYPTED_NAN_FILE_NAME, serialized_encrypted_nan)
+
+    def __enter__(self) -> "EncryptedDataFrameWriter":
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def write_rows(self, serialized_values: Union[numpy.ndarray, Sequence[Sequence[bytes]]]):
+        """Append rows of serialized encrypted values.
+
+        Args:
+            serialized_values (Union[numpy.ndarray, Sequence[Sequence[bytes]]]): The rows to
+                append, each one containing a serialized value per column.
+
+        Raises:
+            ValueError: If the writer is closed or if a row does not have the expected number of
+                values.
+        """
+        if self._zip_file is None:
+            raise ValueError("Cannot write rows in a closed writer.")
+
+        for row in serialized_values:
+            row = list(row)
+
+            if len(row) != len(self.column_names):
+                raise ValueError(
+                    f"Expected rows made of {len(self.column_names)} values. Got {len(row)}."
+                )
+
+            self._pending_rows.append(row)
+
+            if len(self._pending_rows) == self.chunk_size:
+                self._flush()
+
+    def _flush(self):
+        """Write the buffered rows as a new chunk for each column."""
+        if not self._pending_rows:
+            return
+
+        assert self._zip_file is not None
+        compression = ZIP_DEFLATED if self.compress else ZIP_STORED
+
+        for column_position in range(len(self.column_names)):
+            self._zip_file.writestr(
+                get_chunk_file_name(column_position, self.n_chunks),
+                pack_values([row[column_position] for row in self._pending_rows]),
+                compress_type=compression,
+            )
+
+        self.n_rows += len(self._pending_rows)
+        self.n_chunks += 1
+        self._pending_rows = []
+
+    def close(self):
+        """Write the remaining rows and the metadata, and close the archive."""
+        if self._zip_file is None:
+            return
+
+        self._flush()
+
+        metadata = {
+            "format_version": STORAGE_FORMAT_VERSION,
+            "column_names": self.column_names,
+            "dtype_mappings": self.dtype_mappings,
+            "api_version": self.api_version,
+            "n_rows": self.n_rows,
+            "chunk_size": self.chunk_size,
+        }
+
+        self._zip_file.writestr(METADATA_FILE_NAME, json.dumps(metadata).encode(encoding="utf-8"))
+        self._zip_file.close()
+        self._zip_file = None
+
+
+class EncryptedDataFrameReader:
+    """Read serialized encrypted values from disk, lazily.
+
+    Only the chunks covering the requested columns and rows are read. Uncompressed files are read
+    through a memory map, which avoids loading the whole archive in memory.
+
+    Args:
+        path (Union[Path, str]): The path of the archive to read.
+
+    Raises:
+        ValueError: If the archive does not follow the chunked and columnar format.
+    """
+
+    def __init__(self, path: Union[Path, str]):
+        self._file = open(path, "rb")  # pylint: disable=consider-using-with
+        self._zip_file = ZipFile(self._file, "r")
+
+        if METADATA_FILE_NAME not in self._zip_file.namelist():
+            self.close()
+            raise ValueError(
+                f"File '{path}' does not follow the chunked encrypted data-frame format."
+            )
+
+        self._mmap: Optional[mmap.mmap] = None
+        if Path(path).stat().st_size > 0:
+            self._mmap = mmap.mmap(self._file.fileno(), 0, access=mmap.ACCESS_READ)
+
+        metadata = json.loads(self._zip_file.read(METADATA_FILE_NAME))
+
+        self.format_version: int = metadata["format_version"]
+        self.column_names: List[str] = metadata["column_names"]
+        self.dtype_mappings: Dict = metadata["dtype_mappings"]
+        self.api_version: int = metadata["api_version"]
+        self.n_rows: int = metadata["n_rows"]
+        self.chunk_size: int = metadata["chunk_size"]
+
+    def __enter__(self) -> "EncryptedDataFrameReader":
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    @property
+    def n_chunks(self) -> int:
+        """Get the number of chunks stored per column.
+
+        Returns:
+            int: The number of chunks.
+        """
+        return -(-self.n_rows // self.chunk_size)
+
+    def close(self):
+        """Close the memory map and the archive."""
+        if getattr(self, "_mmap", None) is not None:
+            self._mmap.close()
+            self._mmap = None
+
+        self._zip_file.close()
+        self._file.close()
+
+    def _read_file(self, file_name: str) -> bytes:
+        """Read a file from the archive, through the memory map if it is not compressed.
+
+        Args:
+            file_name (str): The file's name in the archive.
+
+        Returns:
+            bytes: The file's content.
+        """
+        info = self._zip_file.getinfo(file_name)
+
+        if info.compress_type != ZIP_STORED or self._mmap is None:
+            return self._zip_file.read(file_name)
+
+        # The file's data starts right after its local header, whose size depends on the lengths
+        # of the file name and extra field stored in it
+        header = _ZIP_LOCAL_HEADER.unpack_from(self._mmap, info.header_offset)
+        assert header[0] == _ZIP_LOCAL_HEADER_SIGNATURE, f"Corrupted archive file '{file_name}'."
+
+        name_length, extra_length = header[-2], header[-1]
+        data_offset = info.header_offset + _ZIP_LOCAL_HEADER.size + name_length + extra_length
+
+        return self._mmap[data_offset : data_offset + info.file_size]
+
+    def read_evaluation_keys(self) -> bytes:
+        """Read the serialized evaluation keys.
+
+        Returns:
+            bytes: The serialized evaluation keys.
+        """
+        return self._read_file(EVALUATION_KEYS_FILE_NAME)
+
+    def read_encrypted_nan(self) -> bytes:
+        """Read the serialized encrypted value representing NaN.
+
+        Returns:
+            bytes: The serialized encrypted NaN value.
+        """
+        return self._read_file(ENCRYPTED_NAN_FILE_NAME)
+
+    def get_column_positions(self, columns: Optional[Sequence[str]] = None) -> List[int]:
+        """Get the positions of the given columns.
+
+        Args:
+            columns (Optional[Sequence[str]]): The column names to consider. If None, all columns
+                are considered. Default to None.
+
+        Returns:
+            List[int]: The columns' positions.
+
+        Raises:
+            ValueError: If a column cannot be found.
+        """
+        if columns is None:
+            return list(range(len(self.column_names)))
+
+        column_positions = []
+        for column_name in columns:
+            if column_name not in self.column_names:
+                raise ValueError(
+                    f"Column '{column_name}' cannot be found in the encrypted data-frame. Expected "
+                    f"one of {self.column_names}."
+                )
+            column_positions.append(self.column_names.index(column_name))
+
+        return column_positions
+
+    def get_row_range(self, rows: Optional[slice] = None) -> Tuple[int, int]:
+        """Get the first and last (excluded) row indexes to read.
+
+        Args:
+            rows (Optional[slice]): The range of rows to consider. If None, all rows are
+                considered. Default to None.
+
+        Returns:
+            Tuple[int, int]: The first and last (excluded) row indexes.
+
+        Raises:
+            ValueError: If the slice has a step different than 1.
+        """
+        if rows is None:
+            return 0, self.n_rows
+
+        start, stop, step = rows.indices(self.n_rows)
+
+        if step != 1:
+            raise ValueError(f"Only contiguous ranges of rows can be loaded. Got step {step}.")
+
+        return start, max(start, stop)
+
+    def read_chunk(self, chunk_index: int, column_positions: Sequence[int]) -> numpy.ndarray:
+        """Read a chunk for the given columns.
+
+        Args:
+            chunk_index (int): The chunk's index.
+            column_positions (Sequence[int]): The positions of the columns to read.
+
+        Returns:
+            numpy.ndarray: The serialized values, of shape (n_chunk_rows, n_columns).
+        """
+        n_chunk_rows = min(self.chunk_size, self.n_rows - chunk_index * self.chunk_size)
+        serialized_values = numpy.empty((n_chunk_rows, len(column_positions)), dtype=object)
+
+        for j, column_position in enumerate(column_positions):
+            column_values = unpack_values(
+                self._read_file(get_chunk_file_name(column_position, chunk_index))
+            )
+
+            assert len(column_values) == n_chunk_rows, (
+                f"Chunk {chunk_index} of column {column_position} contains {len(column_values)} "
+                f"values but {n_chunk_rows} were expected."
+            )
+
+            serialized_values[:, j] = column_values
+
+        return serialized_values
+
+    def read_values(
+        self, columns: Optional[Sequence[str]] = None, rows: Optional[slice] = None
+    ) -> numpy.ndarray:
+        """Read the serialized values for the given columns and range of rows.
+
+        Args:
+            columns (Optional[Sequence[str]]): The column names to read. If None, all columns are
+                read. Default to None.
+            rows (Optional[slice]): The contiguous range of rows to read. If None, all rows are
+                read. Default to None.
+
+        Returns:
+            numpy.ndarray: The serialized values, of shape (n_rows, n_columns).
+        """
+        column_positions = self.get_column_positions(columns)
+        start, stop = self.get_row_range(rows)
+
+        chunks = [
+            self.read_chunk(chunk_index, column_positions)
+            for chunk_index in range(start // self.chunk_size, -(-stop // self.chunk_size))
+        ]
+
+        if not chunks:
+            return numpy.empty((0, len(column_positions)), dtype=object)
+
+        # Only keep the requested rows from the first and last chunks
+        offset = (start // self.chunk_size) * self.chunk_size
+        return numpy.concatenate(chunks, axis=0)[start - offset : stop - offset]
+
+    def iter_chunks(
+        self, columns: Optional[Sequence[str]] = None
+    ) -> Generator[numpy.ndarray, None, None]:
+        """Iterate over the chunks for the given columns.
+
+        Args:
+            columns (Optional[Sequence[str]]): The column names to read. If None, all columns are
+                read. Default to None.
+
+        Yields:
+            numpy.ndarray: The serialized values of each chunk, of shape (n_chunk_rows, n_columns).
+        """
+        column_positions = self.get_column_positions(columns)
+
+        for chunk_index in range(self.n_chunks):
+            yield self.read_chunk(chunk_index, column_positions)
@@ -1,12 +1,108 @@
 """Define utility functions for encrypted data-frames."""
 
 import functools
-from typing import List, Optional, Tuple, Union
+import os
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Callable, List, Optional, Tuple, Union
 
 import numpy
 
 from concrete import fhe
 
+# Default number of values encrypted or decrypted at once by a single worker
+DEFAULT_ELEMENTWISE_CHUNK_SIZE = 1024
+
+
+def get_n_workers(n_jobs: Optional[int]) -> int:
+    """Get the number of workers to use for running computations in parallel.
+
+    Args:
+        n_jobs (Optional[int]): The number of workers to use. If None or 1, computations are run
+            sequentially. If -1, all available CPU cores are used.
+
+    Returns:
+        int: The number of workers.
+
+    Raises:
+        ValueError: If 'n_jobs' is not None, -1 or a strictly positive integer.
+    """
+    if n_jobs is not None and n_jobs != -1 and n_jobs < 1:
+        raise ValueError(
+            f"Parameter 'n_jobs' must be None, -1 or a strictly positive integer. Got {n_jobs}."
+        )
+
+    if n_jobs is None:
+        return 1
+
+    if n_jobs == -1:
+        return os.cpu_count() or 1
+
+    return n_jobs
+
+
+def apply_elementwise(
+    func: Callable,
+    array: numpy.ndarray,
+    n_jobs: Optional[int] = -1,
+    chunk_size: int = DEFAULT_ELEMENTWISE_CHUNK_SIZE,
+    progress_callback: Optional[Callable[[int, int], None]] = None,
+    dtype: Any = object,
+) -> numpy.ndarray:
+    """Apply a function on each element of an array, by chunks and on several workers.
+
+    Only threads are used as Concrete clients cannot be pickled and sent to other processes.
+
+    Args:
+        func (Callable): The function to apply on each element.
+        array (numpy.ndarray): The array to consider.
+        n_jobs (Optional[int]): The number of workers to use. If None or 1, chunks are processed
+            sequentially. If -1, all available CPU cores are used. Default to -1.
+        chunk_size (int): The number of elements processed at once by a single worker. Default to
+            DEFAULT_ELEMENTWISE_CHUNK_SIZE.
+        progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+            chunk is processed, with the number of elements processed so far and the total number
+            of elements. Default to None.
+        dtype (Any): The dtype of the output array. Default to object.
+
+    Returns:
+        numpy.ndarray: An array with the same shape as the input array, containing the function's
+            outputs.
+
+    Raises:
+        ValueError: If 'chunk_size' is not a strictly positive integer.
+    """
+    if chunk_size < 1:
+        raise ValueError(
+            f"Parameter 'chunk_size' must be a strictly positive integer. Got {chunk_size}."
+        )
+
+    n_workers = get_n_workers(n_jobs)
+
+    flat_array = numpy.asarray(array).reshape(-1)
+    n_values = flat_array.size
+
+    vectorized_func = numpy.vectorize(func, otypes=[dtype])
+    chunks = [flat_array[start : start + chunk_size] for start in range(0, n_values, chunk_size)]
+
+    flat_outputs = numpy.empty((n_values,), dtype=dtype)
+
+    def _process_chunks(chunk_outputs):
+        n_processed_values = 0
+        for chunk_output in chunk_outputs:
+            flat_outputs[n_processed_values : n_processed_values + chunk_output.size] = chunk_output
+            n_processed_values += chunk_output.size
+
+            if progress_callback is not None:
+                progress_callback(n_processed_values, n_values)
+
+    if n_workers == 1:
+        _process_chunks(vectorized_func(chunk) for chunk in chunks)
+    else:
+        with ThreadPoolExecutor(max_workers=n_workers) as pool:
+            _process_chunks(pool.map(vectorized_func, chunks))
+
+    return flat_outputs.reshape(numpy.shape(array))
+
 
 def encrypt_value(
     value: Optional[Union[int, numpy.ndarray, List]], client: fhe.Client, n: int, pos: int
@@ -53,8 +149,14 @@ def decrypt_value(
     return client.decrypt(value)
 
 
+# pylint: disable-next=too-many-arguments
 def encrypt_elementwise(
-    array: numpy.ndarray, client: fhe.Client, n: int, pos: int
+    array: numpy.ndarray,
+    client: fhe.Client,
+    n: int,
+    pos: int,
+    n_jobs: Optional[int] = -1,
+    progress_callback: Optional[Callable[[int, int], None]] = None,
 ) -> numpy.ndarray:
     """Encrypt an array element-wise.
 
@@ -63,26 +165,45 @@ def encrypt_elementwise(
         client (fhe.Client): The client to use for encryption.
         n (int): The total number of inputs the client's circuit considers.
         pos (int): The input's position to consider when encrypting it.
+        n_jobs (Optional[int]): The number of workers to use. If None or 1, values are encrypted
+            sequentially. If -1, all available CPU cores are used. Default to -1.
+        progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+            chunk of values is encrypted, with the number of values encrypted so far and the total
+            number of values. Default to None.
 
     Returns:
         numpy.ndarray: An array containing encrypted values only.
     """
     encrypt_func = functools.partial(encrypt_value, client=client, n=n, pos=pos)
-    return numpy.vectorize(encrypt_func)(array)
+    return apply_elementwise(
+        encrypt_func, array, n_jobs=n_jobs, progress_callback=progress_callback
+    )
 
 
-def decrypt_elementwise(array: numpy.ndarray, client: fhe.Client) -> numpy.ndarray:
+def decrypt_elementwise(
+    array: numpy.ndarray,
+    client: fhe.Client,
+    n_jobs: Optional[int] = -1,
+    progress_callback: Optional[Callable[[int, int], None]] = None,
+) -> numpy.ndarray:
     """Decrypt an array element-wise.
 
     Args:
         array (numpy.ndarray): The array whose values to decrypt.
         client (fhe.Client): The client to use for decryption.
+        n_jobs (Optional[int]): The number of workers to use. If None or 1, values are decrypted
+            sequentially. If -1, all available CPU cores are used. Default to -1.
+        progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+            chunk of values is decrypted, with the number of values decrypted so far and the total
+            number of values. Default to None.
 
     Returns:
         numpy.ndarray: An array containing decrypted values only.
     """
     decrypt_func = functools.partial(decrypt_value, client=client)
-    return numpy.vectorize(decrypt_func)(array)
+    return apply_elementwise(
+        decrypt_func, array, n_jobs=n_jobs, progress_callback=progress_callback, dtype=numpy.int64
+    )
 
 
 def serialize_value(encrypted_value: fhe.Value) -> str:
@@ -134,6 +255,30 @@ def deserialize_elementwise(array: numpy.ndarray) -> numpy.ndarray:
     return numpy.vectorize(deserialize_value)(array)
 
 
+def serialize_elementwise_to_bytes(array: numpy.ndarray) -> numpy.ndarray:
+    """Serialize an array made of encrypted values element-wise, into bytes.
+
+    Args:
+        array (numpy.ndarray): The array to serialize.
+
+    Returns:
+        numpy.ndarray: An array containing serialized encrypted values only, as bytes.
+    """
+    return numpy.vectorize(lambda value: value.serialize(), otypes=[object])(array)
+
+
+def deserialize_elementwise_from_bytes(array: numpy.ndarray) -> numpy.ndarray:
+    """Deserialize an array made of encrypted values serialized into bytes, element-wise.
+
+    Args:
+        array (numpy.ndarray): The array to deserialize.
+
+    Returns:
+        numpy.ndarray: An array containing deserialized encrypted values only.
+    """
+    return numpy.vectorize(fhe.Value.deserialize, otypes=[object])(array)
+
+
 def serialize_evaluation_keys(evaluation_keys: fhe.EvaluationKeys) -> bytes:
     """Serialize the evaluation keys into bytes.
 
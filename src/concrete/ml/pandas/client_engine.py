@@ -1,8 +1,9 @@
 """Define the framework used for managing keys (encrypt, decrypt) for encrypted data-frames."""
 
 from pathlib import Path
-from typing import Dict, Optional, Union
+from typing import Callable, Dict, Generator, Iterable, Optional, Tuple, Union
 
+import numpy
 import pandas
 
 from concrete import fhe
@@ -12,7 +13,13 @@ from concrete.ml.pandas._processing import (
     post_process_to_pandas,
     pre_process_from_pandas,
 )
-from concrete.ml.pandas._utils import decrypt_elementwise, encrypt_elementwise, encrypt_value
+from concrete.ml.pandas._storage import DEFAULT_CHUNK_SIZE
+from concrete.ml.pandas._utils import (
+    decrypt_elementwise,
+    encrypt_elementwise,
+    encrypt_value,
+    serialize_elementwise_to_bytes,
+)
 from concrete.ml.pandas.dataframe import EncryptedDataFrame
 
 CURRENT_API_VERSION = 1
@@ -41,19 +48,36 @@ class ClientEngine:
         else:
             self.client.keygen(True)
 
-    def encrypt_from_pandas(
-        self, pandas_dataframe: pandas.DataFrame, schema: Optional[Dict] = None
-    ) -> EncryptedDataFrame:
-        """Encrypt a Pandas data-frame using the loaded client.
+    def _encrypt_nan(self) -> fhe.Value:
+        """Encrypt the value representing NaN.
+
+        Returns:
+            fhe.Value: The encrypted NaN value.
+        """
+        # Encrypt a 0 in order to represent NaN values
+        # Remove this once NaN values are not represented by 0 anymore
+        # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4342
+        return encrypt_value(0, self.client, **get_encrypt_config())
+
+    def _encrypt_values(
+        self,
+        pandas_dataframe: pandas.DataFrame,
+        schema: Optional[Dict],
+        n_jobs: Optional[int],
+        progress_callback: Optional[Callable[[int, int], None]],
+    ) -> Tuple[numpy.ndarray, Dict]:
+        """Pre-process and encrypt the values of a Pandas data-frame.
 
         Args:
             pandas_dataframe (DataFrame): The Pandas data-frame to encrypt.
-            schema (Optional[Dict]): The input schema to consider. Default to None.
+            schema (Optional[Dict]): The input schema to consider.
+            n_jobs (Optional[int]): The number of workers to use for encrypting the values.
+            progress_callback (Optional[Callable[[int, int], None]]): The function called each
+                time a chunk of values is encrypted.
 
         Returns:
-            EncryptedDataFrame: The encrypted data-frame.
+            Tuple[numpy.ndarray, Dict]: The encrypted values and the dtype mappings.
         """
-
         check_schema_format(pandas_dataframe, schema)
 
         pandas_array, dtype_mappings = pre_process_from_pandas(pandas_dataframe, schema=schema)
@@ -61,36 +85,235 @@ class ClientEngine:
         # Inputs need to be encrypted element-wise in order to be able to use a composable circuit
         # Once multi-operator is supported, better handle encryption configuration parameters
         # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4342
-        encrypted_values = encrypt_elementwise(pandas_array, self.client, **get_encrypt_config())
+        encrypted_values = encrypt_elementwise(
+            pandas_array,
+            self.client,
+            **get_encrypt_config(),
+            n_jobs=n_jobs,
+            progress_callback=progress_callback,
+        )
 
-        # Encrypt a 0 in order to represent NaN values
-        # Remove this once NaN values are not represented by 0 anymore
-        # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4342
-        encrypted_nan = encrypt_value(0, self.client, **get_encrypt_config())
+        return encrypted_values, dtype_mappings
+
+    def encrypt_from_pandas(
+        self,
+        pandas_dataframe: pandas.DataFrame,
+        schema: Optional[Dict] = None,
+        n_jobs: Optional[int] = -1,
+        progress_callback: Optional[Callable[[int, int], None]] = None,
+    ) -> EncryptedDataFrame:
+        """Encrypt a Pandas data-frame using the loaded client.
+
+        Args:
+            pandas_dataframe (DataFrame): The Pandas data-frame to encrypt.
+            schema (Optional[Dict]): The input schema to consider. Default to None.
+            n_jobs (Optional[int]): The number of workers to use for encrypting the values. If None
+                or 1, values are encrypted sequentially. If -1, all available CPU cores are used.
+                Default to -1.
+            progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+                chunk of values is encrypted, with the number of values encrypted so far and the
+                total number of values. Default to None.
+
+        Returns:
+            EncryptedDataFrame: The encrypted data-frame.
+        """
+        encrypted_values, dtype_mappings = self._encrypt_values(
+            pandas_dataframe, schema, n_jobs, progress_callback
+        )
 
         return EncryptedDataFrame(
             encrypted_values,
-            encrypted_nan,
+            self._encrypt_nan(),
             self.client.evaluation_keys,
             pandas_dataframe.columns,
             dtype_mappings,
             CURRENT_API_VERSION,
         )
 
-    def decrypt_to_pandas(self, encrypted_dataframe: EncryptedDataFrame) -> pandas.DataFrame:
+    def encrypt_from_pandas_iter(
+        self,
+        pandas_dataframes: Iterable[pandas.DataFrame],
+        schema: Optional[Dict] = None,
+        n_jobs: Optional[int] = -1,
+        progress_callback: Optional[Callable[[int, int], None]] = None,
+    ) -> Generator[EncryptedDataFrame, None, None]:
+        """Encrypt Pandas data-frames one after the other, for example chunks of a large table.
+
+        This makes it possible to encrypt tables that do not fit in memory, for example using
+        `pandas.read_csv(..., chunksize=...)`. All chunks must lead to the same dtype mappings,
+        which usually requires providing a schema for float and string columns.
+
+        Args:
+            pandas_dataframes (Iterable[pandas.DataFrame]): The Pandas data-frames to encrypt.
+            schema (Optional[Dict]): The input schema to consider. Default to None.
+            n_jobs (Optional[int]): The number of workers to use for encrypting the values. If None
+                or 1, values are encrypted sequentially. If -1, all available CPU cores are used.
+                Default to -1.
+            progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+                chunk of values is encrypted, with the number of values encrypted so far and the
+                total number of values of the current data-frame. Default to None.
+
+        Yields:
+            EncryptedDataFrame: The encrypted data-frame for each input data-frame.
+
+        Raises:
+            ValueError: If the column names or dtype mappings differ between data-frames.
+        """
+        encrypted_nan = self._encrypt_nan()
+        first_column_names, first_dtype_mappings = None, None
+
+        for i, pandas_dataframe in enumerate(pandas_dataframes):
+            encrypted_values, dtype_mappings = self._encrypt_values(
+                pandas_dataframe, schema, n_jobs, progress_callback
+            )
+
+            column_names = list(pandas_dataframe.columns)
+
+            # Make sure all chunks can be decrypted and merged the same way
+            if first_dtype_mappings is None:
+                first_column_names, first_dtype_mappings = column_names, dtype_mappings
+
+            elif column_names != first_column_names:
+                raise ValueError(
+                    f"Column names of data-frame {i} do not match the ones of the first "
+                    f"data-frame. Got {column_names}, expected {first_column_names}."
+                )
+
+            elif dtype_mappings != first_dtype_mappings:
+                raise ValueError(
+                    f"Dtype mappings of data-frame {i} do not match the ones of the first "
+                    "data-frame. Please provide a schema for all float and string columns."
+                )
+
+            yield EncryptedDataFrame(
+                encrypted_values,
+                encrypted_nan,
+                self.client.evaluation_keys,
+                column_names,
+                dtype_mappings,
+                CURRENT_API_VERSION,
+            )
+
+    # pylint: disable-next=too-many-arguments
+    def encrypt_to_file(
+        self,
+        pandas_dataframes: Union[pandas.DataFrame, Iterable[pandas.DataFrame]],
+        path: Union[Path, str],
+        schema: Optional[Dict] = None,
+        chunk_size: int = DEFAULT_CHUNK_SIZE,
+        compress: bool = False,
+        n_jobs: Optional[int] = -1,
+        progress_callback: Optional[Callable[[int, int], None]] = None,
+    ):
+        """Encrypt Pandas data-frames and save them on disk as a single encrypted data-frame.
+
+        Data-frames are encrypted and written one after the other, so that only a single one is
+        held in memory at a time. The saved file can then be loaded using
+        `load_encrypted_dataframe`.
+
+        Args:
+            pandas_dataframes (Union[pandas.DataFrame, Iterable[pandas.DataFrame]]): The Pandas
+                data-frame or data-frames to encrypt, for example chunks of a large table.
+            path (Union[Path, str]): The path where to save the encrypted data-frame.
+            schema (Optional[Dict]): The input schema to consider. Default to None.
+            chunk_size (int): The number of rows stored in a single chunk on disk. Default to 1024.
+            compress (bool): Whether the encrypted values should be compressed. Default to False.
+            n_jobs (Optional[int]): The number of workers to use for encrypting the values. If None
+                or 1, values are encrypted sequentially. If -1, all available CPU cores are used.
+                Default to -1.
+            progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+                chunk of values is encrypted, with the number of values encrypted so far and the
+                total number of values of the current data-frame. Default to None.
+        """
+        if isinstance(pandas_dataframes, pandas.DataFrame):
+            pandas_dataframes = [pandas_dataframes]
+
+        writer = None
+
+        try:
+            for encrypted_dataframe in self.encrypt_from_pandas_iter(
+                pandas_dataframes, schema=schema, n_jobs=n_jobs, progress_callback=progress_callback
+            ):
+                # The writer is opened once the first data-frame's dtype mappings are known
+                if writer is None:
+                    writer = EncryptedDataFrame.open_writer(
+                        path,
+                        encrypted_dataframe.encrypted_nan,
+                        encrypted_dataframe.evaluation_keys,
+                        encrypted_dataframe.column_names,
+                        encrypted_dataframe.dtype_mappings,
+                        encrypted_dataframe.api_version,
+                        chunk_size=chunk_size,
+                        compress=compress,
+                    )
+
+                writer.write_rows(
+                    serialize_elementwise_to_bytes(encrypted_dataframe.encrypted_values)
+                )
+
+        finally:
+            if writer is not None:
+                writer.close()
+
+    def decrypt_to_pandas(
+        self,
+        encrypted_dataframe: EncryptedDataFrame,
+        n_jobs: Optional[int] = -1,
+        progress_callback: Optional[Callable[[int, int], None]] = None,
+    ) -> pandas.DataFrame:
         """Decrypt an encrypted data-frame using the loaded client and return a Pandas data-frame.
 
         Args:
             encrypted_dataframe (EncryptedDataFrame): The encrypted data-frame to decrypt.
+            n_jobs (Optional[int]): The number of workers to use for decrypting the values. If None
+                or 1, values are decrypted sequentially. If -1, all available CPU cores are used.
+                Default to -1.
+            progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+                chunk of values is decrypted, with the number of values decrypted so far and the
+                total number of values. Default to None.
 
         Returns:
             pandas.DataFrame: The Pandas data-frame built on the decrypted values.
         """
         # Inputs need to be decrypted element-wise in order to be able to use a composable circuit
-        clear_array = decrypt_elementwise(encrypted_dataframe.encrypted_values, self.client)
+        clear_array = decrypt_elementwise(
+            encrypted_dataframe.encrypted_values,
+            self.client,
+            n_jobs=n_jobs,
+            progress_callback=progress_callback,
+        )
 
         pandas_dataframe = post_process_to_pandas(
             clear_array, encrypted_dataframe.column_names, encrypted_dataframe.dtype_mappings
         )
 
         return pandas_dataframe
+
+    def decrypt_to_pandas_iter(
+        self,
+        encrypted_dataframes: Iterable[EncryptedDataFrame],
+        n_jobs: Optional[int] = -1,
+        progress_callback: Optional[Callable[[int, int], None]] = None,
+    ) -> Generator[pandas.DataFrame, None, None]:
+        """Decrypt encrypted data-frames one after the other.
+
+        This is typically used along `EncryptedDataFrame.iter_load` in order to decrypt a large
+        encrypted data-frame stored on disk chunk by chunk.
+
+        Args:
+            encrypted_dataframes (Iterable[EncryptedDataFrame]): The encrypted data-frames to
+                decrypt.
+            n_jobs (Optional[int]): The number of workers to use for decrypting the values. If None
+                or 1, values are decrypted sequentially. If -1, all available CPU cores are used.
+                Default to -1.
+            progress_callback (Optional[Callable[[int, int], None]]): A function called each time a
+                chunk of values is decrypted, with the number of values decrypted so far and the
+                total number of values of the current data-frame. Default to None.
+
+        Yields:
+            pandas.DataFrame: The Pandas data-frame built on each decrypted data-frame.
+        """
+        for encrypted_dataframe in encrypted_dataframes:
+            yield self.decrypt_to_pandas(
+                encrypted_dataframe, n_jobs=n_jobs, progress_callback=progress_callback
+            )
@@ -3,7 +3,7 @@
 import json
 from collections.abc import Hashable
 from pathlib import Path
-from typing import Dict, List, Optional, Sequence, Tuple, Union
+from typing import Dict, Generator, List, Optional, Sequence, Tuple, Union
 from zipfile import ZIP_STORED, ZipFile
 
 import numpy
@@ -13,12 +13,20 @@ from pandas.io.formats.format import get_dataframe_repr_params
 from concrete import fhe
 from concrete.ml.pandas._development import load_server
 from concrete.ml.pandas._operators import encrypted_merge
+from concrete.ml.pandas._storage import (
+    DEFAULT_CHUNK_SIZE,
+    LEGACY_FILE_NAME,
+    EncryptedDataFrameReader,
+    EncryptedDataFrameWriter,
+)
 from concrete.ml.pandas._utils import (
     deserialize_elementwise,
+    deserialize_elementwise_from_bytes,
     deserialize_evaluation_keys,
     deserialize_value,
     get_serialized_representation_elementwise,
     serialize_elementwise,
+    serialize_elementwise_to_bytes,
     serialize_evaluation_keys,
     serialize_value,
 )
@@ -184,6 +192,7 @@ class EncryptedDataFrame:
         copy: Optional[bool] = None,
         indicator: Union[bool, str] = False,
         validate: Optional[str] = None,
+        n_jobs: Optional[int] = -1,
     ):
         """Merge two encrypted data-frames in FHE using Pandas parameters.
 
@@ -223,6 +232,9 @@ class EncryptedDataFrame:
                 Default to False.
             validate (Optional[str]): Currently not supported, please keep the default value.
                 Default to None.
+            n_jobs (Optional[int]): The number of workers to use for running the FHE computations.
+                If None or 1, computations are run sequentially. If -1, all available CPU cores are
+                used. Default to -1.
 
         Returns:
             EncryptedDataFrame: The joined encrypted data-frame.
@@ -242,6 +254,7 @@ class EncryptedDataFrame:
             copy=copy,
             indicator=indicator,
             validate=validate,
+            n_jobs=n_jobs,
         )
 
         # Once multi-operator is supported, make sure to provide relevant keys and objects
@@ -314,42 +327,113 @@ class EncryptedDataFrame:
             api_version,
         )
 
-    def save(self, path: Union[Path, str]):
-        """Save the encrypted data-frame on disk.
+    @staticmethod
+    def _get_zip_path(path: Union[Path, str]) -> Path:
+        """Get the path to consider for saving or loading an encrypted data-frame.
 
         Args:
-            path (Union[Path, str]): The path where to save the encrypted data-frame.
+            path (Union[Path, str]): The path given by the user.
+
+        Returns:
+            Path: The path, with a '.zip' suffix.
         """
         path = Path(path)
 
         if path.suffix != ".zip":
             path = path.with_suffix(".zip")
 
-        encrypted_df_dict, evaluation_keys = self._to_dict_and_eval_keys()
+        return path
 
-        encrypted_df_json_bytes = json.dumps(encrypted_df_dict).encode(encoding="utf-8")
+    def save(
+        self,
+        path: Union[Path, str],
+        chunk_size: int = DEFAULT_CHUNK_SIZE,
+        compress: bool = False,
+    ):
+        """Save the encrypted data-frame on disk.
 
-        with ZipFile(path, "w", compression=ZIP_STORED, allowZip64=True) as zip_file:
-            zip_file.writestr("encrypted_dataframe.json", encrypted_df_json_bytes)
-            zip_file.writestr("evaluation_keys", evaluation_keys)
+        Values are stored column by column, in chunks of consecutive rows, which allows loading
+        only some columns or rows later on. The evaluation keys are stored once, separately.
 
+        Args:
+            path (Union[Path, str]): The path where to save the encrypted data-frame.
+            chunk_size (int): The number of rows stored in a single chunk. Default to 1024.
+            compress (bool): Whether the encrypted values should be compressed. Compressed values
+                cannot be loaded through a memory map. Default to False.
+        """
+        with self.open_writer(
+            path,
+            self._encrypted_nan,
+            self._evaluation_keys,
+            self._column_names,
+            self._dtype_mappings,
+            self._api_version,
+            chunk_size=chunk_size,
+            compress=compress,
+        ) as writer:
+
+            # Serialize and write values chunk by chunk in order to bound the memory used
+            for start in range(0, self._encrypted_values.shape[0], chunk_size):
+                writer.write_rows(
+                    serialize_elementwise_to_bytes(
+                        self._encrypted_values[start : start + chunk_size]
+                    )
+                )
+
+    # pylint: disable-next=too-many-arguments
     @classmethod
-    def load(cls, path: Union[Path, str]):
-        """Load an encrypted data-frame from disk.
+    def open_writer(
+        cls,
+        path: Union[Path, str],
+        encrypted_nan: fhe.Value,
+        evaluation_keys: fhe.EvaluationKeys,
+        column_names: Sequence[str],
+        dtype_mappings: Dict,
+        api_version: int,
+        chunk_size: int = DEFAULT_CHUNK_SIZE,
+        compress: bool = False,
+    ) -> EncryptedDataFrameWriter:
+        """Open a writer for saving an encrypted data-frame on disk, rows after rows.
+
+        Rows of encrypted values can then be appended using the writer's `write_rows` method, once
+        serialized into bytes. This avoids having the full encrypted data-frame in memory.
 
         Args:
-            path (Union[Path, str]): The path where to load the encrypted data-frame.
+            path (Union[Path, str]): The path where to save the encrypted data-frame.
+            encrypted_nan (fhe.Value): The encrypted value representing NaN.
+            evaluation_keys (fhe.EvaluationKeys): The evaluation keys.
+            column_names (Sequence[str]): The data-frame's column names.
+            dtype_mappings (Dict): The mappings needed for recovering the initial values.
+            api_version (int): The encrypted data-frame's API version.
+            chunk_size (int): The number of rows stored in a single chunk. Default to 1024.
+            compress (bool): Whether the encrypted values should be compressed. Default to False.
 
         Returns:
-            EncryptedDataFrame: The loaded encrypted data-frame.
+            EncryptedDataFrameWriter: The writer, to be closed once all rows are written.
         """
-        path = Path(path)
+        return EncryptedDataFrameWriter(
+            cls._get_zip_path(path),
+            serialize_evaluation_keys(evaluation_keys),
+            encrypted_nan.serialize(),
+            column_names,
+            dtype_mappings,
+            api_version,
+            chunk_size=chunk_size,
+            compress=compress,
+        )
 
-        if path.suffix != ".zip":
-            path = path.with_suffix(".zip")
+    @classmethod
+    def _load_legacy(cls, path: Path):
+        """Load an encrypted data-frame saved using the initial single JSON file format.
+
+        Args:
+            path (Path): The path where to load the encrypted data-frame.
 
+        Returns:
+            EncryptedDataFrame: The loaded encrypted data-frame.
+        """
         with ZipFile(path, "r", compression=ZIP_STORED, allowZip64=True) as zip_file:
-            with zip_file.open("encrypted_dataframe.json") as encrypted_df_json_file:
+            with zip_file.open(LEGACY_FILE_NAME) as encrypted_df_json_file:
                 encrypted_df_json_bytes = encrypted_df_json_file.read()
                 encrypted_df_dict = json.loads(encrypted_df_json_bytes)
 
@@ -357,3 +441,127 @@ class EncryptedDataFrame:
                 evaluation_keys = evaluation_keys_file.read()
 
         return cls._from_dict_and_eval_keys(encrypted_df_dict, evaluation_keys)
+
+    @classmethod
+    def _from_reader(
+        cls,
+        reader: EncryptedDataFrameReader,
+        serialized_values: numpy.ndarray,
+        evaluation_keys: fhe.EvaluationKeys,
+        encrypted_nan: fhe.Value,
+        columns: Optional[Sequence[str]],
+    ):
+        """Build an encrypted data-frame from values read on disk.
+
+        Args:
+            reader (EncryptedDataFrameReader): The reader used for loading the values.
+            serialized_values (numpy.ndarray): The serialized encrypted values.
+            evaluation_keys (fhe.EvaluationKeys): The deserialized evaluation keys.
+            encrypted_nan (fhe.Value): The deserialized encrypted NaN value.
+            columns (Optional[Sequence[str]]): The loaded column names. If None, all columns were
+                loaded.
+
+        Returns:
+            EncryptedDataFrame: The encrypted data-frame.
+        """
+        column_names = reader.column_names if columns is None else list(columns)
+        dtype_mappings = {
+            column_name: reader.dtype_mappings[column_name] for column_name in column_names
+        }
+
+        return cls(
+            deserialize_elementwise_from_bytes(serialized_values),
+            encrypted_nan,
+            evaluation_keys,
+            column_names,
+            dtype_mappings,
+            reader.api_version,
+        )
+
+    @classmethod
+    def load(
+        cls,
+        path: Union[Path, str],
+        columns: Optional[Sequence[str]] = None,
+        rows: Optional[slice] = None,
+    ):
+        """Load an encrypted data-frame from disk.
+
+        Only the chunks covering the given columns and rows are read from disk.
+
+        Args:
+            path (Union[Path, str]): The path where to load the encrypted data-frame.
+            columns (Optional[Sequence[str]]): The names of the columns to load. If None, all
+                columns are loaded. Default to None.
+            rows (Optional[slice]): The contiguous range of rows to load, for example
+                `slice(100, 200)`. If None, all rows are loaded. Default to None.
+
+        Returns:
+            EncryptedDataFrame: The loaded encrypted data-frame.
+        """
+        path = cls._get_zip_path(path)
+
+        with ZipFile(path, "r") as zip_file:
+            is_legacy_format = LEGACY_FILE_NAME in zip_file.namelist()
+
+        # Support files saved before the chunked and columnar format was introduced
+        if is_legacy_format:
+            encrypted_df = cls._load_legacy(path)
+
+            if columns is None and rows is None:
+                return encrypted_df
+
+            # Legacy files cannot be loaded lazily, so values are selected once fully loaded
+            column_names = encrypted_df.column_names if columns is None else list(columns)
+            column_positions = [
+                encrypted_df.column_names_to_position[column_name] for column_name in column_names
+            ]
+            encrypted_values = encrypted_df.encrypted_values
+            if rows is not None:
+                encrypted_values = encrypted_values[rows]
+
+            return cls(
+                encrypted_values[:, column_positions],
+                encrypted_df.encrypted_nan,
+                encrypted_df.evaluation_keys,
+                column_names,
+                {name: encrypted_df.dtype_mappings[name] for name in column_names},
+                encrypted_df.api_version,
+            )
+
+        with EncryptedDataFrameReader(path) as reader:
+            return cls._from_reader(
+                reader,
+                reader.read_values(columns=columns, rows=rows),
+                deserialize_evaluation_keys(reader.read_evaluation_keys()),
+                fhe.Value.deserialize(reader.read_encrypted_nan()),
+                columns,
+            )
+
+    @classmethod
+    def iter_load(
+        cls,
+        path: Union[Path, str],
+        columns: Optional[Sequence[str]] = None,
+    ) -> Generator["EncryptedDataFrame", None, None]:
+        """Load an encrypted data-frame from disk, chunk by chunk.
+
+        Each yielded encrypted data-frame contains the rows of a single chunk, which bounds the
+        memory used. Evaluation keys are only deserialized once and shared between chunks.
+
+        Args:
+            path (Union[Path, str]): The path where to load the encrypted data-frame.
+            columns (Optional[Sequence[str]]): The names of the columns to load. If None, all
+                columns are loaded. Default to None.
+
+        Yields:
+            EncryptedDataFrame: The encrypted data-frame for each chunk of rows.
+        """
+        with EncryptedDataFrameReader(cls._get_zip_path(path)) as reader:
+            evaluation_keys = deserialize_evaluation_keys(reader.read_evaluation_keys())
+            encrypted_nan = fhe.Value.deserialize(reader.read_encrypted_nan())
+
+            for serialized_values in reader.iter_chunks(columns=columns):
+                yield cls._from_reader(
+                    reader, serialized_values, evaluation_keys, encrypted_nan, columns
+                )
@@ -15,8 +15,8 @@ from torch import nn
 
 from concrete.ml.sklearn.linear_model import SGDClassifier
 
-from ..common.serialization.dumpers import dump, dumps
-from ..common.serialization.loaders import load, loads
+from ..common.serialization.dumpers import dump, dumps, dumps_binary
+from ..common.serialization.loaders import load, loads, loads_binary
 from ..common.utils import (
     get_model_class,
     get_model_name,
@@ -589,8 +589,8 @@ def check_serialization(
     """Check that the given object can properly be serialized.
 
     This function serializes all objects using the `dump`, `dumps`, `load` and `loads` functions
-    from Concrete ML. If the given object provides a `dump` and `dumps` method, they are also
-    serialized using these.
+    from Concrete ML, as well as their binary format counterparts. If the given object provides a
+    `dump` and `dumps` method, they are also serialized using these.
 
     Args:
         object_to_serialize (Any): The object to serialize.
@@ -688,6 +688,18 @@ def check_serialization(
                 f"{equal_method}."
             )
 
+    # Dump and load the object using the binary format
+    loaded = loads_binary(dumps_binary(object_to_serialize))
+
+    assert isinstance(loaded, expected_type) if expected_type is not None else loaded is None, (
+        f"Loaded object (from binary) is not of the expected type. Expected {expected_type}, "
+        f"got {type(loaded)}."
+    )
+    assert equal_method(object_to_serialize, loaded), (
+        "Loaded object (from binary) is not equal to the initial one, using equal method "
+        f"{equal_method}."
+    )
+
 
 def get_random_samples(x: numpy.ndarray, n_sample: int) -> numpy.ndarray:
     """Select `n_sample` random elements from a 2D NumPy array.
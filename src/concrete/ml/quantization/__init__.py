@@ -8,6 +8,8 @@ from .post_training import (
     _inspect_tree_n_bits,
     get_n_bits_dict,
 )
+from .pipeline import QuantizedPipeline
+from .profiling import PBSCostTable, measure_fhe_latency, profile_quantized_module
 from .quantized_module import QuantizedModule
 from .quantized_ops import (
     QuantizedAbs,
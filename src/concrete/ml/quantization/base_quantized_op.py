@@ -786,6 +786,9 @@ class QuantizedOp:
             "did you forget to call calibrate with sample data?",
         )
 
+        # When executing in the clear, the quantized values are only computed if they are read,
+        # e.g., by an operator that does not fuse this output in its TLU or as a graph output.
+        # This avoids re-quantizing the values after each operator of element-wise chains
         return QuantizedArray(
             self.n_bits,
             qoutput_activation,
@@ -793,6 +796,7 @@ class QuantizedOp:
             options=self._get_output_quant_opts(),
             stats=self.output_quant_stats,
             params=self.output_quant_params,
+            lazy=True,
         )
 
     def call_impl(
@@ -1,12 +1,18 @@
 """GLWE backend for some supported layers."""
 
 import json
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, List, Optional, Tuple
 
 import numpy
 
+from ..common.instrumentation import measure_stage
 from ..common.utils import HybridFHEMode, to_tuple
 from .quantized_module import QuantizedModule
 
+# Default maximum number of activation rows (for example tokens) encrypted together
+DEFAULT_GLWE_MAX_ROWS_PER_BATCH = 256
+
 
 def has_glwe_backend():
     """Check if the GLWE backend is installed.
@@ -22,14 +28,31 @@ def has_glwe_backend():
 
 
 class GLWELinearLayerExecutor:
-    """GLWE execution helper for pure linear layers."""
+    """GLWE execution helper for pure linear layers.
+
+    All the rows of the activations given to `forward` (for example all the tokens of all the
+    sequences in a batch) are flattened and split into batches of at most `max_rows_per_batch`
+    rows. Each batch is encrypted in a single call and, when there are several batches, the next
+    one is encrypted while the current one is being processed. The weights converted to the
+    backend's encoding are cached across calls.
+
+    Args:
+        private_key (Optional[Any]): The GLWE private key. Default to None.
+        compression_key (Optional[Any]): The GLWE compression key. Default to None.
+        max_rows_per_batch (Optional[int]): The maximum number of rows encrypted together. If
+            None, all rows are encrypted together. Default to DEFAULT_GLWE_MAX_ROWS_PER_BATCH.
+    """
 
     def __init__(
         self,
         private_key=None,
         compression_key=None,
+        max_rows_per_batch: Optional[int] = DEFAULT_GLWE_MAX_ROWS_PER_BATCH,
     ):
         assert has_glwe_backend(), "GLWE backend not installed"
+        assert (
+            max_rows_per_batch is None or max_rows_per_batch > 0
+        ), "Parameter 'max_rows_per_batch' must be None or a strictly positive integer"
 
         import concrete_ml_extensions as fhext
 
@@ -37,6 +60,11 @@ class GLWELinearLayerExecutor:
 
         self.compression_key = compression_key
         self.private_key = private_key
+        self.max_rows_per_batch = max_rows_per_batch
+
+        # Weights converted to the backend's encoding, mapped to the identifier of their layer. The
+        # original quantized weights are stored as well in order to detect that they changed
+        self._prepared_weights: Dict[int, Tuple[numpy.ndarray, numpy.ndarray]] = {}
 
         default_crypto_params_glwe = json.loads(fhext.default_params())  # pylint: disable=no-member
         self.glwe_crypto_params = (
@@ -54,22 +82,43 @@ class GLWELinearLayerExecutor:
             self.glwe_crypto_params
         )
 
-    def forward(
-        self, x: numpy.ndarray, q_module: QuantizedModule, fhe: HybridFHEMode
+    def _get_prepared_weights(
+        self, layer_id: int, q_weight: numpy.ndarray, transpose: bool
     ) -> numpy.ndarray:
-        """Perform the inference of this linear layer.
+        """Get the weights in the backend's encoding, converting them only once per layer.
 
         Args:
-            x (numpy.ndarray): inputs or previous layer activations
-            q_module (QuantizedModule): quantized module that contains the layer which
-                is executed through this helper. Stores quantized weights and input
-                and output quantizers
-            fhe (HybridFHEMode): execution mode, can be 'disable' or 'execute'
+            layer_id (int): The identifier of the layer the weights belong to.
+            q_weight (numpy.ndarray): The layer's quantized weights.
+            transpose (bool): Whether the weights need to be transposed.
 
         Returns:
-            numpy.ndarray: result of applying the linear layer
+            numpy.ndarray: The contiguous uint64 weights.
         """
+        cached = self._prepared_weights.get(layer_id)
+        if cached is not None and cached[0] is q_weight:
+            return cached[1]
+
+        prepared_weight = numpy.transpose(q_weight) if transpose else q_weight
+
+        # The GLWE backend needs uint64 encoding for both neg/pos values
+        prepared_weight = numpy.ascontiguousarray(prepared_weight.astype(numpy.uint64))
 
+        self._prepared_weights[layer_id] = (q_weight, prepared_weight)
+        return prepared_weight
+
+    @staticmethod
+    def _get_linear_op(q_module: QuantizedModule) -> Tuple[Any, bool, bool, numpy.ndarray]:
+        """Retrieve the single linear layer of a quantized module and its quantized weights.
+
+        Args:
+            q_module (QuantizedModule): quantized module that contains the layer which
+                is executed through this helper
+
+        Returns:
+            Tuple[Any, bool, bool, numpy.ndarray]: The quantized linear op, whether its inputs
+                and its weights need to be transposed, and its quantized weights.
+        """
         # Extract all the layers in this quantized module
         # and check that there is only one, as only a single linear layer QM
         # can be optimized
@@ -93,7 +142,120 @@ class GLWELinearLayerExecutor:
         # Retrieve quantized weights
         q_weight = weight_bias[0].qvalues
 
-        q_weight = numpy.transpose(q_weight) if transpose_inputs2 else q_weight
+        return quantized_linear_op, transpose_inputs1, transpose_inputs2, q_weight
+
+    def prepare_weights(self, q_module: QuantizedModule):
+        """Convert the frozen weights of a linear layer to the backend's encoding ahead of time.
+
+        This avoids converting them during the first encrypted execution, for example during the
+        first step of a fine-tuning. Weights that are already converted are not converted again.
+
+        Args:
+            q_module (QuantizedModule): quantized module that contains the layer which
+                is executed through this helper
+        """
+        quantized_linear_op, _, transpose_inputs2, q_weight = self._get_linear_op(q_module)
+        self._get_prepared_weights(id(quantized_linear_op), q_weight, transpose_inputs2)
+
+    def _encrypt_rows(self, q_x_rows: numpy.ndarray) -> Any:
+        """Encrypt a batch of activation rows.
+
+        Args:
+            q_x_rows (numpy.ndarray): The contiguous uint64 rows to encrypt.
+
+        Returns:
+            Any: The encrypted matrix.
+        """
+        with measure_stage("glwe.encrypt", n_rows=q_x_rows.shape[0]):
+            return self.fhext.encrypt_matrix(  # pylint: disable=no-member
+                pkey=self.private_key, crypto_params=self.glwe_crypto_params, data=q_x_rows
+            )
+
+    def _matmul_decrypt(
+        self, ciphertext: Any, q_weight: numpy.ndarray, num_valid_glwe_values: int
+    ) -> numpy.ndarray:
+        """Multiply an encrypted matrix with the weights and decrypt the result.
+
+        Args:
+            ciphertext (Any): The encrypted matrix.
+            q_weight (numpy.ndarray): The contiguous uint64 weights.
+            num_valid_glwe_values (int): The number of valid values in the last GLWE ciphertext.
+
+        Returns:
+            numpy.ndarray: The decrypted integer results.
+        """
+        with measure_stage("glwe.matmul"):
+            encrypted_result = self.fhext.matrix_multiplication(  # pylint: disable=no-member
+                encrypted_matrix=ciphertext,
+                data=q_weight,
+                compression_key=self.compression_key,
+            )
+        with measure_stage("glwe.decrypt"):
+            q_result = self.fhext.decrypt_matrix(  # pylint: disable=no-member
+                encrypted_result,
+                self.private_key,
+                self.glwe_crypto_params,
+                num_valid_glwe_values,
+            )
+        return q_result.astype(numpy.int64)
+
+    def _run_batches(
+        self, batches: List[numpy.ndarray], q_weight: numpy.ndarray, num_valid_glwe_values: int
+    ) -> List[numpy.ndarray]:
+        """Run the encrypted matrix multiplication on several batches of rows.
+
+        When there are several batches, the next batch is encrypted in a background thread while
+        the current one is being multiplied and decrypted.
+
+        Args:
+            batches (List[numpy.ndarray]): The contiguous uint64 batches of rows.
+            q_weight (numpy.ndarray): The contiguous uint64 weights.
+            num_valid_glwe_values (int): The number of valid values in the last GLWE ciphertext.
+
+        Returns:
+            List[numpy.ndarray]: The decrypted integer results of each batch.
+        """
+        if len(batches) == 1:
+            return [
+                self._matmul_decrypt(
+                    self._encrypt_rows(batches[0]), q_weight, num_valid_glwe_values
+                )
+            ]
+
+        results = []
+        with ThreadPoolExecutor(max_workers=1) as pool:
+            next_ciphertext = pool.submit(self._encrypt_rows, batches[0])
+
+            for next_batch in batches[1:]:
+                ciphertext = next_ciphertext.result()
+                next_ciphertext = pool.submit(self._encrypt_rows, next_batch)
+                results.append(self._matmul_decrypt(ciphertext, q_weight, num_valid_glwe_values))
+
+            results.append(
+                self._matmul_decrypt(next_ciphertext.result(), q_weight, num_valid_glwe_values)
+            )
+
+        return results
+
+    def forward(
+        self, x: numpy.ndarray, q_module: QuantizedModule, fhe: HybridFHEMode
+    ) -> numpy.ndarray:
+        """Perform the inference of this linear layer.
+
+        Args:
+            x (numpy.ndarray): inputs or previous layer activations
+            q_module (QuantizedModule): quantized module that contains the layer which
+                is executed through this helper. Stores quantized weights and input
+                and output quantizers
+            fhe (HybridFHEMode): execution mode, can be 'disable' or 'execute'
+
+        Returns:
+            numpy.ndarray: result of applying the linear layer
+        """
+
+        quantized_linear_op, transpose_inputs1, transpose_inputs2, q_weight = (
+            self._get_linear_op(q_module)
+        )
 
         q_x = q_module.quantize_input(x)
         assert q_x is not None
@@ -102,6 +264,8 @@ class GLWELinearLayerExecutor:
         q_x = numpy.transpose(q_x) if transpose_inputs1 else q_x
 
         if fhe == HybridFHEMode.DISABLE:
+            q_weight = numpy.transpose(q_weight) if transpose_inputs2 else q_weight
+
             # There is no need to add the bias to the de-quantized values
             # as the bias is already included in the output quantizer
             # zero-point, in the analytical calibration
@@ -109,14 +273,15 @@ class GLWELinearLayerExecutor:
             q_weight = q_weight.astype(numpy.float32)
             y = q_module.dequantize_output(*to_tuple(numpy.matmul(q_x, q_weight)))
         else:
+            q_weight = self._get_prepared_weights(
+                id(quantized_linear_op), q_weight, transpose_inputs2
+            )
+
             # Need to slice the last GLWE (this will be improved in later cml-extensions)
             num_valid_glwe_values_in_last_ciphertext = (
                 q_weight.shape[1] % self.poly_size or self.poly_size
             )
 
-            # The GLWE backend needs uint64 encoding for both neg/pos values
-            q_weight = q_weight.astype(numpy.uint64)
-
             # Some models have (B, C, H)-size activations,
             # for example LLMs: B=batch size, C=context length, H=hidden dime
             # while other models only have (B, H)-size activations.
@@ -126,33 +291,26 @@ class GLWELinearLayerExecutor:
                 return_2d = True
                 q_x = numpy.expand_dims(q_x, 0)
 
-            # The GLWE backend needs contiguous memory uint64 encoding for both neg/pos values
-            q_x = numpy.ascontiguousarray(q_x.astype(numpy.uint64))
-
             assert q_weight.ndim == 2
-            result_buffer = numpy.zeros(
-                (q_x.shape[0], q_x.shape[1], q_weight.shape[1]), dtype=numpy.int64
-            )
 
-            for idx, q_x_sample in enumerate(q_x):
+            # Flatten all the rows so that rows from different samples can be encrypted together
+            # The GLWE backend needs contiguous memory uint64 encoding for both neg/pos values
+            q_x_rows = numpy.ascontiguousarray(q_x.reshape(-1, q_x.shape[-1]).astype(numpy.uint64))
 
-                ciphertext = self.fhext.encrypt_matrix(  # pylint: disable=no-member
-                    pkey=self.private_key, crypto_params=self.glwe_crypto_params, data=q_x_sample
-                )
-                encrypted_result = self.fhext.matrix_multiplication(  # pylint: disable=no-member
-                    encrypted_matrix=ciphertext,
-                    data=q_weight.astype(numpy.uint64),
-                    compression_key=self.compression_key,
-                )
-                q_result = self.fhext.decrypt_matrix(  # pylint: disable=no-member
-                    encrypted_result,
-                    self.private_key,
-                    self.glwe_crypto_params,
-                    num_valid_glwe_values_in_last_ciphertext,
-                )
-                q_result = q_result.astype(numpy.int64)
+            n_rows = q_x_rows.shape[0]
+            rows_per_batch = self.max_rows_per_batch or n_rows
+            batches = [
+                q_x_rows[start : start + rows_per_batch]
+                for start in range(0, n_rows, rows_per_batch)
+            ]
 
-                result_buffer[idx, :] = q_result
+            q_result_rows = self._run_batches(
+                batches, q_weight, num_valid_glwe_values_in_last_ciphertext
+            )
+
+            result_buffer = numpy.concatenate(q_result_rows, axis=0).reshape(
+                (q_x.shape[0], q_x.shape[1], q_weight.shape[1])
+            )
 
             # There is no need to add the bias to the de-quantized values
             # as the bias is already included in the output quantizer
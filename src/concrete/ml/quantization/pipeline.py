@@ -0,0 +1,409 @@
+"""Pipelines chaining several Concrete ML models in a single FHE circuit."""
+
+import os
+from typing import Any, Callable, Dict, List, Optional, Sequence, Union
+
+import numpy
+from concrete.fhe.compilation.artifacts import DebugArtifacts
+from concrete.fhe.compilation.circuit import Circuit
+from concrete.fhe.compilation.compiler import Compiler
+from concrete.fhe.compilation.configuration import Configuration
+
+from ..common.batch_executor import (
+    BatchExecutor,
+    get_fhe_execution_device,
+    get_fhe_predict_method,
+)
+from ..common.debugging import assert_true
+from ..common.instrumentation import measure_stage
+from ..common.utils import (
+    FheMode,
+    check_compilation_device_is_valid_and_is_cuda,
+    check_there_is_no_p_error_options_in_configuration,
+    manage_parameters_for_pbs_errors,
+)
+from .quantized_module import QuantizedModule, _get_inputset_generator
+from .quantizers import UniformQuantizer
+
+
+def _get_quantized_module(stage: Any) -> Optional[QuantizedModule]:
+    """Get the quantized module executing a pipeline stage, if any.
+
+    Args:
+        stage (Any): A QuantizedModule or a built-in model.
+
+    Returns:
+        Optional[QuantizedModule]: The stage itself if it is a QuantizedModule, the underlying
+            module of built-in neural networks, or None for other built-in models.
+    """
+    if isinstance(stage, QuantizedModule):
+        return stage
+
+    module = getattr(stage, "quantized_module_", None)
+    return module if isinstance(module, QuantizedModule) else None
+
+
+def _requantize(
+    q_values: numpy.ndarray,
+    output_quantizer: UniformQuantizer,
+    input_quantizers: Sequence[UniformQuantizer],
+) -> numpy.ndarray:
+    """Re-quantize a stage's outputs into the following stage's inputs.
+
+    This step is executed in FHE, where the de-quantization and quantization operations are fused
+    in a single table lookup on each value.
+
+    Args:
+        q_values (numpy.ndarray): The quantized outputs of a stage.
+        output_quantizer (UniformQuantizer): The quantizer of these outputs.
+        input_quantizers (Sequence[UniformQuantizer]): The quantizers of the following stage's
+            inputs, either a single one for the whole input or one for each feature (column).
+
+    Returns:
+        numpy.ndarray: The quantized inputs of the following stage.
+    """
+    values = output_quantizer.dequant(q_values)
+
+    if len(input_quantizers) == 1:
+        return input_quantizers[0].quant(values)
+
+    return numpy.concatenate(
+        [
+            input_quantizer.quant(values[:, i : i + 1])
+            for i, input_quantizer in enumerate(input_quantizers)
+        ],
+        axis=1,
+    )
+
+
+class QuantizedPipeline:
+    """Chain several Concrete ML models in a single FHE circuit.
+
+    Each stage's encrypted outputs are re-quantized and directly given to the following stage,
+    so that the whole pipeline is executed on the server without decrypting the intermediate
+    values on the client. Compared to deploying each stage separately, this removes a network round
+    trip as well as a decryption and encryption step for each additional stage.
+
+    All stages except the last one must be QuantizedModule instances (for example, as returned by
+    `compile_torch_model`) or built-in neural networks, with a single input and a single output. The
+    last stage can be any built-in model or QuantizedModule with a single output, whose
+    de-quantization and post-processing steps are applied to the pipeline's outputs. The stages
+    must be fitted, but do not need to be compiled.
+
+    Once compiled, the pipeline can be deployed like any other model using `FHEModelDev`,
+    `FHEModelClient` and `FHEModelServer`.
+
+    Args:
+        stages (Optional[Sequence[Any]]): The models to chain, in order. Can be None when the
+            pipeline is loaded by a client, which only needs its quantizers and post-processing
+            parameters. Default to None.
+    """
+
+    def __init__(self, stages: Optional[Sequence[Any]] = None):
+        self.stages: List[Any] = list(stages) if stages is not None else []
+
+        self.input_quantizers: List[UniformQuantizer] = []
+        self.output_quantizers: List[UniformQuantizer] = []
+        self.post_processing_params: Dict[str, Any] = {}
+        self.fhe_circuit: Optional[Circuit] = None
+        self.fhe_executor = BatchExecutor()
+        self._is_compiled = False
+        self._compiled_for_cuda = False
+
+        # The stage applying the de-quantization and post-processing steps. Clients re-build it
+        # from the post-processing parameters
+        self._output_stage: Optional[Any] = None
+
+        if stages is not None:
+            self._check_stages()
+
+            first_module = _get_quantized_module(self.stages[0])
+            first_stage = self.stages[0] if first_module is None else first_module
+            self.input_quantizers = list(first_stage.input_quantizers)
+
+            self._output_stage = self.stages[-1]
+            self.output_quantizers = list(self._output_stage.output_quantizers)
+            self.post_processing_params = {
+                "output_stage_type": type(self._output_stage),
+                "output_stage_post_processing_params": self._output_stage.post_processing_params,
+            }
+
+    def _check_stages(self):
+        """Check that the stages can be chained.
+
+        Raises:
+            ValueError: If no stages are given or if some stages cannot be chained.
+        """
+        if len(self.stages) == 0:
+            raise ValueError("A pipeline needs at least one stage.")
+
+        for i, stage in enumerate(self.stages):
+            if not getattr(stage, "is_fitted", True):
+                raise ValueError(f"Stage {i} ({type(stage).__name__}) is not fitted.")
+
+            module = _get_quantized_module(stage)
+
+            if i < len(self.stages) - 1 and module is None:
+                raise ValueError(
+                    f"Stage {i} ({type(stage).__name__}) must be a QuantizedModule or a built-in "
+                    "neural network, as only the last stage of a pipeline can be another model."
+                )
+
+            n_outputs = len(stage.output_quantizers)
+            n_inputs = len(module.input_quantizers) if module is not None else 1
+            if n_outputs != 1 or (i > 0 and n_inputs != 1):
+                raise ValueError(
+                    f"Stage {i} ({type(stage).__name__}) must have a single input and a single "
+                    f"output in order to be chained. Got {n_inputs} inputs and {n_outputs} outputs."
+                )
+
+    def _get_output_stage(self) -> Any:
+        """Get the stage applying the de-quantization and post-processing steps.
+
+        Returns:
+            Any: The pipeline's last stage.
+        """
+        if self._output_stage is None:
+            output_stage = self.post_processing_params["output_stage_type"]()
+            output_stage.output_quantizers = self.output_quantizers
+            output_stage.post_processing_params = self.post_processing_params[
+                "output_stage_post_processing_params"
+            ]
+
+            # Built-in models are loaded the same way FHEModelClient loads them
+            if hasattr(output_stage, "is_fitted"):
+                # pylint: disable-next=protected-access
+                output_stage._is_fitted = True
+
+            self._output_stage = output_stage
+
+        return self._output_stage
+
+    @property
+    def is_compiled(self) -> bool:
+        """Indicate if the pipeline is compiled.
+
+        Returns:
+            bool: If the pipeline is compiled.
+        """
+        return self._is_compiled
+
+    def check_model_is_compiled(self):
+        """Check if the pipeline is compiled.
+
+        Raises:
+            AttributeError: If the pipeline is not compiled.
+        """
+        if not self.is_compiled:
+            raise AttributeError(
+                "The pipeline is not compiled. Please run compile(...) first before executing it "
+                "in FHE."
+            )
+
+    def quantize_input(self, x: numpy.ndarray) -> numpy.ndarray:
+        """Quantize the inputs of the first stage.
+
+        Args:
+            x (numpy.ndarray): The floating point inputs.
+
+        Returns:
+            numpy.ndarray: The quantized (numpy.int64) inputs.
+        """
+        if len(self.input_quantizers) == 1:
+            return self.input_quantizers[0].quant(x)
+
+        # Built-in models other than neural networks quantize each feature separately
+        q_x = numpy.zeros_like(x, dtype=numpy.int64)
+        for i, input_quantizer in enumerate(self.input_quantizers):
+            q_x[:, i] = input_quantizer.quant(x[:, i])
+
+        return q_x
+
+    def dequantize_output(self, q_y_preds: numpy.ndarray) -> numpy.ndarray:
+        """De-quantize the outputs of the last stage.
+
+        Args:
+            q_y_preds (numpy.ndarray): The quantized outputs.
+
+        Returns:
+            numpy.ndarray: The de-quantized outputs.
+        """
+        return self._get_output_stage().dequantize_output(q_y_preds)
+
+    def post_processing(self, y_preds: numpy.ndarray) -> numpy.ndarray:
+        """Apply the last stage's post-processing to the de-quantized outputs.
+
+        Args:
+            y_preds (numpy.ndarray): The de-quantized outputs.
+
+        Returns:
+            numpy.ndarray: The post-processed outputs.
+        """
+        return self._get_output_stage().post_processing(y_preds)
+
+    def _get_stage_functions(self) -> List[Callable]:
+        """Get the functions executing each stage on quantized values.
+
+        Returns:
+            List[Callable]: The stages' functions, as compiled to FHE by each stage.
+        """
+        functions = []
+        for stage in self.stages:
+            module = _get_quantized_module(stage)
+
+            # pylint: disable-next=protected-access
+            functions.append(module._clear_forward if module is not None else stage._inference)
+
+        return functions
+
+    def _clear_forward(self, q_x: numpy.ndarray) -> numpy.ndarray:
+        """Execute all stages on quantized values, re-quantizing the values between stages.
+
+        Args:
+            q_x (numpy.ndarray): The quantized inputs of the first stage.
+
+        Returns:
+            numpy.ndarray: The quantized outputs of the last stage.
+        """
+        q_values = q_x
+        for i, function in enumerate(self._get_stage_functions()):
+            if i > 0:
+                previous_stage = self.stages[i - 1]
+                module = _get_quantized_module(self.stages[i])
+                stage = self.stages[i] if module is None else module
+
+                q_values = _requantize(
+                    q_values, previous_stage.output_quantizers[0], stage.input_quantizers
+                )
+
+            q_values = function(q_values)
+
+        return q_values
+
+    def compile(
+        self,
+        inputs: numpy.ndarray,
+        configuration: Optional[Configuration] = None,
+        artifacts: Optional[DebugArtifacts] = None,
+        show_mlir: bool = False,
+        p_error: Optional[float] = None,
+        global_p_error: Optional[float] = None,
+        verbose: bool = False,
+        device: str = "cpu",
+    ) -> Circuit:
+        """Compile all stages into a single FHE circuit.
+
+        Args:
+            inputs (numpy.ndarray): A representative set of input values for the first stage, used
+                for building cryptographic parameters.
+            configuration (Optional[Configuration]): Options to use for compilation. Default
+                to None.
+            artifacts (Optional[DebugArtifacts]): Artifacts information about the
+                compilation process to store for debugging.
+            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
+            p_error (Optional[float]): Probability of error of a single PBS. A p_error value cannot
+                be given if a global_p_error value is already set. Default to None, which sets this
+                error to a default value.
+            global_p_error (Optional[float]): Probability of error of the full circuit. A
+                global_p_error value cannot be given if a p_error value is already set. Default to
+                None, which sets this error to a default value.
+            verbose (bool): Indicate if compilation information should be printed
+                during compilation. Default to False.
+            device: FHE compilation device, can be either 'cpu' or 'cuda'.
+
+        Returns:
+            Circuit: The compiled Circuit.
+        """
+        assert_true(
+            len(self.stages) > 0,
+            "This pipeline was loaded without its stages and therefore cannot be compiled.",
+        )
+
+        def inference_to_compile(q_x: numpy.ndarray) -> numpy.ndarray:
+            """Execute the pipeline on quantized values.
+
+            Args:
+                q_x (numpy.ndarray): The quantized inputs.
+
+            Returns:
+                numpy.ndarray: The quantized outputs.
+            """
+            return self._clear_forward(q_x)
+
+        compiler = Compiler(inference_to_compile, {"q_x": "encrypted"})
+
+        inputset = _get_inputset_generator(self.quantize_input(inputs))
+
+        # Check that p_error or global_p_error is not set in both the configuration and in the
+        # direct parameters
+        check_there_is_no_p_error_options_in_configuration(configuration)
+
+        # Find the right way to set parameters for compiler, depending on the way we want to default
+        p_error, global_p_error = manage_parameters_for_pbs_errors(p_error, global_p_error)
+
+        use_gpu = check_compilation_device_is_valid_and_is_cuda(device)
+
+        # Enable input ciphertext compression
+        enable_input_compression = os.environ.get("USE_INPUT_COMPRESSION", "1") == "1"
+        enable_key_compression = os.environ.get("USE_KEY_COMPRESSION", "1") == "1"
+
+        self.fhe_circuit = compiler.compile(
+            inputset,
+            configuration=configuration,
+            artifacts=artifacts,
+            show_mlir=show_mlir,
+            p_error=p_error,
+            global_p_error=global_p_error,
+            verbose=verbose,
+            single_precision=False,
+            use_gpu=use_gpu,
+            compress_input_ciphertexts=enable_input_compression,
+            compress_evaluation_keys=enable_key_compression,
+        )
+
+        self._is_compiled = True
+        self._compiled_for_cuda = use_gpu
+
+        return self.fhe_circuit
+
+    def predict(
+        self, x: numpy.ndarray, fhe: Union[FheMode, str] = FheMode.DISABLE
+    ) -> numpy.ndarray:
+        """Predict the outputs of the whole pipeline.
+
+        Args:
+            x (numpy.ndarray): The floating point inputs of the first stage.
+            fhe (Union[FheMode, str]): The mode to use for prediction. Can be FheMode.DISABLE for
+                Concrete ML Python inference, FheMode.SIMULATE for FHE simulation and
+                FheMode.EXECUTE for actual FHE execution. Can also be the string representation of
+                any of these values. Default to FheMode.DISABLE.
+
+        Returns:
+            numpy.ndarray: The post-processed outputs of the last stage.
+        """
+        assert_true(
+            FheMode.is_valid(fhe),
+            "`fhe` mode is not supported. Expected one of 'disable' (resp. FheMode.DISABLE), "
+            "'simulate' (resp. FheMode.SIMULATE) or 'execute' (resp. FheMode.EXECUTE). Got "
+            f"{fhe}",
+        )
+
+        q_x = self.quantize_input(x)
+
+        with measure_stage("pipeline.inference", fhe=str(fhe)):
+            if fhe == "disable":
+                q_y_pred = self._clear_forward(q_x)
+            else:
+                self.check_model_is_compiled()
+
+                # For mypy
+                assert self.fhe_circuit is not None
+
+                predict_method = get_fhe_predict_method(self.fhe_circuit, fhe)
+                q_y_pred = self.fhe_executor.run(
+                    predict_method,
+                    q_x,
+                    device=get_fhe_execution_device(self._compiled_for_cuda, fhe),
+                )[0]
+
+        return self.post_processing(self.dequantize_output(q_y_pred))
@@ -2,6 +2,7 @@
 
 import enum
 from abc import abstractmethod
+from collections import Counter
 from typing import Dict, List, Optional, Set, Tuple, Type, Union, cast
 
 import numpy
@@ -24,7 +25,13 @@ from .base_quantized_op import (
 from .quantized_module import QuantizedModule
 from .quantized_module_passes import PowerOfTwoScalingRoundPBSAdapter
 from .quantized_ops import QuantizedBrevitasQuant
-from .quantizers import QuantizationOptions, QuantizedArray, UniformQuantizer
+from .quantizers import (
+    MinMaxQuantizationStats,
+    QuantizationOptions,
+    QuantizedArray,
+    UniformQuantizationParameters,
+    UniformQuantizer,
+)
 
 
 # pylint: disable=too-many-lines
@@ -195,6 +202,134 @@ class CalibrationMode(enum.Enum):
     FAST_RAW = "fast"  # Output raw float values, don't process rounding
 
 
+class BatchedCalibrationData:
+    """Calibration data of an intermediate tensor, stored as a list of batches.
+
+    When calibrating in batches, each layer is computed one batch at a time from the batches of
+    its inputs, which are only released once all the layers using them are calibrated. Each
+    batch is thus computed once. Only a single copy of the tensor is kept, and the temporary
+    float, quantized and de-quantized values of a layer are never created for the whole
+    calibration data-set. The min/max of the tensor over the whole data-set are also kept.
+
+    Args:
+        batches (List[numpy.ndarray]): the values of the tensor for each batch, in order
+        batch_size (int): the number of samples in each batch, the last one can have less
+        rmin (float): the minimum value of the tensor over the calibration data-set
+        rmax (float): the maximum value of the tensor over the calibration data-set
+    """
+
+    def __init__(
+        self,
+        batches: List[numpy.ndarray],
+        batch_size: int,
+        rmin: float,
+        rmax: float,
+    ):
+        self.batches = batches
+        self.batch_size = batch_size
+        self.rmin = rmin
+        self.rmax = rmax
+
+    @property
+    def n_samples(self) -> int:
+        """Get the number of samples in the calibration data-set.
+
+        Returns:
+            int: the number of samples of all batches
+        """
+        return sum(batch.shape[0] for batch in self.batches)
+
+    @property
+    def batch_slices(self) -> List[slice]:
+        """Get the slices of all batches of the calibration data-set.
+
+        Returns:
+            List[slice]: the slices of the batches, in order
+        """
+        return get_batch_slices(self.n_samples, self.batch_size)
+
+    def get_batch(self, batch_slice: slice) -> numpy.ndarray:
+        """Get a batch of the tensor.
+
+        Args:
+            batch_slice (slice): the samples of the batch, as given by `batch_slices`
+
+        Returns:
+            numpy.ndarray: the values of the tensor for these samples
+        """
+        return self.batches[batch_slice.start // self.batch_size]
+
+    def materialize(self) -> numpy.ndarray:
+        """Concatenate the tensor's batches into the whole calibration data-set.
+
+        This is only used for layers that can't be calibrated in batches.
+
+        Returns:
+            numpy.ndarray: the values of the tensor for all samples
+        """
+        return numpy.concatenate(self.batches, axis=0)
+
+
+# Calibration data of a layer's input, stored for the whole data-set or computed in batches
+CalibrationDataType = Union[numpy.ndarray, BatchedCalibrationData]
+
+
+def get_batch_slices(n_samples: int, batch_size: int) -> List[slice]:
+    """Split a data-set in batches.
+
+    Args:
+        n_samples (int): the number of samples in the data-set
+        batch_size (int): the number of samples in each batch, the last one can have less
+
+    Returns:
+        List[slice]: the slices of the batches, in order
+    """
+    return [slice(start, start + batch_size) for start in range(0, n_samples, batch_size)]
+
+
+def _get_n_samples(data: CalibrationDataType) -> int:
+    """Get the number of samples of a layer's calibration data.
+
+    Args:
+        data (CalibrationDataType): the calibration data, either stored for the whole data-set or
+            computed in batches
+
+    Returns:
+        int: the number of samples
+    """
+    if isinstance(data, BatchedCalibrationData):
+        return data.n_samples
+    return data.shape[0]
+
+
+def _get_calibration_batch(data: CalibrationDataType, batch_slice: slice) -> numpy.ndarray:
+    """Get a batch of a layer's calibration data.
+
+    Args:
+        data (CalibrationDataType): the calibration data, either stored for the whole data-set or
+            computed in batches
+        batch_slice (slice): the samples of the batch
+
+    Returns:
+        numpy.ndarray: the calibration data of the batch
+    """
+    if isinstance(data, BatchedCalibrationData):
+        return data.get_batch(batch_slice)
+    return data[batch_slice]
+
+
+def _merge_min_max(stats: MinMaxQuantizationStats, rmin: float, rmax: float) -> None:
+    """Merge the min/max of a batch into the statistics of the previous batches.
+
+    Args:
+        stats (MinMaxQuantizationStats): the statistics of the previous batches, updated in place
+        rmin (float): the minimum value of the batch
+        rmax (float): the maximum value of the batch
+    """
+    stats.rmin = rmin if stats.rmin is None else min(stats.rmin, rmin)
+    stats.rmax = rmax if stats.rmax is None else max(stats.rmax, rmax)
+
+
 class ONNXConverter:
     """Base ONNX to Concrete ML computation graph conversion class.
 
@@ -225,6 +360,12 @@ class ONNXConverter:
             rounding for model accumulators. Accepts None, an int, or a dict.
             The dict can specify 'method' (fhe.Exactness.EXACT or fhe.Exactness.APPROXIMATE)
             and 'n_bits' ('auto' or int)
+        calibration_batch_size (Optional[int]): if not None, the calibration data-set is passed
+            through the layers in batches of this size. The layers are calibrated one after the
+            other, each batch of a layer being computed once from the batches of its inputs, so
+            that the temporary values of a layer are never created for the whole data-set. The
+            resulting quantizers are the same as when calibrating on the whole data-set at once.
+            Default to None.
     """
 
     quant_ops_dict: Dict[str, Tuple[Tuple[str, ...], QuantizedOp]]
@@ -232,19 +373,28 @@ class ONNXConverter:
     quant_params: Dict[str, numpy.ndarray]
     numpy_model: NumpyModule
     rounding_threshold_bits: Union[None, int, Dict[str, Union[str, int]]]
+    calibration_batch_size: Optional[int]
 
     def __init__(
         self,
         n_bits: Union[int, Dict],
         numpy_model: NumpyModule,
         rounding_threshold_bits: Union[None, int, Dict[str, Union[str, int]]] = None,
+        calibration_batch_size: Optional[int] = None,
     ):
+        assert_true(
+            calibration_batch_size is None or calibration_batch_size > 0,
+            f"calibration_batch_size must be a positive integer, got {calibration_batch_size}",
+            ValueError,
+        )
+
         self.quant_ops_dict = {}
 
         self.n_bits = get_n_bits_dict(n_bits)
         self.quant_params = {}
         self.numpy_model = numpy_model
         self.rounding_threshold_bits = process_rounding_threshold_bits(rounding_threshold_bits)
+        self.calibration_batch_size = calibration_batch_size
 
     @property
     def n_bits_model_outputs(self):
@@ -286,15 +436,15 @@ class ONNXConverter:
     def _process_layer(
         self,
         quantized_op: QuantizedOp,
-        *calibration_data: numpy.ndarray,
+        *calibration_data: CalibrationDataType,
         quantizers: List[Optional[UniformQuantizer]],
         fast_calibration: bool = False,
-    ) -> Tuple[numpy.ndarray, Optional[UniformQuantizer]]:
+    ) -> Tuple[CalibrationDataType, Optional[UniformQuantizer]]:
         """Configure a graph operation according to model conversion mode.
 
         Args:
             quantized_op (QuantizedOp): Quantized graph operator instance
-            *calibration_data (numpy.ndarray): tuple of network input tensors to be used for
+            *calibration_data (CalibrationDataType): tuple of network input tensors to be used for
                 calibration
             quantizers (List[Optional[UniformQuantizer]]): a list of quantizers that
                 should produce the quantized values used in calibration. If none are given,
@@ -306,16 +456,16 @@ class ONNXConverter:
                 quantization parameters
 
         Returns:
-            numpy.ndarray: calibration data for the following operators
+            CalibrationDataType: calibration data for the following operators
         """
 
     def _calibrate_layers_activation(
         self,
         calibrate_mode: CalibrationMode,
         quantized_op: QuantizedOp,
-        *calibration_data: numpy.ndarray,
+        *calibration_data: CalibrationDataType,
         quantizers: List[Optional[UniformQuantizer]],
-    ) -> Tuple[numpy.ndarray, Optional[UniformQuantizer]]:
+    ) -> Tuple[CalibrationDataType, Optional[UniformQuantizer]]:
         """Calibrate the QuantizedOp with the previous layer's output calibration data.
 
         Args:
@@ -323,14 +473,14 @@ class ONNXConverter:
                 output de-quantized values or raw values during calibration,
                 or analytically determine output quantization parameters (for linear layers)
             quantized_op (QuantizedOp): the quantized operator for the current layer.
-            *calibration_data: numpy.ndarray: the previous layer's calibration data.
+            *calibration_data (CalibrationDataType): the previous layer's calibration data.
             quantizers (List[Optional[UniformQuantizer]]): a list of quantizers that
                 should produce the quantized values used in calibration. If none are given,
                 the calibration will generate the quantized values with the layer's input
                 calibration options.
 
         Returns:
-            numpy.ndarray: the output of the newly calibrated layer.
+            CalibrationDataType: the output of the newly calibrated layer.
         """
         # Some operators need to quantize their inputs using model_outputs instead of op_inputs in
         # order to reduce the impact of quantization.
@@ -339,10 +489,27 @@ class ONNXConverter:
         else:
             n_bits = self.n_bits_op_inputs
 
+        if calibrate_mode != CalibrationMode.FAST_RAW and self._can_calibrate_in_batches(
+            quantized_op, *calibration_data
+        ):
+            return self._calibrate_layers_activation_in_batches(
+                calibrate_mode,
+                quantized_op,
+                n_bits,
+                *calibration_data,
+                quantizers=quantizers,
+            )
+
+        # Layers that can't be calibrated in batches need their inputs for the whole data-set
+        full_calibration_data = tuple(
+            data.materialize() if isinstance(data, BatchedCalibrationData) else data
+            for data in calibration_data
+        )
+
         # Create new calibration data (output of the previous layer)
         # Use the op's input options (thus behavior in calibration is the same as in compilation)
         q_calibration_data: List[Union[QuantizedArray, numpy.ndarray]] = []
-        for idx, data in enumerate(calibration_data):
+        for idx, data in enumerate(full_calibration_data):
             is_clear_value = isinstance(data, RawOpOutput)
             if is_clear_value or data is None:
                 q_calibration_data.append(data)
@@ -388,7 +555,7 @@ class ONNXConverter:
             )
 
         # Calibrate the output of the layer
-        raw_result = quantized_op.calibrate(*calibration_data)
+        raw_result = quantized_op.calibrate(*full_calibration_data)
 
         # Enable rounding calibration if used has set a rounding_threshold_bits
         calibrate_attr = (
@@ -437,6 +604,225 @@ class ONNXConverter:
             quant_result.quantizer if isinstance(quant_result, QuantizedArray) else None,
         )
 
+    def _can_calibrate_in_batches(
+        self, quantized_op: QuantizedOp, *calibration_data: CalibrationDataType
+    ) -> bool:
+        """Determine if a layer can be calibrated by passing its data in batches.
+
+        Args:
+            quantized_op (QuantizedOp): the quantized operator for the current layer.
+            *calibration_data (CalibrationDataType): the previous layer's calibration data.
+
+        Returns:
+            bool: whether the layer's calibration data can be split in batches.
+        """
+        if self.calibration_batch_size is None or quantized_op.produces_raw_output:
+            return False
+
+        # Operators that override the calibration compute additional parameters from the whole
+        # data-set (e.g., the range of a divider), they are thus calibrated in a single pass
+        if type(quantized_op).calibrate is not QuantizedOp.calibrate:
+            return False
+
+        # All variable inputs must be float tensors holding the same number of samples. Raw
+        # values, such as shapes, can depend on the number of samples and can't be split
+        variable_inputs = [data for data in calibration_data if data is not None]
+        if not variable_inputs or any(
+            not isinstance(data, BatchedCalibrationData)
+            and (
+                isinstance(data, RawOpOutput)
+                or not isinstance(data, numpy.ndarray)
+                or data.ndim == 0
+            )
+            for data in variable_inputs
+        ):
+            return False
+
+        n_samples = {_get_n_samples(data) for data in variable_inputs}
+        return len(n_samples) == 1 and n_samples.pop() > self.calibration_batch_size
+
+    # pylint: disable-next=too-many-locals
+    def _calibrate_layers_activation_in_batches(
+        self,
+        calibrate_mode: CalibrationMode,
+        quantized_op: QuantizedOp,
+        n_bits: int,
+        *calibration_data: CalibrationDataType,
+        quantizers: List[Optional[UniformQuantizer]],
+    ) -> Tuple[BatchedCalibrationData, Optional[UniformQuantizer]]:
+        """Calibrate the QuantizedOp by passing the previous layers' outputs in batches.
+
+        This gives the same quantizers as calibrating the layer on the whole data-set at once. The
+        layer's inputs are quantized using their min/max over the whole data-set and the output
+        quantizer is computed from the running min/max of the layer's outputs. Only statistics
+        are merged across batches, the layer's outputs being stored batch by batch for the
+        following layers.
+
+        Args:
+            calibrate_mode (CalibrationMode): whether to use data-based quantization for
+                output de-quantized values or raw values during calibration
+            quantized_op (QuantizedOp): the quantized operator for the current layer.
+            n_bits (int): the number of bits used to quantize the layer's inputs.
+            *calibration_data (CalibrationDataType): the previous layer's calibration data.
+            quantizers (List[Optional[UniformQuantizer]]): a list of quantizers that
+                should produce the quantized values used in calibration. If none are given,
+                the calibration will generate the quantized values with the layer's input
+                calibration options.
+
+        Returns:
+            BatchedCalibrationData: the output of the newly calibrated layer, stored in batches.
+        """
+        assert self.calibration_batch_size is not None
+
+        n_samples = next(_get_n_samples(data) for data in calibration_data if data is not None)
+
+        # The inputs of each batch, None for missing inputs
+        input_batches: List[List[Optional[numpy.ndarray]]] = [
+            [
+                None if data is None else _get_calibration_batch(data, batch_slice)
+                for data in calibration_data
+            ]
+            for batch_slice in get_batch_slices(n_samples, self.calibration_batch_size)
+        ]
+
+        # Get the quantization settings of each input. Inputs that are not quantized with an
+        # overriding quantizer use their min/max over the whole data-set, so that all batches
+        # are quantized the same way
+        input_quantization: List[Optional[Tuple]] = []
+        for data, quantizer in zip(calibration_data, quantizers):
+            if data is None:
+                input_quantization.append(None)
+            elif quantizer is None:
+                stats = MinMaxQuantizationStats()
+                if isinstance(data, BatchedCalibrationData):
+                    _merge_min_max(stats, data.rmin, data.rmax)
+                else:
+                    stats.compute_quantization_stats(data)
+                input_quantization.append((n_bits, quantized_op.input_quant_opts, stats, None))
+            else:
+                input_quantization.append(
+                    (
+                        quantizer.n_bits,
+                        quantizer.quant_options,
+                        quantizer.quant_stats,
+                        quantizer.quant_params,
+                    )
+                )
+
+        # Calibrate the output of the layer, merging the statistics of all batches. For QAT, the
+        # following layers are calibrated on these raw values
+        output_stats = MinMaxQuantizationStats()
+        raw_batches = []
+        for batch in input_batches:
+            raw_batch = quantized_op.calibrate(*batch)
+            if calibrate_mode != CalibrationMode.QUANTIZED:
+                raw_batches.append(raw_batch)
+
+            batch_stats = quantized_op.output_quant_stats
+            assert batch_stats is not None
+            _merge_min_max(output_stats, batch_stats.rmin, batch_stats.rmax)
+
+        # Set the output quantizer the same way calibrating on the whole data-set would
+        output_params = UniformQuantizationParameters()
+        output_params.compute_quantization_parameters(
+            QuantizationOptions(quantized_op.n_bits), output_stats
+        )
+        quantized_op.output_quant_stats = output_stats
+        quantized_op.output_quant_params = output_params
+
+        # The number of bits to remove by rounding is the maximum over all batches. It is thus
+        # calibrated on all batches before computing the outputs, so that all batches are rounded
+        # the same way
+        is_mixing_op = isinstance(quantized_op, QuantizedMixingOp)
+        if is_mixing_op and getattr(quantized_op, "rounding_threshold_bits", None) is not None:
+            calibrate_rounding_attr = {**quantized_op.attrs, "calibrate_rounding": True}
+            for batch in input_batches:
+                quantized_op.q_impl(
+                    *self._quantize_batch(batch, input_quantization), **calibrate_rounding_attr
+                )
+
+        q_impl_attr = quantized_op.attrs.copy()
+        if is_mixing_op:
+            q_impl_attr["calibrate_rounding"] = False
+
+        def quantize_output_batch(batch: List[Optional[numpy.ndarray]]) -> QuantizedArray:
+            """Compute a batch of the calibrated layer's quantized output.
+
+            Args:
+                batch (List[Optional[numpy.ndarray]]): the layer's inputs for the batch.
+
+            Returns:
+                QuantizedArray: the quantized output of the batch.
+            """
+            quant_result = quantized_op.q_impl(
+                *self._quantize_batch(batch, input_quantization), **q_impl_attr
+            )
+            assert isinstance(quant_result, QuantizedArray)
+            return quant_result
+
+        # The output quantizer does not depend on the batch. For PTQ, the following layers are
+        # calibrated on de-quantized values, whose min/max are computed on all batches
+        if calibrate_mode == CalibrationMode.QUANTIZED:
+            result_stats = MinMaxQuantizationStats()
+            result_batches = []
+            for batch in input_batches:
+                quant_result = quantize_output_batch(batch)
+                dequantized_batch = quant_result.dequant()
+                result_batches.append(dequantized_batch)
+                _merge_min_max(
+                    result_stats, numpy.min(dequantized_batch), numpy.max(dequantized_batch)
+                )
+        else:
+            quant_result = quantize_output_batch(input_batches[0])
+            result_stats = output_stats
+            result_batches = raw_batches
+
+        if quantized_op.produces_graph_output:
+            assert quantized_op.output_quant_stats is not None
+            assert quantized_op.output_quant_params is not None
+            quantized_op.output_quant_stats.copy_stats(quant_result.quantizer.quant_stats)
+            quantized_op.output_quant_params.copy_params(quant_result.quantizer.quant_params)
+
+        assert result_stats.rmin is not None and result_stats.rmax is not None
+        batched_result = BatchedCalibrationData(
+            result_batches,
+            self.calibration_batch_size,
+            result_stats.rmin,
+            result_stats.rmax,
+        )
+        return batched_result, quant_result.quantizer
+
+    @staticmethod
+    def _quantize_batch(
+        input_batches: List[Optional[numpy.ndarray]],
+        input_quantization: List[Optional[Tuple]],
+    ) -> List[Optional[QuantizedArray]]:
+        """Quantize a batch of a layer's calibration data.
+
+        Args:
+            input_batches (List[Optional[numpy.ndarray]]): the layer's inputs for the batch.
+            input_quantization (List[Optional[Tuple]]): the number of bits, options, statistics
+                and parameters used to quantize each input, or None for missing inputs.
+
+        Returns:
+            List[Optional[QuantizedArray]]: the quantized inputs of the batch.
+        """
+        return [
+            (
+                None
+                if data is None or quantization is None
+                else QuantizedArray(
+                    quantization[0],
+                    data,
+                    True,
+                    options=quantization[1],
+                    stats=quantization[2],
+                    params=quantization[3],
+                )
+            )
+            for data, quantization in zip(input_batches, input_quantization)
+        ]
+
     @abstractmethod
     def _process_initializer(
         self, n_bits: int, values: Union[numpy.ndarray, float, int, bool]
@@ -457,13 +843,14 @@ class ONNXConverter:
     @abstractmethod
     def _get_input_quant_opts(
         self,
-        values: Tuple[ONNXOpInputOutputType, ...],
+        values: Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...],
         quantized_op_class: Type["QuantizedOp"],
     ) -> QuantizationOptions:
         """Construct a quantization options set for the input of a layer.
 
         Args:
-            values (Tuple[ONNXOpInputOutputType, ...]): calibration data for this op
+            values (Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...]): calibration
+                data for this op
             quantized_op_class (Type["QuantizedOp"]): The quantized operator's class
 
         Returns:
@@ -490,6 +877,9 @@ class ONNXConverter:
         quantization parameters for activations and layers. Moreover, this function determines
         the compilation mode of the quantized ops: on integers or in floating point.
 
+        When a calibration batch size is set, the outputs of the layers calibrated in batches are
+        stored batch by batch and released as soon as all the layers using them are calibrated.
+
         Args:
             *input_calibration_data (numpy.ndarray): Data that will be used to compute the bounds,
                 scales and zero point values for every quantized object.
@@ -501,7 +891,7 @@ class ONNXConverter:
         # Get the list of output tensor names
         graph_output_names = [o.name for o in graph.output]
 
-        node_results: Dict[str, ONNXOpInputOutputType] = dict(
+        node_results: Dict[str, Union[ONNXOpInputOutputType, BatchedCalibrationData]] = dict(
             {
                 graph_input.name: input_value
                 for graph_input, input_value in zip(graph.input, input_calibration_data)
@@ -512,6 +902,10 @@ class ONNXConverter:
 
         constants: Set[str] = set(self.quant_params.keys())
 
+        # Count the number of nodes that use each tensor, in order to release the calibration
+        # data of intermediate tensors as soon as all their consumers are calibrated
+        n_remaining_uses = Counter(input_name for node in graph.node for input_name in node.input)
+
         # Check if the model has only GLWE supported linear layers.
         # In this case, use analytical calibration which is much faster
         fast_calibration = True
@@ -610,9 +1004,12 @@ class ONNXConverter:
 
             # For mypy
             assert_true(
-                all(val is None or isinstance(val, numpy.ndarray) for val in curr_calibration_data)
+                all(
+                    val is None or isinstance(val, (numpy.ndarray, BatchedCalibrationData))
+                    for val in curr_calibration_data
+                )
             )
-            curr_calibration_data = cast(Tuple[numpy.ndarray], curr_calibration_data)
+            curr_calibration_data = cast(Tuple[CalibrationDataType], curr_calibration_data)
 
             # Find the unique integer producers of the current's op output tensor
             node_integer_inputs = set.union(
@@ -730,6 +1127,11 @@ class ONNXConverter:
                 node_results[output_name] = node_output[0]
                 constants.add(output_name)
 
+            for input_name in node.input:
+                n_remaining_uses[input_name] -= 1
+                if n_remaining_uses[input_name] == 0 and input_name not in constants:
+                    node_results.pop(input_name, None)
+
     def quantize_module(self, *calibration_data: numpy.ndarray) -> QuantizedModule:
         """Quantize numpy module.
 
@@ -896,6 +1298,9 @@ class PostTrainingAffineQuantization(ONNXConverter):
                                         'method' and 'n_bits', where 'method' is either
                                         fhe.Exactness.EXACT or fhe.Exactness.APPROXIMATE, and
                                         'n_bits' is either 'auto' or an int.
+        calibration_batch_size (Optional[int]): if not None, the calibration data-set is passed
+                                        through each layer in batches of this size, in order to
+                                        bound the memory used during calibration.
         is_signed:                      Whether the weights of the layers can be signed.
                                         Currently, only the weights can be signed.
 
@@ -906,15 +1311,15 @@ class PostTrainingAffineQuantization(ONNXConverter):
     def _process_layer(
         self,
         quantized_op: QuantizedOp,
-        *calibration_data: numpy.ndarray,
+        *calibration_data: CalibrationDataType,
         quantizers: List[Optional[UniformQuantizer]],
         fast_calibration: bool = False,
-    ) -> Tuple[numpy.ndarray, Optional[UniformQuantizer]]:
+    ) -> Tuple[CalibrationDataType, Optional[UniformQuantizer]]:
         """Configure a graph operation by performing calibration for uniform quantization.
 
         Args:
             quantized_op (QuantizedOp): Quantized graph operator instance
-            *calibration_data (numpy.ndarray): tuple of network input tensors to be used for
+            *calibration_data (CalibrationDataType): tuple of network input tensors to be used for
                 calibration
             quantizers (List[Optional[UniformQuantizer]]): a list of quantizers that
                 should produce the quantized values used in calibration. If none are given,
@@ -926,7 +1331,7 @@ class PostTrainingAffineQuantization(ONNXConverter):
                 quantization parameters
 
         Returns:
-            numpy.ndarray: calibration data for the following operators
+            CalibrationDataType: calibration data for the following operators
         """
 
         # Fast calibration can only be enabled in special cases such as a module with
@@ -984,7 +1389,7 @@ class PostTrainingAffineQuantization(ONNXConverter):
 
     def _get_input_quant_opts(
         self,
-        values: Tuple[ONNXOpInputOutputType, ...],
+        values: Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...],
         quantized_op_class: Type["QuantizedOp"],
     ):
         """Construct a quantization options set for the input of a layer.
@@ -992,14 +1397,17 @@ class PostTrainingAffineQuantization(ONNXConverter):
         Inputs and activations require signed quantization.
 
         Args:
-            values (Tuple[ONNXOpInputOutputType, ...]): calibration data for this op
+            values (Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...]): calibration
+                data for this op
             quantized_op_class (Type["QuantizedOp"]): The quantized operator's class
 
         Returns:
             QuantizationOptions: quantization options set, specific to the network conversion method
         """
-        is_signed = any(v.min() < 0 for v in values if isinstance(v, numpy.ndarray)) or any(
-            v.values.min() < 0 for v in values if isinstance(v, QuantizedArray)
+        is_signed = (
+            any(v.min() < 0 for v in values if isinstance(v, numpy.ndarray))
+            or any(v.values.min() < 0 for v in values if isinstance(v, QuantizedArray))
+            or any(v.rmin < 0 for v in values if isinstance(v, BatchedCalibrationData))
         )
 
         # Some operators need to quantize their inputs using model_outputs instead of op_inputs in
@@ -1059,15 +1467,15 @@ class PostTrainingQATImporter(ONNXConverter):
     def _process_layer(
         self,
         quantized_op: QuantizedOp,
-        *calibration_data: numpy.ndarray,
+        *calibration_data: CalibrationDataType,
         quantizers: List[Optional[UniformQuantizer]],
         fast_calibration: bool = False,
-    ) -> Tuple[numpy.ndarray, Optional[UniformQuantizer]]:
+    ) -> Tuple[CalibrationDataType, Optional[UniformQuantizer]]:
         """Configure a graph operation by calibrating it for Quantization Aware Training.
 
         Args:
             quantized_op (QuantizedOp): Quantized graph operator instance
-            *calibration_data (numpy.ndarray): tuple of network input tensors to be used for
+            *calibration_data (CalibrationDataType): tuple of network input tensors to be used for
                 calibration
             quantizers (List[Optional[UniformQuantizer]]): a list of quantizers that
                 should produce the quantized values used in calibration. If none are given,
@@ -1079,7 +1487,7 @@ class PostTrainingQATImporter(ONNXConverter):
                 quantization parameters
 
         Returns:
-            numpy.ndarray: calibration data for the following operators
+            CalibrationDataType: calibration data for the following operators
         """
 
         return self._calibrate_layers_activation(
@@ -1124,7 +1532,7 @@ class PostTrainingQATImporter(ONNXConverter):
 
     def _get_input_quant_opts(
         self,
-        values: Tuple[ONNXOpInputOutputType, ...],
+        values: Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...],
         quantized_op_class: Type["QuantizedOp"],
     ):
         """Construct a quantization options set for the input of a layer of a QAT network.
@@ -1133,7 +1541,8 @@ class PostTrainingQATImporter(ONNXConverter):
         (such as Gemm/Conv/Add).
 
         Args:
-            values (Tuple[ONNXOpInputOutputType, ...]): calibration data for this op
+            values (Tuple[Union[ONNXOpInputOutputType, BatchedCalibrationData], ...]): calibration
+                data for this op
             quantized_op_class (Type["QuantizedOp"]): The quantized operator's class
 
         Returns:
@@ -0,0 +1,434 @@
+"""Per-layer profiling and FHE latency estimation of quantized modules.
+
+The latency of FHE circuits is dominated by their programmable bootstrapping (PBS) operations,
+whose cost mostly depends on the bit-width of their inputs. Tracing a module gives the bit-width of
+each of its operations in a small fraction of the compilation time, from which the number of PBS
+per bit-width of each layer is known. Combined with a table of measured PBS costs, this gives an
+estimation of each layer's latency before compiling the module.
+
+The cost table is built by a micro-benchmark, which compiles and runs circuits made of a given
+number of PBS for each bit-width. It only needs to be calibrated once per machine and device, and
+can be saved and loaded as JSON.
+"""
+
+import json
+import re
+import time
+from pathlib import Path
+from typing import Any, Dict, Iterable, Optional, Union
+
+import numpy
+from concrete.fhe import univariate
+from concrete.fhe.compilation.compiler import Compiler
+from concrete.fhe.compilation.configuration import Configuration
+from concrete.fhe.dtypes import Integer
+from concrete.fhe.representation import Graph, Node
+
+from ..common.debugging import assert_true
+from ..common.utils import (
+    check_compilation_device_is_valid_and_is_cuda,
+    manage_parameters_for_pbs_errors,
+)
+from .quantized_module import QuantizedModule
+
+# Name of the profile entry gathering the PBS that are not tagged with any layer's name
+UNTAGGED_LAYER_NAME = "<untagged>"
+
+
+def get_pbs_input_bit_width(graph: Graph, node: Node) -> Optional[int]:
+    """Get the bit-width of the encrypted input of a node evaluated as a PBS.
+
+    Args:
+        graph (Graph): The graph the node belongs to.
+        node (Node): The node.
+
+    Returns:
+        Optional[int]: The largest bit-width of the node's encrypted integer inputs, or None if the
+            node is not evaluated as a PBS.
+    """
+    if not node.converted_to_table_lookup:
+        return None
+
+    bit_widths = [
+        pred.output.dtype.bit_width
+        for pred in graph.ordered_preds_of(node)
+        if pred.output.is_encrypted and isinstance(pred.output.dtype, Integer)
+    ]
+
+    return max(bit_widths) if bit_widths else None
+
+
+def get_pbs_count_per_bit_width(
+    graph: Graph, tag_pattern: Optional[re.Pattern] = None
+) -> Dict[int, int]:
+    """Count the PBS operations of a graph for each input bit-width.
+
+    Args:
+        graph (Graph): The traced or compiled graph.
+        tag_pattern (Optional[re.Pattern]): If given, only the nodes whose tag fully matches this
+            pattern are counted. Default to None.
+
+    Returns:
+        Dict[int, int]: The number of PBS operations, by bit-width of their encrypted inputs.
+    """
+    pbs_count_per_bit_width: Dict[int, int] = {}
+
+    for node in graph.graph.nodes:
+        if tag_pattern is not None and tag_pattern.fullmatch(node.tag) is None:
+            continue
+
+        bit_width = get_pbs_input_bit_width(graph, node)
+        if bit_width is None:
+            continue
+
+        pbs_count_per_bit_width[bit_width] = pbs_count_per_bit_width.get(bit_width, 0) + int(
+            numpy.prod(node.output.shape, dtype=numpy.int64)
+        )
+
+    return dict(sorted(pbs_count_per_bit_width.items()))
+
+
+def _get_pbs_circuit(max_value: int):
+    """Get a function applying a PBS on each of its inputs, for the cost micro-benchmark.
+
+    Args:
+        max_value (int): The largest input value, which sets the PBS input bit-width.
+
+    Returns:
+        Callable: The function to compile.
+    """
+
+    def pbs_circuit(x):
+        """Apply a PBS on each input value.
+
+        Args:
+            x: The encrypted input values.
+
+        Returns:
+            The encrypted output values.
+        """
+        return univariate(lambda value: max_value - value)(x)
+
+    return pbs_circuit
+
+
+class PBSCostTable:
+    """Measured duration of a single PBS, for each device and input bit-width.
+
+    Args:
+        costs (Optional[Dict[str, Dict[int, float]]]): The duration of a PBS in seconds, by device
+            and bit-width. Default to None, which creates an empty table to calibrate.
+    """
+
+    def __init__(self, costs: Optional[Dict[str, Dict[int, float]]] = None):
+        self.costs: Dict[str, Dict[int, float]] = {
+            device: dict(sorted((int(bit_width), cost) for bit_width, cost in device_costs.items()))
+            for device, device_costs in (costs or {}).items()
+        }
+
+    @property
+    def devices(self):
+        """Get the calibrated devices.
+
+        Returns:
+            List[str]: The devices for which PBS costs are known.
+        """
+        return list(self.costs)
+
+    # pylint: disable-next=too-many-arguments
+    def calibrate(
+        self,
+        bit_widths: Iterable[int] = range(1, 9),
+        device: str = "cpu",
+        n_pbs: int = 64,
+        n_repetitions: int = 3,
+        p_error: Optional[float] = None,
+        configuration: Optional[Configuration] = None,
+    ) -> "PBSCostTable":
+        """Measure the duration of a PBS for the given bit-widths and device.
+
+        For each bit-width, a circuit applying `n_pbs` PBS in parallel is compiled and executed
+        `n_repetitions` times. The fastest execution is kept, divided by the number of PBS, so that
+        the cost accounts for the parallel execution of the PBS within a layer.
+
+        Args:
+            bit_widths (Iterable[int]): The bit-widths to calibrate. Default to 1 to 8.
+            device (str): The FHE compilation device, either 'cpu' or 'cuda'. Default to 'cpu'.
+            n_pbs (int): The number of PBS in each measured circuit. Default to 64.
+            n_repetitions (int): The number of measured executions. Default to 3.
+            p_error (Optional[float]): The probability of error of a single PBS. Default to None,
+                which sets Concrete ML's default value.
+            configuration (Optional[Configuration]): Options to use for compilation. Default to
+                None.
+
+        Returns:
+            PBSCostTable: The table, updated with the measured costs.
+        """
+        assert_true(
+            n_pbs > 0 and n_repetitions > 0,
+            "Parameters 'n_pbs' and 'n_repetitions' must be strictly positive integers. Got "
+            f"{n_pbs} and {n_repetitions}",
+            ValueError,
+        )
+
+        use_gpu = check_compilation_device_is_valid_and_is_cuda(device)
+        p_error, global_p_error = manage_parameters_for_pbs_errors(p_error, None)
+
+        device_costs = self.costs.setdefault(device, {})
+
+        for bit_width in bit_widths:
+            max_value = 2**bit_width - 1
+
+            compiler = Compiler(_get_pbs_circuit(max_value), {"x": "encrypted"})
+            inputset = [
+                numpy.full((n_pbs,), value, dtype=numpy.int64) for value in (0, max_value)
+            ]
+            circuit = compiler.compile(
+                inputset,
+                configuration=configuration,
+                p_error=p_error,
+                global_p_error=global_p_error,
+                single_precision=False,
+                use_gpu=use_gpu,
+            )
+            circuit.keygen(force=False)
+
+            encrypted_input = circuit.encrypt(numpy.zeros((n_pbs,), dtype=numpy.int64))
+
+            durations = []
+            for _ in range(n_repetitions):
+                start = time.perf_counter()
+                circuit.run(encrypted_input)
+                durations.append(time.perf_counter() - start)
+
+            device_costs[bit_width] = min(durations) / n_pbs
+
+        self.costs[device] = dict(sorted(device_costs.items()))
+
+        return self
+
+    def get_cost(self, device: str, bit_width: int) -> float:
+        """Get the duration of a PBS.
+
+        Bit-widths that were not calibrated take the cost of the closest larger calibrated one, or
+        of the largest one if none is larger, which then under-estimates the cost.
+
+        Args:
+            device (str): The device.
+            bit_width (int): The PBS input bit-width.
+
+        Returns:
+            float: The duration of a PBS, in seconds.
+
+        Raises:
+            ValueError: If the device is not calibrated.
+        """
+        if not self.costs.get(device):
+            raise ValueError(
+                f"No PBS costs are calibrated for device '{device}'. Please call 'calibrate' "
+                f"first. Calibrated devices are: {self.devices}"
+            )
+
+        device_costs = self.costs[device]
+        larger_bit_widths = [calibrated for calibrated in device_costs if calibrated >= bit_width]
+
+        return device_costs[min(larger_bit_widths) if larger_bit_widths else max(device_costs)]
+
+    def estimate_latency(self, pbs_count_per_bit_width: Dict[int, int], device: str) -> float:
+        """Estimate the duration of a set of PBS.
+
+        Args:
+            pbs_count_per_bit_width (Dict[int, int]): The number of PBS, by input bit-width.
+            device (str): The device.
+
+        Returns:
+            float: The estimated duration, in seconds.
+        """
+        return sum(
+            count * self.get_cost(device, bit_width)
+            for bit_width, count in pbs_count_per_bit_width.items()
+        )
+
+    def save(self, path: Union[str, Path]):
+        """Save the table as JSON.
+
+        Args:
+            path (Union[str, Path]): The file to write.
+        """
+        with open(path, "w", encoding="utf-8") as file:
+            json.dump(self.costs, file, indent=4)
+
+    @classmethod
+    def load(cls, path: Union[str, Path]) -> "PBSCostTable":
+        """Load a table saved as JSON.
+
+        Args:
+            path (Union[str, Path]): The file to read.
+
+        Returns:
+            PBSCostTable: The loaded table.
+        """
+        with open(path, "r", encoding="utf-8") as file:
+            return cls(json.load(file))
+
+
+def measure_fhe_latency(quantized_module: QuantizedModule, fhe_inputs: numpy.ndarray) -> float:
+    """Measure the average latency of a compiled module executed in FHE.
+
+    The keys are generated beforehand, so that they are not part of the measured latency.
+
+    Args:
+        quantized_module (QuantizedModule): The compiled quantized module.
+        fhe_inputs (numpy.ndarray): Inputs on which the module is executed in FHE.
+
+    Returns:
+        float: The average execution time of a single input, in seconds.
+
+    Raises:
+        ValueError: If the module is not compiled.
+    """
+    assert_true(
+        quantized_module.is_compiled,
+        "The module needs to be compiled before measuring its latency in FHE.",
+        ValueError,
+    )
+    assert quantized_module.fhe_circuit is not None
+    quantized_module.fhe_circuit.keygen(force=False)
+
+    start = time.perf_counter()
+    quantized_module.forward(fhe_inputs, fhe="execute")
+    return (time.perf_counter() - start) / fhe_inputs.shape[0]
+
+
+def profile_quantized_module(
+    quantized_module: QuantizedModule,
+    inputs: Optional[numpy.ndarray] = None,
+    cost_table: Optional[PBSCostTable] = None,
+    configuration: Optional[Configuration] = None,
+    fhe_inputs: Optional[numpy.ndarray] = None,
+) -> Dict[str, Dict[str, Any]]:
+    """Profile the PBS count, accumulator bit-width and latency of each layer of a module.
+
+    If the module is compiled, the profile is based on its circuit's graph. Otherwise, the module is
+    traced on the given input-set, which does not compile it.
+
+    A compiled circuit is executed as a single program, in which the PBS of consecutive layers can
+    run at the same time, so that layers can't be timed individually. When `fhe_inputs` are given,
+    only the circuit's total latency is measured, using `measure_fhe_latency`. It is then
+    attributed to the layers in proportion to their estimated latencies, or to their number of PBS
+    if no cost table is given.
+
+    Args:
+        quantized_module (QuantizedModule): The quantized module.
+        inputs (Optional[numpy.ndarray]): The input-set to trace the module with. Only used if the
+            module is not compiled. Default to None.
+        cost_table (Optional[PBSCostTable]): The PBS costs used to estimate the layers' latency on
+            each of their calibrated devices. Default to None, which only counts the PBS.
+        configuration (Optional[Configuration]): Options to use for tracing. Default to None.
+        fhe_inputs (Optional[numpy.ndarray]): Inputs on which the compiled module is executed in
+            FHE, in order to measure its total latency. Default to None.
+
+    Returns:
+        Dict[str, Dict[str, Any]]: The profile of each layer that mixes encrypted values or
+            applies PBS, by name, with the following entries:
+            - "op_type": the layer's quantized op class name
+            - "accumulator_bit_width": the largest bit-width of the layer's integer values
+            - "pbs_count": the layer's number of PBS
+            - "pbs_count_per_bit_width": the layer's number of PBS, by input bit-width
+            - "estimated_latency": the estimated latency in seconds, by calibrated device
+            - "attributed_latency": the layer's share of the measured total latency in seconds,
+                which is not a measurement of the layer itself, only if `fhe_inputs` were given
+
+    Raises:
+        ValueError: If the module is not compiled and no inputs are given, or if `fhe_inputs` are
+            given for a module that is not compiled.
+    """
+    if quantized_module.is_compiled:
+        assert quantized_module.fhe_circuit is not None
+        graph = quantized_module.fhe_circuit.graph
+    else:
+        assert_true(
+            inputs is not None,
+            "An input-set is needed for profiling a module that is not compiled.",
+            ValueError,
+        )
+        assert_true(
+            fhe_inputs is None,
+            "The module needs to be compiled before measuring its latency in FHE.",
+            ValueError,
+        )
+        assert inputs is not None
+        graph = quantized_module.trace(inputs, configuration=configuration)
+
+    profile: Dict[str, Dict[str, Any]] = {}
+    layer_patterns = {}
+
+    for _, layer in quantized_module.quant_layers_dict.values():
+        # As in `bitwidth_and_range_report`, a layer's nodes are tagged with its name, possibly
+        # followed by sub-tags starting with a period
+        pattern = re.compile(re.escape(layer.op_instance_name) + "(\\..*)?")
+        layer_patterns[layer.op_instance_name] = pattern
+
+        bit_width = graph.maximum_integer_bit_width(pattern)
+        pbs_count_per_bit_width = get_pbs_count_per_bit_width(graph, pattern)
+
+        # Fused layers do not have tags
+        if bit_width < 0 and not pbs_count_per_bit_width:
+            continue
+
+        profile[layer.op_instance_name] = {
+            "op_type": type(layer).__name__,
+            "accumulator_bit_width": bit_width if bit_width >= 0 else None,
+            "pbs_count_per_bit_width": pbs_count_per_bit_width,
+        }
+
+    # PBS tagged with none of the layers' names, for example those computing fused activations
+    untagged_pbs_count_per_bit_width: Dict[int, int] = {}
+    for node in graph.graph.nodes:
+        bit_width = get_pbs_input_bit_width(graph, node)
+        if bit_width is None or any(
+            pattern.fullmatch(node.tag) for pattern in layer_patterns.values()
+        ):
+            continue
+
+        untagged_pbs_count_per_bit_width[bit_width] = untagged_pbs_count_per_bit_width.get(
+            bit_width, 0
+        ) + int(numpy.prod(node.output.shape, dtype=numpy.int64))
+
+    if untagged_pbs_count_per_bit_width:
+        profile[UNTAGGED_LAYER_NAME] = {
+            "op_type": None,
+            "accumulator_bit_width": None,
+            "pbs_count_per_bit_width": dict(sorted(untagged_pbs_count_per_bit_width.items())),
+        }
+
+    for layer_profile in profile.values():
+        layer_profile["pbs_count"] = sum(layer_profile["pbs_count_per_bit_width"].values())
+        layer_profile["estimated_latency"] = {}
+
+        if cost_table is not None:
+            for device in cost_table.devices:
+                layer_profile["estimated_latency"][device] = cost_table.estimate_latency(
+                    layer_profile["pbs_count_per_bit_width"], device
+                )
+
+    if fhe_inputs is not None:
+        measured_latency = measure_fhe_latency(quantized_module, fhe_inputs)
+
+        device = "cuda" if quantized_module._compiled_for_cuda else "cpu"  # pylint: disable=W0212
+        weights = {
+            name: (
+                layer_profile["estimated_latency"][device]
+                if device in layer_profile["estimated_latency"]
+                else layer_profile["pbs_count"]
+            )
+            for name, layer_profile in profile.items()
+        }
+        total_weight = sum(weights.values())
+
+        for name, layer_profile in profile.items():
+            layer_profile["attributed_latency"] = (
+                measured_latency * weights[name] / total_weight if total_weight > 0 else 0.0
+            )
+
+    return profile
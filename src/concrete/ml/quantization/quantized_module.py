@@ -3,8 +3,21 @@
 import copy
 import os
 import re
-from functools import partial
-from typing import Any, Dict, Generator, Iterable, List, Optional, Sequence, TextIO, Tuple, Union
+from collections import Counter
+from typing import (
+    TYPE_CHECKING,
+    Any,
+    Dict,
+    Generator,
+    Iterable,
+    List,
+    Optional,
+    Sequence,
+    TextIO,
+    Tuple,
+    Union,
+    cast,
+)
 
 import numpy
 import onnx
@@ -12,13 +25,19 @@ from concrete.fhe.compilation.artifacts import DebugArtifacts
 from concrete.fhe.compilation.circuit import Circuit
 from concrete.fhe.compilation.compiler import Compiler
 from concrete.fhe.compilation.configuration import Configuration
+from concrete.fhe.representation import Graph
 
+from ..common.batch_executor import (
+    BatchExecutor,
+    get_fhe_execution_device,
+    get_fhe_predict_method,
+)
 from ..common.debugging import assert_true
+from ..common.instrumentation import measure_stage
 from ..common.serialization.dumpers import dump, dumps
 from ..common.utils import (
     SUPPORTED_FLOAT_TYPES,
     SUPPORTED_INT_TYPES,
-    USE_OLD_VL,
     FheMode,
     all_values_are_floats,
     all_values_are_integers,
@@ -34,6 +53,11 @@ from .base_quantized_op import ONNXOpInputOutputType, QuantizedOp
 from .quantized_ops import QuantizedReduceSum
 from .quantizers import QuantizedArray, UniformQuantizer
 
+# The compilation cache stores quantized modules, it is only imported for type checking in order
+# to avoid circular imports
+if TYPE_CHECKING:  # pragma: no cover
+    from ..deployment.compilation_cache import CompilationCache
+
 
 def _raise_qat_import_error(bad_qat_ops: List[Tuple[str, str]]):
     """Raise a descriptive error if any invalid ops are present in the ONNX graph.
@@ -136,6 +160,10 @@ class QuantizedModule:
         self._is_compiled = False
         self._compiled_for_cuda = False
         self._onnx_model = onnx_model
+
+        # The executor used for running batches of samples in FHE or with simulation. It is not
+        # serialized as it only describes how the circuit is executed on the current machine
+        self.fhe_executor = BatchExecutor()
         self._post_processing_params: Dict[str, Any] = {}
 
         # Initialize output quantizers based on quant_layers_dict
@@ -411,6 +439,7 @@ class QuantizedModule:
         *x: numpy.ndarray,
         fhe: Union[FheMode, str] = FheMode.DISABLE,
         debug: bool = False,
+        fhe_executor: Optional[BatchExecutor] = None,
     ) -> Union[
         numpy.ndarray,
         Tuple[numpy.ndarray, ...],
@@ -438,6 +467,9 @@ class QuantizedModule:
                 as values, their input QuantizedArray or ndarray. The use can thus extract the
                 quantized or float values of quantized inputs. This feature is only available in
                 FheMode.DISABLE mode. Default to False.
+            fhe_executor (Optional[BatchExecutor]): The executor to use for running the samples in
+                FHE or with simulation. If None, the executor set at compilation is used. Default
+                to None.
 
         Returns:
             numpy.ndarray: Predictions of the quantized model, in floating points.
@@ -462,7 +494,8 @@ class QuantizedModule:
         )
 
         # Quantized the input values
-        q_x = to_tuple(self.quantize_input(*x))
+        with measure_stage("module.quantize"):
+            q_x = to_tuple(self.quantize_input(*x))
 
         if debug and fhe == "disable":
             debug_value_tracker: Dict[
@@ -477,14 +510,19 @@ class QuantizedModule:
             y_pred = self.dequantize_output(*to_tuple(q_y_pred))
             return y_pred, debug_value_tracker
 
-        q_y_pred = self.quantized_forward(*q_x, fhe=fhe)
+        with measure_stage("module.inference", fhe=str(fhe)):
+            q_y_pred = self.quantized_forward(*q_x, fhe=fhe, fhe_executor=fhe_executor)
 
         # De-quantize the output predicted values
-        y_pred = self.dequantize_output(*to_tuple(q_y_pred))
+        with measure_stage("module.dequantize"):
+            y_pred = self.dequantize_output(*to_tuple(q_y_pred))
         return y_pred
 
     def quantized_forward(
-        self, *q_x: numpy.ndarray, fhe: Union[FheMode, str] = FheMode.DISABLE
+        self,
+        *q_x: numpy.ndarray,
+        fhe: Union[FheMode, str] = FheMode.DISABLE,
+        fhe_executor: Optional[BatchExecutor] = None,
     ) -> Union[Tuple[numpy.ndarray, ...], numpy.ndarray]:
         """Forward function for the FHE circuit.
 
@@ -494,6 +532,9 @@ class QuantizedModule:
                 Concrete ML Python inference, FheMode.SIMULATE for FHE simulation and
                 FheMode.EXECUTE for actual FHE execution. Can also be the string representation of
                 any of these values. Default to FheMode.DISABLE.
+            fhe_executor (Optional[BatchExecutor]): The executor to use for running the samples in
+                FHE or with simulation. If None, the executor set at compilation is used. Default
+                to None.
 
         Returns:
             (Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]): Predictions of the quantized model,
@@ -520,7 +561,7 @@ class QuantizedModule:
         if fhe == "disable":
             return self._clear_forward(*q_x)
         simulate = fhe == "simulate"
-        return self._fhe_forward(*q_x, simulate=simulate)
+        return self._fhe_forward(*q_x, simulate=simulate, fhe_executor=fhe_executor)
 
     def _clear_forward(
         self, *q_x: numpy.ndarray
@@ -555,6 +596,14 @@ class QuantizedModule:
             zip(self.ordered_module_input_names, q_inputs)
         )
 
+        # Count the number of layers that use each intermediate result, in order to release it
+        # as soon as it is not needed anymore
+        n_remaining_uses = Counter(
+            input_name
+            for input_names, _ in self.quant_layers_dict.values()
+            for input_name in input_names
+        )
+
         bad_qat_ops: List[Tuple[str, str]] = []
         for output_name, (input_names, layer) in self.quant_layers_dict.items():
             inputs = (layer_results.get(input_name, None) for input_name in input_names)
@@ -572,6 +621,14 @@ class QuantizedModule:
 
             layer_results[output_name] = output
 
+            for input_name in input_names:
+                n_remaining_uses[input_name] -= 1
+                if (
+                    n_remaining_uses[input_name] == 0
+                    and input_name not in self.ordered_module_output_names
+                ):
+                    layer_results.pop(input_name, None)
+
         if len(bad_qat_ops) > 0:
             _raise_qat_import_error(bad_qat_ops)
 
@@ -633,7 +690,10 @@ class QuantizedModule:
         return q_results
 
     def _fhe_forward(
-        self, *q_x: numpy.ndarray, simulate: bool = True
+        self,
+        *q_x: numpy.ndarray,
+        simulate: bool = True,
+        fhe_executor: Optional[BatchExecutor] = None,
     ) -> Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]:
         """Forward function executed in FHE or with simulation.
 
@@ -641,6 +701,8 @@ class QuantizedModule:
             *q_x (numpy.ndarray): Input integer values to consider.
             simulate (bool): Whether the function should be run in FHE or in simulation mode.
                 Default to True.
+            fhe_executor (Optional[BatchExecutor]): The executor to use for running the samples.
+                If None, the executor set at compilation is used. Default to None.
 
         Returns:
             (Union[numpy.ndarray, Tuple[numpy.ndarray, ...]]): Predictions of the quantized model,
@@ -654,49 +716,30 @@ class QuantizedModule:
             "The quantized module is not compiled. Please run compile(...) first before "
             "executing it in FHE.",
         )
-        q_result_by_output: List[List[numpy.ndarray]] = [[] for _ in self.output_quantizers]
-        for i in range(q_x[0].shape[0]):
-
-            # Extract example i from every element in the tuple q_x
-            q_input = tuple(q_x[input][[i]] for input in range(len(q_x)))
-
-            # For mypy
-            assert self.fhe_circuit is not None
-
-            # If the inference should be executed using simulation
-            if simulate:
-                is_crt_encoding = self.fhe_circuit.statistics["packing_key_switch_count"] != 0
-
-                # If the virtual library method should be used
-                # For now, use the virtual library when simulating
-                # circuits that use CRT  encoding because the official simulation is too slow
-                # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4391
-                if USE_OLD_VL or is_crt_encoding:
-                    predict_method = partial(
-                        self.fhe_circuit.graph, p_error=self.fhe_circuit.p_error
-                    )  # pragma: no cover
-
-                # Else, use the official simulation method
-                else:
-                    predict_method = self.fhe_circuit.simulate
-
-            # Else, use the FHE execution method
-            else:
-                predict_method = self.fhe_circuit.encrypt_run_decrypt
-
-            # Execute the forward pass in FHE or with simulation
-            q_result = to_tuple(predict_method(*q_input))
-
-            assert len(q_result) == len(q_result_by_output), (
-                "Number of outputs does not match the number of output quantizers.\n"
-                f"{len(q_result)=}!={len(self.output_quantizers)=}"
-            )
-            for elt_index, elt in enumerate(q_result):
-                q_result_by_output[elt_index].append(elt)
 
-        q_results: Tuple[numpy.ndarray, ...] = tuple(
-            numpy.concatenate(elt, axis=0) for elt in q_result_by_output
+        # For mypy
+        assert self.fhe_circuit is not None
+
+        fhe = FheMode.SIMULATE if simulate else FheMode.EXECUTE
+
+        # Resolve the execution method once for the whole batch
+        predict_method = get_fhe_predict_method(self.fhe_circuit, fhe)
+
+        if fhe_executor is None:
+            fhe_executor = self.fhe_executor
+
+        # Execute the forward pass in FHE or with simulation
+        q_results = fhe_executor.run(
+            predict_method,
+            *q_x,
+            device=get_fhe_execution_device(self._compiled_for_cuda, fhe),
+        )
+
+        assert len(q_results) == len(self.output_quantizers), (
+            "Number of outputs does not match the number of output quantizers.\n"
+            f"{len(q_results)=}!={len(self.output_quantizers)=}"
         )
+
         if len(q_results) == 1:
             return q_results[0]
         return q_results
@@ -794,44 +837,21 @@ class QuantizedModule:
         self.input_quantizers.clear()
         self.input_quantizers.extend(copy.deepcopy(q_params) for q_params in input_q_params)
 
-    def compile(
+    def _get_compiler_and_inputset(
         self,
         inputs: Union[Tuple[numpy.ndarray, ...], numpy.ndarray],
-        configuration: Optional[Configuration] = None,
-        artifacts: Optional[DebugArtifacts] = None,
-        show_mlir: bool = False,
-        p_error: Optional[float] = None,
-        global_p_error: Optional[float] = None,
-        verbose: bool = False,
         inputs_encryption_status: Optional[Sequence[str]] = None,
-        device: str = "cpu",
-    ) -> Circuit:
-        """Compile the module's forward function.
+    ) -> Tuple[Compiler, Generator]:
+        """Build the compiler of the module's forward function and its quantized input-set.
 
         Args:
             inputs (numpy.ndarray): A representative set of input values used for building
                 cryptographic parameters.
-            configuration (Optional[Configuration]): Options to use for compilation. Default
-                to None.
-            artifacts (Optional[DebugArtifacts]): Artifacts information about the
-                compilation process to store for debugging.
-            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
-            p_error (Optional[float]): Probability of error of a single PBS. A p_error value cannot
-                be given if a global_p_error value is already set. Default to None, which sets this
-                error to a default value.
-            global_p_error (Optional[float]): Probability of error of the full circuit. A
-                global_p_error value cannot be given if a p_error value is already set. This feature
-                is not supported during simulation, meaning the probability is
-                currently set to 0. Default to None, which sets this
-                error to a default value.
-            verbose (bool): Indicate if compilation information should be printed
-                during compilation. Default to False.
             inputs_encryption_status (Optional[Sequence[str]]): encryption status ('clear',
                 'encrypted') for each input.
-            device: FHE compilation device, can be either 'cpu' or 'cuda'.
 
         Returns:
-            Circuit: The compiled Circuit.
+            Tuple[Compiler, Generator]: The compiler and the generator of quantized inputs.
 
         Raises:
             ValueError: if inputs_encryption_status does not match with the
@@ -909,10 +929,102 @@ class QuantizedModule:
         # is None
         inputset = _get_inputset_generator(q_inputs)  # type: ignore[arg-type]
 
+        return compiler, inputset
+
+    def trace(
+        self,
+        inputs: Union[Tuple[numpy.ndarray, ...], numpy.ndarray],
+        configuration: Optional[Configuration] = None,
+        inputs_encryption_status: Optional[Sequence[str]] = None,
+    ) -> Graph:
+        """Trace the module's forward function without compiling it.
+
+        Tracing evaluates the bit-width of each operation on the input-set, which takes a small
+        fraction of the compilation time. The cryptographic parameters are not selected.
+
+        Args:
+            inputs (numpy.ndarray): A representative set of input values.
+            configuration (Optional[Configuration]): Options to use for tracing. Default to None.
+            inputs_encryption_status (Optional[Sequence[str]]): encryption status ('clear',
+                'encrypted') for each input.
+
+        Returns:
+            Graph: The traced computation graph.
+        """
+        compiler, inputset = self._get_compiler_and_inputset(inputs, inputs_encryption_status)
+
+        with measure_stage("module.trace"):
+            return compiler.trace(inputset, configuration=configuration)
+
+    def compile(
+        self,
+        inputs: Union[Tuple[numpy.ndarray, ...], numpy.ndarray],
+        configuration: Optional[Configuration] = None,
+        artifacts: Optional[DebugArtifacts] = None,
+        show_mlir: bool = False,
+        p_error: Optional[float] = None,
+        global_p_error: Optional[float] = None,
+        verbose: bool = False,
+        inputs_encryption_status: Optional[Sequence[str]] = None,
+        device: str = "cpu",
+        fhe_executor: Optional[BatchExecutor] = None,
+        compilation_cache: Optional["CompilationCache"] = None,
+    ) -> Circuit:
+        """Compile the module's forward function.
+
+        If a compilation cache is given and already holds the module's compiled artifacts, the
+        circuit is loaded from them without compiling the module. Otherwise, the module is
+        compiled and its artifacts are stored in the cache.
+
+        Args:
+            inputs (numpy.ndarray): A representative set of input values used for building
+                cryptographic parameters.
+            configuration (Optional[Configuration]): Options to use for compilation. Default
+                to None.
+            artifacts (Optional[DebugArtifacts]): Artifacts information about the
+                compilation process to store for debugging.
+            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
+            p_error (Optional[float]): Probability of error of a single PBS. A p_error value cannot
+                be given if a global_p_error value is already set. Default to None, which sets this
+                error to a default value.
+            global_p_error (Optional[float]): Probability of error of the full circuit. A
+                global_p_error value cannot be given if a p_error value is already set. This feature
+                is not supported during simulation, meaning the probability is
+                currently set to 0. Default to None, which sets this
+                error to a default value.
+            verbose (bool): Indicate if compilation information should be printed
+                during compilation. Default to False.
+            inputs_encryption_status (Optional[Sequence[str]]): encryption status ('clear',
+                'encrypted') for each input.
+            device: FHE compilation device, can be either 'cpu' or 'cuda'.
+            fhe_executor (Optional[BatchExecutor]): The executor to use by default for running
+                batches of samples in FHE or with simulation. If None, the current executor is
+                kept, which runs samples sequentially unless set otherwise. Default to None.
+            compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+                from, or to store it in. Default to None.
+
+        Returns:
+            Circuit: The compiled Circuit, or the `CachedCircuit` loaded from the cache.
+        """
+        compiler, inputset = self._get_compiler_and_inputset(inputs, inputs_encryption_status)
+
         # Check that p_error or global_p_error is not set in both the configuration and in the
         # direct parameters
         check_there_is_no_p_error_options_in_configuration(configuration)
 
+        # The key is computed on the given parameters, as done by the cache's `compile_and_save`
+        cache_key = None
+        if compilation_cache is not None:
+            cache_key = compilation_cache.get_key(
+                self,
+                inputs,
+                configuration=configuration,
+                p_error=p_error,
+                global_p_error=global_p_error,
+                inputs_encryption_status=inputs_encryption_status,
+                device=device,
+            )
+
         # Find the right way to set parameters for compiler, depending on the way we want to default
         p_error, global_p_error = manage_parameters_for_pbs_errors(p_error, global_p_error)
 
@@ -922,23 +1034,44 @@ class QuantizedModule:
         enable_input_compression = os.environ.get("USE_INPUT_COMPRESSION", "1") == "1"
         enable_key_compression = os.environ.get("USE_KEY_COMPRESSION", "1") == "1"
 
-        self.fhe_circuit = compiler.compile(
-            inputset,
-            configuration=configuration,
-            artifacts=artifacts,
-            show_mlir=show_mlir,
-            p_error=p_error,
-            global_p_error=global_p_error,
-            verbose=verbose,
-            single_precision=False,
-            use_gpu=use_gpu,
-            compress_input_ciphertexts=enable_input_compression,
-            compress_evaluation_keys=enable_key_compression,
-        )
+        compilation_options: Dict[str, Any] = {
+            "show_mlir": show_mlir,
+            "p_error": p_error,
+            "global_p_error": global_p_error,
+            "verbose": verbose,
+            "single_precision": False,
+            "use_gpu": use_gpu,
+            "compress_input_ciphertexts": enable_input_compression,
+            "compress_evaluation_keys": enable_key_compression,
+        }
+
+        cached_circuit = None
+        if compilation_cache is not None:
+            assert cache_key is not None
+            cached_circuit = compilation_cache.load_circuit(
+                cache_key,
+                lambda: compiler.trace(inputset, configuration=configuration),
+                (configuration or Configuration()).fork(**compilation_options),
+            )
+
+        if cached_circuit is not None:
+            # The cached circuit provides the same interface as the compiled one
+            self.fhe_circuit = cast(Circuit, cached_circuit)
+        else:
+            self.fhe_circuit = compiler.compile(
+                inputset, configuration=configuration, artifacts=artifacts, **compilation_options
+            )
 
         self._is_compiled = True
         self._compiled_for_cuda = use_gpu
 
+        if compilation_cache is not None and cached_circuit is None:
+            assert cache_key is not None
+            compilation_cache.put(cache_key, self)
+
+        if fhe_executor is not None:
+            self.fhe_executor = fhe_executor
+
         return self.fhe_circuit
 
     def bitwidth_and_range_report(
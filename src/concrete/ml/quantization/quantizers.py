@@ -758,13 +758,16 @@ class QuantizedArray:
         stats (Optional[MinMaxQuantizationStats]): Quantization batch statistics set
         params (Optional[UniformQuantizationParameters]): Quantization parameters set
             (scale, zero-point)
+        lazy (bool): Whether the quantized values of real (float) numpy values should only be
+            computed when they are first read. In this case, the values are not copied and must not
+            be modified afterwards. Defaults to False.
         kwargs: Any member of the options, stats, params sets as a key-value pair. The parameter
             sets need to be completely parametrized if their members appear in kwargs.
     """
 
     quantizer: UniformQuantizer
     values: Union[numpy.ndarray, Tracer]
-    qvalues: Union[numpy.ndarray, Tracer]
+    _qvalues: Optional[Union[numpy.ndarray, Tracer]] = None
 
     def __init__(
         self,
@@ -774,6 +777,7 @@ class QuantizedArray:
         options: Optional[QuantizationOptions] = None,
         stats: Optional[MinMaxQuantizationStats] = None,
         params: Optional[UniformQuantizationParameters] = None,
+        lazy: bool = False,
         **kwargs,
     ):
         # If no options were passed, create a default options structure with the required n_bits
@@ -802,7 +806,26 @@ class QuantizedArray:
         self.quantizer = UniformQuantizer(options, stats, params)
 
         if values is not None:
-            self._values_setup(values, value_is_float, options, stats, params)
+            self._values_setup(values, value_is_float, options, stats, params, lazy)
+
+    @property
+    def qvalues(self) -> Union[numpy.ndarray, Tracer]:
+        """Get the quantized values.
+
+        Returns:
+            Union[numpy.ndarray, Tracer]: Quantized values, computed when first read if the
+                array was built with lazy quantization.
+        """
+        if self._qvalues is None:
+            self.quant()
+
+        # For mypy
+        assert self._qvalues is not None
+        return self._qvalues
+
+    @qvalues.setter
+    def qvalues(self, qvalues: Union[numpy.ndarray, Tracer]):
+        self._qvalues = qvalues
 
     def __eq__(self, other):
         is_equal = other.n_bits == self.n_bits and other.quantizer == self.quantizer
@@ -819,6 +842,7 @@ class QuantizedArray:
         options: Optional[QuantizationOptions] = None,
         stats: Optional[MinMaxQuantizationStats] = None,
         params: Optional[UniformQuantizationParameters] = None,
+        lazy: bool = False,
     ):
         """Set up the values of the quantized array.
 
@@ -830,6 +854,8 @@ class QuantizedArray:
             stats (Optional[MinMaxQuantizationStats]): Quantization batch statistics set
             params (Optional[UniformQuantizationParameters]): Quantization parameters set
                 (scale, zero-point)
+            lazy (bool): Whether real (float) numpy values should be quantized only when the
+                quantized values are first read.
         """
         if value_is_float:
             if isinstance(values, numpy.ndarray):
@@ -839,8 +865,12 @@ class QuantizedArray:
                     f"got {values.dtype}: {values}",
                 )
 
+            # Lazy quantization is only possible on numpy values, as tracing needs the quantization
+            # to be done when the array is built
+            lazy = lazy and isinstance(values, numpy.ndarray)
+
             if isinstance(values, numpy.ndarray):
-                self.values = deepcopy(values)
+                self.values = values if lazy else deepcopy(values)
             elif isinstance(values, Tracer):
                 self.values = values
             else:
@@ -860,7 +890,8 @@ class QuantizedArray:
                 self.quantizer.compute_quantization_parameters(options, self.quantizer.quant_stats)
 
             # Once the quantizer is ready, quantize the float values provided
-            self.quant()
+            if not lazy:
+                self.quant()
         else:
             assert_true(
                 params is not None,
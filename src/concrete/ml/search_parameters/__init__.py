@@ -1,3 +1,4 @@
-"""Modules for `p_error` search."""
+"""Modules for `p_error`, bit-width and rounding search."""
 
+from .bit_width_search import BitWidthSearch
 from .p_error_search import BinarySearch
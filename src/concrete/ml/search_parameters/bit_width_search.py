@@ -0,0 +1,414 @@
+"""Search of the quantization bit-width and per-layer rounding bits of Torch models.
+
+The latency of FHE circuits is dominated by their programmable bootstrapping (PBS) operations, whose
+cost grows quickly with the bit-width of their inputs. Lowering the models' quantization bit-width
+(`n_bits`) or rounding the accumulators of their linear layers (`rounding_threshold_bits`) reduces
+these bit-widths, at the expense of the models' accuracy.
+
+For each candidate `n_bits`, the search first compiles the quantized model without rounding, in
+order to get the bit-width of each layer's accumulator from `bitwidth_and_range_report`. It then
+greedily rounds the layer with the largest accumulator by one more bit, as long as the score of the
+model in the clear does not drop by more than `max_metric_loss` compared to the floating point
+model. Rounding a layer is refused once this budget is exceeded.
+
+Each accepted configuration is compiled and its cost is estimated using the complexity computed by
+the Concrete optimizer, which models the FHE latency of the circuit. The configuration with the
+lowest estimated cost is selected, and all evaluated configurations are reported along with their
+score, cost and number of PBS per bit-width, the Pareto-optimal ones being flagged.
+
+Compilation statistics are identified by the same keys as the compilation cache, so that identical
+configurations are compiled only once. If a `CompilationCache` is given, these statistics are stored
+in it and can be reused by later searches without compiling the models again.
+"""
+
+import inspect
+from typing import Any, Callable, Dict, List, Optional, Sequence
+
+import numpy
+import torch
+from concrete.fhe.compilation.configuration import Configuration
+
+from ..common.debugging import assert_true
+from ..common.instrumentation import measure_stage
+from ..common.utils import to_tuple
+from ..deployment.compilation_cache import CompilationCache
+from ..quantization import QuantizedModule
+from ..quantization.base_quantized_op import QuantizedMixingOp
+from ..quantization.profiling import get_pbs_count_per_bit_width
+from ..torch.compile import (
+    build_quantized_module,
+    convert_torch_tensor_or_numpy_array_to_numpy_array,
+)
+
+
+def _get_roundable_layers(quantized_module: QuantizedModule) -> Dict[str, QuantizedMixingOp]:
+    """Get the layers whose accumulators can be rounded.
+
+    Layers already rounded, for example by the QAT import passes, are not considered.
+
+    Args:
+        quantized_module (QuantizedModule): The quantized module.
+
+    Returns:
+        Dict[str, QuantizedMixingOp]: The layers, by name.
+    """
+    return {
+        layer.op_instance_name: layer
+        for _, layer in quantized_module.quant_layers_dict.values()
+        if isinstance(layer, QuantizedMixingOp)
+        and layer.rounding_threshold_bits is None
+        and "calibrate_rounding" in inspect.signature(layer.q_impl).parameters
+    }
+
+
+def _calibrate_rounding(
+    quantized_module: QuantizedModule,
+    layers: Dict[str, QuantizedMixingOp],
+    rounding_threshold_bits: Dict[str, int],
+    x: numpy.ndarray,
+):
+    """Set the rounding bits of each layer and calibrate the number of bits to remove.
+
+    As in post-training quantization, each layer is calibrated on the rounded outputs of the
+    previous ones, and the number of bits to remove is the one needed over the whole data-set.
+
+    Args:
+        quantized_module (QuantizedModule): The quantized module.
+        layers (Dict[str, QuantizedMixingOp]): The layers that can be rounded, by name.
+        rounding_threshold_bits (Dict[str, int]): The rounding bits of the rounded layers. Layers
+            that are not given are not rounded.
+        x (numpy.ndarray): The calibration data.
+    """
+    for name, layer in layers.items():
+        layer.rounding_threshold_bits = rounding_threshold_bits.get(name)
+        layer.lsbs_to_remove = {}
+        layer.attrs["calibrate_rounding"] = True
+
+    try:
+        q_x = to_tuple(quantized_module.quantize_input(*quantized_module.pre_processing(x)))
+
+        # pylint: disable-next=protected-access
+        quantized_module._clear_forward(*q_x)
+    finally:
+        for layer in layers.values():
+            layer.attrs.pop("calibrate_rounding")
+
+
+# pylint: disable-next=too-many-instance-attributes
+class BitWidthSearch:
+    """Search the `n_bits` and per-layer rounding bits minimizing a Torch model's FHE latency."""
+
+    def __init__(
+        self,
+        estimator: torch.nn.Module,
+        metric: Callable,
+        n_bits_candidates: Sequence[int] = (2, 3, 4, 5, 6, 7, 8),
+        rounding_candidates: Sequence[int] = (8, 7, 6, 5, 4, 3),
+        max_metric_loss: float = 0.01,
+        higher_is_better: bool = True,
+        configuration: Optional[Configuration] = None,
+        p_error: Optional[float] = None,
+        compilation_cache: Optional[CompilationCache] = None,
+        **kwargs: dict,
+    ):
+        """Search the `n_bits` and per-layer rounding bits minimizing the estimated FHE latency.
+
+        Args:
+            estimator (torch.nn.Module): The floating point Torch model, quantized with
+                post-training quantization.
+            metric (Callable): Evaluation metric, called as `metric(ground_truth, predictions)`.
+            n_bits_candidates (Sequence[int]): The quantization bit-widths to consider. Default
+                is all bit-widths from 2 to 8.
+            rounding_candidates (Sequence[int]): The rounding bits to consider for each layer's
+                accumulator. Default is all bits from 8 to 3.
+            max_metric_loss (float): The maximum loss of score allowed compared to the floating
+                point model, evaluated in the clear. Default is 0.01.
+            higher_is_better (bool): Flag that indicates whether higher scores are better, as for
+                an accuracy, or whether lower ones are, as for an error. Default is True.
+            configuration (Optional[Configuration]): Options to use for compilation. Default is
+                None.
+            p_error (Optional[float]): The probability of error of a single PBS, used for
+                compilation. Default is None, which sets Concrete ML's default value.
+            compilation_cache (Optional[CompilationCache]): The cache in which the compilation
+                statistics and the selected configuration's circuit are stored, so that later
+                searches do not compile the same configurations again. Default is None.
+            kwargs: Parameter of the evaluation metric.
+        """
+        assert_true(
+            len(n_bits_candidates) > 0 and all(n_bits >= 2 for n_bits in n_bits_candidates),
+            "Parameter 'n_bits_candidates' must contain at least one bit-width, each greater or "
+            f"equal than 2. Got {n_bits_candidates}",
+            ValueError,
+        )
+        assert_true(
+            all(rounding_bits >= 1 for rounding_bits in rounding_candidates),
+            "Parameter 'rounding_candidates' must only contain strictly positive integers. Got "
+            f"{rounding_candidates}",
+            ValueError,
+        )
+
+        self.estimator = estimator
+        self.metric = metric
+        self.n_bits_candidates = sorted(n_bits_candidates, reverse=True)
+        self.rounding_candidates = sorted(set(rounding_candidates), reverse=True)
+        self.max_metric_loss = max_metric_loss
+        self.higher_is_better = higher_is_better
+        self.configuration = configuration
+        self.p_error = p_error
+        self.compilation_cache = compilation_cache
+        self.kwargs = kwargs
+
+        self.reference_score: Optional[float] = None
+        self.history: List[Dict[str, Any]] = []
+        self.n_bits: Optional[int] = None
+        self.rounding_threshold_bits: Dict[str, int] = {}
+
+        # Compilation statistics, by compilation key
+        self._statistics: Dict[str, Dict[str, Any]] = {}
+
+    def _get_metric_loss(self, score: float) -> float:
+        """Compute the loss of score compared to the floating point model.
+
+        Args:
+            score (float): The score to compare.
+
+        Returns:
+            float: The loss, positive if the score is worse than the reference one.
+        """
+        assert self.reference_score is not None
+
+        loss = self.reference_score - score
+        return loss if self.higher_is_better else -loss
+
+    def _score(self, quantized_module: QuantizedModule, x: numpy.ndarray, y: numpy.ndarray):
+        """Evaluate a quantized module in the clear.
+
+        Args:
+            quantized_module (QuantizedModule): The quantized module.
+            x (numpy.ndarray): The evaluation data.
+            y (numpy.ndarray): The ground truth.
+
+        Returns:
+            float: The module's score.
+        """
+        return float(self.metric(y, quantized_module.forward(x, fhe="disable"), **self.kwargs))
+
+    def _compile(self, quantized_module: QuantizedModule, x: numpy.ndarray) -> Dict[str, Any]:
+        """Compile a quantized module, unless its statistics are already known.
+
+        Args:
+            quantized_module (QuantizedModule): The quantized module.
+            x (numpy.ndarray): The compilation input-set.
+
+        Returns:
+            Dict[str, Any]: The compiled circuit's estimated cost, maximum bit-width, number of PBS
+                per bit-width and accumulator bit-width of each layer.
+        """
+        compile_kwargs = {"configuration": self.configuration, "p_error": self.p_error}
+        key = CompilationCache.get_key(quantized_module, x, **compile_kwargs)
+
+        if key not in self._statistics and self.compilation_cache is not None:
+            statistics = self.compilation_cache.get_statistics(key)
+
+            if statistics is not None:
+                # JSON keys are strings
+                statistics["pbs_count_per_bit_width"] = {
+                    int(bit_width): count
+                    for bit_width, count in statistics["pbs_count_per_bit_width"].items()
+                }
+                self._statistics[key] = statistics
+
+        if key not in self._statistics:
+            with measure_stage("bit_width_search.compile"):
+                fhe_circuit = quantized_module.compile(x, **compile_kwargs)
+
+            bitwidth_report = quantized_module.bitwidth_and_range_report() or {}
+
+            statistics = {
+                "cost": float(fhe_circuit.complexity),
+                "max_bit_width": int(fhe_circuit.graph.maximum_integer_bit_width()),
+                "pbs_count_per_bit_width": get_pbs_count_per_bit_width(fhe_circuit.graph),
+                "layer_bit_widths": {
+                    name: int(report["bitwidth"]) for name, report in bitwidth_report.items()
+                },
+            }
+
+            if self.compilation_cache is not None:
+                self.compilation_cache.put_statistics(key, statistics)
+
+            self._statistics[key] = statistics
+
+        return self._statistics[key]
+
+    def _record(
+        self,
+        n_bits: int,
+        rounding_threshold_bits: Dict[str, int],
+        score: float,
+        statistics: Optional[Dict[str, Any]],
+    ):
+        """Record an evaluated configuration.
+
+        Args:
+            n_bits (int): The quantization bit-width.
+            rounding_threshold_bits (Dict[str, int]): The rounding bits of the rounded layers.
+            score (float): The score in the clear.
+            statistics (Optional[Dict[str, Any]]): The compilation statistics, or None if the
+                configuration has not been compiled.
+        """
+        metric_loss = self._get_metric_loss(score)
+
+        self.history.append(
+            {
+                "n_bits": n_bits,
+                "rounding_threshold_bits": dict(rounding_threshold_bits),
+                "score": score,
+                "metric_loss": metric_loss,
+                "is_valid": metric_loss <= self.max_metric_loss,
+                "cost": None if statistics is None else statistics["cost"],
+                "max_bit_width": None if statistics is None else statistics["max_bit_width"],
+                "pbs_count_per_bit_width": (
+                    None if statistics is None else statistics["pbs_count_per_bit_width"]
+                ),
+                "is_pareto_optimal": False,
+            }
+        )
+
+    def _search_rounding(self, n_bits: int, x: numpy.ndarray, y: numpy.ndarray):
+        """Greedily round the layers of a model quantized with the given bit-width.
+
+        Args:
+            n_bits (int): The quantization bit-width.
+            x (numpy.ndarray): The calibration and evaluation data.
+            y (numpy.ndarray): The ground truth.
+        """
+        quantized_module = build_quantized_module(self.estimator, torch_inputset=x, n_bits=n_bits)
+        layers = _get_roundable_layers(quantized_module)
+
+        score = self._score(quantized_module, x, y)
+        if self._get_metric_loss(score) > self.max_metric_loss:
+            self._record(n_bits, {}, score, None)
+            return
+
+        statistics = self._compile(quantized_module, x)
+        self._record(n_bits, {}, score, statistics)
+
+        # The accumulator bit-widths are only known for the layers that are not fused
+        bit_widths = {
+            name: statistics["layer_bit_widths"][name]
+            for name in layers
+            if name in statistics["layer_bit_widths"]
+        }
+        rounding_threshold_bits: Dict[str, int] = {}
+
+        while bit_widths:
+            # Round the layer with the largest accumulator. Ties are broken by the layers' order
+            name = max(bit_widths, key=bit_widths.__getitem__)
+            lower_candidates = [
+                bits for bits in self.rounding_candidates if bits < bit_widths[name]
+            ]
+
+            if not lower_candidates:
+                bit_widths.pop(name)
+                continue
+
+            candidate = {**rounding_threshold_bits, name: lower_candidates[0]}
+            _calibrate_rounding(quantized_module, layers, candidate, x)
+            score = self._score(quantized_module, x, y)
+
+            if self._get_metric_loss(score) > self.max_metric_loss:
+                self._record(n_bits, candidate, score, None)
+                bit_widths.pop(name)
+                continue
+
+            rounding_threshold_bits = candidate
+            bit_widths[name] = lower_candidates[0]
+            self._record(n_bits, candidate, score, self._compile(quantized_module, x))
+
+    def _set_pareto_optimal(self):
+        """Flag the compiled configurations that no other configuration dominates."""
+        compiled = [entry for entry in self.history if entry["cost"] is not None]
+
+        for entry in compiled:
+            entry["is_pareto_optimal"] = not any(
+                other["cost"] <= entry["cost"]
+                and other["metric_loss"] <= entry["metric_loss"]
+                and (other["cost"] < entry["cost"] or other["metric_loss"] < entry["metric_loss"])
+                for other in compiled
+            )
+
+    def run(self, x: numpy.ndarray, ground_truth: numpy.ndarray) -> QuantizedModule:
+        """Search the configuration minimizing the estimated FHE latency within the score budget.
+
+        Args:
+            x (numpy.ndarray): The calibration data, also used for evaluating the configurations.
+            ground_truth (numpy.ndarray): The ground truth.
+
+        Returns:
+            QuantizedModule: The model, quantized and compiled with the selected configuration.
+
+        Raises:
+            ValueError: If no configuration keeps the score within the budget.
+        """
+        x = convert_torch_tensor_or_numpy_array_to_numpy_array(x)
+
+        if hasattr(self.estimator, "eval"):
+            self.estimator.eval()
+
+        with torch.no_grad():
+            float_predictions = self.estimator(torch.from_numpy(x).float()).numpy()
+
+        self.reference_score = float(self.metric(ground_truth, float_predictions, **self.kwargs))
+        self.history = []
+
+        for n_bits in self.n_bits_candidates:
+            self._search_rounding(n_bits, x, ground_truth)
+
+        self._set_pareto_optimal()
+
+        valid_entries = [
+            entry for entry in self.history if entry["is_valid"] and entry["cost"] is not None
+        ]
+        if not valid_entries:
+            raise ValueError(
+                f"No configuration keeps the score within {self.max_metric_loss} of the floating "
+                f"point model's score ({self.reference_score}). Please increase 'max_metric_loss' "
+                "or consider larger 'n_bits_candidates'."
+            )
+
+        best_entry = min(valid_entries, key=lambda entry: (entry["cost"], entry["metric_loss"]))
+        self.n_bits = best_entry["n_bits"]
+        self.rounding_threshold_bits = best_entry["rounding_threshold_bits"]
+
+        # Re-build and compile the selected configuration, its circuit being loaded from the cache
+        # when the same search has already been run
+        quantized_module = build_quantized_module(
+            self.estimator, torch_inputset=x, n_bits=self.n_bits
+        )
+        _calibrate_rounding(
+            quantized_module,
+            _get_roundable_layers(quantized_module),
+            self.rounding_threshold_bits,
+            x,
+        )
+        quantized_module.compile(
+            x,
+            configuration=self.configuration,
+            p_error=self.p_error,
+            compilation_cache=self.compilation_cache,
+        )
+
+        return quantized_module
+
+    def get_pareto_report(self) -> List[Dict[str, Any]]:
+        """Get the Pareto-optimal configurations, sorted by increasing estimated cost.
+
+        Returns:
+            List[Dict[str, Any]]: The configurations that no other one beats on both the estimated
+                cost and the loss of score.
+        """
+        return sorted(
+            (entry for entry in self.history if entry["is_pareto_optimal"]),
+            key=lambda entry: entry["cost"],
+        )
+
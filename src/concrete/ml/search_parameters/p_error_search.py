@@ -48,36 +48,54 @@ Update the current `p_error` with the mean of the bounds
 
 We stop the search when the maximum number of iterations is reached.
 
+The search can also evaluate several candidates at each iteration (`n_candidates`), evenly spaced
+between the bounds, which turns it into a k-ary search converging in fewer iterations. Candidates
+are then compiled and simulated concurrently, each on its own copy of the model. Simulations can be
+run in parallel (`n_jobs`) and stopped as soon as the outcome of the strategy is known
+(`early_stopping`).
+
 If we don't reach the convergence, a user warning is raised.
 """
 
+import copy
+import os
+import threading
 import warnings
 from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from pprint import pprint
-from typing import Any, Callable, Dict, List, Tuple, Union
+from typing import Any, Callable, Dict, List, Optional, Tuple, Union
 
 import numpy
 import torch
+from concrete.fhe.compilation.circuit import Circuit
+from concrete.fhe.compilation.module import FheModule
 from tqdm import tqdm
 
+from ..common.cached_circuit import CachedCircuit
 from ..common.utils import is_brevitas_model, is_model_class_in_a_list
+from ..deployment.compilation_cache import CompilationCache
+from ..quantization import QuantizedModule
 from ..sklearn import _get_sklearn_all_models, _get_sklearn_linear_models
-from ..torch.compile import compile_brevitas_qat_model, compile_torch_model
+from ..torch.compile import (
+    compile_brevitas_qat_model,
+    compile_torch_model,
+    convert_torch_tensor_or_numpy_array_to_numpy_array,
+)
 
 
-def compile_and_simulated_fhe_inference(
+def compile_for_simulation(
     estimator: torch.nn.Module,
     calibration_data: numpy.ndarray,
     ground_truth: numpy.ndarray,
     p_error: float,
     n_bits: int,
     is_qat: bool,
-    metric: Callable,
-    predict: str,
-    **kwargs: Dict,
-) -> Tuple[numpy.ndarray, float]:
-    """Get the quantized module of a given model in FHE, simulated or not.
+    quantized_module: Optional[QuantizedModule] = None,
+    compilation_cache: Optional[CompilationCache] = None,
+) -> Optional[QuantizedModule]:
+    """Compile a given model with the given `p_error`.
 
     Supported models are:
     - Built-in models, including trees and QNN,
@@ -92,13 +110,15 @@ def compile_and_simulated_fhe_inference(
         n_bits (int): Quantization bits
         is_qat (bool): True, if the NN has been trained through QAT.
             If `False` it is converted into post-trained quantized model.
-        metric (Callable): Classification or regression evaluation metric.
-        predict (str): The predict method to use.
-        kwargs (Dict): Hyper-parameters to use for the metric.
+        quantized_module (Optional[QuantizedModule]): A quantized module previously obtained from
+            the same torch model and calibration data. If given, it is compiled again instead of
+            converting the torch model. Default to None.
+        compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+            from, or to store it in. Default to None.
 
     Returns:
-        Tuple[numpy.ndarray, float]: De-quantized or quantized output model depending on
-        `is_benchmark_test` and the score.
+        Optional[QuantizedModule]: The compiled quantized module for torch models, None for
+            built-in models, which are compiled in place.
 
     Raises:
         ValueError: If the model is neither a built-in model nor a torch neural network.
@@ -106,10 +126,20 @@ def compile_and_simulated_fhe_inference(
 
     compile_params: Dict = {}
     compile_function: Callable[..., Any]
-    dequantized_output: numpy.ndarray
 
     # Custom neural networks with QAT
     if isinstance(estimator, torch.nn.Module):
+
+        # The quantization of the model does not depend on `p_error`, only the circuit needs to be
+        # compiled again
+        if quantized_module is not None:
+            quantized_module.compile(
+                convert_torch_tensor_or_numpy_array_to_numpy_array(calibration_data),
+                p_error=p_error,
+                compilation_cache=compilation_cache,
+            )
+            return quantized_module
+
         if is_qat and is_brevitas_model(estimator):
             compile_function = compile_brevitas_qat_model
         else:
@@ -117,36 +147,144 @@ def compile_and_simulated_fhe_inference(
             compile_function = compile_torch_model
             compile_params = {"import_qat": is_qat, "n_bits": n_bits}
 
-        quantized_module = compile_function(
+        return compile_function(
             torch_model=estimator,
             torch_inputset=calibration_data,
             p_error=p_error,
+            compilation_cache=compilation_cache,
             **compile_params,
         )
 
-        dequantized_output = quantized_module.forward(calibration_data, fhe="simulate")
-
-    elif is_model_class_in_a_list(
+    if is_model_class_in_a_list(
         estimator, _get_sklearn_all_models()
     ) and not is_model_class_in_a_list(estimator, _get_sklearn_linear_models()):
         if not estimator.is_fitted:
             estimator.fit(calibration_data, ground_truth)
 
-        estimator.compile(calibration_data, p_error=p_error)
-        predict_method = getattr(estimator, predict)
-        dequantized_output = predict_method(calibration_data, fhe="simulate")
+        estimator.compile(calibration_data, p_error=p_error, compilation_cache=compilation_cache)
+        return None
+
+    raise ValueError(
+        f"`{type(estimator)}` is not supported. "
+        "Supported types are: custom Torch, Brevitas NNs and built-in models (trees and QNNs)."
+    )
+
 
+def simulated_fhe_inference(
+    estimator: torch.nn.Module,
+    quantized_module: Optional[QuantizedModule],
+    calibration_data: numpy.ndarray,
+    ground_truth: numpy.ndarray,
+    metric: Callable,
+    predict: str,
+    **kwargs: Dict,
+) -> Tuple[numpy.ndarray, float]:
+    """Run a compiled model with FHE simulation and evaluate its score.
+
+    Args:
+        estimator (torch.nn.Module): Torch model or a built-in model
+        quantized_module (Optional[QuantizedModule]): The compiled quantized module of a torch
+            model, or None for built-in models.
+        calibration_data (numpy.ndarray): Calibration data required for compilation
+        ground_truth (numpy.ndarray): The ground truth
+        metric (Callable): Classification or regression evaluation metric.
+        predict (str): The predict method to use.
+        kwargs (Dict): Hyper-parameters to use for the metric.
+
+    Returns:
+        Tuple[numpy.ndarray, float]: De-quantized output model and the score.
+    """
+    dequantized_output: numpy.ndarray
+
+    if quantized_module is not None:
+        dequantized_output = quantized_module.forward(calibration_data, fhe="simulate")
     else:
-        raise ValueError(
-            f"`{type(estimator)}` is not supported. "
-            "Supported types are: custom Torch, Brevitas NNs and built-in models (trees and QNNs)."
-        )
+        predict_method = getattr(estimator, predict)
+        dequantized_output = predict_method(calibration_data, fhe="simulate")
 
     score = metric(ground_truth, dequantized_output, **kwargs)
 
     return dequantized_output, score
 
 
+def compile_and_simulated_fhe_inference(
+    estimator: torch.nn.Module,
+    calibration_data: numpy.ndarray,
+    ground_truth: numpy.ndarray,
+    p_error: float,
+    n_bits: int,
+    is_qat: bool,
+    metric: Callable,
+    predict: str,
+    **kwargs: Dict,
+) -> Tuple[numpy.ndarray, float]:
+    """Get the quantized module of a given model in FHE, simulated or not.
+
+    Supported models are:
+    - Built-in models, including trees and QNN,
+    - Quantized aware trained model are supported using Brevitas framework,
+    - Torch models can be converted into post-trained quantized models.
+
+    Args:
+        estimator (torch.nn.Module): Torch model or a built-in model
+        calibration_data (numpy.ndarray): Calibration data required for compilation
+        ground_truth (numpy.ndarray): The ground truth
+        p_error (float): Concrete ML uses table lookup (TLU) to represent any non-linear
+        n_bits (int): Quantization bits
+        is_qat (bool): True, if the NN has been trained through QAT.
+            If `False` it is converted into post-trained quantized model.
+        metric (Callable): Classification or regression evaluation metric.
+        predict (str): The predict method to use.
+        kwargs (Dict): Hyper-parameters to use for the metric.
+
+    Returns:
+        Tuple[numpy.ndarray, float]: De-quantized or quantized output model depending on
+        `is_benchmark_test` and the score.
+    """
+
+    quantized_module = compile_for_simulation(
+        estimator=estimator,
+        calibration_data=calibration_data,
+        ground_truth=ground_truth,
+        p_error=p_error,
+        n_bits=n_bits,
+        is_qat=is_qat,
+    )
+
+    return simulated_fhe_inference(
+        estimator=estimator,
+        quantized_module=quantized_module,
+        calibration_data=calibration_data,
+        ground_truth=ground_truth,
+        metric=metric,
+        predict=predict,
+        **kwargs,
+    )
+
+
+def copy_without_circuits(model: Any) -> Any:
+    """Deep copy a model or a quantized module, without its compiled circuits.
+
+    Compiled circuits cannot be copied. They are replaced by None in the copy, which thus needs to
+    be compiled again before being executed in FHE.
+
+    Args:
+        model (Any): The torch model, built-in model or quantized module to copy.
+
+    Returns:
+        Any: The copied model.
+    """
+    # Circuits are either held by the model itself or by one of its attributes, such as the
+    # quantized module of built-in neural networks
+    memo: Dict[int, Any] = {}
+    for value in [model, *vars(model).values()]:
+        for attribute in getattr(value, "__dict__", {}).values():
+            if isinstance(attribute, (Circuit, CachedCircuit, FheModule)):
+                memo[id(attribute)] = None
+
+    return copy.deepcopy(model, memo)
+
+
 # pylint: disable=too-many-instance-attributes, too-many-arguments
 class BinarySearch:
     """Class for `p_error` hyper-parameter search for classification and regression tasks."""
@@ -172,6 +310,10 @@ class BinarySearch:
         log_file: str = None,
         directory: str = None,
         verbose: bool = False,
+        n_candidates: int = 1,
+        n_jobs: Optional[int] = None,
+        early_stopping: bool = False,
+        compilation_cache: Optional[CompilationCache] = None,
         **kwargs: dict,
     ):
         """`p_error` binary search algorithm.
@@ -204,6 +346,19 @@ class BinarySearch:
             directory (str): The directory to save the meta data. Default is None.
             verbose (bool): Flag that indicates whether to print detailed information.
                 Default is False.
+            n_candidates (int): The number of `p_error` candidates evaluated at each iteration,
+                evenly spaced between the bounds. With 1 candidate, the search is a binary search.
+                With more candidates, the search interval shrinks faster. Candidates are compiled
+                and simulated concurrently, each on its own copy of the model, which needs as much
+                more memory. Default is 1.
+            n_jobs (Optional[int]): The number of workers running the simulations in parallel. If
+                None, simulations run sequentially. If -1, all CPUs are used. Default is None.
+            early_stopping (bool): Flag that indicates whether to stop simulating a candidate as
+                soon as the outcome of `strategy` cannot change anymore. This assumes that the
+                strategy is monotonic, as `all`, `any`, `mean` or `median` are. Default is False.
+            compilation_cache (Optional[CompilationCache]): The cache to load the candidates'
+                compiled circuits from, or to store them in, so that running the same search again
+                does not compile the model. Default is None.
             kwargs: Parameter of the evaluation metric.
         """
 
@@ -220,8 +375,15 @@ class BinarySearch:
         self.strategy = strategy
         self.metric = metric
         self.predict = predict
+        self.n_candidates = n_candidates
+        self.n_jobs = n_jobs
+        self.early_stopping = early_stopping
+        self.compilation_cache = compilation_cache
         self.kwargs = kwargs
 
+        # Candidates evaluated concurrently save their metadata in the same log file
+        self._save_lock = threading.Lock()
+
         if directory is not None and log_file is not None:
             self.path = Path(directory) / log_file
 
@@ -237,6 +399,12 @@ class BinarySearch:
         assert (
             self.n_simulation >= 1
         ), "Invalid value, `n_simulation` must be greater or equal than 1"
+        assert (
+            self.n_candidates >= 1
+        ), "Invalid value, `n_candidates` must be greater or equal than 1"
+        assert (
+            self.n_jobs is None or self.n_jobs == -1 or self.n_jobs >= 1
+        ), "Invalid value, `n_jobs` must be None, -1 or greater or equal than 1"
         assert (
             self.save is True and self.path is not None
         ) or self.save is False, "To save logs, file name and path must be provided"
@@ -254,17 +422,18 @@ class BinarySearch:
         """
 
         if self.save:
-            # When instantiating the class, if the log file exists, we reset it
-            # On the first iteration, we write the header
-            # Then, we append the data at each iteration
-            if not self.path.exists():
-                self.path.parent.mkdir(parents=True, exist_ok=True)
-                with self.path.open("w", encoding="utf-8") as file:
-                    file.write(f"{','.join(data.keys())}\n")  # Iteration = 0, set the header
-
-            # Append new data, as it goes along
-            with self.path.open("a", encoding="utf-8") as file:
-                file.write(f"{','.join(map(str, data.values()))}\n")
+            with self._save_lock:
+                # When instantiating the class, if the log file exists, we reset it
+                # On the first iteration, we write the header
+                # Then, we append the data at each iteration
+                if not self.path.exists():
+                    self.path.parent.mkdir(parents=True, exist_ok=True)
+                    with self.path.open("w", encoding="utf-8") as file:
+                        file.write(f"{','.join(data.keys())}\n")  # Iteration = 0, set the header
+
+                # Append new data, as it goes along
+                with self.path.open("a", encoding="utf-8") as file:
+                    file.write(f"{','.join(map(str, data.values()))}\n")
 
     def _eval(self) -> None:
         """Set the model in an eval mode."""
@@ -300,12 +469,50 @@ class BinarySearch:
 
         return is_match
 
+    @staticmethod
+    def is_decided(strategy: Callable, all_matches: List[bool], n_remaining: int) -> bool:
+        """Indicate if the outcome of the strategy is known before running all the simulations.
+
+        The outcome is known if it stays the same whether all remaining simulations match or
+        not, which is only correct for monotonic strategies.
+
+        Args:
+            strategy (Callable): A uni-variate function that defines a "match".
+            all_matches (List[bool]): List of matches of the simulations already run.
+            n_remaining (int): The number of simulations left to run.
+
+        Returns:
+            bool: Whether the remaining simulations can be skipped.
+        """
+        if n_remaining == 0:
+            return True
+
+        return BinarySearch.eval_match(
+            strategy, all_matches + [True] * n_remaining
+        ) == BinarySearch.eval_match(strategy, all_matches + [False] * n_remaining)
+
+    @property
+    def n_workers(self) -> int:
+        """Get the number of workers running the simulations.
+
+        Returns:
+            int: The number of workers.
+        """
+        if self.n_jobs is None:
+            return 1
+
+        if self.n_jobs == -1:
+            return os.cpu_count() or 1
+
+        return self.n_jobs
+
     def _acc_diff_objective(
         self,
         reference_output: numpy.ndarray,
         estimated_output: numpy.ndarray,
         reference_score: float,
         estimated_score: float,
+        p_error: float,
     ) -> Dict:
         """Figure out if the selected `p_error` is a good candidate and meets the criteria.
 
@@ -324,6 +531,7 @@ class BinarySearch:
             estimated_output (numpy.ndarray): The inference of a model with p_error in ]0,1[
             reference_score (float): The score computed by the original model with p_error ≈ 0
             estimated_score (float): The score computed by the original model with p_error in ]0,1[
+            p_error (float): The `p_error` of the evaluated candidate.
 
         Returns:
             Dict: Set of information
@@ -346,7 +554,7 @@ class BinarySearch:
         metadata = OrderedDict(
             {
                 "lower": self.lower,
-                "p_error": self.p_error,
+                "p_error": p_error,
                 "upper": self.upper,
                 "l1_error": [round(l1_error, 4)],
                 "l2_error": [round(l2_error, 4)],
@@ -363,6 +571,141 @@ class BinarySearch:
 
         return metadata
 
+    # pylint: disable-next=too-many-arguments
+    def _simulate_candidate(
+        self,
+        x: numpy.ndarray,
+        ground_truth: numpy.ndarray,
+        strategy: Callable,
+        reference_output: numpy.ndarray,
+        reference_score: float,
+        p_error: float,
+        estimator: Any,
+        quantized_module: Optional[QuantizedModule],
+        pool: Optional[ThreadPoolExecutor],
+    ) -> Dict:
+        """Run the simulations of a `p_error` candidate, already compiled.
+
+        Since `p_error` represents a probability, to validate the results of the FHE simulation
+        and get a stable estimation, several runs are needed. These are run in waves of as many
+        simulations as there are workers, so that early stopping can be checked between waves.
+
+        Args:
+            x (numpy.ndarray): Data-set which is used for calibration and evaluation
+            ground_truth (numpy.ndarray): The ground truth
+            strategy (Callable): A uni-variate function that defines a "match".
+            reference_output (numpy.ndarray): The inference of a original model with p_error ≈ 0
+            reference_score (float): The score computed by the original model with p_error ≈ 0
+            p_error (float): The candidate's `p_error`.
+            estimator (Any): The candidate's model, compiled in place for built-in models.
+            quantized_module (Optional[QuantizedModule]): The candidate's compiled quantized module
+                for torch models, or None for built-in models.
+            pool (Optional[ThreadPoolExecutor]): The workers to use, if any.
+
+        Returns:
+            Dict: All metadata collected from the simulations.
+        """
+
+        def simulate(_) -> Tuple[numpy.ndarray, float]:
+            return simulated_fhe_inference(
+                estimator=estimator,
+                quantized_module=quantized_module,
+                calibration_data=x,
+                ground_truth=ground_truth,
+                metric=self.metric,
+                predict=self.predict,
+                **self.kwargs,
+            )
+
+        # Without early stopping, all simulations can be run at once
+        wave_size = self.n_workers if self.early_stopping else self.n_simulation
+
+        simulation_data: List[Dict] = []
+        while len(simulation_data) < self.n_simulation:
+            n_runs = min(wave_size, self.n_simulation - len(simulation_data))
+            map_function = map if pool is None else pool.map
+
+            for current_output, current_score in map_function(simulate, range(n_runs)):
+                simulation_data.append(
+                    self._acc_diff_objective(
+                        reference_output=reference_output,
+                        estimated_output=current_output,
+                        reference_score=reference_score,
+                        estimated_score=current_score,
+                        p_error=p_error,
+                    )
+                )
+
+            all_matches = [metadata["all_matches"][0] for metadata in simulation_data]
+            if self.early_stopping and self.is_decided(
+                strategy, all_matches, self.n_simulation - len(simulation_data)
+            ):
+                break
+
+        # Aggregating all metadata collected from `n` simulations to display them all at once
+        return OrderedDict(
+            {
+                k: (
+                    sum((d[k] for d in simulation_data), [])
+                    if isinstance(simulation_data[0][k], list)
+                    else simulation_data[0][k]
+                )
+                for k in simulation_data[0]
+            }
+        )
+
+    def _evaluate_candidate(
+        self,
+        x: numpy.ndarray,
+        ground_truth: numpy.ndarray,
+        strategy: Callable,
+        reference_output: numpy.ndarray,
+        reference_score: float,
+        p_error: float,
+        estimator: Any,
+        quantized_module: Optional[QuantizedModule],
+        pool: Optional[ThreadPoolExecutor],
+    ) -> Dict:
+        """Compile a model with the given `p_error` and run the candidate's simulations.
+
+        Args:
+            x (numpy.ndarray): Data-set which is used for calibration and evaluation
+            ground_truth (numpy.ndarray): The ground truth
+            strategy (Callable): A uni-variate function that defines a "match".
+            reference_output (numpy.ndarray): The inference of a original model with p_error ≈ 0
+            reference_score (float): The score computed by the original model with p_error ≈ 0
+            p_error (float): The candidate's `p_error`.
+            estimator (Any): The model to compile, in place for built-in models.
+            quantized_module (Optional[QuantizedModule]): The quantized module of the torch model to
+                compile again, or None for built-in models.
+            pool (Optional[ThreadPoolExecutor]): The workers running the simulations, if any.
+
+        Returns:
+            Dict: All metadata collected from the simulations.
+        """
+        quantized_module = compile_for_simulation(
+            estimator=estimator,
+            calibration_data=x,
+            ground_truth=ground_truth,
+            p_error=p_error,
+            is_qat=self.is_qat,
+            n_bits=self.n_bits,
+            quantized_module=quantized_module,
+            compilation_cache=self.compilation_cache,
+        )
+
+        return self._simulate_candidate(
+            x,
+            ground_truth,
+            strategy,
+            reference_output,
+            reference_score,
+            p_error,
+            estimator,
+            quantized_module,
+            pool,
+        )
+
     def _update_attr(self, **kwargs: dict) -> None:
         """Update the hyper-parameters then check if the values are valid.
 
@@ -406,6 +749,10 @@ class BinarySearch:
         Else, we update the upper bound to be the current p_error.
         Update the current p_error with the mean of the bounds.
 
+        If several candidates are evaluated at each iteration, they are compiled and simulated
+        concurrently and the bounds are updated to the largest matching candidate and the smallest
+        non-matching one.
+
         We stop the search either when the maximum number of iterations is reached or when the
         update of the `p_error` is below at a given threshold.
 
@@ -431,13 +778,22 @@ class BinarySearch:
 
         # Reference predictions:
         # Compile the model in FHE simulation, then compute the score with a model of `p_error ≈ 0`
-        reference_output, reference_score = compile_and_simulated_fhe_inference(
+        # For torch models, the resulting quantized module is compiled again for all the
+        # candidates, or copied if several candidates are evaluated concurrently
+        quantized_module = compile_for_simulation(
             estimator=self.estimator,
             calibration_data=x,
             ground_truth=ground_truth,
             p_error=2**-40,
             is_qat=self.is_qat,
             n_bits=self.n_bits,
+            compilation_cache=self.compilation_cache,
+        )
+        reference_output, reference_score = simulated_fhe_inference(
+            estimator=self.estimator,
+            quantized_module=quantized_module,
+            calibration_data=x,
+            ground_truth=ground_truth,
             metric=self.metric,
             predict=self.predict,
             **self.kwargs,
@@ -446,60 +802,78 @@ class BinarySearch:
         # Set `p_error`
         self.p_error = (self.lower + self.upper) / 2.0
 
-        # Binary search algorithm
-        for _ in tqdm(range(self.max_iter), disable=not self.verbose):
-            # Run the inference with a given p-error
-
-            # Since `p_error` represents a probability, to validate the results of the Fhe
-            # simulation and get a stable estimation, several runs are needed
-            simulation_data = []
-            for _ in range(self.n_simulation):
-                current_output, current_score = compile_and_simulated_fhe_inference(
-                    estimator=self.estimator,
-                    calibration_data=x,
-                    ground_truth=ground_truth,
-                    p_error=self.p_error,
-                    is_qat=self.is_qat,
-                    n_bits=self.n_bits,
-                    metric=self.metric,
-                    predict=self.predict,
-                    **self.kwargs,
-                )
+        pool = ThreadPoolExecutor(max_workers=self.n_workers) if self.n_workers > 1 else None
 
-                current_metadata = self._acc_diff_objective(
-                    reference_output=reference_output,
-                    estimated_output=current_output,
-                    reference_score=reference_score,
-                    estimated_score=current_score,
-                )
+        # The candidates of an iteration are evaluated concurrently, each on its own copy of the
+        # model (or of its quantized module for torch models) as compiling a model replaces its
+        # circuit. With a single candidate, the model is directly compiled
+        candidates_pool = (
+            ThreadPoolExecutor(max_workers=self.n_candidates) if self.n_candidates > 1 else None
+        )
 
-                simulation_data.append(current_metadata)
-
-            # Aggregating all metadata collected from `n` simulations to display them all at once
-            self.history.append(
-                OrderedDict(
-                    {
-                        k: (
-                            sum((d[k] for d in simulation_data), [])
-                            if isinstance(simulation_data[0][k], list)
-                            else simulation_data[0][k]
-                        )
-                        for k in simulation_data[0]
-                    }
-                )
+        def evaluate_candidate(p_error: float) -> Dict:
+            """Evaluate a candidate, on copies of the model if several candidates are evaluated.
+
+            Args:
+                p_error (float): The candidate's `p_error`.
+
+            Returns:
+                Dict: All metadata collected from the simulations.
+            """
+            estimator, candidate_module = self.estimator, quantized_module
+            if candidates_pool is not None:
+                if candidate_module is not None:
+                    candidate_module = copy_without_circuits(candidate_module)
+                else:
+                    estimator = copy_without_circuits(estimator)
+
+            return self._evaluate_candidate(
+                x,
+                ground_truth,
+                strategy,
+                reference_output,
+                reference_score,
+                p_error,
+                estimator,
+                candidate_module,
+                pool,
             )
 
-            if self.verbose:
-                pprint(self.history[-1])
-
-            # Update interval
-            if self.eval_match(strategy, self.history[-1]["all_matches"]):
-                # If we valid our criteria, we increase the `p_error`
-                self.lower = self.p_error
-            else:
-                # If not, we decrease the `p_error`
-                self.upper = self.p_error
-            self.p_error = (self.lower + self.upper) / 2.0
+        try:
+            # Binary (or k-ary) search algorithm
+            for _ in tqdm(range(self.max_iter), disable=not self.verbose):
+                step = (self.upper - self.lower) / (self.n_candidates + 1)
+                p_errors = [self.lower + step * (i + 1) for i in range(self.n_candidates)]
+
+                map_function = map if candidates_pool is None else candidates_pool.map
+                candidates_history = list(map_function(evaluate_candidate, p_errors))
+
+                # Candidates are looked at from the smallest to the largest `p_error`
+                lower, upper = self.lower, self.upper
+                for p_error, metadata in zip(p_errors, candidates_history):
+                    self.p_error = p_error
+                    self.history.append(metadata)
+
+                    if self.verbose:
+                        pprint(metadata)
+
+                    # If we valid our criteria, we can increase the `p_error`
+                    if self.eval_match(strategy, metadata["all_matches"]):
+                        lower = p_error
+
+                    # If not, we decrease the `p_error`. Larger candidates are not considered as
+                    # the error is expected to increase with the `p_error`
+                    else:
+                        upper = p_error
+                        break
+
+                # Update interval
+                self.lower, self.upper = lower, upper
+                self.p_error = (self.lower + self.upper) / 2.0
+        finally:
+            for executor in [pool, candidates_pool]:
+                if executor is not None:
+                    executor.shutdown()
 
         # Raise a user warning if the convergence is not reached
         if numpy.mean(self.history[-1]["metric_difference"]) > self.max_metric_loss:
@@ -11,9 +11,9 @@ import tempfile
 # pylint: disable=too-many-lines,invalid-name
 import warnings
 from abc import ABC, abstractmethod
-from functools import partial
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
-from typing import Any, Callable, Dict, List, Optional, Set, TextIO, Type, Union
+from typing import Any, Callable, Dict, List, Optional, Set, TextIO, Tuple, Type, Union, cast
 
 import brevitas.nn as qnn
 
@@ -29,24 +29,34 @@ from concrete.fhe.compilation.artifacts import DebugArtifacts
 from concrete.fhe.compilation.circuit import Circuit
 from concrete.fhe.compilation.compiler import Compiler
 from concrete.fhe.compilation.configuration import Configuration
+from concrete.fhe.compilation.module import FheModule
+from concrete.fhe.compilation.module_compiler import ModuleCompiler
 from concrete.fhe.dtypes.integer import Integer
 from sklearn.base import clone
 from sklearn.linear_model import LinearRegression, LogisticRegression
 from sklearn.utils.validation import check_is_fitted
 from xgboost.sklearn import XGBModel
 
+from ..common.batch_executor import (
+    BatchExecutor,
+    get_fhe_execution_device,
+    get_fhe_predict_method,
+)
+from ..common.cached_circuit import CachedCircuit
 from ..common.check_inputs import check_array_and_assert, check_X_y_and_assert_multi_output
 from ..common.debugging.custom_assert import assert_true
+from ..common.instrumentation import measure_stage
 from ..common.serialization.dumpers import dump, dumps
 from ..common.utils import (
-    USE_OLD_VL,
     FheMode,
     check_compilation_device_is_valid_and_is_cuda,
     check_execution_device_is_valid_and_is_cuda,
     check_there_is_no_p_error_options_in_configuration,
     generate_proxy_function,
     manage_parameters_for_pbs_errors,
+    reduce_block_outputs,
 )
+from ..deployment.compilation_cache import CompilationCache
 from ..onnx.convert import OPSET_VERSION_FOR_ONNX_EXPORT
 from ..onnx.onnx_model_manipulations import clean_graph_after_node_op_type, remove_node_types
 
@@ -171,6 +181,11 @@ class BaseEstimator:
         self.fhe_circuit_: Optional[Circuit] = None
         self.onnx_model_: Optional[onnx.ModelProto] = None
 
+        #: The executor used for running batches of samples in FHE or with simulation. By default,
+        #: samples are executed sequentially. Setting `BatchExecutor(n_jobs=..., batch_size=...)`
+        #: spreads them across several workers. This attribute is not serialized
+        self.fhe_executor: BatchExecutor = BatchExecutor()
+
     def __getattr__(self, attr: str):
         """Get the model's attribute.
 
@@ -283,7 +298,7 @@ class BaseEstimator:
         Returns:
             Circuit: The FHE circuit.
         """
-        assert isinstance(self.fhe_circuit_, Circuit) or self.fhe_circuit_ is None
+        assert isinstance(self.fhe_circuit_, (Circuit, CachedCircuit)) or self.fhe_circuit_ is None
         return self.fhe_circuit_
 
     def _sklearn_model_is_not_fitted_error_message(self) -> str:
@@ -516,9 +531,14 @@ class BaseEstimator:
         global_p_error: Optional[float] = None,
         verbose: bool = False,
         device: str = "cpu",
+        compilation_cache: Optional[CompilationCache] = None,
     ) -> Circuit:
         """Compile the model.
 
+        If a compilation cache is given and already holds the model's compiled artifacts, the
+        circuit is loaded from them without compiling the model. Otherwise, the model is compiled
+        and its artifacts are stored in the cache.
+
         Args:
             X (Data): A representative set of input values used for building cryptographic
                 parameters, as a Numpy array, Torch tensor, Pandas DataFrame or List. This is
@@ -539,9 +559,11 @@ class BaseEstimator:
             verbose (bool): Indicate if compilation information should be printed
                 during compilation. Default to False.
             device: FHE compilation device, can be either 'cpu' or 'cuda'.
+            compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+                from, or to store it in. Default to None.
 
         Returns:
-            Circuit: The compiled Circuit.
+            Circuit: The compiled Circuit, or the `CachedCircuit` loaded from the cache.
         """
         # Reset for double compile
         self._is_compiled = False
@@ -555,6 +577,18 @@ class BaseEstimator:
         # p_error or global_p_error should not be set in both the configuration and direct arguments
         check_there_is_no_p_error_options_in_configuration(configuration)
 
+        # The key is computed on the given parameters, as done by the cache's `compile_and_save`
+        cache_key = None
+        if compilation_cache is not None:
+            cache_key = compilation_cache.get_key(
+                self,
+                X,
+                configuration=configuration,
+                p_error=p_error,
+                global_p_error=global_p_error,
+                device=device,
+            )
+
         # Find the right way to set parameters for compiler, depending on the way we want to default
         p_error, global_p_error = manage_parameters_for_pbs_errors(p_error, global_p_error)
 
@@ -575,33 +609,122 @@ class BaseEstimator:
             f"{type(module_to_compile)}."
         )
 
-        # Enable input ciphertext compression
-        enable_input_compression = os.environ.get("USE_INPUT_COMPRESSION", "1") == "1"
-        # Enable evaluation key compression
-        enable_key_compression = os.environ.get("USE_KEY_COMPRESSION", "1") == "1"
+        cached_circuit = None
+        if compilation_cache is not None:
+            assert cache_key is not None
+            compilation_options = self._get_compilation_options(
+                show_mlir, p_error, global_p_error, verbose, use_gpu
+            )
+            cached_circuit = compilation_cache.load_circuit(
+                cache_key,
+                lambda: module_to_compile.trace(inputset, configuration=configuration),
+                (configuration or Configuration()).fork(**compilation_options),
+            )
 
-        self.fhe_circuit_ = module_to_compile.compile(
-            inputset,
-            configuration=configuration,
-            artifacts=artifacts,
-            show_mlir=show_mlir,
-            p_error=p_error,
-            global_p_error=global_p_error,
-            verbose=verbose,
-            single_precision=False,
-            use_gpu=use_gpu,
-            compress_input_ciphertexts=enable_input_compression,
-            compress_evaluation_keys=enable_key_compression,
-        )
+        if cached_circuit is not None:
+            # The cached circuit provides the same interface as the compiled one
+            self.fhe_circuit_ = cast(Circuit, cached_circuit)
+        else:
+            self.fhe_circuit_ = self._compile_circuit(
+                module_to_compile,
+                inputset,
+                configuration=configuration,
+                artifacts=artifacts,
+                show_mlir=show_mlir,
+                p_error=p_error,
+                global_p_error=global_p_error,
+                verbose=verbose,
+                use_gpu=use_gpu,
+            )
 
         self._is_compiled = True
         self._compiled_for_cuda = use_gpu
 
+        if compilation_cache is not None and cached_circuit is None:
+            assert cache_key is not None
+            compilation_cache.put(cache_key, self)
+
         # For mypy
-        assert isinstance(self.fhe_circuit, Circuit)
+        assert isinstance(self.fhe_circuit, (Circuit, CachedCircuit))
 
         return self.fhe_circuit
 
+    @staticmethod
+    def _compile_circuit(
+        compiler: Compiler,
+        inputset: Any,
+        configuration: Optional[Configuration],
+        artifacts: Optional[DebugArtifacts],
+        show_mlir: bool,
+        p_error: Optional[float],
+        global_p_error: Optional[float],
+        verbose: bool,
+        use_gpu: bool,
+    ) -> Circuit:
+        """Compile a Concrete compiler instance using the model's compilation options.
+
+        Args:
+            compiler (Compiler): The compiler instance to compile.
+            inputset (Any): The compilation input-set.
+            configuration (Optional[Configuration]): Options to use for compilation.
+            artifacts (Optional[DebugArtifacts]): Artifacts information about the compilation
+                process to store for debugging.
+            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
+            p_error (Optional[float]): Probability of error of a single PBS.
+            global_p_error (Optional[float]): Probability of error of the full circuit.
+            verbose (bool): Indicate if compilation information should be printed during
+                compilation.
+            use_gpu (bool): Indicate if the circuit should be compiled for CUDA.
+
+        Returns:
+            Circuit: The compiled Circuit.
+        """
+        return compiler.compile(
+            inputset,
+            configuration=configuration,
+            artifacts=artifacts,
+            **BaseEstimator._get_compilation_options(
+                show_mlir, p_error, global_p_error, verbose, use_gpu
+            ),
+        )
+
+    @staticmethod
+    def _get_compilation_options(
+        show_mlir: bool,
+        p_error: Optional[float],
+        global_p_error: Optional[float],
+        verbose: bool,
+        use_gpu: bool,
+    ) -> Dict[str, Any]:
+        """Get the options given to Concrete when compiling the model's circuits or modules.
+
+        Args:
+            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
+            p_error (Optional[float]): Probability of error of a single PBS.
+            global_p_error (Optional[float]): Probability of error of the full circuit.
+            verbose (bool): Indicate if compilation information should be printed during
+                compilation.
+            use_gpu (bool): Indicate if the circuit should be compiled for CUDA.
+
+        Returns:
+            Dict[str, Any]: The compilation options.
+        """
+        # Enable input ciphertext compression
+        enable_input_compression = os.environ.get("USE_INPUT_COMPRESSION", "1") == "1"
+        # Enable evaluation key compression
+        enable_key_compression = os.environ.get("USE_KEY_COMPRESSION", "1") == "1"
+
+        return {
+            "show_mlir": show_mlir,
+            "p_error": p_error,
+            "global_p_error": global_p_error,
+            "verbose": verbose,
+            "single_precision": False,
+            "use_gpu": use_gpu,
+            "compress_input_ciphertexts": enable_input_compression,
+            "compress_evaluation_keys": enable_key_compression,
+        }
+
     @abstractmethod
     def _inference(self, q_X: numpy.ndarray) -> numpy.ndarray:
         """Inference function to consider when executing in the clear.
@@ -648,57 +771,39 @@ class BaseEstimator:
         # Check that X's type and shape are supported
         X = check_array_and_assert(X)
 
+        model_name = self.__class__.__name__
+
         # Quantize the input
-        q_X = self.quantize_input(X)
+        with measure_stage("model.quantize", model=model_name):
+            q_X = self.quantize_input(X)
 
         # If the inference is executed in FHE or simulation mode
         if fhe in ["simulate", "execute"]:
             # Check that the model is properly compiled
             self.check_model_is_compiled()
 
-            q_y_pred_list = []
-            for q_X_i in q_X:
-                # Expected encrypt_run_decrypt output shape is (1, n_features) while q_X_i
-                # is of shape (n_features,)
-                q_X_i = numpy.expand_dims(q_X_i, 0)
-
-                # For mypy, even though we already check this with self.check_model_is_compiled()
-                assert self.fhe_circuit is not None
-
-                # If the inference should be executed using simulation
-                if fhe == "simulate":
-                    is_crt_encoding = self.fhe_circuit.statistics["packing_key_switch_count"] != 0
-
-                    # If the virtual library method should be used
-                    # For now, use the virtual library when simulating
-                    # circuits that use CRT  encoding because the official simulation is too slow
-                    # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4391
-                    if USE_OLD_VL or is_crt_encoding:
-                        predict_method = partial(
-                            self.fhe_circuit.graph, p_error=self.fhe_circuit.p_error
-                        )  # pragma: no cover
-
-                    # Else, use the official simulation method
-                    else:
-                        predict_method = self.fhe_circuit.simulate
-
-                # Else, use the FHE execution method
-                else:
-                    predict_method = self.fhe_circuit.encrypt_run_decrypt
+            # For mypy, even though we already check this with self.check_model_is_compiled()
+            assert self.fhe_circuit is not None
 
-                # Execute the inference in FHE or with simulation
-                q_y_pred_i = predict_method(q_X_i)
-                assert isinstance(q_y_pred_i, numpy.ndarray)
-                q_y_pred_list.append(q_y_pred_i[0])
+            # Resolve the execution method once for the whole batch
+            predict_method = get_fhe_predict_method(self.fhe_circuit, fhe)
 
-            q_y_pred = numpy.array(q_y_pred_list)
+            # Execute the inference in FHE or with simulation, sample by sample
+            with measure_stage("model.inference", model=model_name, fhe=str(fhe)):
+                q_y_pred = self.fhe_executor.run(
+                    predict_method,
+                    q_X,
+                    device=get_fhe_execution_device(self._compiled_for_cuda, fhe),
+                )[0]
 
         # Else, the prediction is simulated in the clear
         else:
-            q_y_pred = self._inference(q_X)
+            with measure_stage("model.inference", model=model_name, fhe=str(fhe)):
+                q_y_pred = self._inference(q_X)
 
         # De-quantize the predicted values in the clear
-        y_pred = self.dequantize_output(q_y_pred)
+        with measure_stage("model.dequantize", model=model_name):
+            y_pred = self.dequantize_output(q_y_pred)
         assert isinstance(y_pred, numpy.ndarray)
         return y_pred
 
@@ -1180,6 +1285,7 @@ class QuantizedTorchEstimatorMixin(BaseEstimator):
         global_p_error: Optional[float] = None,
         verbose: bool = False,
         device: str = "cpu",
+        compilation_cache: Optional[CompilationCache] = None,
     ) -> Circuit:
         # Reset for double compile
         self._is_compiled = False
@@ -1193,7 +1299,7 @@ class QuantizedTorchEstimatorMixin(BaseEstimator):
         # Retrieve the module instance to compile
         module_to_compile = self._get_module_to_compile()
 
-        # Compile the QuantizedModule
+        # Compile the QuantizedModule, whose circuit is cached on its own
         module_to_compile.compile(
             X,
             configuration=configuration,
@@ -1203,6 +1309,7 @@ class QuantizedTorchEstimatorMixin(BaseEstimator):
             global_p_error=global_p_error,
             verbose=verbose,
             device=device,
+            compilation_cache=compilation_cache,
         )
 
         # Make sure that no avoidable TLUs are found in the built-in model
@@ -2028,6 +2135,48 @@ class SklearnSGDClassifierMixin(SklearnLinearClassifierMixin):
         self._clean_graph()
 
 
+def _get_blocks_module_functions(n_blocks: int) -> Dict[str, Any]:
+    """Get the names of the functions of a module computing the k nearest neighbors by blocks.
+
+    The module holds one function per block and a last function merging two outputs into the k
+    nearest labels. With more than two blocks, an additional function merges two outputs into new
+    k nearest distances and labels. A last function returns the query as is, its output being
+    wired to all the blocks' inputs so that a single encrypted query is given to all of them.
+
+    Args:
+        n_blocks (int): The number of blocks, at least two.
+
+    Returns:
+        Dict[str, Any]: The names of the query function ("query"), of the blocks' functions
+            ("blocks"), of the merge function ("merge", None if there are only two blocks) and of
+            the last merge function ("merge_final").
+    """
+    return {
+        "query": "query",
+        "blocks": [f"block_{i}" for i in range(n_blocks)],
+        "merge": "merge" if n_blocks > 2 else None,
+        "merge_final": "merge_final",
+    }
+
+
+def _concatenate_block_outputs(
+    block_outputs: List[Tuple[numpy.ndarray, numpy.ndarray]]
+) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    """Concatenate the k nearest distances and labels of several blocks of training points.
+
+    Args:
+        block_outputs (List[Tuple[numpy.ndarray, numpy.ndarray]]): The k nearest distances and
+            labels of each block, of shape (1, k).
+
+    Returns:
+        Tuple[numpy.ndarray, numpy.ndarray]: The concatenated distances and labels, of shape
+            (1, n_blocks * k).
+    """
+    distances = numpy.concatenate([distances for distances, _ in block_outputs], axis=1)
+    labels = numpy.concatenate([labels for _, labels in block_outputs], axis=1)
+    return distances, labels
+
+
 # pylint: disable-next=invalid-name,too-many-instance-attributes
 class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
     """A Mixin class for sklearn KNeighbors models with FHE.
@@ -2044,14 +2193,26 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
                 _NEIGHBORS_MODELS.add(cls)
                 _ALL_SKLEARN_MODELS.add(cls)
 
-    def __init__(self, n_bits: int = 3):
+    def __init__(self, n_bits: int = 3, block_size: Optional[int] = None):
         """Initialize the FHE knn model.
 
         Args:
             n_bits (int): Number of bits to quantize the model. The value will be used for
                 quantizing inputs and X_fit. Default to 3.
+            block_size (Optional[int]): If set, the training set is split into blocks of at least
+                `block_size` points, each one being compiled in its own small circuit, and a last
+                circuit merges the blocks' k nearest neighbors. If None, a single circuit over all
+                training points is compiled. Default to None.
         """
         self.n_bits: int = n_bits
+        self.block_size: Optional[int] = block_size
+
+        #: The module computing and merging the k nearest neighbors of each block of training
+        #: points, when `block_size` is set. The `fhe_circuit` is then None
+        self.fhe_module_: Optional[FheModule] = None
+
+        #: The names of the module's functions, as given by `_get_blocks_module_functions`
+        self.fhe_module_functions_: Optional[Dict[str, Any]] = None
 
         # _q_fit_X: In distance metric algorithms, `_q_fit_X` stores the training set to compute
         # the similarity or distance measures. There is no `weights` attribute because there isn't
@@ -2136,6 +2297,13 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
 
         self._y = numpy.array(y)
 
+        assert_true(
+            self.block_size is None or self.block_size >= self.n_neighbors,
+            "Parameter 'block_size' must be None or greater or equal to 'n_neighbors'. Got "
+            f"{self.block_size}.",
+            ValueError,
+        )
+
         # We assume that the query has the same distribution as the data in _X_fit.
         # therefore, they use the same scaling and zero point.
         # https://arxiv.org/abs/1712.05877
@@ -2158,6 +2326,31 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
 
         return self
 
+    def get_sklearn_params(self, deep: bool = True) -> dict:
+        params = super().get_sklearn_params(deep=deep)
+
+        # Remove the block_size parameter as this attribute is added by Concrete ML
+        params.pop("block_size", None)
+
+        return params
+
+    def _get_blocks(self) -> List[Tuple[numpy.ndarray, numpy.ndarray]]:
+        """Split the quantized training points and their labels into blocks.
+
+        The training set is split into `n_samples // block_size` blocks of balanced sizes, meaning
+        each block holds at least `block_size` points.
+
+        Returns:
+            List[Tuple[numpy.ndarray, numpy.ndarray]]: The blocks' training points and labels.
+        """
+        n_blocks = 1
+        if self.block_size is not None:
+            n_blocks = max(1, self._q_fit_X.shape[0] // self.block_size)
+
+        return list(
+            zip(numpy.array_split(self._q_fit_X, n_blocks), numpy.array_split(self._y, n_blocks))
+        )
+
     def quantize_input(self, X: numpy.ndarray) -> numpy.ndarray:
         self.check_model_is_fitted()
         q_X = self.input_quantizers[0].quant(X)
@@ -2196,6 +2389,385 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
 
         return compiler
 
+    def _get_blocks_module_compiler(
+        self, blocks: List[Tuple[numpy.ndarray, numpy.ndarray]]
+    ) -> ModuleCompiler:
+        """Retrieve the module compiler computing and merging the k nearest neighbors of blocks.
+
+        The module holds one function per block, computing the k nearest distances and labels among
+        its training points, as well as the functions merging these outputs two by two. All
+        functions are compiled together and share the same keys. The blocks' and merges' outputs
+        are wired to the merge functions' inputs, so that their ciphertexts can be chained without
+        being decrypted. The query function's output is wired to all the blocks' inputs, which
+        thus share the same encryption parameters: the query is encrypted once for all blocks.
+
+        Args:
+            blocks (List[Tuple[numpy.ndarray, numpy.ndarray]]): The blocks' quantized training
+                points and labels.
+
+        Returns:
+            ModuleCompiler: The module compiler instance.
+        """
+        function_names = _get_blocks_module_functions(len(blocks))
+
+        def to_module_function(
+            function: Callable, name: str, encryption_statuses: Dict[str, str]
+        ) -> Any:
+            """Turn a function into a module function of the given name.
+
+            Args:
+                function (Callable): The function to turn into a module function.
+                name (str): The name of the module function.
+                encryption_statuses (Dict[str, str]): The encryption status of each parameter.
+
+            Returns:
+                Any: The module function.
+            """
+            function.__name__ = name
+            return cp.function(encryption_statuses)(function)
+
+        def get_block_inference_to_compile(q_fit_X: numpy.ndarray, y: numpy.ndarray) -> Callable:
+            """Get the function computing the k nearest neighbors of a block.
+
+            Args:
+                q_fit_X (numpy.ndarray): The block's quantized training points.
+                y (numpy.ndarray): The block's labels.
+
+            Returns:
+                Callable: The block's function.
+            """
+
+            def block_inference_to_compile(
+                q_X: numpy.ndarray,
+            ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+                """Compile the block's function in FHE using only the inputs as parameters.
+
+                Args:
+                    q_X (numpy.ndarray): The quantized input data
+
+                Returns:
+                    Tuple[numpy.ndarray, numpy.ndarray]: The block's k nearest distances and labels.
+                """
+                return self._block_inference(q_X, q_fit_X, y)
+
+            return block_inference_to_compile
+
+        def merge_inference_to_compile(
+            distances_a: numpy.ndarray,
+            labels_a: numpy.ndarray,
+            distances_b: numpy.ndarray,
+            labels_b: numpy.ndarray,
+        ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+            """Compile the merge function in FHE using only the inputs as parameters.
+
+            Args:
+                distances_a (numpy.ndarray): The first k nearest distances.
+                labels_a (numpy.ndarray): The labels of these distances.
+                distances_b (numpy.ndarray): The second k nearest distances.
+                labels_b (numpy.ndarray): The labels of these distances.
+
+            Returns:
+                Tuple[numpy.ndarray, numpy.ndarray]: The merged k nearest distances and labels.
+            """
+            return self._merge_pair(distances_a, labels_a, distances_b, labels_b)
+
+        def merge_final_inference_to_compile(
+            distances_a: numpy.ndarray,
+            labels_a: numpy.ndarray,
+            distances_b: numpy.ndarray,
+            labels_b: numpy.ndarray,
+        ) -> numpy.ndarray:
+            """Compile the last merge function in FHE using only the inputs as parameters.
+
+            Args:
+                distances_a (numpy.ndarray): The first k nearest distances.
+                labels_a (numpy.ndarray): The labels of these distances.
+                distances_b (numpy.ndarray): The second k nearest distances.
+                labels_b (numpy.ndarray): The labels of these distances.
+
+            Returns:
+                numpy.ndarray: The k nearest labels.
+            """
+            return self._merge_pair(distances_a, labels_a, distances_b, labels_b)[1]
+
+        def query_to_compile(q_X: numpy.ndarray) -> numpy.ndarray:
+            """Compile the function returning the query, only used to wire the blocks' inputs.
+
+            Args:
+                q_X (numpy.ndarray): The quantized input data
+
+            Returns:
+                numpy.ndarray: The same quantized input data.
+            """
+            return cp.identity(q_X)
+
+        merge_encryption_statuses = {
+            name: "encrypted" for name in ["distances_a", "labels_a", "distances_b", "labels_b"]
+        }
+
+        functions = {
+            name: to_module_function(
+                get_block_inference_to_compile(q_fit_X, y), name, {"q_X": "encrypted"}
+            )
+            for name, (q_fit_X, y) in zip(function_names["blocks"], blocks)
+        }
+        sources = list(functions.values())
+
+        merge_functions = []
+        if function_names["merge"] is not None:
+            functions[function_names["merge"]] = to_module_function(
+                merge_inference_to_compile, function_names["merge"], merge_encryption_statuses
+            )
+            sources.append(functions[function_names["merge"]])
+            merge_functions.append(functions[function_names["merge"]])
+
+        functions[function_names["merge_final"]] = to_module_function(
+            merge_final_inference_to_compile,
+            function_names["merge_final"],
+            merge_encryption_statuses,
+        )
+        merge_functions.append(functions[function_names["merge_final"]])
+
+        # Wire the distances and labels output by any block or merge to both sides of the merges
+        wires = {
+            cp.Wire(cp.Output(source, position), cp.Input(target, 2 * side + position))
+            for source in sources
+            for target in merge_functions
+            for side in range(2)
+            for position in range(2)
+        }
+
+        # Wire the query to all blocks, so that they accept the same ciphertext
+        functions[function_names["query"]] = to_module_function(
+            query_to_compile, function_names["query"], {"q_X": "encrypted"}
+        )
+        wires.update(
+            cp.Wire(cp.Output(functions[function_names["query"]], 0), cp.Input(block, 0))
+            for block in (functions[name] for name in function_names["blocks"])
+        )
+
+        module_class = type(
+            "KNeighborsBlocksModule", (), {**functions, "composition": cp.Wired(wires)}
+        )
+
+        return cp.module()(module_class)
+
+    # pylint: disable-next=too-many-locals
+    def compile(
+        self,
+        X: Data,
+        configuration: Optional[Configuration] = None,
+        artifacts: Optional[DebugArtifacts] = None,
+        show_mlir: bool = False,
+        p_error: Optional[float] = None,
+        global_p_error: Optional[float] = None,
+        verbose: bool = False,
+        device: str = "cpu",
+        compilation_cache: Optional[CompilationCache] = None,
+    ) -> Union[Circuit, FheModule]:
+        """Compile the model.
+
+        If `block_size` is set, the blocks' functions and the functions merging their outputs are
+        compiled together as a single FHE module, stored in `fhe_module_`, which is also returned.
+        The p_error and global_p_error values then apply to each of these functions.
+
+        Args:
+            X (Data): A representative set of input values used for building cryptographic
+                parameters, as a Numpy array, Torch tensor, Pandas DataFrame or List. This is
+                usually the training data-set or a sub-set of it.
+            configuration (Optional[Configuration]): Options to use for compilation. Default
+                to None.
+            artifacts (Optional[DebugArtifacts]): Artifacts information about the compilation
+                process to store for debugging. Not supported if `block_size` is set. Default to
+                None.
+            show_mlir (bool): Indicate if the MLIR graph should be printed during compilation.
+                Default to False.
+            p_error (Optional[float]): Probability of error of a single PBS. A p_error value cannot
+                be given if a global_p_error value is already set. Default to None, which sets this
+                error to a default value.
+            global_p_error (Optional[float]): Probability of error of the full circuit. A
+                global_p_error value cannot be given if a p_error value is already set. This feature
+                is not supported during the FHE simulation mode, meaning the probability is
+                currently set to 0. Default to None, which sets this error to a default value.
+            verbose (bool): Indicate if compilation information should be printed
+                during compilation. Default to False.
+            device: FHE compilation device, can be either 'cpu' or 'cuda'.
+            compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+                from, or to store it in. Not supported if `block_size` is set. Default to None.
+
+        Returns:
+            Union[Circuit, FheModule]: The compiled Circuit, or the compiled module if `block_size`
+                is set.
+
+        Raises:
+            ValueError: If debug artifacts or a compilation cache are given while `block_size` is
+                set.
+        """
+        self.fhe_module_ = None
+        self.fhe_module_functions_ = None
+
+        # Check that the model is correctly fitted
+        self.check_model_is_fitted()
+
+        blocks = self._get_blocks()
+
+        if len(blocks) == 1:
+            return super().compile(
+                X,
+                configuration,
+                artifacts,
+                show_mlir,
+                p_error,
+                global_p_error,
+                verbose,
+                device,
+                compilation_cache,
+            )
+
+        if artifacts is not None:
+            raise ValueError("Debug artifacts are not supported for models compiled by blocks.")
+
+        if compilation_cache is not None:
+            raise ValueError("Compilation caches are not supported for models compiled by blocks.")
+
+        # Reset for double compile
+        self._is_compiled = False
+        self.fhe_circuit_ = None
+
+        # Cast pandas, list or torch to numpy
+        X = check_array_and_assert(X)
+
+        # p_error or global_p_error should not be set in both the configuration and direct arguments
+        check_there_is_no_p_error_options_in_configuration(configuration)
+
+        # Find the right way to set parameters for compiler, depending on the way we want to default
+        p_error, global_p_error = manage_parameters_for_pbs_errors(p_error, global_p_error)
+
+        use_gpu = check_compilation_device_is_valid_and_is_cuda(device)
+
+        # Quantize the inputs
+        q_X = self.quantize_input(X)
+
+        function_names = _get_blocks_module_functions(len(blocks))
+        merge_name, merge_final_name = function_names["merge"], function_names["merge_final"]
+
+        # Each block is compiled on the input-set, while the merges are compiled on the outputs
+        # they are given when running the blocks in the clear
+        block_inputset = list(_get_inputset_generator(q_X))
+        inputsets: Dict[str, list] = {name: block_inputset for name in function_names["blocks"]}
+        inputsets[function_names["query"]] = block_inputset
+        inputsets[merge_final_name] = []
+        if merge_name is not None:
+            inputsets[merge_name] = []
+
+        def record_merge(*outputs: numpy.ndarray) -> Tuple[numpy.ndarray, numpy.ndarray]:
+            """Record the merge's inputs and merge them in the clear.
+
+            Args:
+                *outputs (numpy.ndarray): The distances and labels to merge.
+
+            Returns:
+                Tuple[numpy.ndarray, numpy.ndarray]: The merged distances and labels.
+            """
+            inputsets[merge_name].append(outputs)
+            return self._merge_pair(*outputs)
+
+        def record_merge_final(*outputs: numpy.ndarray) -> None:
+            """Record the last merge's inputs.
+
+            Args:
+                *outputs (numpy.ndarray): The distances and labels to merge.
+            """
+            inputsets[merge_final_name].append(outputs)
+
+        for q_x in block_inputset:
+            reduce_block_outputs(
+                [self._block_inference(q_x, q_fit_X, y) for q_fit_X, y in blocks],
+                record_merge,
+                record_merge_final,
+            )
+
+        self.fhe_module_ = self._get_blocks_module_compiler(blocks).compile(
+            inputsets,
+            configuration=configuration,
+            **self._get_compilation_options(show_mlir, p_error, global_p_error, verbose, use_gpu),
+        )
+        self.fhe_module_functions_ = function_names
+
+        self._is_compiled = True
+        self._compiled_for_cuda = use_gpu
+
+        return self.fhe_module_
+
+    # pylint: disable-next=too-many-locals
+    def _sharded_fhe_inference(self, q_X: numpy.ndarray, fhe: Union[FheMode, str]) -> numpy.ndarray:
+        """Execute the blocks' functions in parallel and merge their outputs, one query at a time.
+
+        In FHE, the query is encrypted once and given to all blocks, and the blocks' encrypted
+        outputs are directly given to the merge functions, meaning only the k nearest labels are
+        decrypted.
+
+        Args:
+            q_X (numpy.ndarray): The quantized input values.
+            fhe (Union[FheMode, str]): The mode to use, either FheMode.SIMULATE or
+                FheMode.EXECUTE. Can also be the string representation of any of these values.
+
+        Returns:
+            numpy.ndarray: The k nearest labels of each query.
+        """
+        assert self.fhe_module_ is not None and self.fhe_module_functions_ is not None
+
+        function_names = self.fhe_module_functions_
+        block_functions = [getattr(self.fhe_module_, name) for name in function_names["blocks"]]
+        merge_function = (
+            getattr(self.fhe_module_, function_names["merge"])
+            if function_names["merge"] is not None
+            else None
+        )
+        merge_final_function = getattr(self.fhe_module_, function_names["merge_final"])
+
+        encrypt_method: Optional[Callable] = None
+        if fhe == "simulate":
+            block_methods = [function.simulate for function in block_functions]
+            merge_method = merge_function.simulate if merge_function is not None else None
+            merge_final_method = merge_final_function.simulate
+
+        else:
+
+            def run_decrypt_merge_final(*outputs: Any) -> numpy.ndarray:
+                """Run the last merge on encrypted values and decrypt the k nearest labels.
+
+                Args:
+                    *outputs (Any): The encrypted distances and labels to merge.
+
+                Returns:
+                    numpy.ndarray: The k nearest labels.
+                """
+                return merge_final_function.decrypt(merge_final_function.run(*outputs))
+
+            # All blocks share the same input encryption parameters, the query is thus encrypted
+            # once and its ciphertext given to all of them
+            encrypt_method = block_functions[0].encrypt
+            block_methods = [function.run for function in block_functions]
+            merge_method = merge_function.run if merge_function is not None else None
+            merge_final_method = run_decrypt_merge_final
+
+        n_workers = min(len(block_methods), os.cpu_count() or 1)
+
+        topk_labels = []
+        with ThreadPoolExecutor(max_workers=n_workers) as executor:
+            for q_x in _get_inputset_generator(q_X):
+                block_input = q_x if encrypt_method is None else encrypt_method(q_x)
+
+                futures = [executor.submit(method, block_input) for method in block_methods]
+                topk_labels.append(
+                    reduce_block_outputs(
+                        [future.result() for future in futures], merge_method, merge_final_method
+                    )
+                )
+
+        return numpy.concatenate(topk_labels, axis=0)
+
     @staticmethod
     def majority_vote(nearest_classes: numpy.ndarray):
         """Determine the most common class among nearest neighborsfor each query.
@@ -2211,155 +2783,228 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
 
         return majority_votes
 
-    def _inference(self, q_X: numpy.ndarray) -> numpy.ndarray:
-        """Inference function.
+    @staticmethod
+    def _pairwise_euclidean_distance(q_X: numpy.ndarray, q_fit_X: numpy.ndarray) -> numpy.ndarray:
+        """Compute the squared euclidean distance between the inputs and the training points.
 
         Args:
             q_X (numpy.ndarray): The quantized input values.
+            q_fit_X (numpy.ndarray): The quantized training points to consider.
 
         Returns:
-            numpy.ndarray: The quantized predicted values.
+            numpy.ndarray: The distance matrix.
         """
-        assert self._q_fit_X_quantizer is not None, self._is_not_fitted_error_message()
+        # dist(x, y) = sqrt(dot(x, x) - 2 * dot(x, y) + dot(y, y))
+        return (
+            numpy.sum(q_X**2, axis=1, keepdims=True)
+            - 2 * q_X @ q_fit_X.T
+            + numpy.expand_dims(numpy.sum(q_fit_X**2, axis=1), 0)
+        )
 
-        def pairwise_euclidean_distance(q_X):
-            # 1. Pairwise euclidean distance
-            # dist(x, y) = sqrt(dot(x, x) - 2 * dot(x, y) + dot(y, y))
-            return (
-                numpy.sum(q_X**2, axis=1, keepdims=True)
-                - 2 * q_X @ self._q_fit_X.T
-                + numpy.expand_dims(numpy.sum(self._q_fit_X**2, axis=1), 0)
-            )
+    def _topk_sorting(
+        self, x: numpy.ndarray, labels: numpy.ndarray
+    ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+        """Argsort in FHE.
+
+        Time complexity: O(nlog²(k))
+
+        Args:
+            x (numpy.ndarray): The quantized input values
+            labels (numpy.ndarray): The labels of the training data-set
 
-        def topk_sorting(x, labels):
-            """Argsort in FHE.
+        Returns:
+            Tuple[numpy.ndarray, numpy.ndarray]: The k smallest values and their labels.
+        """
 
-            Time complexity: O(nlog²(k))
+        def gather1d(x, indices):
+            """Select elements from the input array `x` using the provided `indices`.
 
             Args:
-                x (numpy.ndarray): The quantized input values
-                labels (numpy.ndarray): The labels of the training data-set
+                x (numpy.ndarray): The encrypted input array
+                indices (numpy.ndarray): The desired indexes
 
             Returns:
-                numpy.ndarray: The argsort.
+                numpy.ndarray: The selected encrypted indexes.
             """
+            arr = []
+            for i in indices:
+                arr.append(x[i])
+            enc_arr = cp.array(arr)
+            return enc_arr
 
-            def gather1d(x, indices):
-                """Select elements from the input array `x` using the provided `indices`.
+        def scatter1d(x, v, indices):
+            """Rearrange elements of `x` with values from `v` at the specified `indices`.
 
-                Args:
-                    x (numpy.ndarray): The encrypted input array
-                    indices (numpy.ndarray): The desired indexes
-
-                Returns:
-                    numpy.ndarray: The selected encrypted indexes.
-                """
-                arr = []
-                for i in indices:
-                    arr.append(x[i])
-                enc_arr = cp.array(arr)
-                return enc_arr
-
-            def scatter1d(x, v, indices):
-                """Rearrange elements of `x` with values from `v` at the specified `indices`.
+            Args:
+                x (numpy.ndarray): The encrypted input array in which items will be updated
+                v (numpy.ndarray): The array containing values to be inserted into `x`
+                    at the specified `indices`.
+                indices (numpy.ndarray): The indices indicating where to insert the elements
+                    from `v` into `x`.
 
-                Args:
-                    x (numpy.ndarray): The encrypted input array in which items will be updated
-                    v (numpy.ndarray): The array containing values to be inserted into `x`
-                        at the specified `indices`.
-                    indices (numpy.ndarray): The indices indicating where to insert the elements
-                        from `v` into `x`.
+            Returns:
+                numpy.ndarray: The updated encrypted `x`
+            """
+            for idx, i in enumerate(indices):
+                x[i] = v[idx]
+            return x
+
+        comparisons = numpy.zeros(x.shape)
+        labels = labels + cp.zeros(labels.shape)
+
+        n, k = x.size, self.n_neighbors
+        # Determine the number of stages for a sequence of length n
+        ln2n = int(numpy.ceil(numpy.log2(n)))
+
+        # Stage loop
+        for t in range(ln2n - 1, -1, -1):
+            # p: Determines the range of indexes to be compared in each pass.
+            p = 2**t
+            # r: Offset that adjusts the range of indexes to be compared and sorted in each pass
+            r = 0
+            # d: Comparison distance in each pass
+            d = p
+            # Number of passes for each stage
+            for bq in range(ln2n - 1, t - 1, -1):
+                with cp.tag(f"Stage_{t}_pass_{bq}"):
+                    q = 2**bq
+                    # Determine the range of indexes to be compared
+                    range_i = numpy.array(
+                        [i for i in range(0, n - d) if i & p == r and comparisons[i] < k]
+                    )
+                    if len(range_i) == 0:
+                        # Edge case, for k=1
+                        continue
+
+                    # Select 2 bitonic sequences `a` and `b` of length `d`
+                    # a = x[range_i]: first bitonic sequence
+                    # a_i = idx[range_i]: Indexes of a_i elements in the original x
+                    a = gather1d(x, range_i)
+                    # a_i = gather1d(idx, range_i)
+                    # b = x[range_i + d]: Second bitonic sequence
+                    # b_i = idx[range_i + d]: Indexes of b_i elements in the original x
+                    b = gather1d(x, range_i + d)
+                    # b_i = gather1d(idx, range_i + d)
+
+                    labels_a = gather1d(labels, range_i)  #
+                    labels_b = gather1d(labels, range_i + d)  # idx[range_i + d]
+
+                    with cp.tag("diff"):
+                        # Select max(a, b)
+                        diff = b - a
+
+                    with cp.tag("max_value"):
+                        max_x = a + numpy.maximum(0, diff)
+
+                    with cp.tag("swap_max_value"):
+                        # Swap if a > b
+                        # x[range_i] = max_x(a, b): First bitonic sequence gets min(a, b)
+                        x = scatter1d(x, a + b - max_x, range_i)
+                        # x[range_i + d] = min(a, b): Second bitonic sequence gets max(a, b)
+                        x = scatter1d(x, max_x, range_i + d)
+
+                    # Update labels array according to the max value
+                    with cp.tag("max_label"):
+                        is_a_greater_than_b = diff > 0
+                        max_labels = labels_a + (labels_b - labels_a) * is_a_greater_than_b
+
+                    with cp.tag("swap_max_label"):
+                        labels = scatter1d(labels, labels_a + labels_b - max_labels, range_i)
+                        labels = scatter1d(labels, max_labels, range_i + d)
+
+                    # Update
+                    with cp.tag("update"):
+                        comparisons[range_i + d] = comparisons[range_i + d] + 1
+                        # Reduce the comparison distance by half
+                        d = q - p
+                        r = p
+
+        return x[0 : self.n_neighbors], labels[0 : self.n_neighbors]
+
+    def _block_inference(
+        self, q_X: numpy.ndarray, q_fit_X: numpy.ndarray, y: numpy.ndarray
+    ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+        """Retrieve the k nearest distances and labels among a block of training points.
 
-                Returns:
-                    numpy.ndarray: The updated encrypted `x`
-                """
-                for idx, i in enumerate(indices):
-                    x[i] = v[idx]
-                return x
-
-            comparisons = numpy.zeros(x.shape)
-            labels = labels + cp.zeros(labels.shape)
-
-            n, k = x.size, self.n_neighbors
-            # Determine the number of stages for a sequence of length n
-            ln2n = int(numpy.ceil(numpy.log2(n)))
-
-            # Stage loop
-            for t in range(ln2n - 1, -1, -1):
-                # p: Determines the range of indexes to be compared in each pass.
-                p = 2**t
-                # r: Offset that adjusts the range of indexes to be compared and sorted in each pass
-                r = 0
-                # d: Comparison distance in each pass
-                d = p
-                # Number of passes for each stage
-                for bq in range(ln2n - 1, t - 1, -1):
-                    with cp.tag(f"Stage_{t}_pass_{bq}"):
-                        q = 2**bq
-                        # Determine the range of indexes to be compared
-                        range_i = numpy.array(
-                            [i for i in range(0, n - d) if i & p == r and comparisons[i] < k]
-                        )
-                        if len(range_i) == 0:
-                            # Edge case, for k=1
-                            continue
-
-                        # Select 2 bitonic sequences `a` and `b` of length `d`
-                        # a = x[range_i]: first bitonic sequence
-                        # a_i = idx[range_i]: Indexes of a_i elements in the original x
-                        a = gather1d(x, range_i)
-                        # a_i = gather1d(idx, range_i)
-                        # b = x[range_i + d]: Second bitonic sequence
-                        # b_i = idx[range_i + d]: Indexes of b_i elements in the original x
-                        b = gather1d(x, range_i + d)
-                        # b_i = gather1d(idx, range_i + d)
-
-                        labels_a = gather1d(labels, range_i)  #
-                        labels_b = gather1d(labels, range_i + d)  # idx[range_i + d]
-
-                        with cp.tag("diff"):
-                            # Select max(a, b)
-                            diff = b - a
-
-                        with cp.tag("max_value"):
-                            max_x = a + numpy.maximum(0, diff)
-
-                        with cp.tag("swap_max_value"):
-                            # Swap if a > b
-                            # x[range_i] = max_x(a, b): First bitonic sequence gets min(a, b)
-                            x = scatter1d(x, a + b - max_x, range_i)
-                            # x[range_i + d] = min(a, b): Second bitonic sequence gets max(a, b)
-                            x = scatter1d(x, max_x, range_i + d)
-
-                        # Update labels array according to the max value
-                        with cp.tag("max_label"):
-                            is_a_greater_than_b = diff > 0
-                            max_labels = labels_a + (labels_b - labels_a) * is_a_greater_than_b
-
-                        with cp.tag("swap_max_label"):
-                            labels = scatter1d(labels, labels_a + labels_b - max_labels, range_i)
-                            labels = scatter1d(labels, max_labels, range_i + d)
-
-                        # Update
-                        with cp.tag("update"):
-                            comparisons[range_i + d] = comparisons[range_i + d] + 1
-                            # Reduce the comparison distance by half
-                            d = q - p
-                            r = p
-
-            return labels[0 : self.n_neighbors]
+        Args:
+            q_X (numpy.ndarray): The quantized input values.
+            q_fit_X (numpy.ndarray): The block's quantized training points.
+            y (numpy.ndarray): The block's labels.
 
+        Returns:
+            Tuple[numpy.ndarray, numpy.ndarray]: The k nearest distances and their labels.
+        """
         # 1. Pairwise_euclidiean distance
         with cp.tag("Original distance"):
-            distance_matrix = pairwise_euclidean_distance(q_X)
+            distance_matrix = self._pairwise_euclidean_distance(q_X, q_fit_X)
 
         # The square root in the Euclidean distance calculation is not applied to speed up FHE
         # computations.
         # Being a monotonic function, it does not affect the logic of the calculation, notably for
         # the argsort.
 
-        topk_labels = topk_sorting(distance_matrix.flatten(), self._y)
-        return numpy.expand_dims(topk_labels, axis=0)
+        topk_distances, topk_labels = self._topk_sorting(distance_matrix.flatten(), y)
+        return numpy.expand_dims(topk_distances, axis=0), numpy.expand_dims(topk_labels, axis=0)
+
+    def _merge_inference(
+        self, distances: numpy.ndarray, labels: numpy.ndarray
+    ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+        """Merge the blocks' k nearest distances and labels into the overall k nearest ones.
+
+        Args:
+            distances (numpy.ndarray): The concatenated k nearest distances of all blocks.
+            labels (numpy.ndarray): The concatenated labels of these distances.
+
+        Returns:
+            Tuple[numpy.ndarray, numpy.ndarray]: The k nearest distances and their labels.
+        """
+        topk_distances, topk_labels = self._topk_sorting(distances.flatten(), labels.flatten())
+        return numpy.expand_dims(topk_distances, axis=0), numpy.expand_dims(topk_labels, axis=0)
+
+    def _merge_pair(
+        self,
+        distances_a: numpy.ndarray,
+        labels_a: numpy.ndarray,
+        distances_b: numpy.ndarray,
+        labels_b: numpy.ndarray,
+    ) -> Tuple[numpy.ndarray, numpy.ndarray]:
+        """Merge the k nearest distances and labels of two blocks, or of two previous merges.
+
+        Args:
+            distances_a (numpy.ndarray): The first k nearest distances, of shape (1, k).
+            labels_a (numpy.ndarray): The labels of these distances.
+            distances_b (numpy.ndarray): The second k nearest distances, of shape (1, k).
+            labels_b (numpy.ndarray): The labels of these distances.
+
+        Returns:
+            Tuple[numpy.ndarray, numpy.ndarray]: The k nearest distances and their labels.
+        """
+        return self._merge_inference(
+            *_concatenate_block_outputs([(distances_a, labels_a), (distances_b, labels_b)])
+        )
+
+    def _inference(self, q_X: numpy.ndarray) -> numpy.ndarray:
+        """Inference function.
+
+        Args:
+            q_X (numpy.ndarray): The quantized input values.
+
+        Returns:
+            numpy.ndarray: The quantized predicted values.
+        """
+        assert self._q_fit_X_quantizer is not None, self._is_not_fitted_error_message()
+
+        blocks = self._get_blocks()
+
+        if len(blocks) == 1:
+            return self._block_inference(q_X, *blocks[0])[1]
+
+        # Merge the blocks two by two, as done by the compiled module
+        return reduce_block_outputs(
+            [self._block_inference(q_X, q_fit_X, y) for q_fit_X, y in blocks],
+            self._merge_pair,
+            lambda *outputs: self._merge_pair(*outputs)[1],
+        )
 
     def post_processing(self, y_preds: numpy.ndarray) -> numpy.ndarray:
         """Provide the majority vote among the topk labels of each point.
@@ -2393,6 +3038,19 @@ class SklearnKNeighborsMixin(BaseEstimator, sklearn.base.BaseEstimator, ABC):
 
         X = check_array_and_assert(X)
 
+        # In FHE or simulation mode, the circuit is executed one query at a time, which is already
+        # handled by the model's batch executor
+        if fhe in ["simulate", "execute"]:
+            if self.fhe_module_ is None:
+                return BaseEstimator.predict(self, X, fhe=fhe)
+
+            # If the model was compiled by blocks, their functions are executed in parallel
+            self.check_model_is_compiled()
+            check_execution_device_is_valid_and_is_cuda(self._compiled_for_cuda, fhe=fhe)
+
+            q_X = self.quantize_input(X)
+            return self.dequantize_output(self._sharded_fhe_inference(q_X, fhe))
+
         topk_labels = []
         for query in X:
             query = numpy.expand_dims(query, 0)
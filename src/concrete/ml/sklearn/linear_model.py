@@ -1,9 +1,14 @@
 """Implement sklearn linear model."""
 
 import itertools
+import json
+import os
 import time
 import warnings
-from typing import Any, Dict, Optional, Tuple, Union
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple, Union
 
 import numpy
 import sklearn.linear_model
@@ -11,6 +16,7 @@ from concrete.fhe import Configuration
 from concrete.fhe import Value as EncryptedValue
 from sklearn.preprocessing import LabelEncoder
 
+from ..common.instrumentation import measure_stage, record_bytes
 from ..common.utils import FheMode
 from ..onnx.ops_impl import numpy_sigmoid
 from ..quantization import QuantizedModule
@@ -25,6 +31,16 @@ from .base import (
     Target,
 )
 
+# Number of training batches quantized and encrypted in the background while the current training
+# iteration is executed
+TRAINING_PREFETCHED_BATCHES = 2
+
+# Name of the file storing the state of an encrypted training in its checkpoint directory
+TRAINING_CHECKPOINT_FILE_NAME = "training_checkpoint.npz"
+
+# Name of the file storing the keys of an encrypted training in its checkpoint directory
+TRAINING_KEYS_FILE_NAME = "training_keys"
+
 
 # pylint: disable=invalid-name,too-many-instance-attributes,too-many-lines
 class LinearRegression(SklearnLinearRegressorMixin):
@@ -423,7 +439,160 @@ class SGDClassifier(SklearnSGDClassifierMixin):
 
         return weights_float, bias_float
 
-    # pylint: disable-next=too-many-branches, too-many-statements, too-many-locals
+    def _prepare_training_batch(
+        self,
+        X: numpy.ndarray,
+        y: numpy.ndarray,
+        batch_indexes: numpy.ndarray,
+        fhe: Union[str, FheMode],
+    ) -> Tuple[Any, Any]:
+        """Build, quantize and encrypt (if needed) a training batch.
+
+        Args:
+            X (numpy.ndarray): The training data.
+            y (numpy.ndarray): The encoded target data.
+            batch_indexes (numpy.ndarray): The indexes of the batch's samples.
+            fhe (Union[str, FheMode]): The mode to use for FHE training.
+
+        Returns:
+            Tuple[Any, Any]: The quantized, and encrypted if the training is done in FHE, input
+                and target values of the batch.
+        """
+        assert self.training_quantized_module is not None
+
+        n_features = X.shape[1]
+
+        with measure_stage("sgd_training.batch", fhe=str(fhe)):
+
+            # Build the batches
+            X_batch = X[batch_indexes].astype(float).reshape((1, self.batch_size, n_features))
+            y_batch = y[batch_indexes].reshape((1, self.batch_size, 1)).astype(float)
+
+            # The underlying quantized module expects (X, y, weight, bias) as inputs. We thus only
+            # quantize the input and target values using the first and second positional parameter
+            q_X_batch, q_y_batch, _, _ = self.training_quantized_module.quantize_input(
+                X_batch, y_batch, None, None
+            )
+
+            # If the training is done in FHE, encrypt the input and target values
+            if fhe == "execute":
+                assert self.training_quantized_module.fhe_circuit is not None
+
+                # Similarly, the underlying FHE circuit expects (X, y, weight, bias) as inputs, and
+                # so does the encrypt method
+                X_batch_enc, y_batch_enc, _, _ = self.training_quantized_module.fhe_circuit.encrypt(
+                    q_X_batch, q_y_batch, None, None
+                )
+
+                return X_batch_enc, y_batch_enc
+
+        return q_X_batch, q_y_batch
+
+    @staticmethod
+    def _get_training_value_size(value: Any) -> int:
+        """Get the size of a training value, as sent to the training circuit.
+
+        Args:
+            value (Any): The quantized or encrypted value.
+
+        Returns:
+            int: The value's size in bytes.
+        """
+        if isinstance(value, EncryptedValue):  # pragma: no cover
+            return len(value.serialize())
+
+        return int(numpy.asarray(value).nbytes)
+
+    def _save_training_checkpoint(
+        self,
+        checkpoint_dir: Path,
+        state: Dict[str, Any],
+        weights_enc: Any,
+        bias_enc: Any,
+    ):
+        """Save a training checkpoint.
+
+        The checkpoint is first written in a temporary file that then replaces the previous one,
+        so that an interrupted training never leaves a partially written checkpoint.
+
+        Args:
+            checkpoint_dir (Path): The checkpoint directory.
+            state (Dict[str, Any]): The training state, as a JSON serializable dictionary.
+            weights_enc (Any): The quantized, or encrypted, weight values.
+            bias_enc (Any): The quantized, or encrypted, bias values.
+        """
+        values = {}
+        for name, value in (("weights", weights_enc), ("bias", bias_enc)):
+            if isinstance(value, EncryptedValue):  # pragma: no cover
+                values[name] = numpy.frombuffer(value.serialize(), dtype=numpy.uint8)
+            else:
+                values[name] = numpy.asarray(value)
+
+        checkpoint_path = checkpoint_dir / TRAINING_CHECKPOINT_FILE_NAME
+        temporary_path = checkpoint_path.with_suffix(".tmp")
+
+        with measure_stage("sgd_training.checkpoint"):
+            with open(temporary_path, "wb") as file:
+                numpy.savez(file, state=numpy.array(json.dumps(state)), **values)
+
+            os.replace(temporary_path, checkpoint_path)
+
+        if self.verbose:
+            print(f"Saved training checkpoint at iteration {state['iteration']}.")
+
+    def _load_training_checkpoint(
+        self,
+        checkpoint_dir: Path,
+        fhe: Union[str, FheMode],
+        n_features: int,
+        max_iter: int,
+    ) -> Optional[Tuple[Dict[str, Any], Any, Any]]:
+        """Load the last training checkpoint.
+
+        Args:
+            checkpoint_dir (Path): The checkpoint directory.
+            fhe (Union[str, FheMode]): The mode to use for FHE training.
+            n_features (int): The number of features of the training data.
+            max_iter (int): The number of training iterations.
+
+        Returns:
+            Optional[Tuple[Dict[str, Any], Any, Any]]: The training state and the quantized, or
+                encrypted, weight and bias values, or None if the directory has no checkpoint.
+
+        Raises:
+            ValueError: If the checkpoint was saved by a training using different parameters.
+        """
+        checkpoint_path = checkpoint_dir / TRAINING_CHECKPOINT_FILE_NAME
+
+        if not checkpoint_path.is_file():
+            return None
+
+        with numpy.load(checkpoint_path, allow_pickle=False) as checkpoint:
+            state = json.loads(str(checkpoint["state"]))
+            weights_enc, bias_enc = checkpoint["weights"], checkpoint["bias"]
+
+        expected_state = {
+            "fhe": FheMode(fhe).value,
+            "n_features": n_features,
+            "max_iter": max_iter,
+            "batch_size": self.batch_size,
+        }
+
+        for key, expected_value in expected_state.items():
+            if state[key] != expected_value:
+                raise ValueError(
+                    f"The checkpoint found in {checkpoint_dir} was saved by a training with "
+                    f"{key}={state[key]}, but the current training uses {key}={expected_value}. "
+                    "Please use another checkpoint directory."
+                )
+
+        if fhe == "execute":  # pragma: no cover
+            weights_enc = EncryptedValue.deserialize(weights_enc.tobytes())
+            bias_enc = EncryptedValue.deserialize(bias_enc.tobytes())
+
+        return state, weights_enc, bias_enc
+
+    # pylint: disable-next=too-many-branches,too-many-statements,too-many-locals,too-many-arguments
     def _fit_encrypted(
         self,
         X,
@@ -434,6 +603,8 @@ class SGDClassifier(SklearnSGDClassifierMixin):
         is_partial_fit: bool = False,
         classes: Optional[numpy.ndarray] = None,
         device: str = "cpu",
+        checkpoint_dir: Optional[Union[str, Path]] = None,
+        checkpoint_every: int = 1,
     ):
         """Fit SGDClassifier in FHE.
 
@@ -441,7 +612,13 @@ class SGDClassifier(SklearnSGDClassifierMixin):
         A quantized module is first built in order to generate the FHE circuit need for training.
         Then, the method iterates over it in the clear so that outputs of an iteration are used as
         inputs for the following iteration. Thanks to Concrete's composition feature, no
-        encryption/decryption steps are needed when the training is executed in FHE.
+        encryption/decryption steps are needed when the training is executed in FHE. The following
+        batches are quantized and encrypted in a background thread while an iteration is executed.
+
+        If a checkpoint directory is given, the (encrypted) weight and bias values are saved in it
+        during training, along with the keys when training in FHE. Calling fit with the same
+        directory resumes the training from the last checkpoint, following the same batches as
+        the interrupted training.
 
         For more details on some of these arguments please refer to:
         https://scikit-learn.org/stable/modules/generated/sklearn.linear_model.SGDClassifier.html
@@ -464,14 +641,18 @@ class SGDClassifier(SklearnSGDClassifierMixin):
                 similar to a fit but with only a single iteration.
             classes (Optional[numpy.ndarray]): should be specified in the first call to partial fit.
             device: FHE compilation device, can be either 'cpu' or 'cuda'.
+            checkpoint_dir (Optional[Union[str, Path]]): The directory where training checkpoints
+                are saved and resumed from. Not supported for partial fits. Default to None.
+            checkpoint_every (int): The number of iterations between two checkpoints. Default to 1.
 
         Returns:
             The fitted estimator.
 
         Raises:
             NotImplementedError: If the target values are not binary and 2D, or in the target values
-                are not 1D.
-            ValueError: If called from `partial_fit`, and classes is None on first call.
+                are not 1D, or if a checkpoint directory is given for a partial fit.
+            ValueError: If called from `partial_fit`, and classes is None on first call, or if the
+                checkpoint parameters are not valid.
         """
         if len(X.shape) != 2:
             raise NotImplementedError(
@@ -485,6 +666,14 @@ class SGDClassifier(SklearnSGDClassifierMixin):
                 f"enabled. Got {y.shape}"
             )
 
+        if checkpoint_dir is not None and is_partial_fit:
+            raise NotImplementedError("Training checkpoints are not supported for partial fits.")
+
+        if not isinstance(checkpoint_every, int) or checkpoint_every < 1:
+            raise ValueError(
+                f"Parameter 'checkpoint_every' must be a positive integer. Got {checkpoint_every}."
+            )
+
         if classes is not None and self.classes_ is not None:
             if len(numpy.setxor1d(classes, self.classes_)) > 0:
                 raise ValueError(
@@ -543,12 +732,38 @@ class SGDClassifier(SklearnSGDClassifierMixin):
         # Mypy
         assert self.training_quantized_module.fhe_circuit is not None
 
+        # A partial fit is similar to running a fit with a single iteration
+        max_iter = 1 if is_partial_fit else self.max_iter
+
+        # Load the last checkpoint, if any. The random number generator is then set back to its
+        # state at the beginning of the interrupted training, so that the same batches are sampled
+        checkpoint = None
+        if checkpoint_dir is not None:
+            checkpoint_dir = Path(checkpoint_dir)
+            checkpoint_dir.mkdir(parents=True, exist_ok=True)
+
+            checkpoint = self._load_training_checkpoint(
+                checkpoint_dir, fhe=fhe, n_features=n_features, max_iter=max_iter
+            )
+
+            if checkpoint is not None:
+                self.random_number_generator.bit_generator.state = checkpoint[0]["rng_state"]
+
+        rng_state = self.random_number_generator.bit_generator.state
+
         # Key generation
         if fhe == "execute":  # pragma: no cover
 
+            # Resumed trainings need the keys that encrypted the checkpoint's values
+            if checkpoint_dir is not None:
+                keys = self.training_quantized_module.fhe_circuit.keys
+                keys.load_if_exists_generate_and_save_otherwise(
+                    checkpoint_dir / TRAINING_KEYS_FILE_NAME
+                )
+
             # Generate the keys only if necessary. This is already done using the `force=False`
             # parameter, but here we also avoid printing too much verbose if activated
-            if not self.training_quantized_module.fhe_circuit.keys.are_generated:
+            elif not self.training_quantized_module.fhe_circuit.keys.are_generated:
                 if self.verbose:
                     print("Key Generation...")
 
@@ -608,45 +823,11 @@ class SGDClassifier(SklearnSGDClassifierMixin):
             mode_string = " (simulation)" if fhe == "simulate" else ""
             print(f"Training on encrypted data{mode_string}...")
 
-        # A partial fit is similar to running a fit with a single iteration
-        max_iter = 1 if is_partial_fit else self.max_iter
-
-        # Iterate on the batches in order to quantize and encrypt them
-        X_batches_enc, y_batches_enc = [], []
-        for _ in range(max_iter):
-
-            # Sample the batches from X and y in the clear
-            batch_indexes = self.random_number_generator.choice(
-                n_samples, size=self.batch_size, replace=False
-            )
-
-            # Mypy
-            assert isinstance(batch_indexes, numpy.ndarray)
-
-            # Build the batches
-            X_batch = X[batch_indexes].astype(float).reshape((1, self.batch_size, n_features))
-            y_batch = y[batch_indexes].reshape((1, self.batch_size, 1)).astype(float)
-
-            # The underlying quantized module expects (X, y, weight, bias) as inputs. We thus only
-            # quantize the input and target values using the first and second positional parameter
-            q_X_batch, q_y_batch, _, _ = self.training_quantized_module.quantize_input(
-                X_batch, y_batch, None, None
-            )
-
-            # If the training is done in FHE, encrypt the input and target values
-            if fhe == "execute":
-
-                # Similarly, the underlying FHE circuit expects (X, y, weight, bias) as inputs, and
-                # so does the encrypt method
-                X_batch_enc, y_batch_enc, _, _ = self.training_quantized_module.fhe_circuit.encrypt(
-                    q_X_batch, q_y_batch, None, None
-                )
-
-            else:
-                X_batch_enc, y_batch_enc = q_X_batch, q_y_batch
-
-            X_batches_enc.append(X_batch_enc)
-            y_batches_enc.append(y_batch_enc)
+        # Sample the batches' indexes from X and y in the clear
+        batches_indexes: List[numpy.ndarray] = [
+            self.random_number_generator.choice(n_samples, size=self.batch_size, replace=False)
+            for _ in range(max_iter)
+        ]
 
         # Similarly, we only quantize the weight and bias values using the third and fourth
         # position parameter
@@ -669,70 +850,158 @@ class SGDClassifier(SklearnSGDClassifierMixin):
         # the loop)
         loss_value_moving_average = None
 
-        # Iterate on the training quantized module in the clear
-        for iteration_step in range(max_iter):
-            X_batch_enc_i, y_batch_enc_i = (
-                X_batches_enc[iteration_step],
-                y_batches_enc[iteration_step],
-            )
-            # Train the model over one iteration
-            inference_start = time.time()
+        # Resume from the checkpoint's weight and bias values, skipping the iterations it covers
+        first_step, is_done = 0, False
+        if checkpoint is not None:
+            state, weights_enc, bias_enc = checkpoint
+            first_step, is_done = state["iteration"], state["is_done"]
+            loss_value_moving_average = state["loss_value_moving_average"]
 
-            # If the training is done in FHE, execute the underlying FHE circuit directly on the
-            # encrypted values
-            if fhe == "execute":
-                weights_enc, bias_enc = self.training_quantized_module.fhe_circuit.run(
-                    X_batch_enc_i,
-                    y_batch_enc_i,
-                    weights_enc,
-                    bias_enc,
+            if self.verbose:
+                print(f"Resuming training from iteration {first_step}.")
+
+        # Training throughput metrics
+        n_steps, step_bytes = 0, 0
+        training_start = time.time()
+
+        # Quantize and encrypt the next batches in the background while iterating. Values that are
+        # encrypted in the background are independent from the ones used by the running iteration
+        with ThreadPoolExecutor(max_workers=1) as batch_executor:
+            steps = range(first_step, first_step if is_done else max_iter)
+            pending_batches = deque(
+                batch_executor.submit(
+                    self._prepare_training_batch, X, y, batches_indexes[step], fhe
                 )
+                for step in steps[:TRAINING_PREFETCHED_BATCHES]
+            )
 
-            # Else, use the quantized module on the quantized values (works for both quantized
-            # clear and FHE simulation modes). It is important to note that 'quantized_forward'
-            # with 'fhe="execute"' is executing Concrete's 'encrypt_run_decrypt' method, as opposed
-            # to the 'run' method right above. We thus need to separate these cases since values
-            # are already encrypted here.
-            else:
-                weights_enc, bias_enc = self.training_quantized_module.quantized_forward(
-                    X_batch_enc_i, y_batch_enc_i, weights_enc, bias_enc, fhe=fhe
-                )
+            # Iterate on the training quantized module in the clear
+            for iteration_step in steps:
+                X_batch_enc_i, y_batch_enc_i = pending_batches.popleft().result()
 
-            if self.verbose:
-                print(
-                    f"Iteration {iteration_step} took {time.time() - inference_start:.2f} seconds."
-                )
+                next_step = iteration_step + TRAINING_PREFETCHED_BATCHES
+                if next_step < max_iter:
+                    pending_batches.append(
+                        batch_executor.submit(
+                            self._prepare_training_batch, X, y, batches_indexes[next_step], fhe
+                        )
+                    )
 
-            # If early stopping is enabled, decrypt (if needed) and de-quantize the weight and bias
-            # values. Then, compute the loss and stop the training if it gets under the given
-            # tolerance
-            # Additionally, there is no point in computing the following in case of a partial fit,
-            # as it only represents a single iteration
-            if self.early_stopping and not is_partial_fit:
-                weights_float, bias_float = self._decrypt_dequantize_training_output(
-                    weights_enc, bias_enc, fhe=fhe
-                )
+                # The size of the values is the same at all iterations
+                if n_steps == 0:
+                    step_bytes = sum(
+                        self._get_training_value_size(value)
+                        for value in (X_batch_enc_i, y_batch_enc_i, weights_enc, bias_enc)
+                    )
 
-                # Evaluate the model on the full dataset and compute the loss
-                logits = ((X @ weights_float) + bias_float).squeeze()
-                loss_value = binary_cross_entropy(y_true=y, logits=logits)
+                # Train the model over one iteration
+                inference_start = time.time()
+
+                with measure_stage("sgd_training.iteration", fhe=str(fhe)):
+
+                    # If the training is done in FHE, execute the underlying FHE circuit directly
+                    # on the encrypted values
+                    if fhe == "execute":
+                        weights_enc, bias_enc = self.training_quantized_module.fhe_circuit.run(
+                            X_batch_enc_i,
+                            y_batch_enc_i,
+                            weights_enc,
+                            bias_enc,
+                        )
+
+                    # Else, use the quantized module on the quantized values (works for both
+                    # quantized clear and FHE simulation modes). It is important to note that
+                    # 'quantized_forward' with 'fhe="execute"' is executing Concrete's
+                    # 'encrypt_run_decrypt' method, as opposed to the 'run' method right above. We
+                    # thus need to separate these cases since values are already encrypted here.
+                    else:
+                        weights_enc, bias_enc = self.training_quantized_module.quantized_forward(
+                            X_batch_enc_i, y_batch_enc_i, weights_enc, bias_enc, fhe=fhe
+                        )
+
+                record_bytes("sgd_training.step", step_bytes, fhe=str(fhe))
+                n_steps += 1
 
-                # If this is the first training iteration, store the loss value computed above
-                if loss_value_moving_average is None:
-                    loss_value_moving_average = loss_value
+                if self.verbose:
+                    print(
+                        f"Iteration {iteration_step} took {time.time() - inference_start:.2f} "
+                        "seconds."
+                    )
 
-                # Else, update the value
-                else:
-                    previous_loss_value_moving_average = loss_value_moving_average
-                    loss_value_moving_average = (loss_value_moving_average + loss_value) / 2
+                # If early stopping is enabled, decrypt (if needed) and de-quantize the weight and
+                # bias values. Then, compute the loss and stop the training if it gets under the
+                # given tolerance
+                # Additionally, there is no point in computing the following in case of a partial
+                # fit, as it only represents a single iteration
+                if self.early_stopping and not is_partial_fit:
+                    weights_float, bias_float = self._decrypt_dequantize_training_output(
+                        weights_enc, bias_enc, fhe=fhe
+                    )
 
-                    loss_difference = numpy.abs(
-                        previous_loss_value_moving_average - loss_value_moving_average
+                    # Evaluate the model on the full dataset and compute the loss
+                    logits = ((X @ weights_float) + bias_float).squeeze()
+                    loss_value = float(binary_cross_entropy(y_true=y, logits=logits))
+
+                    # If this is the first training iteration, store the loss value computed above
+                    if loss_value_moving_average is None:
+                        loss_value_moving_average = loss_value
+
+                    # Else, update the value
+                    else:
+                        previous_loss_value_moving_average = loss_value_moving_average
+                        loss_value_moving_average = (loss_value_moving_average + loss_value) / 2
+
+                        loss_difference = numpy.abs(
+                            previous_loss_value_moving_average - loss_value_moving_average
+                        )
+
+                        # If the loss gets under the given tolerance, stop the training
+                        is_done = bool(loss_difference < self.tol)
+
+                is_last_step = is_done or iteration_step == max_iter - 1
+
+                # Save a checkpoint every `checkpoint_every` iterations and at the end of training
+                if checkpoint_dir is not None and (
+                    (iteration_step + 1) % checkpoint_every == 0 or is_last_step
+                ):
+                    self._save_training_checkpoint(
+                        checkpoint_dir,
+                        state={
+                            "fhe": FheMode(fhe).value,
+                            "n_features": n_features,
+                            "max_iter": max_iter,
+                            "batch_size": self.batch_size,
+                            "iteration": iteration_step + 1,
+                            "is_done": is_last_step,
+                            "loss_value_moving_average": loss_value_moving_average,
+                            "rng_state": rng_state,
+                        },
+                        weights_enc=weights_enc,
+                        bias_enc=bias_enc,
                     )
 
-                    # If the loss gets under the given tolerance, stop the training
-                    if loss_difference < self.tol:
-                        break
+                if is_done:
+                    for pending_batch in pending_batches:
+                        pending_batch.cancel()
+                    break
+
+        training_duration = time.time() - training_start
+
+        #: The throughput of the last encrypted training
+        # pylint: disable-next=attribute-defined-outside-init
+        self.training_throughput_ = {
+            "iterations": n_steps,
+            "duration": training_duration,
+            "iterations_per_second": n_steps / training_duration if n_steps > 0 else 0.0,
+            "bytes_per_step": step_bytes,
+        }
+
+        if self.verbose and n_steps > 0:
+            print(
+                f"Training ran {n_steps} iterations at "
+                f"{self.training_throughput_['iterations_per_second']:.4f} iterations/s, with "
+                f"{step_bytes} bytes of inputs per iteration."
+            )
 
         # Decrypt (if needed) and de-quantize the fitted weight and bias values
         fitted_weights, fitted_bias = self._decrypt_dequantize_training_output(
@@ -779,6 +1048,8 @@ class SGDClassifier(SklearnSGDClassifierMixin):
         intercept_init: Optional[numpy.ndarray] = None,
         sample_weight: Optional[numpy.ndarray] = None,
         device: str = "cpu",
+        checkpoint_dir: Optional[Union[str, Path]] = None,
+        checkpoint_every: int = 1,
     ):
         """Fit SGDClassifier.
 
@@ -805,12 +1076,17 @@ class SGDClassifier(SklearnSGDClassifierMixin):
             sample_weight (Optional[numpy.ndarray]): Weights applied to individual samples (1. for
                 unweighted). It is currently not supported for FHE training. Default to None.
             device: FHE compilation device, can be either 'cpu' or 'cuda'.
+            checkpoint_dir (Optional[Union[str, Path]]): The directory where FHE training
+                checkpoints are saved. If it already contains a checkpoint, the training resumes
+                from it. Only supported for FHE training. Default to None.
+            checkpoint_every (int): The number of FHE training iterations between two checkpoints.
+                Default to 1.
 
         Returns:
             The fitted estimator.
 
         Raises:
-            ValueError: if `fhe` is provided but `fit_encrypted==False`
+            ValueError: if `fhe` or `checkpoint_dir` is provided but `fit_encrypted==False`
             NotImplementedError: If parameter a 'sample_weight' is given while FHE training is
                 enabled.
         """
@@ -844,6 +1120,8 @@ class SGDClassifier(SklearnSGDClassifierMixin):
                 coef_init=coef_init,
                 intercept_init=intercept_init,
                 device=device,
+                checkpoint_dir=checkpoint_dir,
+                checkpoint_every=checkpoint_every,
             )
 
         if fhe is not None:
@@ -853,6 +1131,11 @@ class SGDClassifier(SklearnSGDClassifierMixin):
                 f"initializing the model. Got {fhe}."
             )
 
+        if checkpoint_dir is not None:
+            raise ValueError(
+                "Parameter 'checkpoint_dir' should not be set when FHE training is disabled."
+            )
+
         # Else, train the model in floating points in the clear through scikit-learn
         return super().fit(
             X,
@@ -17,6 +17,11 @@ class KNeighborsClassifier(SklearnKNeighborsClassifierMixin):
     Parameters:
         n_bits (int): Number of bits to quantize the model. The value will be used for quantizing
             inputs and X_fit. Default to 3.
+        block_size (Optional[int]): If set, the training set is split into blocks of at least
+            `block_size` points, which are compiled as functions of a single FHE module and
+            executed in parallel. Their k nearest neighbors are then merged two by two, without
+            being decrypted. This keeps circuits small for large training sets. If None, a single
+            circuit is compiled. Default to None.
 
     For more details on KNeighborsClassifier please refer to the scikit-learn documentation:
     https://scikit-learn.org/stable/modules/generated/sklearn.neighbors.KNeighborsClassifier.html
@@ -37,9 +42,10 @@ class KNeighborsClassifier(SklearnKNeighborsClassifierMixin):
         metric="minkowski",
         metric_params=None,
         n_jobs=None,
+        block_size=None,
     ):
         # Call SklearnKNeighborsClassifierMixin's __init__ method
-        super().__init__(n_bits=n_bits)
+        super().__init__(n_bits=n_bits, block_size=block_size)
 
         assert_true(
             algorithm in ["brute", "auto"], f"Algorithm = `{algorithm}` is not supported in FHE."
@@ -68,6 +74,7 @@ class KNeighborsClassifier(SklearnKNeighborsClassifierMixin):
 
         # Concrete ML
         metadata["n_bits"] = self.n_bits
+        metadata["block_size"] = self.block_size
         metadata["sklearn_model"] = self.sklearn_model
         metadata["_is_fitted"] = self._is_fitted
         metadata["_is_compiled"] = self._is_compiled
@@ -95,7 +102,7 @@ class KNeighborsClassifier(SklearnKNeighborsClassifierMixin):
     def load_dict(cls, metadata: Dict):
 
         # Instantiate the model
-        obj = cls(n_bits=metadata["n_bits"])
+        obj = cls(n_bits=metadata["n_bits"], block_size=metadata.get("block_size"))
 
         # Concrete-ML
         obj.sklearn_model = metadata["sklearn_model"]
@@ -24,6 +24,7 @@ from ..common.utils import (
     process_rounding_threshold_bits,
     to_tuple,
 )
+from ..deployment.compilation_cache import CompilationCache
 from ..onnx.convert import OPSET_VERSION_FOR_ONNX_EXPORT
 from ..onnx.onnx_utils import remove_initializer_from_input
 from ..quantization import PostTrainingAffineQuantization, PostTrainingQATImporter, QuantizedModule
@@ -75,6 +76,7 @@ def build_quantized_module(
     n_bits: Union[int, Dict[str, int]] = MAX_BITWIDTH_BACKWARD_COMPATIBLE,
     rounding_threshold_bits: Union[None, int, Dict[str, Union[str, int]]] = None,
     reduce_sum_copy=False,
+    calibration_batch_size: Optional[int] = None,
 ) -> QuantizedModule:
     """Build a quantized module from a Torch or ONNX model.
 
@@ -95,6 +97,9 @@ def build_quantized_module(
             and 'n_bits' ('auto' or int)
         reduce_sum_copy (bool): if the inputs of QuantizedReduceSum should be copied to avoid
             bit-width propagation
+        calibration_batch_size (Optional[int]): if not None, the calibration input-set is passed
+            through each layer in batches of this size, in order to bound the memory used during
+            calibration. Default to None.
 
     Returns:
         QuantizedModule: The resulting QuantizedModule.
@@ -125,7 +130,12 @@ def build_quantized_module(
 
     # Quantize with post-training static method, to have a model with integer weights
     post_training = PostTrainingQATImporter if import_qat else PostTrainingAffineQuantization
-    post_training_quant = post_training(n_bits, numpy_model, rounding_threshold_bits)
+    post_training_quant = post_training(
+        n_bits,
+        numpy_model,
+        rounding_threshold_bits,
+        calibration_batch_size=calibration_batch_size,
+    )
 
     # Build the quantized module
     # FIXME: mismatch here. We traced with dummy_input_for_tracing which made some operator
@@ -158,6 +168,8 @@ def _compile_torch_or_onnx_model(
     reduce_sum_copy: bool = False,
     composition_mapping: Optional[Dict] = None,
     device: str = "cpu",
+    calibration_batch_size: Optional[int] = None,
+    compilation_cache: Optional[CompilationCache] = None,
 ) -> QuantizedModule:
     """Compile a torch module or ONNX into an FHE equivalent.
 
@@ -199,6 +211,11 @@ def _compile_torch_or_onnx_model(
             de-quantized using their output quantizer and then re-quantized using their associated
             input quantizer. Default to None.
         device: FHE compilation device, can be either 'cpu' or 'cuda'.
+        calibration_batch_size (Optional[int]): if not None, the calibration input-set is passed
+            through each layer in batches of this size, in order to bound the memory used during
+            calibration. Default to None.
+        compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+            from, or to store it in. Default to None.
 
     Returns:
         QuantizedModule: The resulting compiled QuantizedModule.
@@ -228,6 +245,7 @@ def _compile_torch_or_onnx_model(
         n_bits=n_bits,
         rounding_threshold_bits=rounding_threshold_bits,
         reduce_sum_copy=reduce_sum_copy,
+        calibration_batch_size=calibration_batch_size,
     )
 
     # Check that p_error or global_p_error is not set in both the configuration and in the direct
@@ -265,6 +283,7 @@ def _compile_torch_or_onnx_model(
         verbose=verbose,
         inputs_encryption_status=inputs_encryption_status,
         device=device,
+        compilation_cache=compilation_cache,
     )
 
     return quantized_module
@@ -286,6 +305,8 @@ def compile_torch_model(
     inputs_encryption_status: Optional[Sequence[str]] = None,
     reduce_sum_copy: bool = False,
     device: str = "cpu",
+    calibration_batch_size: Optional[int] = None,
+    compilation_cache: Optional[CompilationCache] = None,
 ) -> QuantizedModule:
     """Compile a torch module into an FHE equivalent.
 
@@ -323,6 +344,11 @@ def compile_torch_model(
         reduce_sum_copy (bool): if the inputs of QuantizedReduceSum should be copied to avoid
             bit-width propagation
         device: FHE compilation device, can be either 'cpu' or 'cuda'.
+        calibration_batch_size (Optional[int]): if not None, the calibration input-set is passed
+            through each layer in batches of this size, in order to bound the memory used during
+            calibration. Default to None.
+        compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+            from, or to store it in. Default to None.
 
     Returns:
         QuantizedModule: The resulting compiled QuantizedModule.
@@ -354,6 +380,8 @@ def compile_torch_model(
         inputs_encryption_status=inputs_encryption_status,
         reduce_sum_copy=reduce_sum_copy,
         device=device,
+        calibration_batch_size=calibration_batch_size,
+        compilation_cache=compilation_cache,
     )
 
 
@@ -373,6 +401,8 @@ def compile_onnx_model(
     inputs_encryption_status: Optional[Sequence[str]] = None,
     reduce_sum_copy: bool = False,
     device: str = "cpu",
+    calibration_batch_size: Optional[int] = None,
+    compilation_cache: Optional[CompilationCache] = None,
 ) -> QuantizedModule:
     """Compile a torch module into an FHE equivalent.
 
@@ -410,6 +440,11 @@ def compile_onnx_model(
         reduce_sum_copy (bool): if the inputs of QuantizedReduceSum should be copied to avoid
             bit-width propagation
         device: FHE compilation device, can be either 'cpu' or 'cuda'.
+        calibration_batch_size (Optional[int]): if not None, the calibration input-set is passed
+            through each layer in batches of this size, in order to bound the memory used during
+            calibration. Default to None.
+        compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+            from, or to store it in. Default to None.
 
     Returns:
         QuantizedModule: The resulting compiled QuantizedModule.
@@ -437,6 +472,8 @@ def compile_onnx_model(
         inputs_encryption_status=inputs_encryption_status,
         reduce_sum_copy=reduce_sum_copy,
         device=device,
+        calibration_batch_size=calibration_batch_size,
+        compilation_cache=compilation_cache,
     )
 
 
@@ -456,6 +493,8 @@ def compile_brevitas_qat_model(
     inputs_encryption_status: Optional[Sequence[str]] = None,
     reduce_sum_copy: bool = False,
     device: str = "cpu",
+    calibration_batch_size: Optional[int] = None,
+    compilation_cache: Optional[CompilationCache] = None,
 ) -> QuantizedModule:
     """Compile a Brevitas Quantization Aware Training model.
 
@@ -495,6 +534,11 @@ def compile_brevitas_qat_model(
         reduce_sum_copy (bool): if the inputs of QuantizedReduceSum should be copied to avoid
             bit-width propagation
         device: FHE compilation device, can be either 'cpu' or 'cuda'.
+        calibration_batch_size (Optional[int]): if not None, the calibration input-set is passed
+            through each layer in batches of this size, in order to bound the memory used during
+            calibration. Default to None.
+        compilation_cache (Optional[CompilationCache]): The cache to load the compiled circuit
+            from, or to store it in. Default to None.
 
     Returns:
         QuantizedModule: The resulting compiled QuantizedModule.
@@ -591,6 +635,8 @@ def compile_brevitas_qat_model(
         inputs_encryption_status=inputs_encryption_status,
         reduce_sum_copy=reduce_sum_copy,
         device=device,
+        calibration_batch_size=calibration_batch_size,
+        compilation_cache=compilation_cache,
     )
 
     # Remove the tempfile if we used one
@@ -3,24 +3,30 @@
 # pylint: disable=too-many-lines
 import ast
 import io
+import struct
 import sys
 import time
 import uuid
 from abc import abstractmethod
-from collections import defaultdict
-from functools import lru_cache
+from collections import defaultdict, deque
+from concurrent.futures import Future, ThreadPoolExecutor
 from pathlib import Path
-from typing import Dict, List, Optional, Tuple, Union
+from typing import Deque, Dict, List, Optional, Sequence, Tuple, Union
 
 import numpy
 import requests
 import torch
 from brevitas.quant_tensor import QuantTensor
-from concrete.fhe import Configuration
+from concrete.fhe import Configuration, EvaluationKeys
 from torch import nn
 
+from ..common.instrumentation import measure_stage, record_bytes
 from ..common.utils import MAX_BITWIDTH_BACKWARD_COMPATIBLE, HybridFHEMode
+from ..deployment.cache import LRUCache
+from ..deployment.compilation_cache import CompilationCache
 from ..deployment.fhe_client_server import FHEModelClient, FHEModelDev, FHEModelServer
+from ..deployment.model_registry import ModelRegistry
+from ..deployment.scheduler import RequestScheduler
 from ..quantization.linear_op_glwe_backend import GLWELinearLayerExecutor, has_glwe_backend
 from .compile import (
     QuantizedModule,
@@ -56,6 +62,157 @@ def underscore_str_to_tuple(tup: str) -> Tuple:
     return ast.literal_eval(tup.replace("po_", "(").replace("_pc", ")").replace("_", ", "))
 
 
+# Number of bytes used for storing the size of each ciphertext in a serialized batch
+_CIPHERTEXT_SIZE_HEADER = struct.Struct(">Q")
+
+
+def serialize_ciphertext_batch(ciphertexts: Sequence[bytes]) -> bytes:
+    """Serialize several ciphertexts into a single payload.
+
+    Each ciphertext is prefixed by its size, which allows sending a batch of ciphertexts in a
+    single request.
+
+    Args:
+        ciphertexts (Sequence[bytes]): the serialized ciphertexts
+
+    Returns:
+        bytes: the serialized batch
+    """
+    return b"".join(
+        _CIPHERTEXT_SIZE_HEADER.pack(len(ciphertext)) + ciphertext for ciphertext in ciphertexts
+    )
+
+
+def deserialize_ciphertext_batch(payload: bytes) -> List[bytes]:
+    """Deserialize a payload built using `serialize_ciphertext_batch`.
+
+    Args:
+        payload (bytes): the serialized batch
+
+    Returns:
+        List[bytes]: the serialized ciphertexts
+
+    Raises:
+        ValueError: if the payload is truncated
+    """
+    ciphertexts = []
+    offset = 0
+    while offset < len(payload):
+        if offset + _CIPHERTEXT_SIZE_HEADER.size > len(payload):
+            raise ValueError("Truncated ciphertext batch: incomplete size header.")
+
+        (size,) = _CIPHERTEXT_SIZE_HEADER.unpack_from(payload, offset)
+        offset += _CIPHERTEXT_SIZE_HEADER.size
+
+        if offset + size > len(payload):
+            raise ValueError(
+                f"Truncated ciphertext batch: expected {size} bytes but only "
+                f"{len(payload) - offset} are left."
+            )
+
+        ciphertexts.append(payload[offset : offset + size])
+        offset += size
+
+    return ciphertexts
+
+
+def _get_shape_size_key(shape: Tuple[int, ...]) -> Tuple[int, Tuple[int, ...]]:
+    """Get the key sorting shapes by size, and then by dimensions.
+
+    Args:
+        shape (Tuple[int, ...]): The shape.
+
+    Returns:
+        Tuple[int, Tuple[int, ...]]: The shape's number of elements and the shape itself.
+    """
+    return int(numpy.prod(shape)), shape
+
+
+def compute_shape_buckets(
+    shape_counts: Dict[Tuple[int, ...], int], n_buckets: int
+) -> List[Tuple[int, ...]]:
+    """Choose the shapes of the circuits to compile from a histogram of input shapes.
+
+    Shapes are sorted by size and split into groups holding roughly the same number of rows. Each
+    bucket is the smallest shape in which all shapes of its group fit, so that inputs only need
+    to be padded to the nearest bucket. Only the dimensions between the first and the last one can
+    be padded, as for example the sequence length of the inputs of a linear layer.
+
+    Args:
+        shape_counts (Dict[Tuple[int, ...], int]): The number of rows seen for each input shape,
+            of the form (1, ...).
+        n_buckets (int): The maximum number of buckets.
+
+    Returns:
+        List[Tuple[int, ...]]: The bucket shapes, smallest first.
+
+    Raises:
+        ValueError: If the number of buckets is not strictly positive or if the shapes differ by
+            their number of dimensions or their last dimension.
+    """
+    if n_buckets < 1:
+        raise ValueError(
+            f"Parameter 'n_shape_buckets' must be None or a strictly positive integer. Got "
+            f"{n_buckets}"
+        )
+
+    shapes = sorted(shape_counts, key=_get_shape_size_key)
+
+    if len({(len(shape), shape[-1]) for shape in shapes}) > 1:
+        raise ValueError(
+            "Shape bucketing requires inputs with the same number of dimensions and the same last "
+            f"dimension, as only the other ones can be padded. Got shapes {shapes}"
+        )
+
+    # Close a group each time its cumulated number of rows reaches the next quantile
+    total_count = sum(shape_counts.values())
+    groups: List[List[Tuple[int, ...]]] = [[]]
+    cumulated_count = 0
+    for shape in shapes:
+        if cumulated_count >= total_count * len(groups) / n_buckets and groups[-1]:
+            groups.append([])
+
+        groups[-1].append(shape)
+        cumulated_count += shape_counts[shape]
+
+    buckets = {tuple(int(dim) for dim in numpy.max(group, axis=0)) for group in groups}
+    return sorted(buckets, key=lambda shape: (int(numpy.prod(shape)), shape))
+
+
+def pad_to_shape(inputs: numpy.ndarray, shape: Tuple[int, ...]) -> numpy.ndarray:
+    """Pad the rows of a batch of inputs with zeros at the end of each dimension.
+
+    Args:
+        inputs (numpy.ndarray): The batch of inputs.
+        shape (Tuple[int, ...]): The shape of a single padded row, of the form (1, ...).
+
+    Returns:
+        numpy.ndarray: The padded inputs.
+    """
+    pad_width = [(0, 0)] + [(0, dim - size) for size, dim in zip(inputs.shape[1:], shape[1:])]
+    return numpy.pad(inputs, pad_width)
+
+
+def strip_padding(outputs: numpy.ndarray, input_shape: Tuple[int, ...]) -> numpy.ndarray:
+    """Remove the rows' padding added by `pad_to_shape` from a batch of outputs.
+
+    Args:
+        outputs (numpy.ndarray): The batch of outputs computed on padded inputs.
+        input_shape (Tuple[int, ...]): The shape of a single row before padding, of the form
+            (1, ...).
+
+    Returns:
+        numpy.ndarray: The outputs of the rows without padding.
+    """
+    assert outputs.ndim == len(input_shape), (
+        "Padding can only be removed from outputs having as many dimensions as their inputs.\n"
+        f"{outputs.ndim=}!={len(input_shape)=}"
+    )
+
+    # The last dimension is never padded and can be changed by the module
+    return outputs[(slice(None),) + tuple(slice(0, dim) for dim in input_shape[1:-1])]
+
+
 # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/3858
 def convert_conv1d_to_linear(layer_or_module):
     """Convert all Conv1D layers in a module or a Conv1D layer itself to nn.Linear.
@@ -103,7 +260,14 @@ def convert_conv1d_to_linear(layer_or_module):
 
 # pylint: disable-next=too-many-instance-attributes
 class RemoteModule(nn.Module):
-    """A wrapper class for the modules to be evaluated remotely with FHE."""
+    """A wrapper class for the modules to be evaluated remotely with FHE.
+
+    In remote mode, rows of a batch are encrypted and sent to the server in chunks of
+    `remote_batch_size` ciphertexts per request, or in a single request if `remote_batch_size` is
+    None. The next chunk is encrypted while previous requests are in flight, with at most
+    `max_in_flight_requests` requests waiting for the server at the same time. All requests share a
+    persistent HTTP session and, if `request_pool` is set, a persistent pool of request threads.
+    """
 
     def __init__(
         self,
@@ -113,8 +277,23 @@ class RemoteModule(nn.Module):
         model_name: Optional[str] = None,
         verbose: int = 0,
         optimized_linear_execution: bool = False,
+        remote_batch_size: Optional[int] = 1,
+        max_in_flight_requests: int = 1,
     ):
         super().__init__()
+
+        if remote_batch_size is not None and remote_batch_size < 1:
+            raise ValueError(
+                "Parameter 'remote_batch_size' must be a strictly positive integer or None. Got "
+                f"{remote_batch_size}"
+            )
+
+        if max_in_flight_requests < 1:
+            raise ValueError(
+                "Parameter 'max_in_flight_requests' must be a strictly positive integer. Got "
+                f"{max_in_flight_requests}"
+            )
+
         self.private_module: Optional[nn.Module] = module
         self.server_remote_address: Optional[str] = server_remote_address
         self.calibration_data: List = []
@@ -129,6 +308,63 @@ class RemoteModule(nn.Module):
         self.verbose = verbose
         self.optimized_linear_execution = optimized_linear_execution
         self.executor: Optional[GLWELinearLayerExecutor] = None
+        self.remote_batch_size = remote_batch_size
+        self.max_in_flight_requests = max_in_flight_requests
+        self.session: Optional[requests.Session] = None
+
+        # The pool of threads sending the requests, shared by all remote modules of a hybrid model
+        # and kept across calls. If None, a pool is created for each call
+        self.request_pool: Optional[ThreadPoolExecutor] = None
+
+        # The input shapes of the circuits compiled with shape bucketing, smallest first. Inputs are
+        # padded to the smallest bucket they fit in. If empty, inputs are used as they are
+        self.shape_buckets: List[Tuple[int, ...]] = []
+        self.bucket_q_modules: Optional[Dict[str, QuantizedModule]] = None
+
+    def get_bucket_shape(self, input_shape: Tuple[int, ...]) -> Optional[Tuple[int, ...]]:
+        """Get the shape of the bucket in which inputs of the given shape are padded.
+
+        Args:
+            input_shape (Tuple[int, ...]): The shape of a single row, of the form (1, ...).
+
+        Returns:
+            Optional[Tuple[int, ...]]: The smallest bucket in which the row fits, or None if shape
+                bucketing is not used.
+
+        Raises:
+            ValueError: If the row does not fit in any bucket.
+        """
+        if not self.shape_buckets:
+            return None
+
+        for bucket_shape in self.shape_buckets:
+            if len(bucket_shape) == len(input_shape) and all(
+                size <= dim for size, dim in zip(input_shape, bucket_shape)
+            ):
+                return bucket_shape
+
+        raise ValueError(
+            f"Input shape {input_shape} does not fit in any of the shape buckets "
+            f"{self.shape_buckets}. Please compile the model, and serve it, with larger inputs."
+        )
+
+    def _get_session(self) -> requests.Session:  # pragma:no cover
+        """Get the persistent HTTP session used for querying the server.
+
+        The session keeps connections open between requests, with a pool large enough for all
+        requests in flight.
+
+        Returns:
+            requests.Session: the HTTP session
+        """
+        if self.session is None:
+            self.session = requests.Session()
+            adapter = requests.adapters.HTTPAdapter(
+                pool_connections=1, pool_maxsize=self.max_in_flight_requests
+            )
+            self.session.mount("http://", adapter)
+            self.session.mount("https://", adapter)
+        return self.session
 
     def init_fhe_client(
         self, path_to_client: Optional[Path] = None, path_to_keys: Optional[Path] = None
@@ -139,6 +375,9 @@ class RemoteModule(nn.Module):
             path_to_client (str): Path where the client.zip is located.
             path_to_keys (str): Path where keys are located.
 
+        The shapes served for the module are used as shape buckets, so that inputs are padded to
+        the smallest one they fit in, even if the model was not compiled by this client.
+
         Raises:
             ValueError: if anything goes wrong with the server.
         """
@@ -155,7 +394,8 @@ class RemoteModule(nn.Module):
         # List all shapes supported by the server
         # This is needed until we have generic shape support in Concrete Python
         assert self.module_name is not None
-        shapes_response = requests.get(
+        session = self._get_session()
+        shapes_response = session.get(
             f"{self.server_remote_address}/list_shapes",
             data={"module_name": self.module_name, "model_name": self.model_name},
         )
@@ -167,8 +407,13 @@ class RemoteModule(nn.Module):
 
         # For all supported shape we need to get the FHE client from the server
         shapes = shapes_response.json()
+
+        # Inputs are padded to the served shapes, which are the buckets compiled by the developer
+        self.shape_buckets = sorted(
+            (tuple(ast.literal_eval(shape)) for shape in shapes), key=_get_shape_size_key
+        )
         for shape in shapes:
-            client_response = requests.get(
+            client_response = session.get(
                 f"{self.server_remote_address}/get_client",
                 data={
                     "module_name": self.module_name,
@@ -197,7 +442,7 @@ class RemoteModule(nn.Module):
             assert isinstance(serialized_evaluation_keys, bytes)
             assert self.module_name is not None
             # Upload the key to the server
-            response = requests.post(
+            response = session.post(
                 f"{self.server_remote_address}/add_key",
                 data={
                     "module_name": self.module_name,
@@ -243,20 +488,31 @@ class RemoteModule(nn.Module):
             HybridFHEMode.TORCH,
             None,
         }:
-            assert self.private_q_module is not None
+            q_module = self.private_q_module
+            clear_inputs = x.detach().numpy()
+
+            # Pad the inputs to their bucket and use the bucket's circuit, if the buckets were
+            # compiled locally and not only received from the server
+            input_shape = (1,) + tuple(clear_inputs.shape[1:])
+            bucket_shape = self.get_bucket_shape(input_shape) if self.bucket_q_modules else None
+            if bucket_shape is not None:
+                assert self.bucket_q_modules is not None
+                clear_inputs = pad_to_shape(clear_inputs, bucket_shape)
+                q_module = self.bucket_q_modules[str(bucket_shape)]
+
+            assert q_module is not None
 
             if self.executor:
                 # Delegate to the optimized GLWE executor
-                y = torch.Tensor(
-                    self.executor.forward(
-                        x.detach().numpy(), self.private_q_module, self.fhe_local_mode
-                    )
-                )
+                clear_outputs = self.executor.forward(clear_inputs, q_module, self.fhe_local_mode)
             else:
                 # Delegate to the quantized module for all fhe modes
-                y = torch.Tensor(
-                    self.private_q_module.forward(x.detach().numpy(), fhe=self.fhe_local_mode.value)
-                )
+                clear_outputs = q_module.forward(clear_inputs, fhe=self.fhe_local_mode.value)
+
+            if bucket_shape is not None:
+                clear_outputs = strip_padding(clear_outputs, input_shape)
+
+            y = torch.Tensor(clear_outputs)
 
         elif self.fhe_local_mode == HybridFHEMode.CALIBRATE:
             # Calling torch + gathering calibration data
@@ -281,66 +537,164 @@ class RemoteModule(nn.Module):
 
         return y
 
+    def _remote_compute(
+        self, encrypted_inputs: List[bytes], key_id: str, repr_input_shape: str
+    ) -> List[bytes]:  # pragma:no cover
+        """Send encrypted inputs to the server and retrieve the encrypted results.
+
+        A single input is sent to the `/compute` endpoint, while several inputs are sent at once
+        to the `/compute_batch` endpoint.
+
+        Args:
+            encrypted_inputs (List[bytes]): the serialized encrypted inputs
+            key_id (str): the uid of the evaluation keys on the server
+            repr_input_shape (str): the input shape of the circuit to use
+
+        Returns:
+            List[bytes]: the serialized encrypted results, in the same order as the inputs
+        """
+        assert self.module_name is not None
+        data = {
+            "uid": key_id,
+            "module_name": self.module_name,
+            "model_name": self.model_name,
+            "input_shape": repr_input_shape,
+        }
+
+        record_bytes(
+            "hybrid.remote_inputs",
+            sum(len(encrypted_input) for encrypted_input in encrypted_inputs),
+            module=self.module_name,
+        )
+
+        start = time.time()
+        with measure_stage(
+            "hybrid.remote_call", module=self.module_name, n_inputs=len(encrypted_inputs)
+        ):
+            if len(encrypted_inputs) == 1:
+                inference_query = self._get_session().post(
+                    f"{self.server_remote_address}/compute",
+                    files={"model_input": io.BytesIO(encrypted_inputs[0])},
+                    data=data,
+                    stream=True,
+                )
+            else:
+                inference_query = self._get_session().post(
+                    f"{self.server_remote_address}/compute_batch",
+                    files={
+                        "model_inputs": io.BytesIO(serialize_ciphertext_batch(encrypted_inputs))
+                    },
+                    data=data,
+                    stream=True,
+                )
+        end = time.time()
+
+        if self.verbose:
+            print(f"Inference of {len(encrypted_inputs)} input(s) done in {end - start} seconds")
+
+        assert inference_query.status_code == 200, inference_query.content.decode("utf-8")
+
+        record_bytes(
+            "hybrid.remote_outputs", len(inference_query.content), module=self.module_name
+        )
+
+        if len(encrypted_inputs) == 1:
+            return [inference_query.content]
+
+        encrypted_results = deserialize_ciphertext_batch(inference_query.content)
+        assert len(encrypted_results) == len(encrypted_inputs), (
+            f"Expected {len(encrypted_inputs)} results from the server, got "
+            f"{len(encrypted_results)}"
+        )
+        return encrypted_results
+
     def remote_call(self, x: torch.Tensor) -> torch.Tensor:  # pragma:no cover
         """Call the remote server to get the private module inference.
 
+        Rows are encrypted and sent in chunks of `remote_batch_size` (or all at once if None)
+        while previous chunks are being computed by the server, with at most
+        `max_in_flight_requests` pending requests.
+
         Args:
             x (torch.Tensor): The input tensor.
 
         Returns:
             torch.Tensor: The result of the FHE computation
+
+        Raises:
+            ValueError: If no client was received from the server for the input's shape.
         """
         # Store tensor device and move to CPU for FHE encryption
         base_device = x.device
         x = x.to(device="cpu")
+        clear_inputs = x.detach().numpy()
+        assert isinstance(clear_inputs, numpy.ndarray)
+
+        # Pad the inputs to their bucket, the padding being removed after decryption
+        input_shape = (1,) + tuple(clear_inputs.shape[1:])
+        bucket_shape = self.get_bucket_shape(input_shape)
+        if bucket_shape is not None:
+            clear_inputs = pad_to_shape(clear_inputs, bucket_shape)
 
-        # We need to iterate over elements in the batch since
+        # We need to encrypt elements in the batch separately since
         # we don't support batch inference
+        repr_input_shape = str((1,) + tuple(clear_inputs.shape[1:]))
+        if repr_input_shape not in self.clients:
+            raise ValueError(
+                f"No FHE client found for input shape {repr_input_shape}. Clients are only "
+                f"available for the shapes served: {list(self.clients)}."
+            )
+        key_id, client = self.clients[repr_input_shape]
+        assert client is not None
+
+        def _decrypt(encrypted_results: List[bytes]) -> List[numpy.ndarray]:
+            return [
+                client.deserialize_decrypt_dequantize(encrypted_result)[0]
+                for encrypted_result in encrypted_results
+            ]
+
+        if self.verbose:
+            print("Infering ...")
+
+        rows_per_request = self.remote_batch_size or max(len(clear_inputs), 1)
+
+        # Use the persistent pool if available, else a temporary one for this call
+        pool = self.request_pool
+        if pool is None:
+            pool = ThreadPoolExecutor(max_workers=self.max_in_flight_requests)
+
         inferences: List[numpy.ndarray] = []
-        for index in range(len(x)):
-            # Manage tensor, tensor shape, and encrypt tensor
-            clear_input = x[[index], :].detach().numpy()
-            input_shape = (1,) + tuple(clear_input.shape)
-            repr_input_shape = str(input_shape[1:])
-            assert isinstance(clear_input, numpy.ndarray)
-            assert repr_input_shape in self.clients
-            key_id, client = self.clients[repr_input_shape]
-            assert client is not None
-            encrypted_input = client.quantize_encrypt_serialize(clear_input)
-            assert isinstance(encrypted_input, bytes)
-            if self.verbose:
-                print(
-                    f"Encrypted input size: {sys.getsizeof(encrypted_input) / 1024 / 1024:.2f} MB"
+        try:
+            in_flight: Deque[Future] = deque()
+            for chunk_start in range(0, len(clear_inputs), rows_per_request):
+                chunk = clear_inputs[chunk_start : chunk_start + rows_per_request]
+
+                # Encrypt the chunk while previous ones are being computed on the server
+                encrypted_inputs = [client.quantize_encrypt_serialize(row[None]) for row in chunk]
+                if self.verbose:
+                    encrypted_size = sum(sys.getsizeof(elt) for elt in encrypted_inputs)
+                    print(f"Encrypted input size: {encrypted_size / 1024 / 1024:.2f} MB")
+
+                # Deserialize and decrypt the oldest results before sending new requests
+                while len(in_flight) >= self.max_in_flight_requests:
+                    inferences.extend(_decrypt(in_flight.popleft().result()))
+
+                in_flight.append(
+                    pool.submit(self._remote_compute, encrypted_inputs, key_id, repr_input_shape)
                 )
-            start = time.time()
-            assert self.module_name is not None
-            if self.verbose:
-                print("Infering ...")
-            # Inference using FHE server
-            inference_query = requests.post(
-                f"{self.server_remote_address}/compute",
-                files={
-                    "model_input": io.BytesIO(encrypted_input),
-                },
-                data={
-                    "uid": key_id,
-                    "module_name": self.module_name,
-                    "model_name": self.model_name,
-                    "input_shape": repr_input_shape,
-                },
-                stream=True,
-            )
-            end = time.time()
-            if self.verbose:
-                print(f"Inference done in {end - start} seconds")
-            # Deserialize and decrypt the result
-            assert inference_query.status_code == 200, inference_query.content.decode("utf-8")
-            encrypted_result = inference_query.content
-            decrypted_prediction = client.deserialize_decrypt_dequantize(encrypted_result)[0]
-            inferences.append(decrypted_prediction)
+
+            while in_flight:
+                inferences.extend(_decrypt(in_flight.popleft().result()))
+        finally:
+            if pool is not self.request_pool:
+                pool.shutdown()
+
+        clear_outputs = numpy.array(inferences)
+        if bucket_shape is not None:
+            clear_outputs = strip_padding(clear_outputs, input_shape)
 
         # Concatenate results and move them back to proper device
-        return torch.Tensor(numpy.array(inferences)).to(device=base_device)
+        return torch.Tensor(clear_outputs).to(device=base_device)
 
 
 # pylint: disable-next=too-many-instance-attributes
@@ -356,6 +710,14 @@ class HybridFHEModel:
         server_remote_address (str): The remote address of the FHE server.
         model_name (str): Model name identifier.
         verbose (int): If logs should be printed when interacting with FHE server.
+        remote_batch_size (Optional[int]): The number of encrypted rows sent to the FHE server in
+            a single request. Batches of several rows are sent to the server's `/compute_batch`
+            endpoint. If None, all the rows given to a remote module are sent in a single request,
+            which for example makes each remote forward and backward matmul of a LoRA training step
+            a single call. Default to 1.
+        max_in_flight_requests (int): The maximum number of requests waiting for the FHE server
+            at the same time, per remote module. The threads sending these requests are shared
+            by all remote modules and kept across calls. Default to 1.
 
     Raises:
         TypeError: If the provided model is not an instance of torch.nn.Module.
@@ -368,6 +730,8 @@ class HybridFHEModel:
         server_remote_address: Optional[str] = None,
         model_name: str = "model",
         verbose: int = 0,
+        remote_batch_size: Optional[int] = 1,
+        max_in_flight_requests: int = 1,
     ):
         if not isinstance(model, torch.nn.Module):
             raise TypeError("The model must be a PyTorch or Brevitas model.")
@@ -380,10 +744,14 @@ class HybridFHEModel:
         }
         self.remote_modules: Dict[str, RemoteModule] = {}
         self.private_q_modules: Dict[str, QuantizedModule] = {}
+        self.bucket_q_modules: Dict[str, Dict[str, QuantizedModule]] = {}
         self.configuration: Optional[Configuration] = None
         self.model_name = model_name
         self.verbose = verbose
+        self.remote_batch_size = remote_batch_size
+        self.max_in_flight_requests = max_in_flight_requests
         self.executor: Optional[GLWELinearLayerExecutor] = None
+        self.request_pool: Optional[ThreadPoolExecutor] = None
 
         self._replace_modules()
 
@@ -437,6 +805,8 @@ class HybridFHEModel:
                 model_name=self.model_name,
                 verbose=self.verbose,
                 optimized_linear_execution=(self._has_only_large_linear_layers),
+                remote_batch_size=self.remote_batch_size,
+                max_in_flight_requests=self.max_in_flight_requests,
             )
 
             self.remote_modules[module_name] = remote_module
@@ -481,9 +851,23 @@ class HybridFHEModel:
                 if fhe_mode != HybridFHEMode.DISABLE and self.executor.private_key is None:
                     self.executor.keygen()
 
+                # Convert the frozen weights of all layers once, before running any of them. They
+                # are then re-used by all the following calls, for example across training steps
+                if fhe_mode == HybridFHEMode.EXECUTE:
+                    for module in self.remote_modules.values():
+                        if module.private_q_module is not None:
+                            self.executor.prepare_weights(module.private_q_module)
+
+        # Requests of all remote modules are sent using the same persistent pool of threads
+        if fhe_mode == HybridFHEMode.REMOTE:  # pragma:no cover
+            self.request_pool = self.request_pool or ThreadPoolExecutor(
+                max_workers=self.max_in_flight_requests
+            )
+
         # Update executor for all remote modules
         for module in self.remote_modules.values():
             module.executor = self.executor
+            module.request_pool = self.request_pool
 
         result = self.model(x)
 
@@ -540,18 +924,21 @@ class HybridFHEModel:
 
     def compile_model(
         self,
-        x: torch.Tensor,
+        x: Union[torch.Tensor, List[torch.Tensor]],
         n_bits: Union[int, Dict[str, int]] = MAX_BITWIDTH_BACKWARD_COMPATIBLE,
         rounding_threshold_bits: Optional[int] = None,
         p_error: Optional[float] = None,
         device: str = "cpu",
         configuration: Optional[Configuration] = None,
+        n_shape_buckets: Optional[int] = None,
+        compilation_cache: Optional[CompilationCache] = None,
     ):
         """Compiles the specific layers to FHE.
 
         Args:
-            x (torch.Tensor): The input tensor for the model. This is used to run the model
-                once for calibration.
+            x (Union[torch.Tensor, List[torch.Tensor]]): The input tensor for the model. This is
+                used to run the model once for calibration. A list of tensors, for example of
+                different sequence lengths, runs the model once per tensor.
             n_bits (int): The bit precision for quantization during FHE model compilation.
                 Default is 8.
             rounding_threshold_bits (int): The number of bits to use for rounding threshold during
@@ -560,55 +947,148 @@ class HybridFHEModel:
             device: FHE compilation device, can be either 'cpu' or 'cuda'.
             configuration (Configuration): A concrete Configuration object specifying the FHE
                 encryption parameters. If not specified, a default configuration is used.
+            n_shape_buckets (Optional[int]): If set, the input shapes seen by each remote module
+                during calibration can vary and at most this number of circuits is compiled per
+                module, one for each bucket shape chosen from the shapes' histogram. Inputs are
+                then padded with zeros to the nearest bucket and the padding is removed from the
+                outputs. Only the dimensions between the first and the last one can vary, which
+                for example fits linear layers applied on sequences of variable lengths. If None,
+                a single circuit is compiled per module. Default to None.
+            compilation_cache (Optional[CompilationCache]): The cache to load the modules'
+                compiled circuits from, or to store them in. Modules found in the cache are not
+                compiled. Default to None.
         """
         # We do a forward pass where we accumulate inputs to use for compilation
         self.set_fhe_mode(HybridFHEMode.CALIBRATE)
 
         # Run the model to get the calibration data
-        self.model(x)
+        for calibration_input in x if isinstance(x, list) else [x]:
+            self.model(calibration_input)
 
         self.configuration = configuration
 
+        compilation_kwargs = {
+            "n_bits": n_bits,
+            "rounding_threshold_bits": rounding_threshold_bits,
+            "p_error": p_error,
+            "device": device,
+            "configuration": configuration,
+            "compilation_cache": compilation_cache,
+        }
+
         for name in self.module_names:
             remote_module = self._get_module_by_name(self.model, name)
             assert isinstance(remote_module, RemoteModule)
 
-            calibration_data_tensor = torch.cat(remote_module.calibration_data, dim=0)
-
-            if has_any_qnn_layers(self.private_modules[name]):
-                self.private_q_modules[name] = compile_brevitas_qat_model(
-                    self.private_modules[name],
-                    calibration_data_tensor,
-                    n_bits=n_bits,
-                    rounding_threshold_bits=rounding_threshold_bits,
-                    configuration=configuration,
-                    p_error=p_error,
-                    device=device,
+            if n_shape_buckets is None:
+                calibration_data_tensor = torch.cat(remote_module.calibration_data, dim=0)
+                self.private_q_modules[name] = self._compile_module(
+                    name, calibration_data_tensor, **compilation_kwargs
                 )
+
             else:
-                # If all layers are linear and the GLWE backend is available
-                # then simply quantize the model without compiling with
-                # Concrete Python.
-                if self._has_only_large_linear_layers and has_glwe_backend():
-                    self.executor = GLWELinearLayerExecutor()
-                    self.private_q_modules[name] = build_quantized_module(
-                        self.private_modules[name],
-                        calibration_data_tensor,
-                        n_bits=n_bits,
-                        rounding_threshold_bits=rounding_threshold_bits,
+                # Choose the buckets from the histogram of the calibration input shapes
+                shape_counts: Dict[Tuple[int, ...], int] = defaultdict(int)
+                for calibration_data in remote_module.calibration_data:
+                    shape_counts[(1,) + tuple(calibration_data.shape[1:])] += len(calibration_data)
+
+                remote_module.shape_buckets = compute_shape_buckets(shape_counts, n_shape_buckets)
+
+                # Pad each calibration input to its bucket
+                bucket_data: Dict[Tuple[int, ...], List[torch.Tensor]] = defaultdict(list)
+                for calibration_data in remote_module.calibration_data:
+                    bucket_shape = remote_module.get_bucket_shape(
+                        (1,) + tuple(calibration_data.shape[1:])
+                    )
+                    assert bucket_shape is not None
+                    bucket_data[bucket_shape].append(
+                        torch.from_numpy(pad_to_shape(calibration_data.cpu().numpy(), bucket_shape))
                     )
-                else:
-                    self.private_q_modules[name] = compile_torch_model(
-                        self.private_modules[name],
-                        calibration_data_tensor,
-                        n_bits=n_bits,
-                        rounding_threshold_bits=rounding_threshold_bits,
-                        configuration=configuration,
-                        p_error=p_error,
+
+                # Buckets in which no input falls are not compiled
+                remote_module.shape_buckets = [
+                    shape for shape in remote_module.shape_buckets if shape in bucket_data
+                ]
+
+                self.bucket_q_modules[name] = {
+                    str(bucket_shape): self._compile_module(
+                        name, torch.cat(bucket_data[bucket_shape], dim=0), **compilation_kwargs
                     )
+                    for bucket_shape in remote_module.shape_buckets
+                }
+                remote_module.bucket_q_modules = self.bucket_q_modules[name]
+
+                # The largest bucket's circuit is the module's default one
+                self.private_q_modules[name] = self.bucket_q_modules[name][
+                    str(remote_module.shape_buckets[-1])
+                ]
 
             self.remote_modules[name].private_q_module = self.private_q_modules[name]
 
+    def _compile_module(
+        self,
+        name: str,
+        calibration_data_tensor: torch.Tensor,
+        n_bits: Union[int, Dict[str, int]],
+        rounding_threshold_bits: Optional[int],
+        p_error: Optional[float],
+        device: str,
+        configuration: Optional[Configuration],
+        compilation_cache: Optional[CompilationCache],
+    ) -> QuantizedModule:
+        """Compile a private module to FHE for the given calibration data.
+
+        Args:
+            name (str): The name of the private module to compile.
+            calibration_data_tensor (torch.Tensor): The inputs of the module seen during
+                calibration.
+            n_bits (Union[int, Dict[str, int]]): The bit precision for quantization.
+            rounding_threshold_bits (Optional[int]): The number of bits to use for rounding
+                threshold.
+            p_error (Optional[float]): Error allowed for each table look-up in the circuit.
+            device (str): FHE compilation device, can be either 'cpu' or 'cuda'.
+            configuration (Optional[Configuration]): A concrete Configuration object specifying
+                the FHE encryption parameters.
+            compilation_cache (Optional[CompilationCache]): The cache to load the compiled
+                circuit from, or to store it in.
+
+        Returns:
+            QuantizedModule: The compiled, or only quantized for the GLWE backend, module.
+        """
+        if has_any_qnn_layers(self.private_modules[name]):
+            return compile_brevitas_qat_model(
+                self.private_modules[name],
+                calibration_data_tensor,
+                n_bits=n_bits,
+                rounding_threshold_bits=rounding_threshold_bits,
+                configuration=configuration,
+                p_error=p_error,
+                device=device,
+                compilation_cache=compilation_cache,
+            )
+
+        # If all layers are linear and the GLWE backend is available
+        # then simply quantize the model without compiling with
+        # Concrete Python.
+        if self._has_only_large_linear_layers and has_glwe_backend():
+            self.executor = GLWELinearLayerExecutor()
+            return build_quantized_module(
+                self.private_modules[name],
+                calibration_data_tensor,
+                n_bits=n_bits,
+                rounding_threshold_bits=rounding_threshold_bits,
+            )
+
+        return compile_torch_model(
+            self.private_modules[name],
+            calibration_data_tensor,
+            n_bits=n_bits,
+            rounding_threshold_bits=rounding_threshold_bits,
+            configuration=configuration,
+            p_error=p_error,
+            compilation_cache=compilation_cache,
+        )
+
     def _save_fhe_circuit(self, path: Path, via_mlir=False):
         """Private method that saves the FHE circuits.
 
@@ -620,24 +1100,29 @@ class HybridFHEModel:
 
         model_path = Path(path)
         for module_name in self.module_names:
-            onnx_model = self.private_q_modules[module_name].onnx_model
-
-            # mypy
-            assert onnx_model is not None
-            input_shapes = [
-                tuple(elt.dim_value for elt in onnx_input.type.tensor_type.shape.dim)
-                for onnx_input in onnx_model.graph.input
+            # With shape bucketing, one circuit is saved per bucket shape
+            q_modules = list(self.bucket_q_modules.get(module_name, {}).values()) or [
+                self.private_q_modules[module_name]
             ]
 
-            assert len(input_shapes) == 1, "Multi-input circuits not supported yet"
-            model_module_path = model_path.resolve() / module_name
-            model_module_path.mkdir(exist_ok=True)
-            model_module_shape_path = model_module_path / tuple_to_underscore_str(input_shapes[0])
-            model_dev = FHEModelDev(
-                str(model_module_shape_path.resolve()),
-                self.private_q_modules[module_name],
-            )
-            model_dev.save(via_mlir=via_mlir)
+            for q_module in q_modules:
+                onnx_model = q_module.onnx_model
+
+                # mypy
+                assert onnx_model is not None
+                input_shapes = [
+                    tuple(elt.dim_value for elt in onnx_input.type.tensor_type.shape.dim)
+                    for onnx_input in onnx_model.graph.input
+                ]
+
+                assert len(input_shapes) == 1, "Multi-input circuits not supported yet"
+                model_module_path = model_path.resolve() / module_name
+                model_module_path.mkdir(exist_ok=True)
+                model_module_shape_path = model_module_path / tuple_to_underscore_str(
+                    input_shapes[0]
+                )
+                model_dev = FHEModelDev(str(model_module_shape_path.resolve()), q_module)
+                model_dev.save(via_mlir=via_mlir)
 
     def save_and_clear_private_info(self, path: Path, via_mlir=True):
         """Save the PyTorch model to the provided path and also saves the corresponding FHE circuit.
@@ -658,6 +1143,9 @@ class HybridFHEModel:
         path = Path(path)
         path.mkdir(parents=True, exist_ok=True)
 
+        # The request threads and HTTP sessions are not saved along with the model
+        self.cleanup()
+
         # Save the complete model (including private info) for the developer
         complete_model_path = path / "complete_model.pth"
         torch.save(self.model.state_dict(), complete_model_path.resolve())
@@ -668,8 +1156,11 @@ class HybridFHEModel:
                 "private_module",
                 "calibration_data",
                 "private_q_module",
+                "bucket_q_modules",
                 "private_key",
                 "compression_key",
+                "session",
+                "request_pool",
             ]:
                 if hasattr(module, attr):
                     setattr(module, attr, None)
@@ -687,6 +1178,23 @@ class HybridFHEModel:
         # Save the FHE circuit in the same directory
         self._save_fhe_circuit(path, via_mlir=via_mlir)
 
+    def cleanup(self):
+        """Release the resources used for querying the FHE server.
+
+        The shared pool of request threads is shut down and the remote modules' HTTP sessions are
+        closed. They are created again if the model is run in remote mode afterwards.
+        """
+        if self.request_pool is not None:
+            self.request_pool.shutdown()
+            self.request_pool = None
+
+        for module in self.remote_modules.values():
+            module.request_pool = None
+
+            if module.session is not None:
+                module.session.close()
+                module.session = None
+
     def publish_to_hub(self):
         """Allow the user to push the model and FHE required files to HF Hub."""
         # FIXME: implement HuggingFace model hub integration
@@ -714,44 +1222,51 @@ class LoggerStub:  # pragma:no cover
         """
 
 
-@lru_cache(maxsize=None)  # noqa: B019
-def _load_key(key_path: Path, uid: Union[str, uuid.UUID]) -> bytes:  # pragma:no cover
-    """Load a public key from the file system.
-
-    Args:
-        key_path (Path): key path
-        uid (Union[str, uuid.UUID]): uid of the public key to load
-
-    Returns:
-        bytes: the bytes of the public key
-    """
-    with open(key_path / str(uid), "rb") as file:
-        return file.read()
-
-
-@lru_cache(maxsize=None)  # noqa: B019,W1517
-def _get_circuit(path: str) -> FHEModelServer:  # pragma:no cover
-    """Get circuit based on model name, module name and input shape.
-
-    Args:
-        path (str): path to the model server
-
-    Returns:
-        FHEModelServer: a fhe model server of the given module of the given model
-            for the given shape
-
-    """
-    return FHEModelServer(path)
-
-
 class HybridFHEModelServer:  # pragma:no cover
     """Hybrid FHE Model Server.
 
     This is a class object to server FHE models serialized using HybridFHEModel.
+
+    Deserialized evaluation keys and loaded circuits are kept in memory, so that repeated calls from
+    the same client do not need to read and deserialize them again. Least recently used entries are
+    evicted once the caches exceed their budget.
+
+    Args:
+        key_path (Path): The directory where the evaluation keys are stored.
+        model_dir (Path): The directory where the compiled models are stored.
+        logger (Optional[LoggerStub]): The logger to use, if any.
+        max_evaluation_keys_cache_size (Optional[int]): The maximum total size, in bytes, of the
+            cached evaluation keys. Sizes are estimated using the keys' serialized size. If None,
+            the cache is not bounded. Default to 4 GB.
+        max_cached_circuits (Optional[int]): The maximum number of cached circuits. If None, the
+            cache is not bounded. Default to None.
+        scheduler (Optional[RequestScheduler]): The scheduler executing the `compute` and
+            `compute_batch` requests, each module being scheduled as a separate model and each
+            row of a batch as a separate request. It bounds the number of requests waiting or
+            running at the same time and rejects new requests when full. If None, requests are
+            executed right away in the calling thread. Default to None.
+        model_registry (Optional[ModelRegistry]): The registry loading and sharing the circuits.
+            All circuits found in `model_dir` are registered in it, which allows preloading them
+            in parallel with `model_registry.preload()` and reloading them when their artifacts
+            change. If None, circuits are loaded on their first request and kept in the bounded
+            circuits cache. Default to None.
     """
 
-    def __init__(self, key_path: Path, model_dir: Path, logger: Optional[LoggerStub]):
+    def __init__(
+        self,
+        key_path: Path,
+        model_dir: Path,
+        logger: Optional[LoggerStub],
+        max_evaluation_keys_cache_size: Optional[int] = 4 * 1024**3,
+        max_cached_circuits: Optional[int] = None,
+        scheduler: Optional[RequestScheduler] = None,
+        model_registry: Optional[ModelRegistry] = None,
+    ):
         self.logger = logger
+        self.scheduler = scheduler
+        self.model_registry = model_registry
+        self.evaluation_keys_cache = LRUCache(max_size=max_evaluation_keys_cache_size)
+        self.circuits_cache = LRUCache(max_entries=max_cached_circuits)
         self.key_path = key_path
         self.key_path.mkdir(exist_ok=True)
         self.model_dir = model_dir
@@ -782,6 +1297,11 @@ class HybridFHEModelServer:  # pragma:no cover
                         "shape": input_shape,
                     }
 
+                    if self.model_registry is not None:
+                        self.model_registry.register(
+                            f"{model_name}/{module_name}/{input_shape}", input_shape_path
+                        )
+
     def load_key(self, uid: Union[str, uuid.UUID]) -> bytes:
         """Load a public key from the key path in the file system.
 
@@ -791,7 +1311,24 @@ class HybridFHEModelServer:  # pragma:no cover
         Returns:
             bytes: the bytes of the public key
         """
-        return _load_key(self.key_path, uid)
+        with open(self.key_path / str(uid), "rb") as file:
+            return file.read()
+
+    def get_evaluation_keys(self, uid: Union[str, uuid.UUID]) -> EvaluationKeys:
+        """Get the deserialized evaluation keys, loading them from the file system if needed.
+
+        Args:
+            uid (Union[str, uuid.UUID]): uid of the public key to get
+
+        Returns:
+            EvaluationKeys: the deserialized evaluation keys
+        """
+
+        def _load_evaluation_keys():
+            key_bytes = self.load_key(uid)
+            return EvaluationKeys.deserialize(key_bytes), len(key_bytes)
+
+        return self.evaluation_keys_cache.get_or_load(str(uid), _load_evaluation_keys)
 
     def dump_key(self, key_bytes: bytes, uid: Union[uuid.UUID, str]) -> None:
         """Dump a public key to a stream.
@@ -803,6 +1340,21 @@ class HybridFHEModelServer:  # pragma:no cover
         with open(self.key_path / str(uid), "wb") as file:
             file.write(key_bytes)
 
+        # Make sure outdated keys are not used anymore
+        self.evaluation_keys_cache.pop(str(uid))
+
+    def cache_metrics(self) -> Dict[str, Dict[str, int]]:
+        """Get the metrics of the evaluation keys and circuits caches.
+
+        Returns:
+            Dict[str, Dict[str, int]]: the hits, misses, evictions, number of entries and size of
+                each cache
+        """
+        return {
+            "evaluation_keys": self.evaluation_keys_cache.metrics,
+            "circuits": self.circuits_cache.metrics,
+        }
+
     def get_circuit(self, model_name, module_name, input_shape):
         """Get circuit based on model name, module name and input shape.
 
@@ -816,8 +1368,15 @@ class HybridFHEModelServer:  # pragma:no cover
                 for the given shape
 
         """
-        path = str(self.modules[model_name][module_name][input_shape]["path"])
-        return _get_circuit(path)
+        if self.model_registry is not None:
+            return self.model_registry.get(f"{model_name}/{module_name}/{input_shape}")
+
+        path = Path(self.modules[model_name][module_name][input_shape]["path"])
+
+        def _load_circuit():
+            return FHEModelServer(str(path)), (path / "server.zip").stat().st_size
+
+        return self.circuits_cache.get_or_load(str(path), _load_circuit)
 
     def check_inputs(self, model_name: str, module_name: Optional[str], input_shape: Optional[str]):
         """Check that the given configuration exist in the compiled models folder.
@@ -943,22 +1502,32 @@ class HybridFHEModelServer:  # pragma:no cover
         """
         self.check_inputs(model_name, module_name, input_shape)
         start = time.time()
-        key_bytes = self.load_key(uid)
+        with measure_stage("hybrid_server.load_evaluation_keys"):
+            evaluation_keys = self.get_evaluation_keys(uid)
         end = time.time()
         if self.logger is not None:
             self.logger.info(f"It took {end - start} seconds to load the key")
 
         start = time.time()
-        fhe = self.get_circuit(model_name, module_name, input_shape)
+        with measure_stage("hybrid_server.load_circuit", module=module_name):
+            fhe_model_server = self.get_circuit(model_name, module_name, input_shape)
         end = time.time()
         if self.logger is not None:
             self.logger.info(f"It took {end - start} seconds to load the circuit")
 
         start = time.time()
-        encrypted_results = fhe.run(
-            serialized_encrypted_quantized_data=model_input,
-            serialized_evaluation_keys=key_bytes,
-        )
+        if self.scheduler is not None:
+            encrypted_results = self.scheduler.submit_run(
+                f"{model_name}/{module_name}",
+                fhe_model_server,
+                model_input,
+                serialized_evaluation_keys=evaluation_keys,
+            ).result()
+        else:
+            encrypted_results = fhe_model_server.run(
+                serialized_encrypted_quantized_data=model_input,
+                serialized_evaluation_keys=evaluation_keys,
+            )
         end = time.time()
 
         if self.logger is not None:
@@ -966,3 +1535,72 @@ class HybridFHEModelServer:  # pragma:no cover
             self.logger.info(f"Results size is {len(encrypted_results)/(1024**2)} Mb")
         start = time.time()
         return encrypted_results
+
+    def compute_batch(
+        self,
+        model_inputs: Sequence[bytes],
+        uid: str,
+        model_name: str,
+        module_name: str,
+        input_shape: str,
+        deadline: Optional[float] = None,
+    ) -> List[bytes]:
+        """Compute the circuit over several encrypted inputs.
+
+        The evaluation keys and the circuit are only loaded once for the whole batch. If a
+        scheduler is set, each input is submitted as a separate request of the module, so that
+        batches follow the same concurrency limits and backpressure as single requests. If the
+        scheduler's queue cannot hold the whole batch, the already queued inputs are cancelled.
+
+        Arguments:
+            model_inputs (Sequence[bytes]): inputs of the circuit
+            uid (str): uid of the public key to use
+            model_name (str): model name
+            module_name (str): name of the module in the model
+            input_shape (str): input shape of said module
+            deadline (Optional[float]): The delay, in seconds from now, after which the inputs
+                that have not been started yet fail. Only used if a scheduler is set. If None,
+                the requests never expire. Default to None.
+
+        Returns:
+            List[bytes]: the results of the circuit, in the same order as the inputs
+        """
+        self.check_inputs(model_name, module_name, input_shape)
+        evaluation_keys = self.get_evaluation_keys(uid)
+        fhe_model_server = self.get_circuit(model_name, module_name, input_shape)
+
+        start = time.time()
+        if self.scheduler is not None:
+            futures: List[Future] = []
+            try:
+                for model_input in model_inputs:
+                    futures.append(
+                        self.scheduler.submit_run(
+                            f"{model_name}/{module_name}",
+                            fhe_model_server,
+                            model_input,
+                            serialized_evaluation_keys=evaluation_keys,
+                            deadline=deadline,
+                        )
+                    )
+            except Exception:
+                for future in futures:
+                    future.cancel()
+                raise
+            encrypted_results = [future.result() for future in futures]
+        else:
+            encrypted_results = [
+                fhe_model_server.run(
+                    serialized_encrypted_quantized_data=model_input,
+                    serialized_evaluation_keys=evaluation_keys,
+                )
+                for model_input in model_inputs
+            ]
+        end = time.time()
+
+        if self.logger is not None:
+            self.logger.info(
+                f"fhe inference of {len(model_inputs)} inputs of shape {input_shape} took "
+                f"{end - start}"
+            )
+        return encrypted_results
@@ -0,0 +1,170 @@
+"""Tests for the batch executor."""
+
+import copy
+import pickle
+import threading
+import time
+
+import numpy
+import pytest
+
+from concrete.ml.common.batch_executor import (
+    DEFAULT_N_CPU_JOBS,
+    BatchExecutor,
+    DeviceBatchExecutor,
+)
+from concrete.ml.search_parameters.p_error_search import copy_without_circuits
+from concrete.ml.sklearn import LogisticRegression
+
+
+def _two_outputs_method(q_x_1, q_x_2):
+    """Return two outputs for a single sample."""
+    assert q_x_1.shape[0] == 1 and q_x_2.shape[0] == 1
+    return q_x_1 + q_x_2, q_x_1 * 2
+
+
+@pytest.mark.parametrize("n_jobs", [None, 1, 3, -1])
+@pytest.mark.parametrize("batch_size", [None, 1, 4])
+def test_batch_executor_keeps_order(n_jobs, batch_size):
+    """Test that the executor returns the same results as the sequential loop, in order."""
+
+    q_x_1 = numpy.random.randint(-10, 10, size=(23, 5))
+    q_x_2 = numpy.random.randint(-10, 10, size=(23, 5))
+
+    executor = BatchExecutor(n_jobs=n_jobs, batch_size=batch_size)
+
+    q_y_1, q_y_2 = executor.run(_two_outputs_method, q_x_1, q_x_2)
+
+    assert numpy.array_equal(q_y_1, q_x_1 + q_x_2)
+    assert numpy.array_equal(q_y_2, q_x_1 * 2)
+
+    # The streaming mode should yield one result per sample, in the same order
+    streamed = list(executor.imap(_two_outputs_method, q_x_1, q_x_2))
+    assert len(streamed) == q_x_1.shape[0]
+    for i, (q_y_1_i, _) in enumerate(streamed):
+        assert numpy.array_equal(q_y_1_i, q_x_1[[i]] + q_x_2[[i]])
+
+
+@pytest.mark.parametrize(
+    "n_jobs, batch_size, error_message",
+    [
+        pytest.param(0, None, "Parameter 'n_jobs' must be None, -1 or a strictly positive integer"),
+        pytest.param(-2, None, "Parameter 'n_jobs' must be None, -1 or a strictly positive integer"),
+        pytest.param(2, 0, "Parameter 'batch_size' must be None or a strictly positive integer"),
+    ],
+)
+def test_batch_executor_errors(n_jobs, batch_size, error_message):
+    """Test that the executor raises errors for invalid parameters."""
+
+    with pytest.raises(ValueError, match=error_message):
+        BatchExecutor(n_jobs=n_jobs, batch_size=batch_size)
+
+
+def test_batch_executor_mismatched_inputs():
+    """Test that the executor raises an error if inputs have different number of samples."""
+
+    with pytest.raises(ValueError, match="All inputs must have the same number of samples."):
+        BatchExecutor().run(_two_outputs_method, numpy.zeros((3, 2)), numpy.zeros((4, 2)))
+
+
+def test_device_batch_executor_overflow():
+    """Test that CPU workers take the overflow of GPU workers and that utilization is reported."""
+
+    q_x = numpy.arange(40).reshape(40, 1)
+    devices_by_sample = {}
+    lock = threading.Lock()
+
+    def get_method(device):
+        """Get a method recording the device executing each sample."""
+
+        def method(q_x_i):
+            """Record the device, GPUs being faster than CPUs."""
+            with lock:
+                devices_by_sample[int(q_x_i[0, 0])] = device
+            time.sleep(0.01 if device == "cuda" else 0.03)
+            return q_x_i * 2
+
+        return method
+
+    executor = DeviceBatchExecutor(n_jobs_per_device={"cpu": 2, "cuda": 2}, batch_size=8)
+
+    # GPU workers are preferred whatever the order in which devices are given
+    assert executor.primary_device == "cuda"
+
+    (q_y,) = executor.run({"cuda": get_method("cuda"), "cpu": get_method("cpu")}, q_x)
+    assert numpy.array_equal(q_y, q_x * 2)
+
+    # Both devices executed samples, the GPU ones executing most of them
+    utilization = executor.get_utilization()
+    assert utilization["cuda"]["n_samples"] + utilization["cpu"]["n_samples"] == 40
+    assert utilization["cuda"]["n_samples"] > utilization["cpu"]["n_samples"] > 0
+    assert set(devices_by_sample.values()) == {"cuda", "cpu"}
+    assert all(0 < device["utilization"] <= 1 for device in utilization.values())
+
+    # A single method given along its device only runs on the workers of that device
+    executor.reset_utilization()
+    (q_y,) = executor.run(get_method("cuda"), q_x, device="cuda")
+    assert numpy.array_equal(q_y, q_x * 2)
+    assert executor.get_utilization()["cpu"]["n_samples"] == 0
+
+    with pytest.raises(ValueError, match="None of the devices"):
+        DeviceBatchExecutor(n_jobs_per_device={"cpu": 1}).run(
+            _two_outputs_method, q_x, q_x, device="cuda"
+        )
+
+
+def test_device_batch_executor_default_n_jobs():
+    """Test that only a few CPU workers are used by default, as Concrete is multi-threaded."""
+
+    executor = DeviceBatchExecutor()
+    assert 1 <= executor.n_jobs_per_device["cpu"] <= DEFAULT_N_CPU_JOBS
+
+
+def test_device_batch_executor_errors():
+    """Test that errors of the executed methods and invalid devices are raised."""
+
+    def failing_method(q_x_i):
+        """Fail on a single sample."""
+        if q_x_i[0, 0] == 3:
+            raise RuntimeError("Sample 3 failed")
+        return q_x_i
+
+    with pytest.raises(RuntimeError, match="Sample 3 failed"):
+        DeviceBatchExecutor(n_jobs_per_device={"cpu": 3}).run(
+            failing_method, numpy.arange(10).reshape(10, 1)
+        )
+
+    with pytest.raises(ValueError, match="Parameter 'n_jobs_per_device' must map at least one"):
+        DeviceBatchExecutor(n_jobs_per_device={"cpu": 0})
+
+    with pytest.raises(ValueError, match="can be one of"):
+        DeviceBatchExecutor(n_jobs_per_device={"tpu": 1})
+
+
+def test_device_batch_executor_copy():
+    """Test that executors, and the models holding them, can be pickled and deep copied."""
+
+    q_x = numpy.arange(10).reshape(10, 1)
+    executor = DeviceBatchExecutor(n_jobs_per_device={"cpu": 2})
+    executor.run(lambda q_x_i: q_x_i * 2, q_x)
+
+    for copied_executor in [copy.deepcopy(executor), pickle.loads(pickle.dumps(executor))]:
+        # Copies keep their configuration and measurements, which are then updated separately
+        assert copied_executor.n_jobs_per_device == executor.n_jobs_per_device
+        assert copied_executor.get_utilization()["cpu"]["n_samples"] == 10
+
+        (q_y,) = copied_executor.run(lambda q_x_i: q_x_i * 3, q_x)
+        assert numpy.array_equal(q_y, q_x * 3)
+        assert copied_executor.get_utilization()["cpu"]["n_samples"] == 20
+        assert executor.get_utilization()["cpu"]["n_samples"] == 10
+
+    model = LogisticRegression()
+    model.fhe_executor = executor
+
+    for copied_model in [
+        copy.deepcopy(model),
+        copy_without_circuits(model),
+        pickle.loads(pickle.dumps(model)),
+    ]:
+        assert isinstance(copied_model.fhe_executor, DeviceBatchExecutor)
+        assert copied_model.fhe_executor.n_jobs_per_device == executor.n_jobs_per_device
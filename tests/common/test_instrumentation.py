@@ -0,0 +1,144 @@
+"""Test the instrumentation hooks."""
+
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from concrete.ml.common.instrumentation import (
+    InstrumentationHook,
+    RecordingHook,
+    is_enabled,
+    measure_stage,
+    record_bytes,
+    register_hook,
+    unregister_hook,
+)
+from concrete.ml.sklearn import LogisticRegression
+
+
+@pytest.fixture
+def recording_hook():
+    """Register a recording hook for the duration of a test."""
+    hook = register_hook(RecordingHook())
+    yield hook
+    unregister_hook(hook)
+
+
+def test_disabled_instrumentation():
+    """Test that nothing is measured when no hooks are registered."""
+
+    assert not is_enabled()
+
+    # The same null context manager is returned for all stages
+    assert measure_stage("stage_a") is measure_stage("stage_b", attribute=1)
+
+    with measure_stage("stage_a"):
+        pass
+
+    record_bytes("data", 10)
+
+
+def test_recording_hook(recording_hook):
+    """Test that durations and byte counts are forwarded to the registered hooks."""
+
+    assert is_enabled()
+
+    # Registering the same hook twice does not duplicate the measurements
+    register_hook(recording_hook)
+
+    for _ in range(3):
+        with measure_stage("stage_a", attribute="value"):
+            pass
+
+    with measure_stage("stage_b"):
+        pass
+
+    record_bytes("data", 10)
+    record_bytes("data", 30)
+
+    durations = recording_hook.durations
+    assert set(durations) == {"stage_a", "stage_b"}
+    assert len(durations["stage_a"]) == 3
+    assert all(duration >= 0 for duration in durations["stage_a"])
+
+    metrics = recording_hook.metrics
+    assert metrics["stage_a.duration"]["count"] == 3
+    assert metrics["stage_b.duration"]["count"] == 1
+    assert metrics["data.bytes"] == {"count": 2, "total": 40, "mean": 20}
+
+    recording_hook.clear()
+    assert not recording_hook.metrics
+
+
+def test_unregister_hook():
+    """Test that unregistered hooks do not receive measurements anymore."""
+
+    hook = register_hook(RecordingHook())
+    unregister_hook(hook)
+
+    # Unregistering an unknown hook is a no-op
+    unregister_hook(hook)
+
+    assert not is_enabled()
+
+    with measure_stage("stage"):
+        pass
+
+    assert not hook.metrics
+
+
+def test_failed_stage_is_reported():
+    """Test that stages raising an exception are still reported, along with the error."""
+
+    class AttributesHook(InstrumentationHook):
+        """Hook keeping the attributes of the last stage."""
+
+        def __init__(self):
+            self.attributes = None
+
+        def on_stage(self, stage, duration, attributes):
+            self.attributes = attributes
+
+    hook = register_hook(AttributesHook())
+
+    try:
+        with pytest.raises(ValueError):
+            with measure_stage("stage", attribute="value"):
+                raise ValueError("Failed stage")
+
+        assert hook.attributes == {"attribute": "value", "error": "ValueError"}
+    finally:
+        unregister_hook(hook)
+
+
+def test_recording_hook_threads(recording_hook):
+    """Test that measurements can be reported from several threads at the same time."""
+
+    def run_stage(_):
+        with measure_stage("stage"):
+            record_bytes("data", 1)
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        list(pool.map(run_stage, range(100)))
+
+    metrics = recording_hook.metrics
+    assert metrics["stage.duration"]["count"] == 100
+    assert metrics["data.bytes"]["total"] == 100
+
+
+def test_model_predict_stages(recording_hook, load_data):
+    """Test that built-in models report their inference stages."""
+
+    x, y = load_data(LogisticRegression, n_samples=50, n_features=4)
+
+    model = LogisticRegression(n_bits=4)
+    model.fit(x, y)
+    model.compile(x)
+
+    recording_hook.clear()
+
+    model.predict(x[:2], fhe="simulate")
+
+    durations = recording_hook.durations
+    for stage in ["model.quantize", "model.inference", "model.dequantize"]:
+        assert stage in durations, f"Stage '{stage}' was not reported"
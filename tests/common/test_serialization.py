@@ -26,8 +26,8 @@ from concrete.ml.common.serialization import (
     UNSUPPORTED_TORCH_ACTIVATIONS,
     USE_SKOPS,
 )
-from concrete.ml.common.serialization.dumpers import dumps
-from concrete.ml.common.serialization.loaders import loads
+from concrete.ml.common.serialization.dumpers import dump_binary, dumps, dumps_binary
+from concrete.ml.common.serialization.loaders import load_binary, loads, loads_binary
 from concrete.ml.pytest.torch_models import SimpleNet
 from concrete.ml.pytest.utils import check_serialization, values_are_equal
 from concrete.ml.quantization import QuantizedModule
@@ -211,6 +211,49 @@ def test_serialize_numpy_array(dtype):
     check_serialization(value, numpy.ndarray)
 
 
+def test_serialize_binary_format(tmp_path, check_array_equal):
+    """Test the binary serialization format's memory-mapped and zero-copy loading."""
+    value = {
+        "array": numpy.arange(60, dtype=numpy.int64).reshape(3, 4, 5),
+        "fortran_array": numpy.asfortranarray(numpy.random.random((7, 3))),
+        "strided_array": numpy.arange(20, dtype=numpy.float32)[::3],
+        "empty_array": numpy.zeros((0, 4), dtype=numpy.int8),
+        "scalar_array": numpy.array(3.5),
+        "string_array": numpy.array(["a", "bc"]),
+        "tuple": (1, 2),
+    }
+
+    file_path = tmp_path / "value.bin"
+    with open(file_path, "wb") as file:
+        dump_binary(value, file)
+
+    with open(file_path, "rb") as file:
+        loaded = load_binary(file)
+
+    assert loaded.keys() == value.keys()
+    assert all(values_are_equal(value[name], loaded[name]) for name in value)
+
+    for name in ["array", "fortran_array", "strided_array", "empty_array", "scalar_array"]:
+        assert loaded[name].dtype == value[name].dtype
+        check_array_equal(loaded[name], value[name])
+
+        # Arrays are views on the memory-mapped file, which can still be modified in place
+        assert not loaded[name].flags.owndata
+        assert loaded[name].flags.writeable
+
+    # Modifying a loaded array does not modify the file
+    loaded["array"] += 1
+    with open(file_path, "rb") as file:
+        check_array_equal(load_binary(file)["array"], value["array"])
+
+    # Loading from a buffer without file descriptor reads it
+    with io.BytesIO(dumps_binary(value)) as buffer:
+        check_array_equal(load_binary(buffer)["array"], value["array"])
+
+    with pytest.raises(ValueError, match="was not dumped using Concrete ML's binary"):
+        loads_binary(dumps(value).encode("utf-8"))
+
+
 # Test the most important types
 @pytest.mark.parametrize(
     "value",
@@ -0,0 +1,164 @@
+"""Tests for the whole-batch simulation of compiled circuits."""
+
+import numpy
+import pytest
+from concrete import fhe
+from torch import nn
+
+from concrete.ml.common.batch_executor import BatchExecutor
+from concrete.ml.common.simulation import BatchedGraphSimulator, get_pbs_error_standard_deviation
+from concrete.ml.pytest.torch_models import FCSmall
+from concrete.ml.torch.compile import compile_torch_model
+
+
+@pytest.mark.parametrize("activation_function", [nn.ReLU, nn.Sigmoid])
+def test_batched_graph_simulation(activation_function, default_configuration, check_array_equal):
+    """Test that simulating the whole batch gives the same results as sample by sample."""
+
+    n_features = 5
+    inputset = numpy.random.uniform(-1, 1, size=(300, n_features))
+
+    quantized_module = compile_torch_model(
+        FCSmall(n_features, activation_function),
+        inputset,
+        configuration=default_configuration,
+        n_bits=4,
+    )
+
+    fhe_circuit = quantized_module.fhe_circuit
+    q_x = quantized_module.quantize_input(inputset)
+
+    expected_q_y = numpy.concatenate(
+        [fhe_circuit.graph(q_x[[i]]) for i in range(q_x.shape[0])], axis=0
+    )
+
+    # Without any error, the batched simulation matches the per-sample evaluation exactly
+    simulator = BatchedGraphSimulator(fhe_circuit.graph)
+    check_array_equal(simulator(q_x), expected_q_y)
+
+    # A single sample can also be given, as done when streaming the samples
+    check_array_equal(simulator(q_x[[0]]), expected_q_y[[0]])
+
+    # The batch executor runs the whole batch in a single call
+    check_array_equal(BatchExecutor(n_jobs=2).run(simulator, q_x)[0], expected_q_y)
+
+    # With a very high error probability, some results are expected to change
+    noisy_simulator = BatchedGraphSimulator(fhe_circuit.graph, p_error=0.5)
+    noisy_q_y = noisy_simulator(q_x)
+
+    assert noisy_q_y.shape == expected_q_y.shape
+    assert not numpy.array_equal(noisy_q_y, expected_q_y)
+
+    with pytest.raises(ValueError, match="cannot be split in samples of shape"):
+        simulator(q_x[:, :-1])
+
+
+def test_batched_graph_simulation_fallback(monkeypatch, default_configuration, check_array_equal):
+    """Test that nodes whose batched evaluation fails are evaluated sample by sample."""
+
+    n_features = 5
+    inputset = numpy.random.uniform(-1, 1, size=(50, n_features))
+
+    quantized_module = compile_torch_model(
+        FCSmall(n_features, nn.ReLU), inputset, configuration=default_configuration, n_bits=4
+    )
+
+    fhe_circuit = quantized_module.fhe_circuit
+    q_x = quantized_module.quantize_input(inputset)
+
+    expected_q_y = numpy.concatenate(
+        [fhe_circuit.graph(q_x[[i]]) for i in range(q_x.shape[0])], axis=0
+    )
+
+    def align_error(*_args):
+        """Fail as the batched evaluation of unsupported shapes does.
+
+        Raises:
+            ValueError: Always.
+        """
+        raise ValueError("operands could not be broadcast together")
+
+    monkeypatch.setattr(BatchedGraphSimulator, "_align", staticmethod(align_error))
+
+    check_array_equal(BatchedGraphSimulator(fhe_circuit.graph)(q_x), expected_q_y)
+
+
+def test_batched_graph_simulation_error_on_inputs(default_configuration, check_array_equal):
+    """Test that lookup tables applied directly on the circuit's inputs are not noisy."""
+
+    @fhe.compiler({"x": "encrypted"})
+    def square_modulo(x):
+        """Apply a lookup table on the input.
+
+        Args:
+            x: the encrypted input
+
+        Returns:
+            The lookup table's output.
+        """
+        return (x**2) % 11
+
+    fhe_circuit = square_modulo.compile(
+        [numpy.arange(8).reshape(1, 8)], configuration=default_configuration
+    )
+
+    q_x = numpy.tile(numpy.arange(8), (100, 1))
+    expected_q_y = (q_x**2) % 11
+
+    # Concrete's evaluation of the graph does not add errors on freshly encrypted inputs either
+    check_array_equal(fhe_circuit.graph(q_x[[0]], p_error=0.5), expected_q_y[[0]])
+    check_array_equal(BatchedGraphSimulator(fhe_circuit.graph, p_error=0.5)(q_x), expected_q_y)
+
+
+def test_batched_graph_simulation_error_rate(default_configuration):
+    """Test that the batched simulation makes as many errors as Concrete's simulation."""
+
+    n_features, n_samples = 5, 500
+    inputset = numpy.random.uniform(-1, 1, size=(n_samples, n_features))
+
+    quantized_module = compile_torch_model(
+        FCSmall(n_features, nn.ReLU),
+        inputset,
+        configuration=default_configuration,
+        n_bits=4,
+        p_error=0.1,
+    )
+
+    fhe_circuit = quantized_module.fhe_circuit
+    q_x = quantized_module.quantize_input(inputset)
+    samples = [q_x[[i]] for i in range(n_samples)]
+
+    expected_q_y = numpy.concatenate([fhe_circuit.graph(q_x_i) for q_x_i in samples], axis=0)
+
+    def get_error_rate(q_y: numpy.ndarray) -> float:
+        """Compute the proportion of samples with at least one wrong output.
+
+        Args:
+            q_y (numpy.ndarray): the simulated outputs
+
+        Returns:
+            float: the error rate
+        """
+        return numpy.mean(numpy.any(q_y != expected_q_y, axis=1))
+
+    simulated_q_y = numpy.concatenate([fhe_circuit.simulate(q_x_i) for q_x_i in samples], axis=0)
+    graph_q_y = numpy.concatenate(
+        [fhe_circuit.graph(q_x_i, p_error=fhe_circuit.p_error) for q_x_i in samples], axis=0
+    )
+    batched_q_y = BatchedGraphSimulator(fhe_circuit.graph, p_error=fhe_circuit.p_error)(q_x)
+
+    batched_error_rate = get_error_rate(batched_q_y)
+
+    # Errors happen as often as with Concrete's graph evaluation and compiled simulation
+    assert abs(batched_error_rate - get_error_rate(graph_q_y)) < 0.1
+    assert abs(batched_error_rate - get_error_rate(simulated_q_y)) < 0.1
+
+
+@pytest.mark.parametrize("p_error", [0.5, 0.1, 0.01])
+def test_pbs_error_standard_deviation(p_error):
+    """Test that the rounded noise is non-zero with the PBS's error probability."""
+
+    standard_deviation = get_pbs_error_standard_deviation(p_error)
+    error = numpy.rint(numpy.random.normal(0, standard_deviation, size=1_000_000))
+
+    assert numpy.isclose(numpy.mean(error != 0), p_error, rtol=0.05)
@@ -12,6 +12,7 @@ from concrete.ml.common.utils import (
     check_compilation_device_is_valid_and_is_cuda,
     check_execution_device_is_valid_and_is_cuda,
     compute_bits_precision,
+    reduce_block_outputs,
 )
 from concrete.ml.pytest.torch_models import QuantCustomModel
 from concrete.ml.pytest.utils import data_calibration_processing
@@ -107,3 +108,32 @@ def test_cuda_compilation_warnings(get_device_for_compilation):
 
     with pytest.raises(ValueError, match=".*no compatible CUDA.*"):
         check_execution_device_is_valid_and_is_cuda(True, "execute")
+
+
+@pytest.mark.parametrize("n_blocks", [2, 3, 5, 8])
+def test_reduce_block_outputs(n_blocks):
+    """Test that block outputs are merged two by two into a single output."""
+
+    merged_pairs = []
+
+    def merge(low_a, high_a, low_b, high_b):
+        """Merge two ranges, recording them."""
+        merged_pairs.append(((low_a, high_a), (low_b, high_b)))
+        return min(low_a, low_b), max(high_a, high_b)
+
+    def merge_final(low_a, high_a, low_b, high_b):
+        """Merge the two last ranges."""
+        return min(low_a, low_b), max(high_a, high_b)
+
+    block_outputs = [(i, i) for i in range(n_blocks)]
+
+    assert reduce_block_outputs(block_outputs, merge, merge_final) == (0, n_blocks - 1)
+
+    # The last merge is done by 'merge_final', all the others by 'merge'
+    assert len(merged_pairs) == n_blocks - 2
+
+    # Only neighboring blocks are merged, following a balanced tree
+    assert all(high_a + 1 == low_b for (_, high_a), (low_b, _) in merged_pairs)
+
+    # Two blocks do not need any merge function
+    assert reduce_block_outputs(block_outputs[:2], None, merge_final) == (0, 1)
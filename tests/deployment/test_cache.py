@@ -0,0 +1,112 @@
+"""Tests the caches used for deployment."""
+
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import pytest
+
+from concrete.ml.deployment.cache import LRUCache
+
+
+def test_lru_cache_memory_budget():
+    """Test that least recently used entries are evicted once the budget is exceeded."""
+
+    cache = LRUCache(max_size=10)
+
+    cache.put("a", "value_a", size=4)
+    cache.put("b", "value_b", size=4)
+
+    # Access "a" so that "b" becomes the least recently used entry
+    assert cache.get("a") == "value_a"
+
+    cache.put("c", "value_c", size=4)
+
+    assert "a" in cache
+    assert "b" not in cache
+    assert "c" in cache
+    assert cache.current_size == 8
+
+    # Entries larger than the whole budget are never cached
+    cache.put("d", "value_d", size=11)
+    assert "d" not in cache
+    assert len(cache) == 2
+
+    assert cache.get("b") is None
+
+    assert cache.metrics == {"hits": 1, "misses": 1, "evictions": 1, "n_entries": 2, "size": 8}
+
+
+def test_lru_cache_max_entries():
+    """Test that the number of entries is bounded."""
+
+    cache = LRUCache(max_entries=2)
+
+    for i in range(5):
+        cache.put(i, str(i))
+
+    assert len(cache) == 2
+    assert 3 in cache and 4 in cache
+    assert cache.metrics["evictions"] == 3
+
+    replaced = cache.pop(3)
+    assert replaced == "3"
+    assert 3 not in cache
+
+    cache.clear()
+    assert len(cache) == 0
+    assert cache.current_size == 0
+
+
+def test_lru_cache_get_or_load():
+    """Test that values are only loaded once, including when accessed from several threads."""
+
+    cache = LRUCache(max_size=100)
+    n_loads = []
+
+    def loader():
+        n_loads.append(1)
+
+        # Make sure the other threads ask for the entry while it is being loaded
+        time.sleep(0.05)
+        return "value", 10
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        values = list(pool.map(lambda _: cache.get_or_load("key", loader), range(20)))
+
+    assert all(value == "value" for value in values)
+    assert len(n_loads) == 1
+    assert cache.current_size == 10
+
+    # Once cached, the loader is not called anymore
+    n_loads_before = len(n_loads)
+    assert cache.get_or_load("key", loader) == "value"
+    assert len(n_loads) == n_loads_before
+
+
+def test_lru_cache_get_or_load_error():
+    """Test that failed loads are not cached and can be retried."""
+
+    cache = LRUCache()
+
+    def failing_loader():
+        raise RuntimeError("Loading failed")
+
+    with pytest.raises(RuntimeError, match="Loading failed"):
+        cache.get_or_load("key", failing_loader)
+
+    assert "key" not in cache
+    assert cache.get_or_load("key", lambda: ("value", 1)) == "value"
+
+
+@pytest.mark.parametrize(
+    "parameters, error_message",
+    [
+        ({"max_size": -1}, "Parameter 'max_size' must be None or a positive integer"),
+        ({"max_entries": -1}, "Parameter 'max_entries' must be None or a positive integer"),
+    ],
+)
+def test_lru_cache_errors(parameters, error_message):
+    """Test that invalid parameters raise an error."""
+
+    with pytest.raises(ValueError, match=error_message):
+        LRUCache(**parameters)
@@ -13,6 +13,7 @@ import pytest
 from torch import nn
 
 from concrete import fhe
+from concrete.ml.common.batch_executor import DeviceBatchExecutor
 from concrete.ml.deployment.fhe_client_server import (
     DeploymentMode,
     FHEModelClient,
@@ -22,6 +23,7 @@ from concrete.ml.deployment.fhe_client_server import (
 from concrete.ml.pytest.torch_models import FCSmall
 from concrete.ml.pytest.utils import MODELS_AND_DATASETS, get_model_name, instantiate_model_generic
 from concrete.ml.quantization.quantized_module import QuantizedModule
+from concrete.ml.sklearn import KNeighborsClassifier
 from concrete.ml.sklearn.linear_model import SGDClassifier
 from concrete.ml.torch.compile import compile_torch_model
 
@@ -194,6 +196,132 @@ def test_client_server_custom_model(
     )
 
 
+@pytest.mark.parametrize("block_size", [5, 3])
+def test_client_server_knn_blocks(block_size, load_data, default_configuration, check_array_equal):
+    """Test the client-server interface for a KNN model compiled by blocks."""
+
+    x, y = load_data(
+        KNeighborsClassifier,
+        n_samples=13,
+        n_features=2,
+        n_classes=2,
+        n_informative=2,
+        n_redundant=0,
+    )
+    x_train, y_train, x_test = x[:-1], y[:-1], x[-1:]
+
+    model = KNeighborsClassifier(n_bits=2, n_neighbors=3, block_size=block_size)
+    model.fit(x_train, y_train)
+    model.compile(x_train, configuration=default_configuration)
+
+    disk_network = OnDiskNetwork()
+
+    FHEModelDev(path_dir=disk_network.dev_dir.name, model=model).save()
+    disk_network.dev_send_clientspecs_and_modelspecs_to_client()
+    disk_network.dev_send_model_to_server()
+
+    fhe_model_client = FHEModelClient(
+        path_dir=disk_network.client_dir.name,
+        key_dir=default_configuration.insecure_key_cache_location,
+    )
+    fhe_model_server = FHEModelServer(path_dir=disk_network.server_dir.name)
+
+    # The module's functions are stored in the wire format
+    assert fhe_model_client.functions == model.fhe_module_functions_
+    assert fhe_model_server.functions == model.fhe_module_functions_
+
+    evaluation_keys = fhe_model_client.get_serialized_evaluation_keys()
+
+    # The client encrypts the query once for all blocks
+    q_x_encrypted_serialized = fhe_model_client.quantize_encrypt_serialize(x_test)
+    assert isinstance(q_x_encrypted_serialized, bytes)
+
+    # The server chains the blocks and merges on the ciphertexts and only returns the k nearest
+    # labels
+    q_y_pred_encrypted_serialized = fhe_model_server.run(q_x_encrypted_serialized, evaluation_keys)
+    q_y_pred = fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized)
+
+    check_array_equal(q_y_pred, model.get_topk_labels(x_test, fhe="disable"))
+
+    # Giving one encrypted input for each block is not allowed
+    with pytest.raises(ValueError, match="Expected a single encrypted input, given to all the"):
+        fhe_model_server.run((q_x_encrypted_serialized,) * 2, evaluation_keys)
+
+
+def test_run_batch_overflow_server(default_configuration, check_array_equal):
+    """Test running a batch on a server whose CPU overflow is taken by another server."""
+
+    x_train, x_test = numpy.random.rand(100, 2), numpy.random.rand(1, 2)
+
+    def save_model(n_bits: int) -> OnDiskNetwork:
+        """Compile a small model and send its files to the client and the server.
+
+        Args:
+            n_bits (int): the number of bits used for quantizing the model
+
+        Returns:
+            OnDiskNetwork: the network holding the model's files
+        """
+        quantized_module = compile_torch_model(
+            FCSmall(2, nn.ReLU), x_train, configuration=default_configuration, n_bits=n_bits
+        )
+
+        disk_network = OnDiskNetwork()
+        FHEModelDev(path_dir=disk_network.dev_dir.name, model=quantized_module).save()
+        disk_network.dev_send_clientspecs_and_modelspecs_to_client()
+        disk_network.dev_send_model_to_server()
+        return disk_network
+
+    disk_network = save_model(n_bits=2)
+
+    fhe_model_client = FHEModelClient(
+        path_dir=disk_network.client_dir.name,
+        key_dir=default_configuration.insecure_key_cache_location,
+    )
+    evaluation_keys = fhe_model_client.get_serialized_evaluation_keys()
+    q_x_encrypted_serialized = fhe_model_client.quantize_encrypt_serialize(x_test)
+
+    # Both servers load the same model, the first one being used as the GPU device
+    fhe_model_server = FHEModelServer(path_dir=disk_network.server_dir.name)
+    overflow_server = FHEModelServer(path_dir=disk_network.server_dir.name)
+
+    q_y_pred = fhe_model_client.deserialize_decrypt(
+        fhe_model_server.run(q_x_encrypted_serialized, evaluation_keys)
+    )
+
+    n_inputs = 6
+    executor = DeviceBatchExecutor(n_jobs_per_device={"cuda": 1, "cpu": 1})
+    q_y_pred_batch = list(
+        fhe_model_server.run_batch(
+            [q_x_encrypted_serialized] * n_inputs,
+            evaluation_keys,
+            fhe_executor=executor,
+            overflow_server=overflow_server,
+        )
+    )
+
+    assert len(q_y_pred_batch) == n_inputs
+    for q_y_pred_encrypted_serialized in q_y_pred_batch:
+        check_array_equal(
+            fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized), q_y_pred
+        )
+
+    utilization = executor.get_utilization()
+    assert utilization["cuda"]["n_samples"] + utilization["cpu"]["n_samples"] == n_inputs
+
+    # A server loading a model with other cryptographic parameters can't take the overflow
+    other_server = FHEModelServer(path_dir=save_model(n_bits=3).server_dir.name)
+    with pytest.raises(ValueError, match="The overflow server must load the same model"):
+        list(
+            fhe_model_server.run_batch(
+                [q_x_encrypted_serialized],
+                evaluation_keys,
+                fhe_executor=executor,
+                overflow_server=other_server,
+            )
+        )
+
+
 def check_client_server_files(model, mode="inference"):
     """Test the client server interface API generates the expected file.
 
@@ -249,6 +377,47 @@ def check_client_server_files(model, mode="inference"):
                 json.load(file), dict
             ), f"{server_zip_path} does not contain a '{versions_file_name}' file."
 
+    # Check that the client and server agree on the compression of the data they exchange
+    if mode == "training":
+        fhe_circuit = model.training_quantized_module.fhe_circuit
+    else:
+        fhe_circuit = model.fhe_circuit
+
+    client_wire_format = FHEModelClient(path_dir=disk_network.dev_dir.name).wire_format
+    server_wire_format = FHEModelServer(path_dir=disk_network.dev_dir.name).wire_format
+
+    assert client_wire_format == server_wire_format
+    assert client_wire_format["inputs"] == {
+        "compressed": os.environ.get("USE_INPUT_COMPRESSION") == "1",
+        "expected_size": fhe_circuit.size_of_inputs,
+    }
+    assert client_wire_format["evaluation_keys"]["compressed"] == (
+        os.environ.get("USE_KEY_COMPRESSION") == "1"
+    )
+
+    # Save the model using the binary serialization format
+    binary_disk_network = OnDiskNetwork()
+    fhe_model_dev = FHEModelDev(path_dir=binary_disk_network.dev_dir.name, model=model)
+    fhe_model_dev.save(mode=mode, binary_serialization=True)
+
+    binary_client_zip_path = Path(binary_disk_network.dev_dir.name) / "client.zip"
+
+    # Check that the client.zip file has the processing binary file instead of the json one
+    with zipfile.ZipFile(binary_client_zip_path) as client_zip:
+        assert "serialized_processing.bin" in client_zip.namelist()
+        assert processing_file_name not in client_zip.namelist()
+
+    # Check that the client loads the same quantizers from both formats
+    binary_fhe_model_client = FHEModelClient(path_dir=binary_disk_network.dev_dir.name)
+    fhe_model_client = FHEModelClient(path_dir=disk_network.dev_dir.name)
+
+    assert binary_fhe_model_client.model.input_quantizers == (
+        fhe_model_client.model.input_quantizers
+    )
+    assert binary_fhe_model_client.model.output_quantizers == (
+        fhe_model_client.model.output_quantizers
+    )
+
 
 def check_client_server_inference(
     x_test, model, key_dir, check_array_equal, check_float_array_equal
@@ -290,6 +459,23 @@ def check_client_server_inference(
     # Server side: Run the model over encrypted data
     q_y_pred_encrypted_serialized = fhe_model_server.run(q_x_encrypted_serialized, evaluation_keys)
 
+    # Client side : Check the sizes of the data sent to the server
+    compression_report = fhe_model_client.get_compression_report()
+    assert compression_report["inputs"]["sent_size"] == len(q_x_encrypted_serialized)
+    assert compression_report["evaluation_keys"]["sent_size"] == len(evaluation_keys)
+
+    sent_data = {"inputs": q_x_encrypted_serialized, "evaluation_keys": evaluation_keys}
+    for name, data in sent_data.items():
+        uncompressed_size = compression_report[name]["uncompressed_size"]
+        assert uncompressed_size == fhe_model_client.wire_format[name]["expected_size"]
+        assert compression_report[name]["compression_ratio"] == pytest.approx(
+            uncompressed_size / len(data)
+        )
+
+    # Compressed data is smaller than its uncompressed counterpart
+    if compression_report["inputs"]["compressed"]:
+        assert compression_report["inputs"]["compression_ratio"] > 1
+
     # Client side : Decrypt, de-quantize and post-process the result
     q_y_pred = fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized)
     y_pred = fhe_model_client.deserialize_decrypt_dequantize(q_y_pred_encrypted_serialized)
@@ -305,6 +491,68 @@ def check_client_server_inference(
     check_float_array_equal(y_pred, y_pred_dev)
     check_array_equal(q_y_pred, q_y_pred_dev)
 
+    # Server side: Register the evaluation keys once and run the model using their handle
+    evaluation_keys_handle = fhe_model_server.register_evaluation_keys(evaluation_keys)
+    q_y_pred_encrypted_serialized = fhe_model_server.run(
+        q_x_encrypted_serialized, evaluation_keys_handle=evaluation_keys_handle
+    )
+    check_array_equal(fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized), q_y_pred)
+
+    # Server side: Run the model over several inputs, streaming the results
+    n_inputs = 3
+    q_y_pred_batch = list(
+        fhe_model_server.run_batch(
+            [q_x_encrypted_serialized] * n_inputs, evaluation_keys_handle=evaluation_keys_handle
+        )
+    )
+    assert len(q_y_pred_batch) == n_inputs
+    for q_y_pred_encrypted_serialized in q_y_pred_batch:
+        check_array_equal(
+            fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized), q_y_pred
+        )
+
+    # Server side: Run the inputs on the workers of each device, the only device being the CPU
+    executor = DeviceBatchExecutor(n_jobs_per_device={"cpu": 2})
+    q_y_pred_batch = list(
+        fhe_model_server.run_batch(
+            [q_x_encrypted_serialized] * n_inputs,
+            evaluation_keys_handle=evaluation_keys_handle,
+            fhe_executor=executor,
+        )
+    )
+    for q_y_pred_encrypted_serialized in q_y_pred_batch:
+        check_array_equal(
+            fhe_model_client.deserialize_decrypt(q_y_pred_encrypted_serialized), q_y_pred
+        )
+    assert executor.get_utilization()["cpu"]["n_samples"] == n_inputs
+
+    # CPU overflow is only possible on top of GPU workers
+    with pytest.raises(ValueError, match="An overflow server needs a DeviceBatchExecutor"):
+        list(
+            fhe_model_server.run_batch(
+                [q_x_encrypted_serialized],
+                evaluation_keys_handle=evaluation_keys_handle,
+                fhe_executor=executor,
+                overflow_server=fhe_model_server,
+            )
+        )
+
+    # Giving both or none of the evaluation keys and handle is not allowed
+    with pytest.raises(ValueError, match="Exactly one of 'serialized_evaluation_keys' or"):
+        fhe_model_server.run(
+            q_x_encrypted_serialized, evaluation_keys, evaluation_keys_handle=evaluation_keys_handle
+        )
+
+    with pytest.raises(ValueError, match="Exactly one of 'serialized_evaluation_keys' or"):
+        fhe_model_server.run(q_x_encrypted_serialized)
+
+    # Unregistered keys cannot be used anymore
+    fhe_model_server.unregister_evaluation_keys(evaluation_keys_handle)
+    with pytest.raises(KeyError, match="No evaluation keys are registered with handle"):
+        fhe_model_server.run(
+            q_x_encrypted_serialized, evaluation_keys_handle=evaluation_keys_handle
+        )
+
 
 def check_input_compression(model, fhe_circuit_compressed, is_torch, **compilation_kwargs):
     """Check that input compression properly reduces input sizes."""
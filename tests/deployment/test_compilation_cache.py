@@ -0,0 +1,159 @@
+"""Tests the on-disk compilation cache."""
+
+import zipfile
+
+import numpy
+import pytest
+import torch
+from torch import nn
+
+from concrete.ml.common.cached_circuit import CachedCircuit
+from concrete.ml.deployment import CompilationCache, FHEModelClient, FHEModelDev, FHEModelServer
+from concrete.ml.pytest.torch_models import FCSmall
+from concrete.ml.sklearn import LogisticRegression
+from concrete.ml.torch.compile import compile_torch_model
+from concrete.ml.torch.hybrid_model import HybridFHEModel
+
+
+def test_compilation_cache(load_data, tmp_path):
+    """Test that cached artifacts are re-used and can be deployed."""
+
+    x, y = load_data(LogisticRegression, n_samples=100, n_features=4)
+
+    model = LogisticRegression(n_bits=4)
+    model.fit(x, y)
+
+    cache = CompilationCache(tmp_path / "cache")
+
+    # The first call compiles the model
+    assert not cache.compile_and_save(model, x, str(tmp_path / "dev_1"), p_error=0.01)
+    assert model.is_compiled
+
+    # Reporting parameters do not change the key
+    key = cache.get_key(model, x, p_error=0.01)
+    assert key == cache.get_key(model, x, p_error=0.01, verbose=True, show_mlir=False)
+    assert cache.get(key) is not None
+
+    # A new model with the same quantized graph, inputs and parameters is not compiled again
+    same_model = LogisticRegression(n_bits=4)
+    same_model.fit(x, y)
+
+    assert cache.compile_and_save(same_model, x, str(tmp_path / "dev_2"), p_error=0.01)
+    assert not same_model.is_compiled
+    assert cache.metrics == {"hits": 1, "misses": 1}
+
+    # Changing the compilation parameters or the input-set changes the key
+    assert key != cache.get_key(model, x, p_error=0.001)
+    assert key != cache.get_key(model, x[:10], p_error=0.01)
+
+    # The cached artifacts can be used by the client and the server
+    client = FHEModelClient(path_dir=str(tmp_path / "dev_2"), key_dir=str(tmp_path / "keys"))
+    server = FHEModelServer(path_dir=str(tmp_path / "dev_2"))
+
+    encrypted_input = client.quantize_encrypt_serialize(x[:1])
+    encrypted_output = server.run(encrypted_input, client.get_serialized_evaluation_keys())
+    y_pred = client.deserialize_decrypt_dequantize(encrypted_output)
+
+    assert numpy.array_equal(numpy.argmax(y_pred, axis=1), model.predict(x[:1]))
+
+    with pytest.raises(Exception, match="is not empty"):
+        cache.compile_and_save(same_model, x, str(tmp_path / "dev_2"), p_error=0.01)
+
+    cache.clear()
+    assert cache.get(key) is None
+
+
+def test_compile_with_compilation_cache(load_data, tmp_path):
+    """Test that models compiled with a cache hit load their circuit and can run in FHE."""
+
+    x, y = load_data(LogisticRegression, n_samples=100, n_features=4)
+
+    cache = CompilationCache(tmp_path / "cache")
+
+    model = LogisticRegression(n_bits=4)
+    model.fit(x, y)
+    model.compile(x, p_error=0.01, compilation_cache=cache)
+
+    assert not isinstance(model.fhe_circuit, CachedCircuit)
+    assert cache.metrics == {"hits": 0, "misses": 1}
+
+    # Models compiled with a cache share their entries with `compile_and_save`
+    assert cache.get(cache.get_key(model, x, p_error=0.01)) is not None
+
+    same_model = LogisticRegression(n_bits=4)
+    same_model.fit(x, y)
+    same_model.compile(x, p_error=0.01, compilation_cache=cache)
+
+    assert cache.metrics == {"hits": 1, "misses": 1}
+    assert same_model.is_compiled
+    assert isinstance(same_model.fhe_circuit, CachedCircuit)
+
+    # The loaded circuit executes and simulates as the compiled one
+    assert numpy.array_equal(
+        same_model.predict(x[:2], fhe="execute"), model.predict(x[:2], fhe="execute")
+    )
+    assert numpy.array_equal(
+        same_model.predict(x[:2], fhe="simulate"), model.predict(x[:2], fhe="simulate")
+    )
+
+    # The loaded circuit can be deployed with the default saving parameters, its compiled
+    # artifacts being copied
+    FHEModelDev(path_dir=str(tmp_path / "dev"), model=same_model).save()
+
+    with zipfile.ZipFile(tmp_path / "dev" / "server.zip") as server_file:
+        assert server_file.namelist().count("versions.json") == 1
+
+    client = FHEModelClient(path_dir=str(tmp_path / "dev"), key_dir=str(tmp_path / "keys"))
+    server = FHEModelServer(path_dir=str(tmp_path / "dev"))
+
+    encrypted_input = client.quantize_encrypt_serialize(x[:1])
+    encrypted_output = server.run(encrypted_input, client.get_serialized_evaluation_keys())
+    y_pred = client.deserialize_decrypt_dequantize(encrypted_output)
+
+    assert numpy.array_equal(numpy.argmax(y_pred, axis=1), model.predict(x[:1]))
+
+
+def test_compile_torch_model_with_compilation_cache(tmp_path):
+    """Test that quantized modules compiled with a cache hit load their circuit."""
+
+    # Use a simple torch model
+    torch_model = nn.Sequential(nn.Linear(4, 3), nn.ReLU(), nn.Linear(3, 2))
+    inputset = numpy.random.uniform(-1, 1, size=(50, 4))
+
+    cache = CompilationCache(tmp_path / "cache")
+
+    quantized_module = compile_torch_model(torch_model, inputset, n_bits=3, compilation_cache=cache)
+    cached_module = compile_torch_model(torch_model, inputset, n_bits=3, compilation_cache=cache)
+
+    assert cache.metrics == {"hits": 1, "misses": 1}
+    assert cached_module.is_compiled
+    assert isinstance(cached_module.fhe_circuit, CachedCircuit)
+
+    assert numpy.array_equal(
+        cached_module.forward(inputset[:2], fhe="execute"),
+        quantized_module.forward(inputset[:2], fhe="execute"),
+    )
+
+
+def test_hybrid_model_with_compilation_cache(tmp_path):
+    """Test that hybrid models compiled with a cache hit can be saved with default parameters."""
+
+    n_features = 8
+    model = FCSmall(n_features, nn.ReLU)
+    inputs = torch.randn((10, n_features))
+
+    cache = CompilationCache(tmp_path / "cache")
+
+    HybridFHEModel(model, module_names="fc1").compile_model(x=inputs, compilation_cache=cache)
+
+    hybrid_model = HybridFHEModel(model, module_names="fc1")
+    hybrid_model.compile_model(x=inputs, compilation_cache=cache)
+
+    assert cache.metrics == {"hits": 1, "misses": 1}
+    assert isinstance(hybrid_model.private_q_modules["fc1"].fhe_circuit, CachedCircuit)
+
+    hybrid_model.save_and_clear_private_info(tmp_path / "hybrid")
+
+    (module_path,) = (tmp_path / "hybrid" / "fc1").iterdir()
+    server = FHEModelServer(path_dir=str(module_path))
+    assert server.server is not None
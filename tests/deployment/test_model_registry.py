@@ -0,0 +1,148 @@
+"""Tests the registry of loaded model servers."""
+
+import os
+import threading
+import time
+
+import numpy
+import pytest
+
+from concrete.ml.deployment import FHEModelClient, FHEModelDev, ModelRegistry
+from concrete.ml.deployment import model_registry as model_registry_module
+from concrete.ml.sklearn import LogisticRegression
+
+
+class _CountingServer:
+    """Stand-in for FHEModelServer counting how many times each model is loaded."""
+
+    n_loads: dict = {}
+    lock = threading.Lock()
+
+    def __init__(self, path_dir):
+        with self.lock:
+            self.n_loads[path_dir] = self.n_loads.get(path_dir, 0) + 1
+
+        with open(os.path.join(path_dir, "server.zip"), "rb") as file:
+            self.content = file.read()
+
+
+def _write_artifact(path_dir, content):
+    """Write a fake server.zip file with a new modification time."""
+    path_dir.mkdir(parents=True, exist_ok=True)
+    server_zip_path = path_dir / "server.zip"
+    server_zip_path.write_bytes(content)
+
+    # Make sure the modification time changes even on file systems with a coarse resolution
+    stat = server_zip_path.stat()
+    os.utime(server_zip_path, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000_000))
+
+
+def test_model_registry_sharing_and_reloading(tmp_path, monkeypatch):
+    """Test that models are loaded once, shared, and reloaded when their artifacts change."""
+
+    monkeypatch.setattr(model_registry_module, "FHEModelServer", _CountingServer)
+    _CountingServer.n_loads = {}
+
+    for name in ["model_a", "model_b/module/(1, 4)"]:
+        _write_artifact(tmp_path / name, b"v1")
+
+    with ModelRegistry(n_workers=4) as registry:
+        assert registry.register_directory(tmp_path) == ["model_a", "model_b/module/(1, 4)"]
+
+        # Registering the same directory again is allowed, but not a different one
+        registry.register("model_a", tmp_path / "model_a")
+        with pytest.raises(ValueError, match="is already registered with directory"):
+            registry.register("model_a", tmp_path / "model_b")
+
+        servers = registry.preload()
+        assert set(servers) == {"model_a", "model_b/module/(1, 4)"}
+
+        # Concurrent requests share the same loaded server
+        results = []
+        threads = [
+            threading.Thread(target=lambda: results.append(registry.get("model_a")))
+            for _ in range(8)
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        assert all(server is servers["model_a"] for server in results)
+        assert set(_CountingServer.n_loads.values()) == {1}
+
+        # Unchanged artifacts are not reloaded
+        assert not registry.refresh()
+
+        # Changed artifacts are reloaded, the previous server being used until then
+        _write_artifact(tmp_path / "model_a", b"v2")
+        futures = registry.refresh()
+
+        assert list(futures) == ["model_a"]
+        assert futures["model_a"].result().content == b"v2"
+        assert registry.get("model_a").content == b"v2"
+        assert registry.get("model_b/module/(1, 4)") is servers["model_b/module/(1, 4)"]
+
+        with pytest.raises(KeyError, match="No model named 'unknown' is registered"):
+            registry.get("unknown")
+
+
+def test_model_registry_background_reload(tmp_path, monkeypatch):
+    """Test that changed artifacts are reloaded periodically in the background."""
+
+    monkeypatch.setattr(model_registry_module, "FHEModelServer", _CountingServer)
+
+    _write_artifact(tmp_path / "model", b"v1")
+
+    with ModelRegistry(reload_interval=0.01) as registry:
+        registry.register("model", tmp_path / "model")
+        assert registry.get("model").content == b"v1"
+
+        _write_artifact(tmp_path / "model", b"v2")
+
+        for _ in range(1000):
+            if registry.get("model").content == b"v2":
+                break
+            time.sleep(0.01)
+
+        assert registry.get("model").content == b"v2"
+
+
+@pytest.mark.parametrize(
+    "parameters, error_message",
+    [
+        pytest.param({"n_workers": 0}, "Parameter 'n_workers' must be None or a strictly"),
+        pytest.param({"reload_interval": 0}, "Parameter 'reload_interval' must be None or a"),
+    ],
+)
+def test_model_registry_invalid_parameters(parameters, error_message):
+    """Test that invalid parameters raise an error."""
+    with pytest.raises(ValueError, match=error_message):
+        ModelRegistry(**parameters)
+
+
+def test_model_registry_inference(load_data, tmp_path):
+    """Test that preloaded servers run encrypted inferences."""
+
+    x, y = load_data(LogisticRegression, n_samples=100, n_features=4)
+
+    model = LogisticRegression(n_bits=4)
+    model.fit(x, y)
+    model.compile(x)
+
+    FHEModelDev(str(tmp_path / "models" / "logistic_regression"), model).save()
+
+    with ModelRegistry() as registry:
+        registry.register_directory(tmp_path / "models")
+        server = registry.preload()["logistic_regression"]
+
+        client = FHEModelClient(
+            path_dir=str(tmp_path / "models" / "logistic_regression"),
+            key_dir=str(tmp_path / "keys"),
+        )
+
+        encrypted_input = client.quantize_encrypt_serialize(x[:1])
+        encrypted_output = server.run(encrypted_input, client.get_serialized_evaluation_keys())
+        y_pred = client.deserialize_decrypt_dequantize(encrypted_output)
+
+        assert numpy.array_equal(numpy.argmax(y_pred, axis=1), model.predict(x[:1]))
@@ -0,0 +1,70 @@
+"""Tests the pipelines chaining several models in a single FHE circuit."""
+
+import numpy
+import pytest
+from torch import nn
+
+from concrete.ml.deployment import FHEModelClient, FHEModelDev, FHEModelServer
+from concrete.ml.pytest.torch_models import FCSmall
+from concrete.ml.quantization import QuantizedPipeline
+from concrete.ml.sklearn import DecisionTreeClassifier, LogisticRegression
+from concrete.ml.torch.compile import build_quantized_module
+
+
+def _build_feature_extractor(x):
+    """Build a small quantized network extracting features from the inputs."""
+    return build_quantized_module(FCSmall(x.shape[1], nn.ReLU), torch_inputset=x, n_bits=3)
+
+
+@pytest.mark.parametrize("model_class", [DecisionTreeClassifier, LogisticRegression])
+def test_pipeline_client_server(
+    model_class, load_data, default_configuration, check_float_array_equal, tmp_path
+):
+    """Test that a deployed pipeline matches the stages executed one after the other."""
+
+    x, y = load_data(model_class, n_samples=100, n_features=4)
+
+    feature_extractor = _build_feature_extractor(x)
+    model = model_class(n_bits=3)
+    model.fit(feature_extractor.forward(x), y)
+
+    pipeline = QuantizedPipeline([feature_extractor, model])
+    pipeline.compile(x, configuration=default_configuration)
+
+    # Chaining the stages in the clear matches executing them one after the other, the
+    # intermediate values being re-quantized the same way
+    y_proba = pipeline.predict(x)
+    check_float_array_equal(y_proba, model.predict_proba(feature_extractor.forward(x)))
+
+    # The pipeline is deployed as a single model, without any round trip between the stages
+    FHEModelDev(str(tmp_path / "pipeline"), pipeline).save()
+
+    client = FHEModelClient(str(tmp_path / "pipeline"), key_dir=str(tmp_path / "keys"))
+    server = FHEModelServer(str(tmp_path / "pipeline"))
+
+    encrypted_input = client.quantize_encrypt_serialize(x[:1])
+    encrypted_output = server.run(encrypted_input, client.get_serialized_evaluation_keys())
+    y_proba_fhe = client.deserialize_decrypt_dequantize(encrypted_output)
+
+    check_float_array_equal(y_proba_fhe, y_proba[:1])
+
+
+def test_pipeline_invalid_stages(load_data):
+    """Test that stages that cannot be chained raise an error."""
+
+    x, y = load_data(DecisionTreeClassifier, n_samples=100, n_features=4)
+
+    tree = DecisionTreeClassifier(n_bits=3)
+    tree.fit(x, y)
+
+    with pytest.raises(ValueError, match="A pipeline needs at least one stage"):
+        QuantizedPipeline([])
+
+    with pytest.raises(ValueError, match="is not fitted"):
+        QuantizedPipeline([_build_feature_extractor(x), DecisionTreeClassifier()])
+
+    with pytest.raises(ValueError, match="only the last stage of a pipeline can be another model"):
+        QuantizedPipeline([tree, _build_feature_extractor(x)])
+
+    with pytest.raises(AttributeError, match="The pipeline is not compiled"):
+        QuantizedPipeline([_build_feature_extractor(x), tree]).predict(x, fhe="simulate")
@@ -0,0 +1,179 @@
+"""Tests for the scheduling of FHE requests."""
+
+import threading
+import time
+
+import pytest
+
+from concrete.ml.deployment.scheduler import (
+    DeadlineExceededError,
+    RequestScheduler,
+    SchedulerOverloadedError,
+)
+
+
+def _wait_for(condition, timeout=10):
+    """Wait until the given condition is met."""
+    start = time.time()
+    while not condition():
+        assert time.time() - start < timeout, "Condition not met before the timeout"
+        time.sleep(0.001)
+
+
+def test_scheduler_results():
+    """Test that the scheduler returns the functions' results and errors."""
+
+    def divide(numerator, denominator=1):
+        return numerator / denominator
+
+    with RequestScheduler(n_workers={"cpu": 3}) as scheduler:
+        futures = [scheduler.submit("model", divide, i, denominator=2) for i in range(20)]
+        assert [future.result() for future in futures] == [i / 2 for i in range(20)]
+
+        with pytest.raises(ZeroDivisionError):
+            scheduler.submit("model", divide, 1, denominator=0).result()
+
+
+def test_scheduler_deadline_ordering():
+    """Test that queued requests are started by earliest deadline first."""
+
+    started = []
+    release = threading.Event()
+
+    with RequestScheduler(n_workers={"cpu": 1}) as scheduler:
+        # Block the only worker while the other requests are queued
+        blocking_future = scheduler.submit("model", release.wait)
+        _wait_for(lambda: scheduler.n_pending == 0)
+
+        futures = [
+            scheduler.submit("model", started.append, "no_deadline"),
+            scheduler.submit("model", started.append, "late", deadline=60),
+            scheduler.submit("model", started.append, "early", deadline=30),
+        ]
+
+        release.set()
+        blocking_future.result()
+        for future in futures:
+            future.result()
+
+    assert started == ["early", "late", "no_deadline"]
+
+
+def test_scheduler_model_concurrency():
+    """Test that a model does not run more requests than its concurrency limit."""
+
+    lock = threading.Lock()
+    n_running = {"slow": 0, "fast": 0}
+    max_running = {"slow": 0, "fast": 0}
+
+    def run(model_name):
+        with lock:
+            n_running[model_name] += 1
+            max_running[model_name] = max(max_running[model_name], n_running[model_name])
+        time.sleep(0.01)
+        with lock:
+            n_running[model_name] -= 1
+
+    with RequestScheduler(n_workers={"cpu": 4}, max_concurrency_per_model=3) as scheduler:
+        scheduler.set_model_concurrency("slow", 1)
+
+        futures = [
+            scheduler.submit(model_name, run, model_name)
+            for _ in range(10)
+            for model_name in ["slow", "fast"]
+        ]
+        for future in futures:
+            future.result()
+
+    assert max_running["slow"] == 1
+    assert 1 <= max_running["fast"] <= 3
+
+
+def test_scheduler_backpressure_and_deadlines():
+    """Test that full queues reject requests and that expired requests are not executed."""
+
+    release = threading.Event()
+    executed = []
+
+    scheduler = RequestScheduler(n_workers={"cpu": 1}, max_queue_size=2)
+
+    blocking_future = scheduler.submit("model", release.wait)
+    _wait_for(lambda: scheduler.n_pending == 0)
+
+    expired_future = scheduler.submit("model", executed.append, "expired", deadline=0)
+    queued_future = scheduler.submit("model", executed.append, "queued")
+
+    with pytest.raises(SchedulerOverloadedError, match="The scheduler's queue is full"):
+        scheduler.submit("model", executed.append, "rejected")
+
+    # Make sure the deadline has passed before the worker is released
+    time.sleep(0.05)
+    release.set()
+    blocking_future.result()
+    queued_future.result()
+
+    with pytest.raises(DeadlineExceededError, match="could not be started before its deadline"):
+        expired_future.result()
+
+    assert executed == ["queued"]
+
+    # Requests that have not been started are cancelled on shutdown
+    release.clear()
+    blocking_future = scheduler.submit("model", release.wait)
+    _wait_for(lambda: scheduler.n_pending == 0)
+    pending_future = scheduler.submit("model", executed.append, "cancelled")
+
+    shutdown_thread = threading.Thread(target=scheduler.shutdown)
+    shutdown_thread.start()
+    _wait_for(pending_future.cancelled)
+    release.set()
+    shutdown_thread.join()
+
+    assert executed == ["queued"]
+
+    with pytest.raises(RuntimeError, match="has been shut down"):
+        scheduler.submit("model", executed.append, "after_shutdown")
+
+
+def test_scheduler_deadlines_expire_while_waiting():
+    """Test that waiting requests fail at their deadline without any other event."""
+
+    release = threading.Event()
+
+    with RequestScheduler(n_workers={"cpu": 2}, max_concurrency_per_model=1) as scheduler:
+        # The second worker is idle but cannot start the model's next request
+        blocking_future = scheduler.submit("model", release.wait)
+        _wait_for(lambda: scheduler.n_pending == 0)
+
+        expired_future = scheduler.submit("model", release.wait, deadline=0.05)
+
+        # The idle worker wakes up at the deadline, while the first request is still running
+        assert isinstance(expired_future.exception(timeout=5), DeadlineExceededError)
+        assert blocking_future.running()
+
+        release.set()
+        blocking_future.result()
+
+
+@pytest.mark.parametrize(
+    "parameters, error_message",
+    [
+        pytest.param({"n_workers": {}}, "Parameter 'n_workers' must map at least one device"),
+        pytest.param({"n_workers": {"cpu": 0}}, "Parameter 'n_workers' must map at least one"),
+        pytest.param({"max_queue_size": 0}, "Parameter 'max_queue_size' must be a strictly"),
+        pytest.param(
+            {"max_concurrency_per_model": 0}, "Parameter 'max_concurrency_per_model' must be None"
+        ),
+    ],
+)
+def test_scheduler_invalid_parameters(parameters, error_message):
+    """Test that invalid parameters raise an error."""
+    with pytest.raises(ValueError, match=error_message):
+        RequestScheduler(**parameters)
+
+
+def test_scheduler_unknown_device():
+    """Test that requests for devices without workers are rejected."""
+    with RequestScheduler(n_workers={"cpu": 1}) as scheduler:
+        with pytest.raises(ValueError, match="Device 'cuda' has no pool of workers"):
+            scheduler.submit("model", print, device="cuda")
@@ -0,0 +1,53 @@
+"""Tests for the clear evaluation of tree-based models by traversing their trees."""
+
+import pytest
+
+from concrete.ml.onnx.onnx_utils import execute_onnx_with_numpy_trees
+from concrete.ml.onnx.tree_traversal import TreeTraversalExecutor
+from concrete.ml.pytest.utils import get_sklearn_tree_models_and_datasets
+
+
+@pytest.mark.parametrize("model_class, parameters", get_sklearn_tree_models_and_datasets())
+@pytest.mark.parametrize("n_bits", [3, 6])
+@pytest.mark.parametrize("lsbs_to_remove_for_trees", [None, (0, 0), (4, 0)])
+def test_tree_traversal(
+    model_class, parameters, n_bits, lsbs_to_remove_for_trees, load_data, check_array_equal
+):
+    """Test that traversing the trees gives the same results as executing the ONNX graph."""
+
+    x, y = load_data(model_class, **parameters)
+
+    model = model_class(n_bits=n_bits)
+    model.fit(x, y)
+
+    graph = model.onnx_model_.graph
+    q_x = model.quantize_input(x)
+
+    tree_traversal = TreeTraversalExecutor.from_graph(graph, lsbs_to_remove_for_trees)
+    assert tree_traversal is not None, "Tree-based model's graph could not be traversed"
+
+    expected_outputs = execute_onnx_with_numpy_trees(graph, lsbs_to_remove_for_trees, q_x)
+    outputs = tree_traversal(q_x)
+
+    assert len(outputs) == len(expected_outputs)
+    for output, expected_output in zip(outputs, expected_outputs):
+        assert output.shape == expected_output.shape
+        check_array_equal(output, expected_output)
+
+    # The model's clear inference uses the traversal
+    # pylint: disable-next=protected-access
+    check_array_equal(model._inference(q_x), expected_outputs[0])
+
+
+@pytest.mark.parametrize(
+    "model_class, parameters", get_sklearn_tree_models_and_datasets(unique_models=True)
+)
+def test_tree_traversal_rounded_leaves(model_class, parameters, load_data):
+    """Test that graphs rounding the leaves' matching are not traversed."""
+
+    x, y = load_data(model_class, **parameters)
+
+    model = model_class(n_bits=6)
+    model.fit(x, y)
+
+    assert TreeTraversalExecutor.from_graph(model.onnx_model_.graph, (0, 2)) is None
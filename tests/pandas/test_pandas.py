@@ -1,11 +1,13 @@
 """Tests the encrypted data-frame API abd its coherence with Pandas"""
 
 import copy
+import json
 import re
 import shutil
 import tempfile
 from pathlib import Path
 from typing import List, Optional, Sequence, Tuple, Union
+from zipfile import ZIP_STORED, ZipFile
 
 import numpy
 import pandas
@@ -13,7 +15,7 @@ import pytest
 from concrete.fhe.compilation.specs import ClientSpecs
 
 import concrete.ml.pandas
-from concrete.ml.pandas import ClientEngine, load_encrypted_dataframe
+from concrete.ml.pandas import ClientEngine, EncryptedDataFrame, load_encrypted_dataframe
 from concrete.ml.pandas._development import CLIENT_PATH, get_min_max_allowed, save_client_server
 from concrete.ml.pytest.utils import pandas_dataframe_are_equal
 
@@ -224,6 +226,111 @@ def test_merge(as_method, how, selected_column):
     ), "Joined encrypted data-frame does not match Pandas' joined data-frame."
 
 
+@pytest.mark.parametrize("how", ["left", "right"])
+def test_merge_n_jobs(how):
+    """Test that running the encrypted merge on several workers does not change the result."""
+    with tempfile.TemporaryDirectory() as temp_dir:
+        keys_path = Path(temp_dir) / "keys"
+
+        client = ClientEngine(keys_path=keys_path)
+
+    pandas_df_left = generate_pandas_dataframe(feat_name="left", indexes=[1, 2, 3], n_features=2)
+    pandas_df_right = generate_pandas_dataframe(feat_name="right", indexes=[3, 1], n_features=2)
+
+    encrypted_df_left = client.encrypt_from_pandas(pandas_df_left)
+    encrypted_df_right = client.encrypt_from_pandas(pandas_df_right)
+
+    clear_df_joined_sequential = client.decrypt_to_pandas(
+        encrypted_df_left.merge(encrypted_df_right, how=how, n_jobs=None)
+    )
+    clear_df_joined_parallel = client.decrypt_to_pandas(
+        encrypted_df_left.merge(encrypted_df_right, how=how, n_jobs=3)
+    )
+
+    assert pandas_dataframe_are_equal(
+        clear_df_joined_sequential, clear_df_joined_parallel, equal_nan=True
+    ), "Joined encrypted data-frames computed sequentially and in parallel are not equal."
+
+
+@pytest.mark.parametrize("n_jobs", [None, 3])
+def test_encrypt_decrypt_parallel(n_jobs):
+    """Test that encrypting and decrypting on several workers reports progress and keeps order."""
+    client = ClientEngine()
+
+    pandas_df = generate_pandas_dataframe(n_features=3, indexes=list(range(1, 16)))
+    n_values = pandas_df.size
+
+    encrypt_progress: List[Tuple[int, int]] = []
+    decrypt_progress: List[Tuple[int, int]] = []
+
+    encrypted_df = client.encrypt_from_pandas(
+        pandas_df, n_jobs=n_jobs, progress_callback=lambda *args: encrypt_progress.append(args)
+    )
+    clear_df = client.decrypt_to_pandas(
+        encrypted_df, n_jobs=n_jobs, progress_callback=lambda *args: decrypt_progress.append(args)
+    )
+
+    assert pandas_dataframe_are_equal(
+        pandas_df, clear_df, float_atol=1, equal_nan=True
+    ), "Encrypted data-frame processed in parallel does not match Pandas' initial data-frame."
+
+    for progress in [encrypt_progress, decrypt_progress]:
+        assert progress, "Progress callback was never called."
+        assert progress[-1] == (n_values, n_values)
+        assert all(n_processed <= n_values for n_processed, _ in progress)
+
+    with pytest.raises(
+        ValueError, match="Parameter 'n_jobs' must be None, -1 or a strictly positive integer."
+    ):
+        client.encrypt_from_pandas(pandas_df, n_jobs=0)
+
+
+def test_encrypt_decrypt_streaming():
+    """Test encrypting and decrypting data-frames chunk by chunk, including on disk."""
+    client = ClientEngine()
+
+    pandas_df = generate_pandas_dataframe(dtype="float", n_features=2, indexes=list(range(1, 8)))
+    float_columns = list(pandas_df.columns[1:])
+
+    # Float columns require a schema so that all chunks are quantized the same way
+    schema = {
+        column_name: {"min": pandas_df[column_name].min(), "max": pandas_df[column_name].max()}
+        for column_name in float_columns
+    }
+
+    def iter_pandas_chunks(chunk_size):
+        for start in range(0, len(pandas_df), chunk_size):
+            yield pandas_df.iloc[start : start + chunk_size].reset_index(drop=True)
+
+    encrypted_df_chunks = list(client.encrypt_from_pandas_iter(iter_pandas_chunks(3), schema))
+    clear_df = pandas.concat(client.decrypt_to_pandas_iter(encrypted_df_chunks), ignore_index=True)
+
+    assert pandas_dataframe_are_equal(
+        pandas_df, clear_df, float_atol=1, equal_nan=True
+    ), "Data-frame encrypted chunk by chunk does not match Pandas' initial data-frame."
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        enc_df_path = Path(temp_dir) / "encrypted_dataframe.zip"
+
+        client.encrypt_to_file(iter_pandas_chunks(2), enc_df_path, schema=schema, chunk_size=3)
+
+        clear_df_from_file = client.decrypt_to_pandas(load_encrypted_dataframe(enc_df_path))
+
+        clear_df_chunks_from_file = pandas.concat(
+            client.decrypt_to_pandas_iter(EncryptedDataFrame.iter_load(enc_df_path)),
+            ignore_index=True,
+        )
+
+    for clear_df_loaded in [clear_df_from_file, clear_df_chunks_from_file]:
+        assert pandas_dataframe_are_equal(
+            pandas_df, clear_df_loaded, float_atol=1, equal_nan=True
+        ), "Data-frame encrypted chunk by chunk on disk does not match Pandas' initial data-frame."
+
+    # Without a schema, float columns are quantized differently for each chunk
+    with pytest.raises(ValueError, match="Dtype mappings of data-frame 1 do not match"):
+        list(client.encrypt_from_pandas_iter(iter_pandas_chunks(3)))
+
+
 @pytest.mark.parametrize("dtype", ["int", "float", "str", "mixed"])
 def test_pre_post_processing(dtype):
     """Test pre-processing and post-processing steps."""
@@ -269,7 +376,8 @@ def test_quantization_corner_cases(float_min_max):
     ), "Processed encrypted data-frame does not match Pandas' initial data-frame."
 
 
-def test_save_load():
+@pytest.mark.parametrize("chunk_size, compress", [(1024, False), (2, False), (3, True)])
+def test_save_load(chunk_size, compress):
     """Test saving and loading an encrypted data-frame."""
     client = ClientEngine()
 
@@ -280,7 +388,7 @@ def test_save_load():
     with tempfile.TemporaryDirectory() as temp_dir:
         enc_df_path = Path(temp_dir) / "encrypted_dataframe"
 
-        encrypted_df.save(enc_df_path)
+        encrypted_df.save(enc_df_path, chunk_size=chunk_size, compress=compress)
 
         loaded_encrypted_df = load_encrypted_dataframe(enc_df_path)
 
@@ -309,6 +417,83 @@ def test_save_load():
     ), "Loaded encrypted data-frame does not match the initial encrypted data-frame."
 
 
+def test_partial_and_chunked_load():
+    """Test loading some columns and rows of an encrypted data-frame, as well as chunk by chunk."""
+    client = ClientEngine()
+
+    pandas_df = generate_pandas_dataframe(n_features=2, indexes=list(range(1, 8)))
+    selected_columns = list(pandas_df.columns[1:])
+
+    encrypted_df = client.encrypt_from_pandas(pandas_df)
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        enc_df_path = Path(temp_dir) / "encrypted_dataframe"
+
+        encrypted_df.save(enc_df_path, chunk_size=3)
+
+        # Load a range of rows overlapping several chunks, for a subset of columns
+        loaded_encrypted_df = load_encrypted_dataframe(
+            enc_df_path, columns=selected_columns, rows=slice(2, 6)
+        )
+
+        encrypted_df_chunks = list(EncryptedDataFrame.iter_load(enc_df_path))
+
+        with pytest.raises(ValueError, match="Only contiguous ranges of rows can be loaded"):
+            load_encrypted_dataframe(enc_df_path, rows=slice(0, 6, 2))
+
+        with pytest.raises(ValueError, match="Column 'unknown' cannot be found"):
+            load_encrypted_dataframe(enc_df_path, columns=["unknown"])
+
+    assert loaded_encrypted_df.column_names == selected_columns
+    assert set(loaded_encrypted_df.dtype_mappings) == set(selected_columns)
+
+    loaded_clear_df = client.decrypt_to_pandas(loaded_encrypted_df)
+    expected_df = pandas_df[selected_columns].iloc[2:6].reset_index(drop=True)
+
+    assert pandas_dataframe_are_equal(
+        loaded_clear_df, expected_df, float_atol=1, equal_nan=True
+    ), "Partially loaded encrypted data-frame does not match the initial data-frame."
+
+    # The data-frame should have been stored as 3 chunks of rows
+    assert [chunk.encrypted_values.shape[0] for chunk in encrypted_df_chunks] == [3, 3, 1]
+
+    clear_df_chunks = pandas.concat(
+        [client.decrypt_to_pandas(chunk) for chunk in encrypted_df_chunks], ignore_index=True
+    )
+
+    assert pandas_dataframe_are_equal(
+        clear_df_chunks, pandas_df, float_atol=1, equal_nan=True
+    ), "Encrypted data-frame loaded chunk by chunk does not match the initial data-frame."
+
+
+def test_load_legacy_format():
+    """Test loading an encrypted data-frame saved as a single JSON file."""
+    client = ClientEngine()
+
+    pandas_df = generate_pandas_dataframe()
+
+    encrypted_df = client.encrypt_from_pandas(pandas_df)
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        enc_df_path = Path(temp_dir) / "encrypted_dataframe.zip"
+
+        encrypted_df_dict, evaluation_keys = (
+            encrypted_df._to_dict_and_eval_keys()  # pylint: disable=protected-access
+        )
+
+        with ZipFile(enc_df_path, "w", compression=ZIP_STORED, allowZip64=True) as zip_file:
+            zip_file.writestr("encrypted_dataframe.json", json.dumps(encrypted_df_dict))
+            zip_file.writestr("evaluation_keys", evaluation_keys)
+
+        loaded_encrypted_df = load_encrypted_dataframe(enc_df_path)
+
+    loaded_clear_df = client.decrypt_to_pandas(loaded_encrypted_df)
+
+    assert pandas_dataframe_are_equal(
+        loaded_clear_df, pandas_df, float_atol=1, equal_nan=True
+    ), "Encrypted data-frame loaded from the legacy format does not match the initial data-frame."
+
+
 def check_invalid_merge_parameters():
     """Check that unsupported or invalid parameters for merge raise correct errors."""
     encrypted_df_left, encrypted_df_right = get_two_encrypted_dataframes()
@@ -334,6 +519,13 @@ def check_invalid_merge_parameters():
                 **{parameter: unsupported_value},
             )
 
+    for n_jobs in [0, -2]:
+        with pytest.raises(
+            ValueError,
+            match="Parameter 'n_jobs' must be None, -1 or a strictly positive integer.",
+        ):
+            encrypted_df_left.merge(encrypted_df_right, n_jobs=n_jobs)
+
     for how in ["outer", "inner", "cross"]:
         with pytest.raises(
             NotImplementedError,
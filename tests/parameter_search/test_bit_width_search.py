@@ -0,0 +1,128 @@
+"""Tests the search of the quantization bit-width and per-layer rounding bits."""
+
+import numpy
+import pytest
+import torch
+from concrete.fhe.compilation.compiler import Compiler
+from torch import nn
+
+from concrete.ml.common.cached_circuit import CachedCircuit
+from concrete.ml.deployment import CompilationCache
+from concrete.ml.pytest.torch_models import FCSmall
+from concrete.ml.search_parameters import BitWidthSearch
+
+
+def _accuracy(y_true: numpy.ndarray, y_pred: numpy.ndarray) -> float:
+    """Compute the accuracy of the predicted classes.
+
+    Args:
+        y_true (numpy.ndarray): The ground truth classes.
+        y_pred (numpy.ndarray): The predicted scores of each class.
+
+    Returns:
+        float: The accuracy.
+    """
+    return float((y_pred.argmax(1) == y_true).mean())
+
+
+def test_bit_width_search(default_configuration, tmp_path, monkeypatch):
+    """Test that the selected configuration is within the budget and that statistics are cached."""
+
+    torch.manual_seed(42)
+    x = numpy.random.RandomState(42).uniform(-1, 1, size=(100, 4)).astype(numpy.float32)
+
+    torch_model = FCSmall(4, nn.ReLU, hidden=16)
+    with torch.no_grad():
+        y = torch_model(torch.from_numpy(x)).numpy().argmax(1)
+
+    n_compilations = {"count": 0}
+    compile_method = Compiler.compile
+
+    def counting_compile(self, *args, **kwargs):
+        """Count the compilations before compiling the circuit.
+
+        Args:
+            *args: The positional arguments of the compile method.
+            **kwargs: The keyword arguments of the compile method.
+
+        Returns:
+            Circuit: The compiled circuit.
+        """
+        n_compilations["count"] += 1
+        return compile_method(self, *args, **kwargs)
+
+    monkeypatch.setattr(Compiler, "compile", counting_compile)
+
+    def run_search():
+        """Run the search with a persistent cache.
+
+        Returns:
+            Tuple[BitWidthSearch, QuantizedModule]: The search and the selected module.
+        """
+        search = BitWidthSearch(
+            torch_model,
+            _accuracy,
+            n_bits_candidates=(4, 6),
+            rounding_candidates=(6, 5, 4, 3),
+            max_metric_loss=0.1,
+            configuration=default_configuration,
+            compilation_cache=CompilationCache(tmp_path / "cache"),
+        )
+        return search, search.run(x, y)
+
+    search, quantized_module = run_search()
+
+    assert quantized_module.fhe_circuit is not None
+    assert search.n_bits in (4, 6)
+
+    # The selected configuration is the cheapest one within the budget
+    valid_entries = [
+        entry for entry in search.history if entry["is_valid"] and entry["cost"] is not None
+    ]
+    assert min(entry["cost"] for entry in valid_entries) == pytest.approx(
+        float(quantized_module.fhe_circuit.complexity)
+    )
+    assert all(entry["metric_loss"] <= 0.1 for entry in valid_entries)
+
+    # The Pareto report is sorted by cost, the loss of score decreasing along the front
+    pareto_report = search.get_pareto_report()
+    assert pareto_report
+    costs = [entry["cost"] for entry in pareto_report]
+    losses = [entry["metric_loss"] for entry in pareto_report]
+    assert costs == sorted(costs)
+    assert losses == sorted(losses, reverse=True)
+
+    for entry in valid_entries:
+        assert sum(entry["pbs_count_per_bit_width"].values()) > 0
+
+    # A second search finds the statistics and the selected configuration's circuit in the cache,
+    # without compiling anything
+    n_compilations["count"] = 0
+    cached_search, cached_module = run_search()
+
+    assert n_compilations["count"] == 0
+    assert isinstance(cached_module.fhe_circuit, CachedCircuit)
+    assert cached_module.is_compiled
+    assert cached_search.history == search.history
+    assert cached_search.rounding_threshold_bits == search.rounding_threshold_bits
+
+
+def test_bit_width_search_invalid_parameters():
+    """Test that invalid parameters and budgets raise an error."""
+
+    torch_model = FCSmall(4, nn.ReLU)
+
+    with pytest.raises(ValueError, match="Parameter 'n_bits_candidates' must contain"):
+        BitWidthSearch(torch_model, _accuracy, n_bits_candidates=(1, 4))
+
+    with pytest.raises(ValueError, match="Parameter 'rounding_candidates' must only contain"):
+        BitWidthSearch(torch_model, _accuracy, rounding_candidates=(4, 0))
+
+    x = numpy.random.RandomState(0).uniform(-1, 1, size=(50, 4)).astype(numpy.float32)
+
+    # No quantized model can do better than the floating point model
+    search = BitWidthSearch(
+        torch_model, lambda y_true, y_pred: 0.0, n_bits_candidates=(2,), max_metric_loss=-1
+    )
+    with pytest.raises(ValueError, match="No configuration keeps the score within"):
+        search.run(x, numpy.zeros(50, dtype=numpy.int64))
@@ -23,6 +23,8 @@ from concrete.ml.pytest.utils import (
 )
 from concrete.ml.quantization import QuantizedModule
 from concrete.ml.search_parameters import BinarySearch
+from concrete.ml.search_parameters.p_error_search import copy_without_circuits
+from concrete.ml.torch.compile import compile_torch_model
 
 # For built-in models (trees and QNNs) we use the fixture `load_data`
 # For custom models, we define the following variables:
@@ -453,3 +455,87 @@ def test_success_save_option(model_name, quant_type, metric, directory, log_file
         lines = f.readlines()
 
     assert len(lines) >= 2
+
+
+@pytest.mark.parametrize(
+    "strategy, all_matches, n_remaining, expected",
+    [
+        (all, [True, False], 3, True),
+        (all, [True, True], 3, False),
+        (any, [False, True], 3, True),
+        (any, [False, False], 3, False),
+        (lambda all_matches: numpy.mean(all_matches) >= 0.5, [True, True, True], 2, True),
+        (lambda all_matches: numpy.mean(all_matches) >= 0.5, [True, False], 2, False),
+        (all, [True, True], 0, True),
+    ],
+)
+def test_is_decided(strategy, all_matches, n_remaining, expected):
+    """Check that the outcome of a strategy is only considered known when it cannot change."""
+
+    assert BinarySearch.is_decided(strategy, all_matches, n_remaining) == expected
+
+
+@pytest.mark.parametrize("n_candidates, n_jobs", [(3, 2), (1, -1)])
+@pytest.mark.parametrize("model_name, quant_type", [("CustomModel", "qat")])
+def test_parallel_search_for_custom_models(n_candidates, n_jobs, model_name, quant_type):
+    """Check the k-ary search with concurrent candidates, parallel simulations and early stop."""
+
+    model = load_torch_model(
+        MODELS_ARGS[model_name][quant_type]["model_class"],
+        MODELS_ARGS[model_name][quant_type]["path"],
+        MODELS_ARGS[model_name][quant_type]["params"],
+    )
+
+    x, y = make_classification(**MODELS_ARGS[model_name]["dataset"])
+    x_calib, y = data_calibration_processing(data=x, targets=y, n_sample=10)
+
+    search = BinarySearch(
+        estimator=model,
+        predict="predict",
+        metric=top_k_accuracy_score,
+        max_metric_loss=0.02,
+        n_simulation=4,
+        max_iter=2,
+        n_candidates=n_candidates,
+        n_jobs=n_jobs,
+        early_stopping=True,
+        k=1,
+        labels=numpy.arange(MODELS_ARGS[model_name]["dataset"]["n_classes"]),
+    )
+
+    largest_perror = search.run(x=x_calib, ground_truth=y, strategy=all)
+
+    assert 1.0 > largest_perror > 0.0
+
+    # Each iteration evaluates at least one and at most `n_candidates` candidates
+    assert search.max_iter <= len(search.history) <= search.max_iter * n_candidates
+
+    # With early stopping, candidates are not necessarily simulated `n_simulation` times
+    for metadata in search.history:
+        assert 1 <= len(metadata["all_matches"]) <= search.n_simulation
+
+    assert search.lower <= largest_perror <= search.upper
+
+
+def test_copy_without_circuits():
+    """Check that copying a compiled quantized module does not copy nor alter its circuit."""
+
+    x = numpy.random.uniform(size=(10, 6))
+
+    quantized_module = compile_torch_model(TorchCustomModel(6, 10, 3), x, n_bits=4)
+    fhe_circuit = quantized_module.fhe_circuit
+
+    copied_module = copy_without_circuits(quantized_module)
+
+    assert copied_module is not quantized_module
+    assert copied_module.fhe_circuit is None
+    assert quantized_module.fhe_circuit is fhe_circuit
+
+    # The copy can be compiled with another p_error without altering the original module
+    copied_module.compile(x, p_error=0.1)
+
+    assert copied_module.fhe_circuit is not None
+    assert quantized_module.fhe_circuit is fhe_circuit
+    numpy.testing.assert_array_equal(
+        copied_module.forward(x, fhe="disable"), quantized_module.forward(x, fhe="disable")
+    )
@@ -0,0 +1,84 @@
+"""Tests the per-layer profiling and FHE latency estimation of quantized modules."""
+
+import numpy
+import pytest
+from torch import nn
+
+from concrete.ml.pytest.torch_models import FCSmall
+from concrete.ml.quantization import PBSCostTable, measure_fhe_latency, profile_quantized_module
+from concrete.ml.torch.compile import build_quantized_module
+
+
+def test_profile_quantized_module(default_configuration):
+    """Test that traced profiles match the compiled ones and estimate the layers' latency."""
+
+    x = numpy.random.RandomState(42).uniform(-1, 1, size=(100, 4))
+    quantized_module = build_quantized_module(
+        FCSmall(4, nn.ReLU, hidden=16), torch_inputset=x, n_bits=4
+    )
+
+    cost_table = PBSCostTable({"cpu": {2: 0.001, 4: 0.002, 8: 0.01}})
+
+    # Profiling a module that is not compiled traces it
+    traced_profile = profile_quantized_module(quantized_module, x, cost_table=cost_table)
+
+    assert not quantized_module.is_compiled
+    assert sum(layer["pbs_count"] for layer in traced_profile.values()) > 0
+
+    for layer in traced_profile.values():
+        expected_latency = sum(
+            count * cost_table.get_cost("cpu", bit_width)
+            for bit_width, count in layer["pbs_count_per_bit_width"].items()
+        )
+        assert layer["estimated_latency"]["cpu"] == pytest.approx(expected_latency)
+
+    # Compiling the module does not change the number of PBS of each layer
+    quantized_module.compile(x, configuration=default_configuration)
+    compiled_profile = profile_quantized_module(
+        quantized_module, cost_table=cost_table, fhe_inputs=x[:1]
+    )
+
+    assert {name: layer["pbs_count"] for name, layer in compiled_profile.items()} == {
+        name: layer["pbs_count"] for name, layer in traced_profile.items()
+    }
+
+    # Only the total latency is measured, it is then attributed to the layers
+    attributed_latencies = [layer["attributed_latency"] for layer in compiled_profile.values()]
+    assert all(latency >= 0 for latency in attributed_latencies)
+    assert sum(attributed_latencies) > 0
+    assert measure_fhe_latency(quantized_module, x[:1]) > 0
+
+    with pytest.raises(ValueError, match="The module needs to be compiled before measuring"):
+        measure_fhe_latency(
+            build_quantized_module(FCSmall(4, nn.ReLU), torch_inputset=x, n_bits=4), x[:1]
+        )
+
+    with pytest.raises(ValueError, match="An input-set is needed for profiling a module"):
+        profile_quantized_module(
+            build_quantized_module(FCSmall(4, nn.ReLU), torch_inputset=x, n_bits=4)
+        )
+
+
+def test_pbs_cost_table(default_configuration, tmp_path):
+    """Test the calibration, look-up and serialization of PBS costs."""
+
+    cost_table = PBSCostTable().calibrate(
+        bit_widths=(1, 3), n_pbs=4, n_repetitions=1, configuration=default_configuration
+    )
+
+    assert cost_table.devices == ["cpu"]
+    assert list(cost_table.costs["cpu"]) == [1, 3]
+    assert all(cost > 0 for cost in cost_table.costs["cpu"].values())
+
+    # Bit-widths that are not calibrated take the cost of the closest larger one, or the largest
+    assert cost_table.get_cost("cpu", 2) == cost_table.costs["cpu"][3]
+    assert cost_table.get_cost("cpu", 8) == cost_table.costs["cpu"][3]
+    assert cost_table.estimate_latency({1: 2, 3: 1}, "cpu") == pytest.approx(
+        2 * cost_table.costs["cpu"][1] + cost_table.costs["cpu"][3]
+    )
+
+    with pytest.raises(ValueError, match="No PBS costs are calibrated for device 'cuda'"):
+        cost_table.get_cost("cuda", 2)
+
+    cost_table.save(tmp_path / "pbs_costs.json")
+    assert PBSCostTable.load(tmp_path / "pbs_costs.json").costs == cost_table.costs
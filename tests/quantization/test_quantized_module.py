@@ -7,9 +7,11 @@ import pytest
 import torch
 from torch import nn
 
+from concrete.ml.common.batch_executor import BatchExecutor
 from concrete.ml.pytest.torch_models import CNN, FC, CNNMaxPool, EmbeddingModel
 from concrete.ml.pytest.utils import check_serialization, values_are_equal
 from concrete.ml.quantization import PostTrainingAffineQuantization, QuantizedModule
+from concrete.ml.quantization.post_training import BatchedCalibrationData
 from concrete.ml.torch import NumpyModule
 from concrete.ml.torch.compile import compile_torch_model
 
@@ -355,6 +357,57 @@ def test_quantized_module_rounding_fhe(model_class, input_shape, default_configu
     # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/3800
 
 
+@pytest.mark.parametrize("model_class, input_shape", [pytest.param(FC, (100, 32 * 32 * 3))])
+@pytest.mark.parametrize("n_jobs, batch_size", [(2, None), (4, 3)])
+def test_quantized_module_batch_executor(
+    model_class, input_shape, n_jobs, batch_size, default_configuration
+):
+    """Check that executing samples on several workers gives the same results in simulation."""
+
+    torch_fc_model = model_class(activation_function=nn.ReLU)
+    torch_fc_model.eval()
+
+    # Create random input
+    numpy_input = numpy.random.uniform(size=input_shape)
+    torch_input = torch.from_numpy(numpy_input).float()
+    numpy_test = numpy_input[:10]
+
+    # Use a very low p_error so that simulated results are deterministic
+    quantized_model = compile_torch_model(
+        torch_fc_model,
+        torch_input,
+        False,
+        default_configuration,
+        n_bits=2,
+        p_error=10e-40,
+    )
+
+    sequential_predictions = quantized_model.forward(numpy_test, fhe="simulate")
+
+    # The executor can be given when executing the module
+    parallel_predictions = quantized_model.forward(
+        numpy_test,
+        fhe="simulate",
+        fhe_executor=BatchExecutor(n_jobs=n_jobs, batch_size=batch_size),
+    )
+
+    assert values_are_equal(sequential_predictions, parallel_predictions)
+
+    # The executor can also be set when compiling the module
+    quantized_model.compile(
+        numpy_input,
+        default_configuration,
+        p_error=10e-40,
+        fhe_executor=BatchExecutor(n_jobs=n_jobs, batch_size=batch_size),
+    )
+
+    assert quantized_model.fhe_executor.n_workers == n_jobs
+
+    parallel_predictions = quantized_model.forward(numpy_test, fhe="simulate")
+
+    assert values_are_equal(sequential_predictions, parallel_predictions)
+
+
 # Extend this test with multi-input encryption status
 # FIXME: https://github.com/zama-ai/concrete-ml-internal/issues/4011
 @pytest.mark.parametrize("model_class, input_shape", [pytest.param(FC, (100, 32 * 32 * 3))])
@@ -515,6 +568,179 @@ def test_serialization(model_class, input_shape, rounding_threshold_bits):
     )
 
 
+@pytest.mark.parametrize(
+    "model_class, input_shape",
+    [
+        pytest.param(FC, (100, 32 * 32 * 3), id="FC"),
+        pytest.param(partial(CNN, input_output=3), (100, 3, 32, 32), id="CNN"),
+    ],
+)
+@pytest.mark.parametrize("rounding_threshold_bits", [None, 6])
+@pytest.mark.parametrize("calibration_batch_size", [1, 32])
+def test_calibration_in_batches(
+    model_class, input_shape, rounding_threshold_bits, calibration_batch_size
+):
+    """Test that calibrating in batches gives the same quantized module as a single pass."""
+
+    torch_model = model_class(activation_function=nn.ReLU)
+    torch_model.eval()
+
+    numpy_input = numpy.random.uniform(size=input_shape)
+    numpy_model = NumpyModule(torch_model, torch.from_numpy(numpy_input).float())
+
+    quantized_modules = [
+        PostTrainingAffineQuantization(
+            4,
+            numpy_model,
+            rounding_threshold_bits=rounding_threshold_bits,
+            calibration_batch_size=batch_size,
+        ).quantize_module(numpy_input)
+        for batch_size in [None, calibration_batch_size]
+    ]
+
+    full_module, batched_module = quantized_modules
+
+    for (_, full_op), (_, batched_op) in zip(
+        full_module.quant_layers_dict.values(), batched_module.quant_layers_dict.values()
+    ):
+        assert full_op.output_quant_params == batched_op.output_quant_params
+        assert full_op.output_quant_stats == batched_op.output_quant_stats
+        assert getattr(full_op, "lsbs_to_remove", None) == getattr(
+            batched_op, "lsbs_to_remove", None
+        )
+
+    assert numpy.array_equal(
+        full_module.forward(numpy_input, fhe="disable"),
+        batched_module.forward(numpy_input, fhe="disable"),
+    )
+
+
+def test_calibration_in_batches_deep_model(monkeypatch):
+    """Test that deep models are calibrated in batches with each layer computed once per batch."""
+
+    n_samples, calibration_batch_size = 64, 8
+
+    # 200 layers, deeper than the recursion limit allows when recomputing batches recursively
+    torch_model = nn.Sequential(
+        *(module for _ in range(100) for module in (nn.Linear(4, 4), nn.ReLU()))
+    )
+    torch_model.eval()
+
+    numpy_input = numpy.random.uniform(-1, 1, size=(n_samples, 4))
+    numpy_model = NumpyModule(torch_model, torch.from_numpy(numpy_input).float())
+
+    full_module = PostTrainingAffineQuantization(4, numpy_model).quantize_module(numpy_input)
+
+    # pylint: disable-next=protected-access
+    quantize_batch = PostTrainingAffineQuantization._quantize_batch
+    n_quantized_batches = []
+
+    def count_quantized_batches(*args, **kwargs):
+        """Count the batches of layer inputs that are quantized.
+
+        Args:
+            *args: the positional arguments of the quantization
+            **kwargs: the keyword arguments of the quantization
+
+        Returns:
+            List[Optional[QuantizedArray]]: the quantized inputs of the batch
+        """
+        n_quantized_batches.append(1)
+        return quantize_batch(*args, **kwargs)
+
+    monkeypatch.setattr(
+        PostTrainingAffineQuantization, "_quantize_batch", staticmethod(count_quantized_batches)
+    )
+
+    batched_module = PostTrainingAffineQuantization(
+        4, numpy_model, calibration_batch_size=calibration_batch_size
+    ).quantize_module(numpy_input)
+
+    # Each batch of each layer is quantized once, previous layers not being computed again
+    n_layers = len(batched_module.quant_layers_dict)
+    assert n_layers == 200
+    assert len(n_quantized_batches) == n_layers * (n_samples // calibration_batch_size)
+
+    for (_, full_op), (_, batched_op) in zip(
+        full_module.quant_layers_dict.values(), batched_module.quant_layers_dict.values()
+    ):
+        assert full_op.output_quant_params == batched_op.output_quant_params
+        assert full_op.output_quant_stats == batched_op.output_quant_stats
+
+    assert numpy.array_equal(
+        full_module.forward(numpy_input, fhe="disable"),
+        batched_module.forward(numpy_input, fhe="disable"),
+    )
+
+
+def test_calibration_in_batches_streams_activations(monkeypatch):
+    """Test that layers calibrated in batches store their activations batch by batch."""
+
+    calibration_batch_size = 16
+
+    torch_model = FC(activation_function=nn.ReLU)
+    torch_model.eval()
+
+    numpy_input = numpy.random.uniform(size=(100, 32 * 32 * 3))
+    numpy_model = NumpyModule(torch_model, torch.from_numpy(numpy_input).float())
+
+    post_training_quant = PostTrainingAffineQuantization(
+        4, numpy_model, calibration_batch_size=calibration_batch_size
+    )
+
+    # pylint: disable-next=protected-access
+    calibrate_layers_activation_in_batches = (
+        post_training_quant._calibrate_layers_activation_in_batches
+    )
+    batched_outputs = []
+
+    def record_batched_outputs(*args, **kwargs):
+        """Record the outputs of the layers calibrated in batches.
+
+        Args:
+            *args: the positional arguments of the calibration
+            **kwargs: the keyword arguments of the calibration
+
+        Returns:
+            Tuple: the output of the layer and its quantizer
+        """
+        result = calibrate_layers_activation_in_batches(*args, **kwargs)
+        batched_outputs.append(result[0])
+        return result
+
+    monkeypatch.setattr(
+        post_training_quant, "_calibrate_layers_activation_in_batches", record_batched_outputs
+    )
+    post_training_quant.quantize_module(numpy_input)
+
+    assert len(batched_outputs) > 0
+
+    for batched_output in batched_outputs:
+        assert isinstance(batched_output, BatchedCalibrationData)
+        assert batched_output.n_samples == numpy_input.shape[0]
+
+        batches = [
+            batched_output.get_batch(batch_slice) for batch_slice in batched_output.batch_slices
+        ]
+        assert all(batch.shape[0] <= calibration_batch_size for batch in batches)
+        assert sum(batch.shape[0] for batch in batches) == numpy_input.shape[0]
+
+        # The statistics merged over all batches are the ones of the whole data-set
+        full_output = batched_output.materialize()
+        assert batched_output.rmin == full_output.min()
+        assert batched_output.rmax == full_output.max()
+
+
+def test_calibration_batch_size_error():
+    """Test that an invalid calibration batch size raises an error."""
+
+    torch_model = FC(activation_function=nn.ReLU)
+    numpy_model = NumpyModule(torch_model, torch.randn(1, 32 * 32 * 3))
+
+    with pytest.raises(ValueError, match="calibration_batch_size must be a positive integer"):
+        PostTrainingAffineQuantization(8, numpy_model, calibration_batch_size=0)
+
+
 def test_quantized_module_initialization_error():
     """Test initialization fails with mismatched parameters."""
     # Initialize with invalid parameters
@@ -134,6 +134,32 @@ def test_quantized_array_constructor():
         QuantizedArray(2, values, stats=None, rmax=2)
 
 
+@pytest.mark.parametrize("n_bits", [2, 8])
+@pytest.mark.parametrize("is_signed", [True, False])
+def test_lazy_quantized_array(n_bits, is_signed):
+    """Test that lazily quantized arrays give the same values as eagerly quantized ones."""
+
+    values = numpy.random.randn(100, 10)
+    options = QuantizationOptions(n_bits, is_signed=is_signed)
+
+    eager_array = QuantizedArray(n_bits, values, options=options)
+    lazy_array = QuantizedArray(n_bits, values, options=options, lazy=True)
+
+    # The values are not copied nor quantized before the quantized values are read
+    assert lazy_array.values is values
+    assert lazy_array._qvalues is None  # pylint: disable=protected-access
+
+    assert lazy_array.quantizer == eager_array.quantizer
+    assert numpy.array_equal(lazy_array.qvalues, eager_array.qvalues)
+    assert lazy_array == eager_array
+
+    # Updating the values quantizes them right away, as for eager arrays
+    new_values = numpy.random.randn(100, 10)
+    assert numpy.array_equal(
+        lazy_array.update_values(new_values), eager_array.update_values(new_values)
+    )
+
+
 # pylint: disable-next=too-many-statements
 def test_serialization():
     """Test the serialization of quantizers objects."""
@@ -659,3 +659,85 @@ def test_encrypted_fit_in_fhe(n_bits, max_iter, parameter_min_max, default_confi
     assert array_allclose_and_same_shape(bias_fhe, bias_disable)
     assert array_allclose_and_same_shape(y_pred_proba_fhe, y_pred_proba_disable)
     assert array_allclose_and_same_shape(y_pred_class_fhe, y_pred_class_disable)
+
+
+@pytest.mark.parametrize("fhe", ["disable", "simulate"])
+@pytest.mark.parametrize("n_bits, max_iter, parameter_min_max", [pytest.param(7, 6, 1.0)])
+def test_encrypted_fit_checkpoint(
+    fhe, n_bits, max_iter, parameter_min_max, simulation_configuration, tmp_path, monkeypatch
+):
+    """Test that an interrupted encrypted training can be resumed from its last checkpoint."""
+
+    # Model parameters
+    random_state = numpy.random.randint(0, 2**15)
+    parameters_range = (-parameter_min_max, parameter_min_max)
+
+    x, y = get_blob_data(n_features=4, scale_input=True, parameters_range=parameters_range)
+
+    def get_model():
+        model = SGDClassifier(
+            n_bits=n_bits,
+            fit_encrypted=True,
+            random_state=random_state,
+            parameters_range=parameters_range,
+            max_iter=max_iter,
+        )
+        model.training_p_error = 1e-15
+        model.training_fhe_configuration = simulation_configuration
+        return model
+
+    # Train a reference model without interruption nor checkpoints
+    reference_model = get_model()
+    reference_model.fit(x, y, fhe=fhe)
+
+    throughput = reference_model.training_throughput_
+    assert throughput["iterations"] == max_iter
+    assert throughput["iterations_per_second"] > 0
+    assert throughput["bytes_per_step"] > 0
+
+    # Interrupt a training after a few iterations, by failing to prepare one of the batches
+    n_prepared_batches = 0
+    # pylint: disable-next=protected-access
+    prepare_training_batch = SGDClassifier._prepare_training_batch
+
+    def failing_prepare_training_batch(*args, **kwargs):
+        nonlocal n_prepared_batches
+        n_prepared_batches += 1
+        if n_prepared_batches > max_iter // 2:
+            raise RuntimeError("Training interrupted")
+        return prepare_training_batch(*args, **kwargs)
+
+    checkpoint_dir = tmp_path / "checkpoint"
+
+    with monkeypatch.context() as patch:
+        patch.setattr(SGDClassifier, "_prepare_training_batch", failing_prepare_training_batch)
+
+        with pytest.raises(RuntimeError, match="Training interrupted"):
+            get_model().fit(x, y, fhe=fhe, checkpoint_dir=checkpoint_dir, checkpoint_every=1)
+
+    assert (checkpoint_dir / "training_checkpoint.npz").is_file()
+
+    # Resuming the training should give the same model as the uninterrupted training
+    resumed_model = get_model()
+    resumed_model.fit(x, y, fhe=fhe, checkpoint_dir=checkpoint_dir)
+
+    assert resumed_model.training_throughput_["iterations"] == max_iter - max_iter // 2
+
+    # pylint: disable=protected-access
+    assert array_allclose_and_same_shape(
+        resumed_model._weights_encrypted_fit, reference_model._weights_encrypted_fit
+    )
+    assert array_allclose_and_same_shape(
+        resumed_model._bias_encrypted_fit, reference_model._bias_encrypted_fit
+    )
+    # pylint: enable=protected-access
+
+    # A checkpoint saved by a training with other parameters cannot be resumed
+    other_model = get_model()
+    other_model.max_iter = max_iter + 1
+
+    with pytest.raises(ValueError, match="was saved by a training with max_iter"):
+        other_model.fit(x, y, fhe=fhe, checkpoint_dir=checkpoint_dir)
+
+    with pytest.raises(ValueError, match="'checkpoint_every' must be a positive integer"):
+        get_model().fit(x, y, fhe=fhe, checkpoint_dir=checkpoint_dir, checkpoint_every=0)
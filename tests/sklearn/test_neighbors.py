@@ -0,0 +1,78 @@
+"""Tests for the k-nearest neighbors models compiled in several blocks."""
+
+import numpy
+import pytest
+
+from concrete.ml.sklearn import KNeighborsClassifier
+from concrete.ml.sklearn.base import _concatenate_block_outputs, _get_blocks_module_functions
+
+# pylint: disable=protected-access
+
+
+@pytest.mark.parametrize("block_size", [3, 4, 5])
+def test_knn_blocks(
+    block_size,
+    load_data,
+    default_configuration,
+    check_is_good_execution_for_cml_vs_circuit,
+    check_array_equal,
+):
+    """Test that merging the blocks' nearest neighbors gives the overall nearest neighbors."""
+
+    n_samples, n_neighbors = 12, 3
+
+    x, y = load_data(
+        KNeighborsClassifier,
+        n_samples=n_samples,
+        n_features=2,
+        n_classes=2,
+        n_informative=2,
+        n_redundant=0,
+    )
+
+    model = KNeighborsClassifier(n_bits=2, n_neighbors=n_neighbors, block_size=block_size)
+    model.fit(x, y)
+
+    blocks = model._get_blocks()
+
+    # The training set is split in balanced blocks of at least `block_size` points
+    assert len(blocks) == n_samples // block_size
+    assert all(len(q_fit_X) >= block_size and len(q_fit_X) == len(y) for q_fit_X, y in blocks)
+    check_array_equal(numpy.concatenate([q_fit_X for q_fit_X, _ in blocks]), model._q_fit_X)
+
+    for q_x in model.quantize_input(x):
+        q_x = numpy.expand_dims(q_x, 0)
+
+        block_outputs = [model._block_inference(q_x, q_fit_X, y) for q_fit_X, y in blocks]
+        topk_distances, topk_labels = model._merge_inference(
+            *_concatenate_block_outputs(block_outputs)
+        )
+
+        # The merged distances are the k smallest distances over the whole training set
+        distances = model._pairwise_euclidean_distance(q_x, model._q_fit_X).flatten()
+        check_array_equal(numpy.sort(topk_distances.flatten()), numpy.sort(distances)[:n_neighbors])
+        assert topk_labels.shape == (1, n_neighbors)
+
+    # Merging the blocks two by two gives the same labels as merging them all at once
+    for q_x in model.quantize_input(x):
+        q_x = numpy.expand_dims(q_x, 0)
+
+        block_outputs = [model._block_inference(q_x, q_fit_X, y) for q_fit_X, y in blocks]
+        check_array_equal(
+            numpy.sort(model._inference(q_x)),
+            numpy.sort(model._merge_inference(*_concatenate_block_outputs(block_outputs))[1]),
+        )
+
+    model.compile(x, configuration=default_configuration)
+
+    # Each block is compiled as a function of a single module, along with the merge functions
+    function_names = _get_blocks_module_functions(len(blocks))
+    assert model.fhe_circuit is None
+    assert model.fhe_module_functions_ == function_names
+    assert (function_names["merge"] is None) == (len(blocks) == 2)
+
+    check_is_good_execution_for_cml_vs_circuit(x, model, simulate=True)
+
+    # Blocks cannot hold less points than the number of neighbors
+    with pytest.raises(ValueError, match="Parameter 'block_size' must be None or greater or"):
+        KNeighborsClassifier(n_bits=2, n_neighbors=n_neighbors, block_size=2).fit(x, y)
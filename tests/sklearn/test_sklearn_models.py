@@ -52,6 +52,7 @@ from sklearn.pipeline import Pipeline
 from sklearn.preprocessing import StandardScaler
 from torch import nn
 
+from concrete.ml.common.batch_executor import BatchExecutor
 from concrete.ml.common.serialization.dumpers import dump, dumps
 from concrete.ml.common.serialization.loaders import load, loads
 from concrete.ml.common.utils import (
@@ -1951,6 +1952,33 @@ def test_p_error_simulation(
         assert not (fhe_diff_found or simulation_diff_found), assert_msg
 
 
+@pytest.mark.parametrize("model_class, parameters", UNIQUE_MODELS_AND_DATASETS)
+@pytest.mark.parametrize("n_jobs, batch_size", [(2, None), (3, 2)])
+def test_batch_executor_predict(
+    model_class,
+    parameters,
+    n_jobs,
+    batch_size,
+    load_data,
+    default_configuration,
+    check_is_good_execution_for_cml_vs_circuit,
+    is_weekly_option,
+):
+    """Test that predicting with several workers matches the clear quantized predictions."""
+
+    n_bits = get_n_bits_non_correctness(model_class)
+
+    model, x = preamble(model_class, parameters, n_bits, load_data, is_weekly_option)
+
+    # Use a very low p_error so that simulated results match the clear ones
+    model.compile(x, default_configuration, p_error=2**-40)
+
+    model.fhe_executor = BatchExecutor(n_jobs=n_jobs, batch_size=batch_size)
+
+    fhe_test = get_random_samples(x, 7)
+    check_is_good_execution_for_cml_vs_circuit(fhe_test, model=model, simulate=True)
+
+
 # This test is only relevant for classifier models
 @pytest.mark.parametrize(
     "model_class, parameters",
@@ -2318,6 +2346,10 @@ def test_initialization_variables_and_defaults_match(
     if model_name == "SGDClassifier":
         extra_params -= {"fit_encrypted", "parameters_range"}
 
+    # Allow 'block_size' for KNeighborsClassifier
+    if model_name == "KNeighborsClassifier":
+        extra_params -= {"block_size"}
+
     def is_nan(x):
         """Check if a variable is nan."""
         return isinstance(x, float) and math.isnan(x)
@@ -1,20 +1,34 @@
 """Tests for the hybrid model converter."""
 
+import ast
 import sys
 import tempfile
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from typing import List, Union
 
 import numpy
 import pytest
+import requests
 import torch
 from concrete.fhe import Configuration
 from sklearn.model_selection import train_test_split
 from transformers import GPT2LMHeadModel, GPT2Tokenizer
 
+from concrete.ml.deployment import FHEModelServer, RequestScheduler, SchedulerOverloadedError
 from concrete.ml.pytest.torch_models import FCSmall, PartialQATModel
+from concrete.ml.quantization.linear_op_glwe_backend import has_glwe_backend
 from concrete.ml.torch.hybrid_model import (
     HybridFHEModel,
+    HybridFHEModelServer,
+    RemoteModule,
+    compute_shape_buckets,
+    deserialize_ciphertext_batch,
+    pad_to_shape,
+    serialize_ciphertext_batch,
+    strip_padding,
     tuple_to_underscore_str,
     underscore_str_to_tuple,
 )
@@ -35,6 +49,439 @@ def test_tuple_serialization(tup):
     assert tup == underscore_str_to_tuple(tuple_to_underscore_str(tup))
 
 
+@pytest.mark.parametrize(
+    "ciphertexts",
+    [
+        [],
+        [b""],
+        [b"abc"],
+        [b"abc", b"", b"defgh" * 1000],
+    ],
+)
+def test_ciphertext_batch_serialization(ciphertexts):
+    """Test that batches of ciphertexts are correctly serialized."""
+    assert ciphertexts == deserialize_ciphertext_batch(serialize_ciphertext_batch(ciphertexts))
+
+
+def test_ciphertext_batch_serialization_truncated():
+    """Test that truncated batches of ciphertexts raise an error."""
+    payload = serialize_ciphertext_batch([b"abc", b"defgh"])
+
+    with pytest.raises(ValueError, match="Truncated ciphertext batch: expected 5 bytes"):
+        deserialize_ciphertext_batch(payload[:-1])
+
+    with pytest.raises(ValueError, match="Truncated ciphertext batch: incomplete size header."):
+        deserialize_ciphertext_batch(payload[:4])
+
+
+@pytest.mark.parametrize(
+    "parameters, error_message",
+    [
+        ({"remote_batch_size": 0}, "Parameter 'remote_batch_size' must be a strictly positive"),
+        (
+            {"max_in_flight_requests": 0},
+            "Parameter 'max_in_flight_requests' must be a strictly positive",
+        ),
+    ],
+)
+def test_remote_module_invalid_pipelining_parameters(parameters, error_message):
+    """Test that invalid pipelining parameters raise an error."""
+    with pytest.raises(ValueError, match=error_message):
+        RemoteModule(**parameters)
+
+
+class _FakeRemoteClient:
+    """A client "encrypting" rows as their bytes and "decrypting" results as their double."""
+
+    @staticmethod
+    def quantize_encrypt_serialize(row: numpy.ndarray) -> bytes:
+        """Serialize a row.
+
+        Args:
+            row (numpy.ndarray): The row, of shape (1, n_features).
+
+        Returns:
+            bytes: The row's bytes.
+        """
+        return row.astype(numpy.float64).tobytes()
+
+    @staticmethod
+    def deserialize_decrypt_dequantize(result: bytes) -> numpy.ndarray:
+        """Deserialize a result.
+
+        Args:
+            result (bytes): The result's bytes.
+
+        Returns:
+            numpy.ndarray: The result, of shape (1, n_features).
+        """
+        return numpy.frombuffer(result, dtype=numpy.float64).reshape(1, -1)
+
+
+@pytest.mark.parametrize(
+    "remote_batch_size, expected_request_sizes",
+    [
+        pytest.param(None, [7], id="unbounded"),
+        pytest.param(3, [3, 3, 1], id="split"),
+    ],
+)
+@pytest.mark.parametrize("use_request_pool", [False, True])
+def test_remote_module_batch_size(remote_batch_size, expected_request_sizes, use_request_pool):
+    """Test that rows are sent in chunks of the batch size and that results come back in order."""
+    n_rows, n_features = 7, 4
+    remote_module = RemoteModule(remote_batch_size=remote_batch_size, max_in_flight_requests=2)
+    remote_module.clients[str((1, n_features))] = ("key_id", _FakeRemoteClient())
+
+    if use_request_pool:
+        remote_module.request_pool = ThreadPoolExecutor(max_workers=2)
+
+    request_sizes: List[int] = []
+
+    def remote_compute(encrypted_inputs: List[bytes], key_id: str, input_shape: str):
+        """Double the rows of the request, the first requests answering last.
+
+        Args:
+            encrypted_inputs (List[bytes]): The serialized rows.
+            key_id (str): The client's key identifier.
+            input_shape (str): The rows' input shape.
+
+        Returns:
+            List[bytes]: The serialized results.
+        """
+        assert key_id == "key_id" and input_shape == str((1, n_features))
+        request_sizes.append(len(encrypted_inputs))
+        time.sleep(0.05 / len(request_sizes))
+
+        return [
+            (numpy.frombuffer(encrypted_input, dtype=numpy.float64) * 2).tobytes()
+            for encrypted_input in encrypted_inputs
+        ]
+
+    remote_module._remote_compute = remote_compute  # type: ignore[method-assign]
+
+    x = torch.arange(n_rows * n_features, dtype=torch.float64).reshape(n_rows, n_features)
+
+    try:
+        y = remote_module.remote_call(x)
+    finally:
+        if remote_module.request_pool is not None:
+            remote_module.request_pool.shutdown()
+
+    assert sorted(request_sizes, reverse=True) == expected_request_sizes
+    assert numpy.array_equal(y.numpy(), 2 * x.numpy())
+
+
+def test_hybrid_model_cleanup():
+    """Test that cleaning up a hybrid model shuts its request threads down."""
+    hybrid_model = HybridFHEModel(FCSmall(4, torch.nn.ReLU), module_names="fc1")
+
+    request_pool = ThreadPoolExecutor(max_workers=1)
+    hybrid_model.request_pool = request_pool
+    remote_module = hybrid_model.remote_modules["fc1"]
+    remote_module.request_pool = request_pool
+    remote_module.session = requests.Session()
+
+    hybrid_model.cleanup()
+
+    assert hybrid_model.request_pool is None
+    assert remote_module.request_pool is None
+    assert remote_module.session is None
+
+    with pytest.raises(RuntimeError):
+        request_pool.submit(print)
+
+
+@pytest.mark.parametrize(
+    "shape_counts, n_buckets, expected_buckets",
+    [
+        pytest.param({(1, 2, 8): 10, (1, 5, 8): 10}, 4, [(1, 2, 8), (1, 5, 8)]),
+        pytest.param({(1, 2, 8): 10, (1, 3, 8): 10, (1, 5, 8): 20}, 2, [(1, 3, 8), (1, 5, 8)]),
+        pytest.param({(1, 2, 8): 10, (1, 3, 8): 1, (1, 5, 8): 1}, 1, [(1, 5, 8)]),
+        pytest.param({(1, 2, 3, 8): 10, (1, 3, 2, 8): 10}, 1, [(1, 3, 3, 8)]),
+    ],
+)
+def test_compute_shape_buckets(shape_counts, n_buckets, expected_buckets):
+    """Test the choice of bucket shapes from a histogram of input shapes."""
+    assert compute_shape_buckets(shape_counts, n_buckets) == expected_buckets
+
+
+@pytest.mark.parametrize(
+    "shape_counts, n_buckets, error_message",
+    [
+        pytest.param({(1, 2, 8): 1}, 0, "Parameter 'n_shape_buckets' must be None or a strictly"),
+        pytest.param({(1, 2, 8): 1, (1, 2, 4): 1}, 2, "Shape bucketing requires inputs with"),
+        pytest.param({(1, 2, 8): 1, (1, 8): 1}, 2, "Shape bucketing requires inputs with"),
+    ],
+)
+def test_compute_shape_buckets_errors(shape_counts, n_buckets, error_message):
+    """Test that invalid histograms or numbers of buckets raise an error."""
+    with pytest.raises(ValueError, match=error_message):
+        compute_shape_buckets(shape_counts, n_buckets)
+
+
+def test_pad_and_strip_shapes():
+    """Test that padded inputs are stripped back to their original shape."""
+    inputs = numpy.random.uniform(size=(3, 2, 8))
+
+    padded_inputs = pad_to_shape(inputs, (1, 5, 8))
+    assert padded_inputs.shape == (3, 5, 8)
+    assert numpy.array_equal(padded_inputs[:, :2], inputs)
+    assert not padded_inputs[:, 2:].any()
+
+    # The last dimension is kept as it is, as it can be changed by the module
+    outputs = numpy.random.uniform(size=(3, 5, 4))
+    assert numpy.array_equal(strip_padding(outputs, (1, 2, 8)), outputs[:, :2])
+
+
+def test_hybrid_shape_bucketing():
+    """Test that inputs of variable sequence lengths are padded to a few compiled buckets."""
+    n_features = 8
+    model = FCSmall(n_features, torch.nn.ReLU)
+
+    # Calibrate the model on sequences of several lengths
+    sequence_lengths = [2, 3, 4, 6, 7, 8]
+    inputs = [torch.randn((10, length, n_features)) for length in sequence_lengths]
+
+    hybrid_model = HybridFHEModel(model, module_names="fc1")
+    hybrid_model.compile_model(x=inputs, n_bits=6, n_shape_buckets=2)
+
+    remote_module = hybrid_model.remote_modules["fc1"]
+    assert remote_module.shape_buckets == [(1, 4, n_features), (1, 8, n_features)]
+    assert len(hybrid_model.bucket_q_modules["fc1"]) == 2
+
+    assert remote_module.get_bucket_shape((1, 3, n_features)) == (1, 4, n_features)
+    with pytest.raises(ValueError, match="does not fit in any of the shape buckets"):
+        remote_module.get_bucket_shape((1, 9, n_features))
+
+    # Padded positions do not change the results of the other ones
+    x = torch.randn((5, 3, n_features))
+    padded_x = torch.cat([x, torch.zeros((5, 1, n_features))], dim=1)
+
+    for fhe in ["disable", "simulate"]:
+        y = hybrid_model(x, fhe=fhe)
+        padded_y = hybrid_model(padded_x, fhe=fhe)
+
+        assert y.shape == (5, 3, n_features)
+        if fhe == "disable":
+            assert torch.equal(y, padded_y[:, :3])
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        temp_dir_path = Path(temp_dir)
+        hybrid_model.save_and_clear_private_info(temp_dir_path)
+
+        # One circuit is saved per bucket
+        saved_shapes = sorted(path.name for path in (temp_dir_path / "fc1").iterdir())
+        assert saved_shapes == sorted(
+            tuple_to_underscore_str(shape) for shape in remote_module.shape_buckets
+        )
+
+
+class _FakeServerResponse:
+    """A response of the FHE server, holding the answer as bytes or as JSON."""
+
+    def __init__(self, content: bytes = b"", json_content=None):
+        self.status_code = 200
+        self.content = content
+        self.json_content = json_content
+
+    def json(self):
+        """Get the JSON answer.
+
+        Returns:
+            The JSON answer.
+        """
+        return self.json_content
+
+
+class _FakeServerSession:
+    """A session answering the client requests sent when initializing a remote module."""
+
+    def __init__(self, module_dir: Path):
+        self.module_dir = module_dir
+
+    def get(self, url: str, data: dict) -> _FakeServerResponse:
+        """Answer the requests listing the served shapes and sending their client.
+
+        Args:
+            url (str): The requested URL.
+            data (dict): The request's data.
+
+        Returns:
+            _FakeServerResponse: The shapes served or the requested client's files.
+        """
+        if url.endswith("/list_shapes"):
+            shapes = [str(underscore_str_to_tuple(path.name)) for path in self.module_dir.iterdir()]
+            return _FakeServerResponse(json_content={shape: {} for shape in shapes})
+
+        shape_dir = tuple_to_underscore_str(underscore_str_to_tuple(data["input_shape"]))
+        return _FakeServerResponse((self.module_dir / shape_dir / "client.zip").read_bytes())
+
+    @staticmethod
+    def post(url: str, data: dict, files: dict) -> _FakeServerResponse:
+        """Answer the requests registering evaluation keys.
+
+        Args:
+            url (str): The requested URL.
+            data (dict): The request's data.
+            files (dict): The request's files.
+
+        Returns:
+            _FakeServerResponse: The key's identifier, the input shape.
+        """
+        assert url.endswith("/add_key") and "key" in files
+        return _FakeServerResponse(json_content={"uid": data["input_shape"]})
+
+
+def test_hybrid_remote_client_shape_bucketing(tmp_path):
+    """Test that clients that were not compiled pad inputs to the buckets served."""
+    n_features = 8
+    model = FCSmall(n_features, torch.nn.ReLU)
+
+    # The developer compiles and saves two buckets
+    inputs = [torch.randn((10, length, n_features)) for length in [2, 4, 6, 8]]
+    hybrid_model = HybridFHEModel(model, module_names="fc1")
+    hybrid_model.compile_model(x=inputs, n_bits=6, n_shape_buckets=2)
+    hybrid_model.save_and_clear_private_info(tmp_path / "dev")
+
+    served_shapes = sorted((tmp_path / "dev" / "fc1").iterdir())
+    assert len(served_shapes) == 2
+
+    # A client only getting the circuits from the server, without compiling the model
+    client_model = HybridFHEModel(
+        FCSmall(n_features, torch.nn.ReLU),
+        module_names="fc1",
+        server_remote_address="http://server",
+    )
+    remote_module = client_model.remote_modules["fc1"]
+    remote_module.session = _FakeServerSession(tmp_path / "dev" / "fc1")  # type: ignore[assignment]
+    remote_module.init_fhe_client(tmp_path / "clients", tmp_path / "keys")
+
+    assert remote_module.shape_buckets == [(1, 4, n_features), (1, 8, n_features)]
+
+    requested_shapes: List[str] = []
+
+    def remote_compute(encrypted_inputs: List[bytes], key_id: str, input_shape: str):
+        """Run the served circuit of the requested shape.
+
+        Args:
+            encrypted_inputs (List[bytes]): The serialized rows.
+            key_id (str): The client's key identifier.
+            input_shape (str): The rows' input shape.
+
+        Returns:
+            List[bytes]: The serialized results.
+        """
+        assert key_id == input_shape
+        requested_shapes.append(input_shape)
+
+        shape_dir = tuple_to_underscore_str(ast.literal_eval(input_shape))
+        server = FHEModelServer(str(tmp_path / "dev" / "fc1" / shape_dir))
+        evaluation_keys = remote_module.clients[input_shape][1].get_serialized_evaluation_keys()
+        return [
+            server.run(encrypted_input, evaluation_keys) for encrypted_input in encrypted_inputs
+        ]
+
+    remote_module._remote_compute = remote_compute  # type: ignore[method-assign]
+    client_model.set_fhe_mode("remote")
+
+    # Inputs are padded to the smallest bucket they fit in, and the padding is then removed
+    y = client_model(torch.randn((2, 3, n_features)))
+    assert y.shape == (2, 3, n_features)
+    assert requested_shapes == [str((1, 4, n_features))]
+
+    with pytest.raises(ValueError, match="does not fit in any of the shape buckets"):
+        client_model(torch.randn((2, 9, n_features)))
+
+
+class _FakeCircuitServer:
+    """A circuit server recording how many of its runs are executed at the same time."""
+
+    def __init__(self, run_duration: float = 0.01):
+        self.run_duration = run_duration
+        self.lock = threading.Lock()
+        self.n_running = 0
+        self.max_running = 0
+        self.executed: List[bytes] = []
+
+    def run(self, serialized_encrypted_quantized_data, **kwargs):
+        """Run the circuit, returning its input reversed.
+
+        Args:
+            serialized_encrypted_quantized_data (bytes): The input.
+            **kwargs: The other parameters of `FHEModelServer.run`, ignored.
+
+        Returns:
+            bytes: The input reversed.
+        """
+        with self.lock:
+            self.n_running += 1
+            self.max_running = max(self.max_running, self.n_running)
+        time.sleep(self.run_duration)
+        with self.lock:
+            self.n_running -= 1
+            self.executed.append(serialized_encrypted_quantized_data)
+        return serialized_encrypted_quantized_data[::-1]
+
+
+def _wait_for_empty_queue(scheduler, timeout=10):
+    """Wait until all the requests queued in the scheduler have been started or discarded."""
+    start = time.time()
+    while scheduler.n_pending > 0:
+        assert time.time() - start < timeout, "The scheduler's queue was not emptied in time"
+        time.sleep(0.001)
+
+
+def _get_fake_hybrid_server(tmp_path, scheduler, circuit_server):
+    """Build a hybrid model server using the given scheduler and circuit server."""
+    (tmp_path / "models").mkdir()
+    server = HybridFHEModelServer(
+        tmp_path / "keys", tmp_path / "models", logger=None, scheduler=scheduler
+    )
+    server.check_inputs = lambda *args: None  # type: ignore[method-assign]
+    server.get_evaluation_keys = lambda uid: b"keys"  # type: ignore[method-assign]
+    server.get_circuit = lambda *args: circuit_server  # type: ignore[method-assign]
+    return server
+
+
+def test_hybrid_server_compute_batch_scheduler(tmp_path):
+    """Test that batches computed by the hybrid server follow the scheduler's limits."""
+    circuit_server = _FakeCircuitServer()
+    model_inputs = [bytes([i, i + 1]) for i in range(8)]
+
+    with RequestScheduler(n_workers={"cpu": 4}, max_concurrency_per_model=2) as scheduler:
+        server = _get_fake_hybrid_server(tmp_path, scheduler, circuit_server)
+        results = server.compute_batch(model_inputs, "uid", "model", "fc1", "(1, 8)")
+
+    # Results keep the inputs' order while rows run concurrently, within the module's limit
+    assert results == [model_input[::-1] for model_input in model_inputs]
+    assert 1 <= circuit_server.max_running <= 2
+
+
+def test_hybrid_server_compute_batch_scheduler_overloaded(tmp_path):
+    """Test that batches not fitting in the scheduler's queue are rejected as a whole."""
+    circuit_server = _FakeCircuitServer()
+    release = threading.Event()
+
+    with RequestScheduler(n_workers={"cpu": 1}, max_queue_size=2) as scheduler:
+        server = _get_fake_hybrid_server(tmp_path, scheduler, circuit_server)
+
+        # Block the only worker while the batch is queued
+        blocking_future = scheduler.submit("other", release.wait)
+        _wait_for_empty_queue(scheduler)
+
+        with pytest.raises(SchedulerOverloadedError, match="The scheduler's queue is full"):
+            server.compute_batch([b"a", b"b", b"c"], "uid", "model", "fc1", "(1, 8)")
+
+        release.set()
+        blocking_future.result()
+        _wait_for_empty_queue(scheduler)
+
+        # The rows queued before the rejection are cancelled and never executed
+        assert server.compute_batch([b"d"], "uid", "model", "fc1", "(1, 8)") == [b"d"]
+
+    assert circuit_server.executed == [b"d"]
+
+
 # pylint: disable=too-many-arguments, too-many-locals, too-many-statements, too-many-branches
 def run_hybrid_llm_test(
     model: torch.nn.Module,
@@ -335,3 +782,38 @@ def test_hybrid_glwe_correctness(n_hidden):
         # For non-GLWE cases, just verify the torch outputs match
         assert numpy.all(numpy.allclose(y_torch, y_hybrid_torch, rtol=1, atol=0.001))
         assert numpy.all(numpy.allclose(y_qm, y_hybrid_torch, rtol=1, atol=0.01))
+
+
+@pytest.mark.parametrize("max_rows_per_batch", [None, 1, 7])
+def test_hybrid_glwe_row_batching(max_rows_per_batch):
+    """Tests that batching the rows encrypted with the GLWE backend does not change the results."""
+
+    if not has_glwe_backend():
+        pytest.skip("GLWE backend not installed")
+
+    n_hidden = 512
+    x = torch.randn(20, n_hidden)
+
+    model = FCSmall(n_hidden, torch.nn.ReLU, hidden=n_hidden)
+    model.eval()
+
+    param_names = [k for k, p in model.named_modules() if isinstance(p, torch.nn.Linear)]
+
+    hybrid_local = HybridFHEModel(model, param_names)
+    hybrid_local.compile_model(x, n_bits=10)
+
+    y_qm = hybrid_local(x, fhe="disable").numpy()
+
+    # Use the same executor, and thus the same keys, with a different batching of the rows
+    hybrid_local.executor.max_rows_per_batch = max_rows_per_batch
+    y_glwe = hybrid_local(x, fhe="execute").numpy()
+
+    # The weights of all layers are converted to the backend's encoding before running them
+    # pylint: disable-next=protected-access
+    assert len(hybrid_local.executor._prepared_weights) == len(param_names)
+
+    # Running a second time re-uses the weights already converted to the backend's encoding
+    y_glwe_cached = hybrid_local(x, fhe="execute").numpy()
+
+    assert numpy.allclose(y_qm, y_glwe, rtol=1, atol=0.01)
+    assert numpy.allclose(y_glwe, y_glwe_cached, rtol=1, atol=0.01)
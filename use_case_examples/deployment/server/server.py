@@ -4,20 +4,30 @@ Routes:
     - Get client.zip
     - Add a key
     - Compute
+
+Compute requests are executed by a scheduler bounding the number of requests waiting for the
+model. Requests are rejected with a 503 status when the queue is full, and with a 504 status when
+their deadline passed before they could be started.
 """
 
+import asyncio
 import io
 import os
 import uuid
 from pathlib import Path
-from typing import Dict
+from typing import Dict, Optional
 
 import uvicorn
 from fastapi import FastAPI, Form, HTTPException, UploadFile
 from fastapi.responses import FileResponse, StreamingResponse
 
 # No relative import here because when not used in the package itself
-from concrete.ml.deployment import FHEModelServer
+from concrete.ml.deployment import (
+    DeadlineExceededError,
+    FHEModelServer,
+    RequestScheduler,
+    SchedulerOverloadedError,
+)
 
 if __name__ == "__main__":
     app = FastAPI(debug=False)
@@ -27,8 +37,11 @@ if __name__ == "__main__":
     KEY_PATH = Path(os.environ.get("KEY_PATH", FILE_FOLDER / Path("server_keys")))
     CLIENT_SERVER_PATH = Path(os.environ.get("PATH_TO_MODEL", FILE_FOLDER / Path("dev")))
     PORT = os.environ.get("PORT", "5000")
+    N_WORKERS = int(os.environ.get("N_WORKERS", str(os.cpu_count() or 1)))
+    MAX_QUEUE_SIZE = int(os.environ.get("MAX_QUEUE_SIZE", "128"))
 
     fhe = FHEModelServer(str(CLIENT_SERVER_PATH.resolve()))
+    scheduler = RequestScheduler(n_workers={"cpu": N_WORKERS}, max_queue_size=MAX_QUEUE_SIZE)
 
     KEYS: Dict[str, bytes] = {}
 
@@ -69,21 +82,44 @@ if __name__ == "__main__":
         return {"uid": uid}
 
     @app.post("/compute")
-    async def compute(model_input: UploadFile, uid: str = Form()):  # noqa: B008
+    async def compute(
+        model_input: UploadFile,
+        uid: str = Form(),  # noqa: B008
+        deadline: Optional[float] = Form(None),  # noqa: B008
+    ):
         """Compute the circuit over encrypted input.
 
         Arguments:
             model_input (UploadFile): input of the circuit
             uid (str): uid of the public key to use
+            deadline (Optional[float]): delay, in seconds, after which the request is dropped if
+                it has not been started yet
 
         Returns:
             StreamingResponse: the result of the circuit
+
+        Raises:
+            HTTPException: if the server is overloaded or if the deadline passed
         """
         key = KEYS[uid]
-        encrypted_results = fhe.run(
-            serialized_encrypted_quantized_data=await model_input.read(),
-            serialized_evaluation_keys=key,
-        )
+        try:
+            future = scheduler.submit_run(
+                "model",
+                fhe,
+                await model_input.read(),
+                serialized_evaluation_keys=key,
+                deadline=deadline,
+            )
+        except SchedulerOverloadedError as error:
+            raise HTTPException(
+                status_code=503, detail=str(error), headers={"Retry-After": "1"}
+            ) from error
+
+        try:
+            encrypted_results = await asyncio.wrap_future(future)
+        except DeadlineExceededError as error:
+            raise HTTPException(status_code=504, detail=str(error)) from error
+
         return StreamingResponse(
             io.BytesIO(encrypted_results),
         )
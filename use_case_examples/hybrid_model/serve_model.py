@@ -5,6 +5,7 @@ Routes:
     - Get client.zip
     - Add a key
     - Compute
+    - Compute a batch
 """
 
 import argparse
@@ -23,7 +24,12 @@ from loguru import logger
 
 # No relative import here because when not used in the package itself
 from concrete.ml.deployment import FHEModelServer
-from concrete.ml.torch.hybrid_model import HybridFHEModelServer, underscore_str_to_tuple
+from concrete.ml.torch.hybrid_model import (
+    HybridFHEModelServer,
+    deserialize_ciphertext_batch,
+    serialize_ciphertext_batch,
+    underscore_str_to_tuple,
+)
 
 if __name__ == "__main__":
     FILE_FOLDER = Path(__file__).parent
@@ -177,4 +183,44 @@ if __name__ == "__main__":
         )
         return StreamingResponse(stream_response(encrypted_results))
 
+    @app.post("/compute_batch")
+    async def compute_batch(
+        model_inputs: UploadFile,
+        uid: str = Form(),
+        model_name: str = Form(),
+        module_name: str = Form(),
+        input_shape: str = Form(),
+    ):
+        """
+        Computes the circuit over a batch of encrypted inputs.
+
+        Args:
+            model_inputs (UploadFile): Inputs of the circuit, serialized using
+                `serialize_ciphertext_batch`.
+            uid (str): The UID of the public key to use for computations.
+            model_name (str): The name of the model to be used.
+            module_name (str): The name of the module containing the computation circuit.
+            input_shape (str): The shape of the input data.
+
+        Returns:
+            StreamingResponse: The results of the computation, serialized using
+                `serialize_ciphertext_batch` and streamed back in chunks.
+        """
+        check_inputs(server, model_name, module_name, input_shape)
+
+        uploaded_data = await model_inputs.read()
+        try:
+            encrypted_inputs = deserialize_ciphertext_batch(uploaded_data)
+        except ValueError as error:
+            raise HTTPException(status_code=400, detail=str(error)) from error
+
+        encrypted_results = server.compute_batch(
+            encrypted_inputs,
+            uid,
+            model_name,
+            module_name,
+            input_shape,
+        )
+        return StreamingResponse(stream_response(serialize_ciphertext_batch(encrypted_results)))
+
     uvicorn.run(app, host="0.0.0.0", port=int(PORT))